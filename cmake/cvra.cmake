@@ -17,6 +17,22 @@ function(cvra_add_test)
     endif()
 endfunction()
 
+# Generate a benchmark exec given benchmark sources and their dependencies
+# Benchmarks use Google Benchmark and are skipped if it is not installed.
+# Called like cvra_add_benchmark(TARGET foo_benchmark SOURCES foo_benchmark.cpp DEPENDENCIES foo_lib)
+function(cvra_add_benchmark)
+    set(options)
+    set(oneValueArgs TARGET)
+    set(multiValueArgs SOURCES DEPENDENCIES)
+    cmake_parse_arguments(BENCHMARK_EXECUTABLE "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+    if (NOT ${CMAKE_CROSSCOMPILING} AND benchmark_FOUND)
+        add_executable(${BENCHMARK_EXECUTABLE_TARGET} ${BENCHMARK_EXECUTABLE_SOURCES})
+
+        target_link_libraries(${BENCHMARK_EXECUTABLE_TARGET} ${BENCHMARK_EXECUTABLE_DEPENDENCIES} benchmark::benchmark)
+    endif()
+endfunction()
+
 macro(add_c_cxx_compiler_flag TARGET)
     add_c_compiler_flag(${TARGET})
     add_cxx_compiler_flag(${TARGET})
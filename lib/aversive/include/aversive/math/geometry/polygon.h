@@ -68,18 +68,57 @@ int is_point_in_poly(poly_t* pol, int16_t x, int16_t y);
  *  and the second segment boundary is out of the polygon) */
 int is_crossing_poly(point_t p1, point_t p2, point_t* intersect_pt, poly_t* pol);
 
-/** Set coordinates of bounding box.
- * @param [in] x1 x-coordinate bottom-left corner
- * @param [in] y1 y-coordiante bottom-left corner
- * @param [in] x2 x-coordinate top-right corner
- * @param [in] y2 y-coordinate top-right corner
+/**@brief An axis-aligned box, such as the playground. */
+typedef struct {
+    int32_t x1; /**< x-coordinate of the bottom-left corner */
+    int32_t y1; /**< y-coordinate of the bottom-left corner */
+    int32_t x2; /**< x-coordinate of the top-right corner */
+    int32_t y2; /**< y-coordinate of the top-right corner */
+} bounding_box_t;
+
+/** Number of cells of a polygon grid along each axis. */
+#define POLY_GRID_SIZE 8
+
+/** Number of polygons which can be indexed by a polygon grid. */
+#define POLY_GRID_MAX_POLYS 64
+
+/**@brief Uniform grid over a list of polygons.
+ *
+ * Each cell stores which polygons have their bounding box overlapping the
+ * cell, so that only the polygons close to a segment need to be checked
+ * against it. The grid must be rebuilt when the polygons change.
+ *
+ * Polygons after the first POLY_GRID_MAX_POLYS are not indexed and are
+ * always returned as candidates.
  */
-void polygon_set_boundingbox(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+typedef struct {
+    float x; /**< x-coordinate of the bottom-left corner */
+    float y; /**< y-coordinate of the bottom-left corner */
+    float cell_width;
+    float cell_height;
+    uint64_t cells[POLY_GRID_SIZE][POLY_GRID_SIZE]; /**< Bitmask of polygons overlapping each cell */
+} poly_grid_t;
 
-/** Checks if a point is in the bounding box.
+/** Builds the grid over the given polygons.
+ * @param [out] *grid The grid to build
+ * @param [in] *polys List of polygons
+ * @param [in] npolys Number of polygons in the list
+ */
+void poly_grid_build(poly_grid_t* grid, const poly_t* polys, int npolys);
+
+/** Finds the polygons which might cross a segment.
+ * @param [in] *grid The grid built over the polygons
+ * @param [in] p1, p2 The two points defining the segment.
+ * @return Bitmask of the polygons close to the segment. Every polygon for
+ * which is_crossing_poly() does not return 0 is in it.
+ */
+uint64_t poly_grid_query(const poly_grid_t* grid, const point_t* p1, const point_t* p2);
+
+/** Checks if a point is in a bounding box.
+ * @param [in] *box The bounding box
  * @param [in] *p Point to check
  * @return 1 if p is in the bounding box. */
-int is_in_boundingbox(const point_t* p);
+int is_in_boundingbox(const bounding_box_t* box, const point_t* p);
 
 /** @brief Constructs the visibility ray graph.
  *
@@ -98,13 +137,18 @@ int is_in_boundingbox(const point_t* p);
  *  point, the polygon is NOT an occluding polygon (but its vertices
  *  are used to compute visibility to start/stop points)
  *
+ *  Vertices outside of the bounding box are not used.
+ *
  * @param [in] *polys List of polygons
  * @param [in] npolys Number of polygons in the list
+ * @param [in] *box Bounding box of the playground
+ * @param [out] *grid Grid used to speed up the computation, can be NULL
  * @param [out] *rays Rays (WTFBBQ?)
- * @return Number of rays
+ * @param [in] max_rays Number of rays which fit in the rays array
+ * @return Number of rays times 4, or -1 if there are more than max_rays
  */
 
-int calc_rays(poly_t* polys, int npolys, int* rays);
+int calc_rays(poly_t* polys, int npolys, const bounding_box_t* box, poly_grid_t* grid, int* rays, int max_rays);
 
 /** Compute the weight of every rays: the length of the rays is used
  * here.
@@ -44,11 +44,15 @@
  */
 
 /*
- * As we run on 4Ko ram uC, we have static structures arrays to store:
+ * As we run on 4Ko ram uC, by default we have static structures arrays to
+ * store:
  *  - MAX_POLY => represent the maximum polygons to avoid in the area.
  *  - MAX_PTS => maximize the sum of every polygons vertices.
  *  - MAX_RAYS => maximum number of rays.
  *  - MAX_CHKPOINTS => maximum accepted checkpoints in the resulting path.
+ *
+ * When more memory is available, oa_init_with_arena() uses caller-supplied
+ * memory instead, of any capacity.
  */
 
 #ifndef _OBSTACLE_AVOIDANCE_H_
@@ -58,6 +62,8 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 #include <aversive/math/geometry/polygon.h>
 #include <aversive/math/geometry/vect_base.h>
 #include <aversive/math/geometry/lines.h>
@@ -65,9 +71,30 @@ extern "C" {
 
 #define MAX_POLY 20 /**< The maximal number of obstacles in the area. */
 #define MAX_PTS 200 /**< The maximal number of polygon vertices. */
-#define MAX_RAYS 1000 /**< The maximal number of rays. */
+#define MAX_RAYS 500 /**< The maximal number of rays. */
 #define MAX_CHKPOINTS 100 /**< Maximal length of the path. */
 
+/** Capacity of an obstacle avoidance instance. */
+struct oa_capacity {
+    int polys; /**< Maximal number of polygons, including the start/end one. */
+    int points; /**< Maximal number of polygon vertices, including start and end. */
+    int rays; /**< Maximal number of rays. */
+    int checkpoints; /**< Maximal length of the path. */
+};
+
+/** Default storage of an instance, used when no arena is given. */
+struct oa_static_storage {
+    poly_t polys[MAX_POLY];
+    point_t points[MAX_PTS];
+    int valid[MAX_PTS];
+    int32_t pweight[MAX_PTS];
+    int p[MAX_PTS];
+    int pt[MAX_PTS];
+    int weight[MAX_RAYS];
+    int rays[MAX_RAYS * 4];
+    point_t res[MAX_CHKPOINTS];
+};
+
 /** @struct obstacle_avoidance
  * @brief Instance of the obstacle avoidance system.
  *
@@ -93,30 +120,77 @@ extern "C" {
  * And each polygon is represented by the sub array starting with the
  * point represented by oa_ext_point_t * pts and composed of int l;
  * (in the oa_poly_t structure)
+ *
+ * All the state used to compute a path is stored in this structure, so
+ * different instances can be processed at the same time by different
+ * threads.
+ *
+ * The arrays point either to the static storage, or to the arena given to
+ * oa_init_with_arena(). Only the part of them which is used is reset and
+ * copied.
  */
 struct obstacle_avoidance {
-    poly_t polys[MAX_POLY]; /**< Array of polygons (obstacles). */
-    point_t points[MAX_PTS]; /**< Array of points, referenced by polys */
-    int valid[MAX_PTS]; /**< Used by the Dijkstra algorithm to say if a point was visited. */
-    int32_t pweight[MAX_PTS]; /**< Weight of a point in Dijkstra. */
-    int p[MAX_PTS]; /**< @todo Dafuq ? */
-    int pt[MAX_PTS]; /**< Stores all the points. */
+    bounding_box_t bbox; /**< Playground, points outside of it are not used. */
+    poly_grid_t grid; /**< Index of the polygons, used to compute the rays. */
+    struct oa_capacity capacity; /**< Size of the arrays below. */
+
+    poly_t* polys; /**< Array of polygons (obstacles). */
+    point_t* points; /**< Array of points, referenced by polys */
+    int* valid; /**< Used by the Dijkstra algorithm to say if a point was visited. */
+    int32_t* pweight; /**< Weight of a point in Dijkstra. */
+    int* p; /**< @todo Dafuq ? */
+    int* pt; /**< Stores all the points. */
 
     int ray_n; /**< Number of computed rays. */
     int cur_poly_idx; /**< Index of the current polygon (for adding polygons). */
     int cur_pt_idx; /**< Index of the current point in the current polygon. */
 
-    int weight[MAX_RAYS]; /**< Length of each ray. */
-    int rays[MAX_RAYS * 2]; /**< All valid rays given by Dijkstra. */
-    point_t res[MAX_CHKPOINTS]; /**< Resulting path. */
+    int* weight; /**< Length of each ray. */
+    int* rays; /**< All valid rays given by Dijkstra. */
+    point_t* res; /**< Resulting path. */
     int res_len; /** Path length */
+
+    struct oa_static_storage storage; /**< Used when no arena is given. */
 };
 
-/** Init the obstacle avoidance structure. */
+/** Init the obstacle avoidance structure, using its static storage. */
 void oa_init(struct obstacle_avoidance* oa);
 
-/** Copies the obstacle avoidance state */
-void oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa);
+/** Capacity needed for the given number of polygons and vertices, with
+ * enough rays for any placement of the polygons.
+ *
+ * @param [in] polys Number of obstacles
+ * @param [in] points Number of vertices of all obstacles
+ */
+struct oa_capacity oa_capacity_for(int polys, int points);
+
+/** Size of the arena needed by an instance of the given capacity, in bytes. */
+size_t oa_arena_size(struct oa_capacity capacity);
+
+/** Init the obstacle avoidance structure, using the given arena instead of
+ * the static storage.
+ *
+ * The arena must be aligned like malloc()'s result, and stay valid as long as
+ * the instance is used.
+ *
+ * @return 0 on success, -1 if the arena is smaller than
+ * oa_arena_size(capacity).
+ */
+int oa_init_with_arena(struct obstacle_avoidance* oa, struct oa_capacity capacity, void* arena, size_t arena_size);
+
+/** Sets the playground. Vertices outside of it are not used for paths.
+ *
+ * The default playground goes from (0, 0) to (100, 100).
+ */
+void oa_set_boundingbox(struct obstacle_avoidance* oa, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/** Copies the obstacle avoidance state.
+ *
+ * dst must have been initialized, and keeps its own storage.
+ *
+ * @return 0 on success, -1 if the state does not fit in dst.
+ */
+int oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa);
 
 /** Set the start and destination point. */
 void oa_start_end_points(struct obstacle_avoidance* oa, int32_t st_x, int32_t st_y, int32_t en_x, int32_t en_y);
@@ -153,9 +227,21 @@ void oa_poly_set_point(struct obstacle_avoidance* oa, poly_t* pol, int32_t x, in
 
 /** Processes the path.
  * @returns The number of points in the path on sucess
- * @returns An error code < 0 in case of failure.
+ * @returns An error code < 0 in case of failure: -1 if the path has too many
+ * points, -2 if there is no path, -3 if there are too many rays.
+ */
+int oa_process(struct obstacle_avoidance* oa);
+
+/** Computes the visibility graph only, for callers searching it themselves.
+ * oa_process() does it before searching the shortest path.
+ *
+ * Ray i goes from oa->polys[oa->rays[4 * i]].pts[oa->rays[4 * i + 1]] to
+ * oa->polys[oa->rays[4 * i + 2]].pts[oa->rays[4 * i + 3]], both ways, and its
+ * length is oa->weight[i].
+ *
+ * @returns The number of rays, or -3 if there are too many of them.
  */
-int8_t oa_process(struct obstacle_avoidance* oa);
+int oa_compute_rays(struct obstacle_avoidance* oa);
 
 /** Gets the computed path.
  *
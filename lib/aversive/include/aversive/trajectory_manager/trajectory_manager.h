@@ -77,6 +77,9 @@ enum trajectory_state {
     /* clitoid */
     RUNNING_CLITOID_LINE, /**< Running a clitoid (line->circle->line) in the line part. */
     RUNNING_CLITOID_CURVE, /**< Running a clitoid in the curve part. */
+
+    /* path */
+    RUNNING_PATH, /**< Tracking a timed path, see trajectory_follow_path_abs(). */
 };
 
 /** Movement target when running on a circle. */
@@ -105,6 +108,42 @@ struct line_target {
     double R; /**< The radius of the circular part. */
 };
 
+/** Maximum number of points of a trajectory going through several points. */
+#define TRAJECTORY_MAX_WAYPOINTS 64
+
+/** Points to go through without stopping, see trajectory_goto_waypoints_abs(). */
+struct waypoints_target {
+    point_t points[TRAJECTORY_MAX_WAYPOINTS]; /**< The points, the last one being the destination. */
+    double max_speed[TRAJECTORY_MAX_WAYPOINTS]; /**< Speed limit on the way to each point, in imp / period. */
+    double pass_speed[TRAJECTORY_MAX_WAYPOINTS]; /**< Speed when going through each point, in imp / period. */
+    int count; /**< Number of points, 0 when not going through several points. */
+    int current; /**< Index of the point the robot is going to. */
+};
+
+/** Timed path tracked by the robot, see trajectory_follow_path_abs().
+ *
+ * Point 0 is where the robot was when the path was given. The reference
+ * drives each segment with a trapezoidal speed profile, turning from the
+ * heading at the point before to the heading at the point after. It turns
+ * in place at the points it stops at. Times are counted in control periods
+ * since the path was given.
+ */
+struct path_target {
+    point_t points[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< The points, in mm. */
+    float heading_in[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< Heading when reaching each point, in rad. */
+    float heading_out[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< Heading when leaving each point, in rad. */
+    float speed[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< Speed at each point, in mm / period. */
+    float peak_speed[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< Highest speed on the way to each point, in mm / period. */
+    float arrival[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< Time at which each point is reached. */
+    float departure[TRAJECTORY_MAX_WAYPOINTS + 1]; /**< Time at which each point is left. */
+    float acc; /**< Acceleration along the path, in mm / period^2. */
+    float turn_speed; /**< Speed when turning in place, in rad / period. */
+    float turn_acc; /**< Acceleration when turning in place, in rad / period^2. */
+    int count; /**< Number of points, including the start. */
+    int current; /**< Index of the point the reference is going to. */
+    int32_t time; /**< Periods since the path was given. */
+};
+
 /** A complete instance of the trajectory manager. */
 struct trajectory {
     absl::Mutex lock_;
@@ -117,8 +156,11 @@ struct trajectory {
         struct rs_polar pol; /**< target, if it is a d,a vector */
         struct circle_target circle; /**< target, if it is a circle */
         struct line_target line; /**< target, if it is a line */
+        struct path_target path; /**< target, if it is a timed path */
     } target GUARDED_BY(lock_); /**< Target of the movement. */
 
+    struct waypoints_target waypoints GUARDED_BY(lock_); /**< Next targets, when going through several points. */
+
     double d_win; /**<< distance window (for END_NEAR) */
     double a_win_rad; /**<< angle window (for END_NEAR) */
     double a_start_rad; /**<< in xy consigns, start to move in distance
@@ -406,6 +448,68 @@ void trajectory_goto_xy_abs(struct trajectory* traj, double x_abs_mm, double y_a
  */
 void trajectory_goto_forward_xy_abs(struct trajectory* traj, double x_abs_mm, double y_abs_mm) LOCKS_EXCLUDED(traj->lock_);
 
+/** @brief Go through several points without stopping.
+ *
+ * This function makes the robot go forward to each point in turn, like
+ * trajectory_goto_forward_xy_abs(). Instead of stopping at the intermediate
+ * points, the robot only slows down enough to turn towards the next one.
+ *
+ * The speed at each point is planned when this function is called: it is
+ * the speed at which the robot can start the next segment given the angle
+ * it turns by (see trajectory_set_windows()), lowered so that the robot can
+ * slow down in time for the points after it.
+ *
+ * The trajectory is only finished, or nearly finished, at the last point.
+ * A single point is driven to like with trajectory_goto_xy_abs(), forward
+ * or backward.
+ *
+ * @param [in] traj The trajectory manager instance.
+ * @param [in] points The points, in mm. Only the first TRAJECTORY_MAX_WAYPOINTS are used.
+ * @param [in] speed_factors Fraction of the speed to drive to each point at,
+ * or NULL to drive at full speed.
+ * @param [in] count The number of points.
+ */
+void trajectory_goto_waypoints_abs(struct trajectory* traj, const point_t* points, const float* speed_factors, int count) LOCKS_EXCLUDED(traj->lock_);
+
+/** @brief Index of the point the robot is going to.
+ *
+ * @param [in] traj The trajectory manager instance.
+ * @return The index of the point in the ones given to
+ * trajectory_goto_waypoints_abs() or trajectory_follow_path_abs(), or -1 if
+ * not going through several points.
+ */
+int trajectory_get_waypoint_index(struct trajectory* traj) LOCKS_EXCLUDED(traj->lock_);
+
+/** @brief Follow a timed path.
+ *
+ * This function makes the robot track a reference moving along the path,
+ * from its current position through each point. Unlike
+ * trajectory_goto_waypoints_abs(), the robot drives the curve between the
+ * points instead of heading for the next one: at each period the distance
+ * and angle consigns are computed from the position and heading of the
+ * reference, their rate of change, and the error of the robot relative to
+ * it. This keeps the robot close to smooth paths at full speed.
+ *
+ * The reference is timed when this function is called. It goes as fast as
+ * the speed and acceleration allow, slower in tight curves so that the
+ * angular speed stays within its limit. At the points turning by more than
+ * the angle start window (see trajectory_set_windows()), it stops and turns
+ * in place. It never reaches a point before its arrival time, if given.
+ *
+ * The robot only goes forward. The event must run at the frequency given to
+ * trajectory_manager_init(). The trajectory is finished once the reference
+ * stopped at the last point and the robot caught up with it.
+ *
+ * @param [in] traj The trajectory manager instance.
+ * @param [in] points The points, in mm. Only the first TRAJECTORY_MAX_WAYPOINTS are used.
+ * @param [in] speed_factors Fraction of the speed to drive to each point at,
+ * or NULL to drive at full speed.
+ * @param [in] arrival_s Earliest time at which to reach each point, in
+ * seconds from now, or NULL to reach them as early as possible.
+ * @param [in] count The number of points.
+ */
+void trajectory_follow_path_abs(struct trajectory* traj, const point_t* points, const float* speed_factors, const float* arrival_s, int count) LOCKS_EXCLUDED(traj->lock_);
+
 /** @brief Go to a point
  *
  * This function is the same as trajectory_goto_xy_abs() but it forces the robot
@@ -449,13 +553,12 @@ void trajectory_goto_xy_rel(struct trajectory* traj, double x_rel_mm, double y_r
  * flag passed tells us if we should go forward or backward and clockwise
  * or counterclockwise.
  *
- * @todo Finish and test this function.
- * @warning Do not use this function yet, it was NOT tested at CVRA.
+ * The robot must already be on the circle, tangent to it.
  *
  * @param [in] traj The trajectory manager instance.
  * @param [in] x,y The coordinate of the center of the circle.
  * @param [in] radius_mm The radius of the circle in mm.
- * @param [in] rel_a_deg The relative target angle.
+ * @param [in] rel_a_deg The angle the robot turns by, its sign is ignored.
  * @param [in] flags Set of OR'd flags to tell if we should go forward/backward and CW/CCW.
  *
  * @sa FORWARD
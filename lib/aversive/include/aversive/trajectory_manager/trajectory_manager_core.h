@@ -108,6 +108,9 @@ void trajectory_manager_xy_event(struct trajectory* traj) EXCLUSIVE_LOCKS_REQUIR
 /* trajectory event for circles */
 void trajectory_manager_circle_event(struct trajectory* traj) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_) SHARED_LOCKS_REQUIRED(traj->position->lock_);
 
+/* trajectory event for timed paths */
+void trajectory_manager_path_event(struct trajectory* traj) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_) SHARED_LOCKS_REQUIRED(traj->position->lock_);
+
 /* trajectory manage events */
 void trajectory_manager_manage(struct trajectory* traj) LOCKS_EXCLUDED(traj->lock_);
 
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 
 #include <aversive/math/geometry/vect_base.h>
 #include <aversive/math/geometry/lines.h>
@@ -37,23 +38,9 @@
 #define debug_printf(args...)
 #endif
 
-/* default bounding box is (0,0) (100,100) */
-static int32_t bbox_x1 = 0;
-static int32_t bbox_y1 = 0;
-static int32_t bbox_x2 = 100;
-static int32_t bbox_y2 = 100;
-
-void polygon_set_boundingbox(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+int is_in_boundingbox(const bounding_box_t* box, const point_t* p)
 {
-    bbox_x1 = x1;
-    bbox_y1 = y1;
-    bbox_x2 = x2;
-    bbox_y2 = y2;
-}
-
-int is_in_boundingbox(const point_t* p)
-{
-    if (p->x >= bbox_x1 && p->x <= bbox_x2 && p->y >= bbox_y1 && p->y <= bbox_y2) {
+    if (p->x >= box->x1 && p->x <= box->x2 && p->y >= box->y1 && p->y <= box->y2) {
         return 1;
     }
     return 0;
@@ -201,6 +188,169 @@ int is_crossing_poly(point_t p1, point_t p2, point_t* intersect_pt, poly_t* pol)
     return 1;
 }
 
+/* Margin added around polygons and segments in the grid, so that rounding
+ * errors never hide a polygon touching a segment. */
+#define POLY_GRID_MARGIN 1.f
+
+/* Below this number of polygons, checking all of them is faster than using
+ * the grid. */
+#define POLY_GRID_MIN_POLYS 8
+
+static int poly_grid_cell(float v, float origin, float cell_size)
+{
+    float c = floorf((v - origin) / cell_size);
+    if (c < 0) {
+        return 0;
+    }
+    if (c > POLY_GRID_SIZE - 1) {
+        return POLY_GRID_SIZE - 1;
+    }
+    return (int)c;
+}
+
+void poly_grid_build(poly_grid_t* grid, const poly_t* polys, int npolys)
+{
+    int i, j, x, y;
+    float x1, y1, x2, y2;
+    float xmin = 0, ymin = 0, xmax = 0, ymax = 0;
+    int first = 1;
+
+    if (npolys > POLY_GRID_MAX_POLYS) {
+        npolys = POLY_GRID_MAX_POLYS;
+    }
+
+    for (i = 0; i < npolys; i++) {
+        for (j = 0; j < polys[i].l; j++) {
+            const point_t* p = &polys[i].pts[j];
+            if (first || p->x < xmin) {
+                xmin = p->x;
+            }
+            if (first || p->x > xmax) {
+                xmax = p->x;
+            }
+            if (first || p->y < ymin) {
+                ymin = p->y;
+            }
+            if (first || p->y > ymax) {
+                ymax = p->y;
+            }
+            first = 0;
+        }
+    }
+
+    grid->x = xmin;
+    grid->y = ymin;
+    grid->cell_width = fmaxf(xmax - xmin, 1.f) / POLY_GRID_SIZE;
+    grid->cell_height = fmaxf(ymax - ymin, 1.f) / POLY_GRID_SIZE;
+    memset(grid->cells, 0, sizeof(grid->cells));
+
+    for (i = 0; i < npolys; i++) {
+        if (polys[i].l == 0) {
+            continue;
+        }
+
+        x1 = x2 = polys[i].pts[0].x;
+        y1 = y2 = polys[i].pts[0].y;
+        for (j = 1; j < polys[i].l; j++) {
+            x1 = fminf(x1, polys[i].pts[j].x);
+            x2 = fmaxf(x2, polys[i].pts[j].x);
+            y1 = fminf(y1, polys[i].pts[j].y);
+            y2 = fmaxf(y2, polys[i].pts[j].y);
+        }
+
+        for (y = poly_grid_cell(y1 - POLY_GRID_MARGIN, grid->y, grid->cell_height);
+             y <= poly_grid_cell(y2 + POLY_GRID_MARGIN, grid->y, grid->cell_height); y++) {
+            for (x = poly_grid_cell(x1 - POLY_GRID_MARGIN, grid->x, grid->cell_width);
+                 x <= poly_grid_cell(x2 + POLY_GRID_MARGIN, grid->x, grid->cell_width); x++) {
+                grid->cells[y][x] |= (uint64_t)1 << i;
+            }
+        }
+    }
+}
+
+uint64_t poly_grid_query(const poly_grid_t* grid, const point_t* p1, const point_t* p2)
+{
+    uint64_t result = 0;
+    int x, y, row_first, row_last;
+    float band_y1, band_y2, seg_x1, seg_x2;
+    const float dx = p2->x - p1->x;
+    const float dy = p2->y - p1->y;
+    const float ymin = fminf(p1->y, p2->y) - POLY_GRID_MARGIN;
+    const float ymax = fmaxf(p1->y, p2->y) + POLY_GRID_MARGIN;
+
+    if (ymax < grid->y || ymin > grid->y + POLY_GRID_SIZE * grid->cell_height) {
+        return 0;
+    }
+
+    row_first = poly_grid_cell(ymin, grid->y, grid->cell_height);
+    row_last = poly_grid_cell(ymax, grid->y, grid->cell_height);
+
+    /* Walk the rows of cells covered by the segment, and only look at the
+     * columns the segment crosses in each row. */
+    for (y = row_first; y <= row_last; y++) {
+        band_y1 = grid->y + y * grid->cell_height;
+        band_y2 = band_y1 + grid->cell_height;
+
+        /* First and last rows extend to the border of the segment, in case
+         * it goes out of the grid. */
+        if (y == row_first || band_y1 < ymin) {
+            band_y1 = ymin;
+        }
+        if (y == row_last || band_y2 > ymax) {
+            band_y2 = ymax;
+        }
+
+        if (dy == 0) {
+            seg_x1 = fminf(p1->x, p2->x);
+            seg_x2 = fmaxf(p1->x, p2->x);
+        } else {
+            /* Clamp the band to the segment, as the margin extends it */
+            const float t1 = fminf(fmaxf((band_y1 - p1->y) / dy, 0.f), 1.f);
+            const float t2 = fminf(fmaxf((band_y2 - p1->y) / dy, 0.f), 1.f);
+            seg_x1 = fminf(p1->x + t1 * dx, p1->x + t2 * dx);
+            seg_x2 = fmaxf(p1->x + t1 * dx, p1->x + t2 * dx);
+        }
+
+        seg_x1 -= POLY_GRID_MARGIN;
+        seg_x2 += POLY_GRID_MARGIN;
+        if (seg_x2 < grid->x || seg_x1 > grid->x + POLY_GRID_SIZE * grid->cell_width) {
+            continue;
+        }
+
+        for (x = poly_grid_cell(seg_x1, grid->x, grid->cell_width);
+             x <= poly_grid_cell(seg_x2, grid->x, grid->cell_width); x++) {
+            result |= grid->cells[y][x];
+        }
+    }
+
+    return result;
+}
+
+/* Checks if a polygon of the list, other than the first one and skip, crosses
+ * the segment. If a grid is given, only the polygons close to the segment in
+ * it are checked. */
+static int is_ray_blocked(const poly_grid_t* grid, poly_t* polys, int npolys, point_t p1, point_t p2, int skip)
+{
+    int index;
+    const uint64_t candidates = grid ? poly_grid_query(grid, &p1, &p2) : UINT64_MAX;
+
+    for (index = 1; index < npolys; index++) {
+        if (index == skip) {
+            continue;
+        }
+
+        if (index < POLY_GRID_MAX_POLYS && !(candidates & ((uint64_t)1 << index))) {
+            continue;
+        }
+
+        if (is_crossing_poly(p1, p2, NULL, &polys[index]) == 1) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 /* Giving the list of poygons, compute the graph of "visibility rays".
  * This rays array is composed of indexes representing 2 polygon
  * vertices that can "see" each others:
@@ -217,16 +367,22 @@ int is_crossing_poly(point_t p1, point_t p2, point_t* intersect_pt, poly_t* pol)
  *  are used to compute visibility to start/stop points)
  */
 
-int calc_rays(poly_t* polys, int npolys, int* rays)
+int calc_rays(poly_t* polys, int npolys, const bounding_box_t* box, poly_grid_t* grid, int* rays, int max_rays)
 {
-    int i, ii, index;
+    int i, ii;
     int ray_n = 0;
-    int is_ok;
     int n;
     int pt1, pt2;
 
     /* !\\first poly is the start stop point */
 
+    if (npolys < POLY_GRID_MIN_POLYS) {
+        grid = NULL;
+    }
+    if (grid) {
+        poly_grid_build(grid, polys, npolys);
+    }
+
     /* 1: calc inner polygon rays
      * compute for each polygon edges, if the vertices can see each others
      * (usefull if interlaced polygons)
@@ -236,33 +392,21 @@ int calc_rays(poly_t* polys, int npolys, int* rays)
         debug_printf("%s(): poly num %d/%d\n", __FUNCTION__, i, npolys);
         for (ii = 0; ii < polys[i].l; ii++) {
             debug_printf("%s() line num %d/%d\n", __FUNCTION__, ii, polys[i].l);
-            if (!is_in_boundingbox(&polys[i].pts[ii])) {
+            if (!is_in_boundingbox(box, &polys[i].pts[ii])) {
                 continue;
             }
-            is_ok = 1;
             n = (ii + 1) % polys[i].l;
 
-            if (!(is_in_boundingbox(&polys[i].pts[n]))) {
+            if (!(is_in_boundingbox(box, &polys[i].pts[n]))) {
                 continue;
             }
 
-            /* check if a polygon cross our ray */
-            for (index = 1; index < npolys; index++) {
-                /* don't check polygon against itself */
-                if (index == i) {
-                    continue;
-                }
-
-                if (is_crossing_poly(polys[i].pts[ii], polys[i].pts[n], NULL,
-                                     &polys[index])
-                    == 1) {
-                    is_ok = 0;
-                    debug_printf("is_crossing_poly() returned 1\n");
-                    break;
+            /* check if a polygon cross our ray, don't check polygon
+             * against itself */
+            if (!is_ray_blocked(grid, polys, npolys, polys[i].pts[ii], polys[i].pts[n], i)) {
+                if (ray_n / 4 >= max_rays) {
+                    return -1;
                 }
-            }
-            /* if ray is not crossed, add it */
-            if (is_ok) {
                 rays[ray_n++] = i;
                 rays[ray_n++] = ii;
                 rays[ray_n++] = i;
@@ -277,30 +421,22 @@ int calc_rays(poly_t* polys, int npolys, int* rays)
     /* For all poly */
     for (i = 0; i < npolys - 1; i++) {
         for (pt1 = 0; pt1 < polys[i].l; pt1++) {
-            if (!(is_in_boundingbox(&polys[i].pts[pt1]))) {
+            if (!(is_in_boundingbox(box, &polys[i].pts[pt1]))) {
                 continue;
             }
 
             /* for next poly */
             for (ii = i + 1; ii < npolys; ii++) {
                 for (pt2 = 0; pt2 < polys[ii].l; pt2++) {
-                    if (!(is_in_boundingbox(&polys[ii].pts[pt2]))) {
+                    if (!(is_in_boundingbox(box, &polys[ii].pts[pt2]))) {
                         continue;
                     }
 
-                    is_ok = 1;
-                    /* test if a poly cross */
-                    for (index = 1; index < npolys; index++) {
-                        if (is_crossing_poly(polys[i].pts[pt1],
-                                             polys[ii].pts[pt2], NULL,
-                                             &polys[index])
-                            == 1) {
-                            is_ok = 0;
-                            break;
-                        }
-                    }
                     /* if not crossed, we found a vilisity ray */
-                    if (is_ok) {
+                    if (!is_ray_blocked(grid, polys, npolys, polys[i].pts[pt1], polys[ii].pts[pt2], -1)) {
+                        if (ray_n / 4 >= max_rays) {
+                            return -1;
+                        }
                         rays[ray_n++] = i;
                         rays[ray_n++] = pt1;
                         rays[ray_n++] = ii;
@@ -1,3 +1,5 @@
+#include <cstdlib>
+#include <vector>
 #include <benchmark/benchmark.h>
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
 
@@ -8,8 +10,8 @@ static void BM_ObstacleAvoidance(benchmark::State& state)
     point_t* points;
     struct obstacle_avoidance oa;
 
-    polygon_set_boundingbox(0, 0, 3000, 3000);
     oa_init(&oa);
+    oa_set_boundingbox(&oa, 0, 0, 3000, 3000);
     oa_start_end_points(&oa, start.x, start.y, end.x, end.y);
 
     for (int i = 0; i < state.range(0); i++) {
@@ -29,4 +31,105 @@ static void BM_ObstacleAvoidance(benchmark::State& state)
 }
 
 BENCHMARK(BM_ObstacleAvoidance)->RangeMultiplier(2)->Range(1, 8);
+
+/* Whole path computation on a cluttered table, with an instance sized for it */
+static void BM_ObstacleAvoidanceCluttered(benchmark::State& state)
+{
+    const int obstacle_count = state.range(0);
+    const auto capacity = oa_capacity_for(obstacle_count, 4 * obstacle_count);
+    std::vector<char> arena(oa_arena_size(capacity));
+    struct obstacle_avoidance oa;
+
+    oa_init_with_arena(&oa, capacity, arena.data(), arena.size());
+    oa_set_boundingbox(&oa, 0, 0, 3000, 2000);
+    oa_start_end_points(&oa, 50, 50, 2950, 1950);
+
+    srand(42);
+    for (int i = 0; i < obstacle_count; i++) {
+        const int x = 100 + rand() % 2700, y = 100 + rand() % 1700;
+        auto obstacle = oa_new_poly(&oa, 4);
+        oa_poly_set_point(&oa, obstacle, x, y, 0);
+        oa_poly_set_point(&oa, obstacle, x + 100, y, 1);
+        oa_poly_set_point(&oa, obstacle, x + 100, y + 100, 2);
+        oa_poly_set_point(&oa, obstacle, x, y + 100, 3);
+    }
+
+    int point_cnt = 0;
+    for (auto _ : state) {
+        point_cnt = oa_process(&oa);
+        benchmark::DoNotOptimize(point_cnt);
+    }
+
+    state.counters["path_points"] = point_cnt;
+    state.counters["rays"] = oa.ray_n / 4;
+}
+
+BENCHMARK(BM_ObstacleAvoidanceCluttered)->RangeMultiplier(2)->Range(8, 32)->Unit(benchmark::kMicrosecond);
+
+/* Copy of a small map, as done before planning on a snapshot of it */
+static void BM_ObstacleAvoidanceCopy(benchmark::State& state)
+{
+    static struct obstacle_avoidance oa, copy;
+
+    oa_init(&oa);
+    oa_init(&copy);
+    oa_set_boundingbox(&oa, 0, 0, 3000, 2000);
+    for (int i = 0; i < 3; i++) {
+        auto obstacle = oa_new_poly(&oa, 4);
+        oa_poly_set_point(&oa, obstacle, 500 + 500 * i, 900, 0);
+        oa_poly_set_point(&oa, obstacle, 600 + 500 * i, 900, 1);
+        oa_poly_set_point(&oa, obstacle, 600 + 500 * i, 1100, 2);
+        oa_poly_set_point(&oa, obstacle, 500 + 500 * i, 1100, 3);
+    }
+    oa_start_end_points(&oa, 200, 1000, 2800, 1000);
+    oa_process(&oa);
+
+    for (auto _ : state) {
+        oa_copy(&copy, &oa);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(BM_ObstacleAvoidanceCopy);
+
+/* Visibility graph of a cluttered table, with obstacles scattered at random */
+static void BM_CalcRays(benchmark::State& state)
+{
+    const int obstacle_count = state.range(0);
+    std::vector<poly_t> polys(obstacle_count + 1);
+    std::vector<point_t> points(2 + 4 * obstacle_count);
+    const bounding_box_t box = {0, 0, 3000, 2000};
+    poly_grid_t grid;
+
+    polys[0].pts = &points[0];
+    polys[0].l = 2;
+    points[0] = {.x = 200, .y = 200};
+    points[1] = {.x = 2800, .y = 1800};
+
+    srand(42);
+    for (int i = 1; i <= obstacle_count; i++) {
+        const float x = 100 + rand() % 2700, y = 100 + rand() % 1700;
+        polys[i].pts = &points[2 + 4 * (i - 1)];
+        polys[i].l = 4;
+        polys[i].pts[0] = {.x = x, .y = y};
+        polys[i].pts[1] = {.x = x + 100, .y = y};
+        polys[i].pts[2] = {.x = x + 100, .y = y + 100};
+        polys[i].pts[3] = {.x = x, .y = y + 100};
+    }
+
+    // Every pair of vertices can be a ray
+    const int max_rays = points.size() * points.size();
+    std::vector<int> rays(4 * max_rays);
+    int ray_n = 0;
+
+    for (auto _ : state) {
+        ray_n = calc_rays(polys.data(), polys.size(), &box, &grid, rays.data(), max_rays);
+        benchmark::DoNotOptimize(rays.data());
+    }
+
+    state.counters["rays"] = ray_n / 4;
+}
+
+BENCHMARK(BM_CalcRays)->RangeMultiplier(2)->Range(4, 64)->Unit(benchmark::kMicrosecond);
+
 BENCHMARK_MAIN();
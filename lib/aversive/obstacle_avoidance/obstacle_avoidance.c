@@ -51,24 +51,23 @@ static void oa_reset(struct obstacle_avoidance* oa)
 {
     DEBUG_OA_PRINTF("%s()\r", __FUNCTION__);
 
-    memset(oa->valid, 0, sizeof(oa->valid));
-    memset(oa->pweight, 0, sizeof(oa->pweight));
-    memset(oa->weight, 0, sizeof(oa->weight));
-    memset(oa->p, 0, sizeof(oa->p));
-    memset(oa->pt, 0, sizeof(oa->pt));
-    memset(oa->rays, 0, sizeof(oa->rays));
-    memset(oa->res, 0, sizeof(oa->res));
+    /* Only the points in use are looked at by the algorithm, and rays are
+     * overwritten by calc_rays() */
+    memset(oa->valid, 0, oa->cur_pt_idx * sizeof(oa->valid[0]));
+    memset(oa->pweight, 0, oa->cur_pt_idx * sizeof(oa->pweight[0]));
+    memset(oa->p, 0, oa->cur_pt_idx * sizeof(oa->p[0]));
+    memset(oa->pt, 0, oa->cur_pt_idx * sizeof(oa->pt[0]));
     oa->ray_n = 0;
     oa->res_len = 0;
 }
 
-/** Init the oa structure. Note: In the algorithm, the first polygon
- * is a dummy one, and is used to represent the START and END points
- * (so it has 2 vertices) */
-void oa_init(struct obstacle_avoidance* oa)
+/* Init the state of oa, once its arrays are set. Note: In the algorithm, the
+ * first polygon is a dummy one, and is used to represent the START and END
+ * points (so it has 2 vertices) */
+static void oa_init_state(struct obstacle_avoidance* oa)
 {
-    DEBUG_OA_PRINTF("%s()\r", __FUNCTION__);
-    memset(oa, 0, sizeof(struct obstacle_avoidance));
+    oa->ray_n = 0;
+    oa->res_len = 0;
 
     /* set a default start and point, reserve the first poly and
      * the first 2 points for it */
@@ -77,12 +76,138 @@ void oa_init(struct obstacle_avoidance* oa)
     __oa_start_end_points(oa, 0, 0, 100, 100);
     oa->cur_pt_idx = 2;
     oa->cur_poly_idx = 1;
+
+    oa_set_boundingbox(oa, 0, 0, 100, 100);
+}
+
+void oa_init(struct obstacle_avoidance* oa)
+{
+    DEBUG_OA_PRINTF("%s()\r", __FUNCTION__);
+
+    oa->capacity.polys = MAX_POLY;
+    oa->capacity.points = MAX_PTS;
+    oa->capacity.rays = MAX_RAYS;
+    oa->capacity.checkpoints = MAX_CHKPOINTS;
+
+    oa->polys = oa->storage.polys;
+    oa->points = oa->storage.points;
+    oa->valid = oa->storage.valid;
+    oa->pweight = oa->storage.pweight;
+    oa->p = oa->storage.p;
+    oa->pt = oa->storage.pt;
+    oa->weight = oa->storage.weight;
+    oa->rays = oa->storage.rays;
+    oa->res = oa->storage.res;
+
+    oa_init_state(oa);
+}
+
+struct oa_capacity oa_capacity_for(int polys, int points)
+{
+    struct oa_capacity capacity;
+
+    /* Add the start and end points. Every vertex has a ray to the next one
+     * of its polygon, and can see at most every other vertex. */
+    capacity.polys = polys + 1;
+    capacity.points = points + 2;
+    capacity.rays = capacity.points + capacity.points * (capacity.points - 1) / 2;
+    capacity.checkpoints = capacity.points;
+
+    return capacity;
+}
+
+/* Places the arrays of an instance of the given capacity in arena, and
+ * returns the size they need. If oa is NULL, the arrays are only measured. */
+static size_t oa_arena_layout(struct obstacle_avoidance* oa, struct oa_capacity capacity, char* arena)
+{
+    size_t size = 0;
+
+#define OA_ARENA_ARRAY(field, count)                                      \
+    do {                                                                  \
+        if (oa) {                                                         \
+            oa->field = (void*)(arena + size);                            \
+        }                                                                 \
+        size += (count) * sizeof(*oa->field);                             \
+        size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);       \
+    } while (0)
+
+    OA_ARENA_ARRAY(polys, capacity.polys);
+    OA_ARENA_ARRAY(points, capacity.points);
+    OA_ARENA_ARRAY(valid, capacity.points);
+    OA_ARENA_ARRAY(pweight, capacity.points);
+    OA_ARENA_ARRAY(p, capacity.points);
+    OA_ARENA_ARRAY(pt, capacity.points);
+    OA_ARENA_ARRAY(weight, capacity.rays);
+    OA_ARENA_ARRAY(rays, 4 * capacity.rays);
+    OA_ARENA_ARRAY(res, capacity.checkpoints);
+
+#undef OA_ARENA_ARRAY
+
+    return size;
+}
+
+size_t oa_arena_size(struct oa_capacity capacity)
+{
+    return oa_arena_layout(NULL, capacity, NULL);
+}
+
+int oa_init_with_arena(struct obstacle_avoidance* oa, struct oa_capacity capacity, void* arena, size_t arena_size)
+{
+    DEBUG_OA_PRINTF("%s()\r", __FUNCTION__);
+
+    if (arena_size < oa_arena_size(capacity) || capacity.polys < 1 || capacity.points < 2) {
+        return -1;
+    }
+
+    oa->capacity = capacity;
+    oa_arena_layout(oa, capacity, arena);
+    oa_init_state(oa);
+
+    return 0;
 }
 
-void oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa)
+void oa_set_boundingbox(struct obstacle_avoidance* oa, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
 {
-    memset(dst, 0, sizeof(struct obstacle_avoidance));
-    memcpy(dst, oa, sizeof(struct obstacle_avoidance));
+    oa->bbox.x1 = x1;
+    oa->bbox.y1 = y1;
+    oa->bbox.x2 = x2;
+    oa->bbox.y2 = y2;
+}
+
+int oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa)
+{
+    int i;
+    const int ray_count = oa->ray_n / 4;
+    const int res_len = oa->res_len > 0 ? oa->res_len : 0;
+
+    if (oa->cur_poly_idx > dst->capacity.polys || oa->cur_pt_idx > dst->capacity.points
+        || ray_count > dst->capacity.rays || res_len > dst->capacity.checkpoints) {
+        return -1;
+    }
+
+    dst->bbox = oa->bbox;
+    dst->ray_n = oa->ray_n;
+    dst->cur_poly_idx = oa->cur_poly_idx;
+    dst->cur_pt_idx = oa->cur_pt_idx;
+    dst->res_len = oa->res_len;
+
+    /* Polygons must use the points of the copy, so that both can be used
+     * independently */
+    for (i = 0; i < oa->cur_poly_idx; i++) {
+        dst->polys[i].l = oa->polys[i].l;
+        dst->polys[i].pts = dst->points + (oa->polys[i].pts - oa->points);
+    }
+
+    memcpy(dst->points, oa->points, oa->cur_pt_idx * sizeof(oa->points[0]));
+    memcpy(dst->valid, oa->valid, oa->cur_pt_idx * sizeof(oa->valid[0]));
+    memcpy(dst->pweight, oa->pweight, oa->cur_pt_idx * sizeof(oa->pweight[0]));
+    memcpy(dst->p, oa->p, oa->cur_pt_idx * sizeof(oa->p[0]));
+    memcpy(dst->pt, oa->pt, oa->cur_pt_idx * sizeof(oa->pt[0]));
+    memcpy(dst->weight, oa->weight, ray_count * sizeof(oa->weight[0]));
+    memcpy(dst->rays, oa->rays, oa->ray_n * sizeof(oa->rays[0]));
+    memcpy(dst->res, oa->res, res_len * sizeof(oa->res[0]));
+
+    return 0;
 }
 
 /**
@@ -126,10 +251,10 @@ poly_t* oa_new_poly(struct obstacle_avoidance* oa, int size)
 {
     DEBUG_OA_PRINTF("%s(size=%d)\r", __FUNCTION__, size);
 
-    if (oa->cur_pt_idx + size > MAX_PTS) {
+    if (oa->cur_pt_idx + size > oa->capacity.points) {
         return NULL;
     }
-    if (oa->cur_poly_idx + 1 > MAX_POLY) {
+    if (oa->cur_poly_idx + 1 > oa->capacity.polys) {
         return NULL;
     }
 
@@ -234,7 +359,7 @@ void oa_dump(struct obstacle_avoidance* oa)
  * When the algo finds a shorter path to reach a point B from point A,
  * it will store in (p, pt) the parent point. This is important to
  * remenber and extract the solution path. */
-void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
+static void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
 {
     int i;
     int8_t add;
@@ -249,7 +374,7 @@ void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
     while (!finish) {
         finish = 1;
 
-        for (start_p = 0; start_p < MAX_POLY; start_p++) {
+        for (start_p = 0; start_p < oa->cur_poly_idx; start_p++) {
             for (start = 0; start < oa->polys[start_p].l; start++) {
                 if (oa->valid[GET_PT(oa->polys[start_p].pts[start])] != 2) {
                     continue;
@@ -306,7 +431,7 @@ void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
 }
 
 /* display the path */
-int8_t get_path(struct obstacle_avoidance* oa, poly_t* polys)
+static int get_path(struct obstacle_avoidance* oa, poly_t* polys)
 {
     int p, pt, p1, pt1, i;
 
@@ -317,7 +442,7 @@ int8_t get_path(struct obstacle_avoidance* oa, poly_t* polys)
     /* forget the first point */
 
     while (!(p == 0 && pt == 0)) {
-        if (i >= MAX_CHKPOINTS) {
+        if (i >= oa->capacity.checkpoints) {
             return -1;
         }
 
@@ -339,8 +464,7 @@ int8_t get_path(struct obstacle_avoidance* oa, poly_t* polys)
     return i;
 }
 
-int8_t
-oa_process(struct obstacle_avoidance* oa)
+int oa_compute_rays(struct obstacle_avoidance* oa)
 {
     int ret;
     int i;
@@ -348,8 +472,11 @@ oa_process(struct obstacle_avoidance* oa)
     oa_reset(oa);
 
     /* First we compute the visibility graph */
-    ret = calc_rays(oa->polys, oa->cur_poly_idx, oa->rays);
+    ret = calc_rays(oa->polys, oa->cur_poly_idx, &oa->bbox, &oa->grid, oa->rays, oa->capacity.rays);
     DEBUG_OA_PRINTF("%s: %d rays\r", __FUNCTION__, ret);
+    if (ret < 0) {
+        return -3;
+    }
 
     DEBUG_OA_PRINTF("Ray list\r");
     for (i = 0; i < ret; i += 4) {
@@ -371,10 +498,20 @@ oa_process(struct obstacle_avoidance* oa)
                         oa->weight[i / 4]);
     }
 
+    oa->ray_n = ret;
+    return ret / 4;
+}
+
+int oa_process(struct obstacle_avoidance* oa)
+{
+    if (oa_compute_rays(oa) < 0) {
+        oa->res_len = -3;
+        return oa->res_len;
+    }
+
     /* We aplly dijkstra on the visibility graph from the start
      * point (point 0 of the polygon 0) */
-    oa->ray_n = ret;
-    DEBUG_OA_PRINTF("dijkstra ray_n = %d\r", ret);
+    DEBUG_OA_PRINTF("dijkstra ray_n = %d\r", oa->ray_n);
     dijkstra(oa, 0, 0);
 
     /* As dijkstra sets the parent points in the resulting graph,
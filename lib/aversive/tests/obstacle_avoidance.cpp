@@ -1,3 +1,5 @@
+#include <thread>
+#include <vector>
 #include <CppUTest/TestHarness.h>
 #include <CppUTestExt/MockSupport.h>
 
@@ -11,8 +13,8 @@ TEST_GROUP (ObstacleAvoidance) {
     struct obstacle_avoidance oa;
     void setup(void)
     {
-        polygon_set_boundingbox(0, 0, 3000, 3000);
         oa_init(&oa);
+        oa_set_boundingbox(&oa, 0, 0, 3000, 3000);
         oa_start_end_points(&oa, start.x, start.y, end.x, end.y);
     }
 };
@@ -103,3 +105,203 @@ TEST(ObstacleAvoidance, FindsPathWithTwoOverlappingObstacles)
     CHECK_EQUAL(end.x, points[2].x);
     CHECK_EQUAL(end.y, points[2].y);
 }
+
+TEST(ObstacleAvoidance, IgnoresPointsOutsideOfPlayground)
+{
+    point_t* points;
+    auto obstacle = oa_new_poly(&oa, 4);
+    oa_poly_set_point(&oa, obstacle, 1400, 900, 3);
+    oa_poly_set_point(&oa, obstacle, 1400, 1300, 2);
+    oa_poly_set_point(&oa, obstacle, 1600, 1300, 1);
+    oa_poly_set_point(&oa, obstacle, 1600, 900, 0);
+
+    // The obstacle's bottom corners cannot be used anymore
+    oa_set_boundingbox(&oa, 0, 950, 3000, 3000);
+    oa_process(&oa);
+
+    auto point_cnt = oa_get_path(&oa, &points);
+
+    CHECK_EQUAL(3, point_cnt);
+    CHECK_EQUAL(1400, points[0].x);
+    CHECK_EQUAL(1300, points[0].y);
+    CHECK_EQUAL(1600, points[1].x);
+    CHECK_EQUAL(1300, points[1].y);
+}
+
+TEST(ObstacleAvoidance, ComputesVisibilityGraphOnly)
+{
+    auto obstacle = oa_new_poly(&oa, 4);
+    oa_poly_set_point(&oa, obstacle, 1400, 900, 3);
+    oa_poly_set_point(&oa, obstacle, 1400, 1300, 2);
+    oa_poly_set_point(&oa, obstacle, 1600, 1300, 1);
+    oa_poly_set_point(&oa, obstacle, 1600, 900, 0);
+
+    auto ray_cnt = oa_compute_rays(&oa);
+
+    CHECK_TRUE(ray_cnt > 0);
+    CHECK_EQUAL(4 * ray_cnt, oa.ray_n);
+
+    // The start and end points cannot see each other
+    for (auto i = 0; i < ray_cnt; i++) {
+        const int* ray = &oa.rays[4 * i];
+        CHECK_FALSE(ray[0] == 0 && ray[2] == 0);
+        CHECK_TRUE(oa.weight[i] > 0);
+    }
+}
+
+TEST(ObstacleAvoidance, CopyIsIndependent)
+{
+    point_t* points;
+    auto obstacle = oa_new_poly(&oa, 4);
+    oa_poly_set_point(&oa, obstacle, 1400, 900, 3);
+    oa_poly_set_point(&oa, obstacle, 1400, 1300, 2);
+    oa_poly_set_point(&oa, obstacle, 1600, 1300, 1);
+    oa_poly_set_point(&oa, obstacle, 1600, 900, 0);
+
+    struct obstacle_avoidance copy;
+    oa_init(&copy);
+    CHECK_EQUAL(0, oa_copy(&copy, &oa));
+
+    // Move the obstacle out of the way in the original only
+    oa_poly_set_point(&oa, obstacle, 1400, 100, 3);
+    oa_poly_set_point(&oa, obstacle, 1400, 200, 2);
+    oa_poly_set_point(&oa, obstacle, 1600, 200, 1);
+    oa_poly_set_point(&oa, obstacle, 1600, 100, 0);
+
+    oa_process(&copy);
+    CHECK_EQUAL(3, oa_get_path(&copy, &points));
+
+    oa_process(&oa);
+    CHECK_EQUAL(1, oa_get_path(&oa, &points));
+}
+
+TEST(ObstacleAvoidance, CanProcessSeveralInstancesConcurrently)
+{
+    // One instance per thread, each with its own playground
+    static struct obstacle_avoidance instances[4];
+    int results[4];
+    std::thread threads[4];
+
+    for (int i = 0; i < 4; i++) {
+        oa_init(&instances[i]);
+        oa_set_boundingbox(&instances[i], 0, i % 2 ? 950 : 0, 3000, 3000);
+        oa_start_end_points(&instances[i], start.x, start.y, end.x, end.y);
+        auto obstacle = oa_new_poly(&instances[i], 4);
+        oa_poly_set_point(&instances[i], obstacle, 1400, 900, 3);
+        oa_poly_set_point(&instances[i], obstacle, 1400, 1300, 2);
+        oa_poly_set_point(&instances[i], obstacle, 1600, 1300, 1);
+        oa_poly_set_point(&instances[i], obstacle, 1600, 900, 0);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        threads[i] = std::thread([&results, i]() {
+            for (int n = 0; n < 100; n++) {
+                oa_process(&instances[i]);
+            }
+            point_t* points;
+            oa_get_path(&instances[i], &points);
+            results[i] = points[0].y;
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < 4; i++) {
+        CHECK_EQUAL(i % 2 ? 1300 : 900, results[i]);
+    }
+}
+
+TEST_GROUP (ObstacleAvoidanceCapacity) {
+    struct obstacle_avoidance oa;
+    std::vector<char> arena;
+
+    // Grid of count x count small squares, with the start and end on opposite
+    // sides of it
+    void add_obstacles(int count)
+    {
+        for (int y = 0; y < count; y++) {
+            for (int x = 0; x < count; x++) {
+                auto obstacle = oa_new_poly(&oa, 4);
+                CHECK_TRUE(obstacle != nullptr);
+                oa_poly_set_point(&oa, obstacle, 300 + 200 * x, 300 + 200 * y, 0);
+                oa_poly_set_point(&oa, obstacle, 400 + 200 * x, 300 + 200 * y, 1);
+                oa_poly_set_point(&oa, obstacle, 400 + 200 * x, 400 + 200 * y, 2);
+                oa_poly_set_point(&oa, obstacle, 300 + 200 * x, 400 + 200 * y, 3);
+            }
+        }
+        oa_start_end_points(&oa, 350, 100, 350, 300 + 200 * count);
+    }
+};
+
+TEST(ObstacleAvoidanceCapacity, StaticStorageIsLimited)
+{
+    oa_init(&oa);
+    oa_set_boundingbox(&oa, 0, 0, 3000, 3000);
+
+    for (int i = 1; i < MAX_POLY; i++) {
+        CHECK_TRUE(oa_new_poly(&oa, 4) != nullptr);
+    }
+    POINTERS_EQUAL(nullptr, oa_new_poly(&oa, 4));
+}
+
+TEST(ObstacleAvoidanceCapacity, TooManyRaysIsAnError)
+{
+    oa_init(&oa);
+    oa_set_boundingbox(&oa, 0, 0, 3000, 3000);
+    add_obstacles(4);
+
+    CHECK_EQUAL(-3, oa_process(&oa));
+}
+
+TEST(ObstacleAvoidanceCapacity, ArenaIsTooSmall)
+{
+    auto capacity = oa_capacity_for(10, 40);
+    arena.resize(oa_arena_size(capacity) - 1);
+
+    CHECK_EQUAL(-1, oa_init_with_arena(&oa, capacity, arena.data(), arena.size()));
+}
+
+TEST(ObstacleAvoidanceCapacity, ArenaCanHoldManyObstacles)
+{
+    auto capacity = oa_capacity_for(36, 4 * 36);
+    arena.resize(oa_arena_size(capacity));
+    CHECK_EQUAL(0, oa_init_with_arena(&oa, capacity, arena.data(), arena.size()));
+    oa_set_boundingbox(&oa, 0, 0, 3000, 3000);
+
+    add_obstacles(6);
+    POINTERS_EQUAL(nullptr, oa_new_poly(&oa, 4));
+
+    // Goes straight along the first column of obstacles
+    auto point_cnt = oa_process(&oa);
+    point_t* points;
+    CHECK_EQUAL(point_cnt, oa_get_path(&oa, &points));
+    CHECK_EQUAL(3, point_cnt);
+    CHECK_EQUAL(300, points[0].x);
+    CHECK_EQUAL(300, points[0].y);
+    CHECK_EQUAL(300, points[1].x);
+    CHECK_EQUAL(1400, points[1].y);
+    CHECK_EQUAL(350, points[2].x);
+    CHECK_EQUAL(1500, points[2].y);
+}
+
+TEST(ObstacleAvoidanceCapacity, CopyNeedsEnoughCapacity)
+{
+    auto capacity = oa_capacity_for(36, 4 * 36);
+    arena.resize(oa_arena_size(capacity));
+    oa_init_with_arena(&oa, capacity, arena.data(), arena.size());
+    add_obstacles(5);
+
+    static struct obstacle_avoidance small;
+    oa_init(&small);
+    CHECK_EQUAL(-1, oa_copy(&small, &oa));
+
+    struct obstacle_avoidance big;
+    std::vector<char> big_arena(arena.size());
+    oa_init_with_arena(&big, capacity, big_arena.data(), big_arena.size());
+    CHECK_EQUAL(0, oa_copy(&big, &oa));
+    CHECK_EQUAL(oa.cur_pt_idx, big.cur_pt_idx);
+    CHECK_EQUAL(oa.points[10].x, big.points[10].x);
+    POINTERS_EQUAL(&big.points[2], big.polys[1].pts);
+}
@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <iostream>
 #include <CppUTest/TestHarness.h>
 
@@ -64,8 +65,6 @@ TEST_GROUP (PolygonIntersection) {
         for (auto i = 0; i < poly.l; i++) {
             poly_points[i] = {0, 0};
         }
-
-        polygon_set_boundingbox(-100, -100, 100, 100);
     }
 };
 
@@ -116,7 +115,6 @@ TEST_GROUP (RayCastingTestGroup) {
         polygons[0].l = 2;
         polygons[1].pts = obstacle;
         polygons[1].l = 4;
-        polygon_set_boundingbox(-100, -100, 100, 100);
     }
 };
 
@@ -131,7 +129,126 @@ TEST(RayCastingTestGroup, CanCastRays)
     startstop[1] = {10, 0};
 
     int rays[128];
-    auto ray_count = calc_rays(polygons, 2, rays);
+    bounding_box_t box = {-100, -100, 100, 100};
+    auto ray_count = calc_rays(polygons, 2, &box, nullptr, rays, 32);
 
     CHECK_EQUAL(8 * 4, ray_count);
 }
+
+TEST(RayCastingTestGroup, IgnoresPointsOutsideOfBoundingBox)
+{
+    obstacle[0] = {-5, -5};
+    obstacle[1] = {5, -5};
+    obstacle[2] = {5, 5};
+    obstacle[3] = {-5, 5};
+
+    startstop[0] = {-10, 0};
+    startstop[1] = {10, 0};
+
+    // Only the top of the obstacle is in the box
+    int rays[128];
+    bounding_box_t box = {-100, 0, 100, 100};
+    auto ray_count = calc_rays(polygons, 2, &box, nullptr, rays, 32);
+
+    // Top edge, and the start and end points to their closest top corner
+    CHECK_EQUAL(3 * 4, ray_count);
+}
+
+TEST(RayCastingTestGroup, FailsWhenRaysDoNotFit)
+{
+    obstacle[0] = {-5, -5};
+    obstacle[1] = {5, -5};
+    obstacle[2] = {5, 5};
+    obstacle[3] = {-5, 5};
+
+    startstop[0] = {-10, 0};
+    startstop[1] = {10, 0};
+
+    int rays[128];
+    bounding_box_t box = {-100, -100, 100, 100};
+
+    CHECK_EQUAL(-1, calc_rays(polygons, 2, &box, nullptr, rays, 7));
+    CHECK_EQUAL(8 * 4, calc_rays(polygons, 2, &box, nullptr, rays, 8));
+}
+
+TEST_GROUP (PolygonGridTestGroup) {
+    static const int poly_count = 40;
+    poly_t polygons[poly_count];
+    point_t points[poly_count][4];
+    poly_grid_t grid;
+
+    void setup() override
+    {
+        for (auto i = 0; i < poly_count; i++) {
+            polygons[i].pts = points[i];
+            polygons[i].l = 4;
+        }
+    }
+
+    void set_square(int i, float x, float y, float size)
+    {
+        points[i][0] = {x, y};
+        points[i][1] = {x + size, y};
+        points[i][2] = {x + size, y + size};
+        points[i][3] = {x, y + size};
+    }
+};
+
+TEST(PolygonGridTestGroup, FarSegmentHasNoCandidates)
+{
+    set_square(0, 0, 0, 100);
+    set_square(1, 1000, 1000, 100);
+    poly_grid_build(&grid, polygons, 2);
+
+    point_t p1 = {0, 1000}, p2 = {100, 1100};
+    CHECK_EQUAL(0, poly_grid_query(&grid, &p1, &p2));
+}
+
+TEST(PolygonGridTestGroup, SegmentInsidePolygonIsCandidate)
+{
+    set_square(0, 0, 0, 100);
+    set_square(1, 1000, 1000, 100);
+    poly_grid_build(&grid, polygons, 2);
+
+    point_t p1 = {1010, 1010}, p2 = {1020, 1030};
+    CHECK_EQUAL(2, poly_grid_query(&grid, &p1, &p2));
+}
+
+TEST(PolygonGridTestGroup, SegmentOutsideOfGrid)
+{
+    set_square(0, 0, 0, 100);
+    set_square(1, 1000, 1000, 100);
+    poly_grid_build(&grid, polygons, 2);
+
+    point_t p1 = {-500, 50}, p2 = {-400, 2000};
+    CHECK_EQUAL(0, poly_grid_query(&grid, &p1, &p2));
+
+    point_t p3 = {-500, 50}, p4 = {3000, 50};
+    CHECK_EQUAL(1, poly_grid_query(&grid, &p3, &p4));
+}
+
+TEST(PolygonGridTestGroup, CandidatesIncludeAllCrossedPolygons)
+{
+    // Squares scattered on the table, and segments between their corners,
+    // like the ones tested by calc_rays
+    srand(42);
+    for (auto i = 0; i < poly_count; i++) {
+        set_square(i, rand() % 2800, rand() % 1800, 50 + rand() % 150);
+    }
+    poly_grid_build(&grid, polygons, poly_count);
+
+    for (auto n = 0; n < 5000; n++) {
+        auto p1 = points[rand() % poly_count][rand() % 4];
+        auto p2 = points[rand() % poly_count][rand() % 4];
+        if (n % 2) {
+            p2 = {float(rand() % 3000), float(rand() % 2000)};
+        }
+
+        auto candidates = poly_grid_query(&grid, &p1, &p2);
+        for (auto i = 0; i < poly_count; i++) {
+            if (is_crossing_poly(p1, p2, nullptr, &polygons[i]) != 0) {
+                CHECK_TRUE(candidates & (uint64_t(1) << i));
+            }
+        }
+    }
+}
@@ -42,6 +42,7 @@ void trajectory_manager_init(struct trajectory* traj, double cs_hz)
     absl::MutexLock l(&traj->lock_);
     traj->cs_hz = cs_hz;
     traj->state = READY;
+    traj->waypoints.count = 0;
 }
 
 /** structure initialization */
@@ -244,6 +244,108 @@ void trajectory_goto_forward_xy_abs(struct trajectory* traj, double x, double y)
     schedule_event(traj);
 }
 
+/** Plans the speed at which the robot goes through each waypoint, from the
+ * last one back to the first. */
+static void plan_waypoints_speed(struct trajectory* traj, point_t start) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_)
+{
+    struct waypoints_target* wp = &traj->waypoints;
+    double next_speed = 0;
+
+    wp->pass_speed[wp->count - 1] = 0;
+
+    for (int i = wp->count - 2; i >= 0; i--) {
+        point_t prev = i == 0 ? start : wp->points[i - 1];
+        point_t corner = wp->points[i];
+        point_t next = wp->points[i + 1];
+
+        /* The xy event drives at full speed once the robot heads towards
+         * its target, and not at all outside of the angle start window. */
+        double turn = simple_modulo_2pi(atan2(next.y - corner.y, next.x - corner.x)
+                                        - atan2(corner.y - prev.y, corner.x - prev.x));
+        double speed = 0;
+        if (traj->a_start_rad > 0) {
+            speed = wp->max_speed[i + 1] * (traj->a_start_rad - fabs(turn)) / traj->a_start_rad;
+        }
+
+        /* Slowing down to the speed at the next point must be possible */
+        double length = pt_norm(&corner, &next) * traj->position->phys.distance_imp_per_mm;
+        double braking_speed = sqrt(next_speed * next_speed + 2 * traj->d_acc * length);
+
+        speed = fmin(speed, braking_speed);
+        speed = fmin(speed, wp->max_speed[i]);
+        speed = fmax(speed, 0);
+
+        wp->pass_speed[i] = speed;
+        next_speed = speed;
+    }
+}
+
+void trajectory_goto_waypoints_abs(struct trajectory* traj, const point_t* points, const float* speed_factors, int count)
+{
+    DEBUG("Goto %d waypoints", count);
+
+    point_t start;
+    start.x = position_get_x_float(traj->position);
+    start.y = position_get_y_float(traj->position);
+
+    absl::MutexLock l(&traj->lock_);
+    delete_event(traj);
+
+    if (count <= 0) {
+        return;
+    }
+    if (count > TRAJECTORY_MAX_WAYPOINTS) {
+        count = TRAJECTORY_MAX_WAYPOINTS;
+    }
+
+    for (int i = 0; i < count; i++) {
+        traj->waypoints.points[i] = points[i];
+        traj->waypoints.max_speed[i] = traj->d_speed * (speed_factors ? speed_factors[i] : 1.f);
+    }
+    traj->waypoints.count = count;
+    traj->waypoints.current = 0;
+    plan_waypoints_speed(traj, start);
+
+    traj->target.cart.x = points[0].x;
+    traj->target.cart.y = points[0].y;
+    traj->state = count == 1 ? RUNNING_XY_START : RUNNING_XY_F_START;
+    schedule_event(traj);
+}
+
+int trajectory_get_waypoint_index(struct trajectory* traj)
+{
+    absl::MutexLock l(&traj->lock_);
+    if (traj->state == RUNNING_PATH) {
+        /* The first point of the path is the start */
+        return traj->target.path.current > 0 ? traj->target.path.current - 1 : 0;
+    }
+    if (traj->waypoints.count == 0) {
+        return -1;
+    }
+    return traj->waypoints.current;
+}
+
+/** True if the robot is going through several points and is not on the way
+ * to the last one yet */
+static bool waypoint_pending(struct trajectory* traj) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_)
+{
+    return traj->waypoints.current < traj->waypoints.count - 1;
+}
+
+/** True if the robot at (x, y) is past the point it is going to, on the
+ * segment leading to it */
+static bool waypoint_passed(struct trajectory* traj, double x, double y) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_)
+{
+    const struct waypoints_target* wp = &traj->waypoints;
+    if (wp->current == 0) {
+        return false;
+    }
+
+    point_t from = wp->points[wp->current - 1];
+    point_t to = wp->points[wp->current];
+    return (x - to.x) * (to.x - from.x) + (y - to.y) * (to.y - from.y) > 0;
+}
+
 void trajectory_goto_backward_xy_abs(struct trajectory* traj, double x, double y)
 {
     DEBUG("Goto XY_B");
@@ -312,6 +414,16 @@ uint8_t trajectory_distance_finished(struct trajectory* traj)
         return 1;
     }
 
+    /* The robot may stop at an intermediate point to turn in place */
+    if (waypoint_pending(traj)) {
+        return 0;
+    }
+
+    /* The consigns of a path only lead the robot by one period */
+    if (traj->state == RUNNING_PATH && traj->scheduled) {
+        return 0;
+    }
+
     return cs_get_consign(traj->csm_distance) == cs_get_filtered_consign(traj->csm_distance);
 }
 
@@ -338,7 +450,7 @@ uint8_t trajectory_in_window(struct trajectory* traj, double d_win, double a_win
         case RUNNING_XY_F_ANGLE_OK:
         case RUNNING_XY_B_ANGLE_OK:
             /* if robot coordinates are near the x,y target */
-            return is_robot_in_xy_window(traj, d_win);
+            return !waypoint_pending(traj) && is_robot_in_xy_window(traj, d_win);
 
         case RUNNING_A:
             return is_robot_in_angle_window(traj, a_win_rad);
@@ -349,6 +461,15 @@ uint8_t trajectory_in_window(struct trajectory* traj, double d_win, double a_win
         case RUNNING_AD:
             return is_robot_in_dist_window(traj, d_win) && is_robot_in_angle_window(traj, a_win_rad);
 
+        case RUNNING_PATH: {
+            /* if robot coordinates are near the end of the path */
+            const struct path_target* path = &traj->target.path;
+            double x = position_get_x_double_unsafe(traj->position);
+            double y = position_get_y_double_unsafe(traj->position);
+            double d = xy_norm(x, y, path->points[path->count - 1].x, path->points[path->count - 1].y);
+            return path->current == path->count - 1 && d < d_win;
+        }
+
         case RUNNING_XY_START:
         case RUNNING_XY_F_START:
         case RUNNING_XY_B_START:
@@ -366,6 +487,7 @@ uint8_t trajectory_in_window(struct trajectory* traj, double d_win, double a_win
 void trajectory_manager_xy_event(struct trajectory* traj)
 {
     double coef = 1.0;
+    double d_speed, pass_speed;
     double x = position_get_x_double_unsafe(traj->position);
     double y = position_get_y_double_unsafe(traj->position);
     double a = position_get_a_rad_double_unsafe(traj->position);
@@ -415,16 +537,25 @@ void trajectory_manager_xy_event(struct trajectory* traj)
 
             /* If the robot is correctly oriented to start moving in distance */
             /* here limit dist speed depending on v2pol_target.theta */
+            d_speed = traj->waypoints.count ? traj->waypoints.max_speed[traj->waypoints.current] : traj->d_speed;
             if (fabs(v2pol_target.theta) > traj->a_start_rad) { // || ABS(v2pol_target.r) < traj->d_win)
                 set_quadramp_speed(traj, 0, traj->a_speed);
             } else {
                 coef = (traj->a_start_rad - fabs(v2pol_target.theta)) / traj->a_start_rad;
-                set_quadramp_speed(traj, traj->d_speed * coef, traj->a_speed);
+                set_quadramp_speed(traj, d_speed * coef, traj->a_speed);
             }
 
             d_consign = (int32_t)(v2pol_target.r * (traj->position->phys.distance_imp_per_mm));
             d_consign += rs_get_distance(traj->robot);
 
+            /* When going through a point, the distance consign is further
+             * away by the distance needed to stop from the speed planned
+             * there, so the ramp only slows down to that speed. */
+            if (waypoint_pending(traj) && traj->d_acc > 0) {
+                pass_speed = traj->waypoints.pass_speed[traj->waypoints.current];
+                d_consign += (int32_t)(pass_speed * pass_speed / (2 * traj->d_acc));
+            }
+
             /* angle consign */
             /* Here we specify 2.2 instead of 2.0 to avoid oscillations */
             a_consign = (int32_t)(v2pol_target.theta * (traj->position->phys.distance_imp_per_mm) * (traj->position->phys.track_mm) / 2.2);
@@ -468,8 +599,18 @@ void trajectory_manager_xy_event(struct trajectory* traj)
         case RUNNING_XY_ANGLE_OK:
         case RUNNING_XY_F_ANGLE_OK:
         case RUNNING_XY_B_ANGLE_OK:
+            /* Go on to the next point once this one is reached, or passed
+             * because the robot was too fast to get in the window */
+            if (waypoint_pending(traj)) {
+                if (is_robot_in_xy_window(traj, traj->d_win) || waypoint_passed(traj, x, y)) {
+                    traj->waypoints.current++;
+                    traj->target.cart.x = traj->waypoints.points[traj->waypoints.current].x;
+                    traj->target.cart.y = traj->waypoints.points[traj->waypoints.current].y;
+                    DEBUG("-> waypoint %d", traj->waypoints.current);
+                }
+            }
             /* If we reached the destination */
-            if (is_robot_in_xy_window(traj, traj->d_win)) {
+            else if (is_robot_in_xy_window(traj, traj->d_win)) {
                 delete_event(traj);
             }
             break;
@@ -550,8 +691,18 @@ void trajectory_manager_circle_event(struct trajectory* traj)
     coef_p = v2pol_target.r / radius;
     coef_p = 1. * coef_p;
 
-    angle_to_center_rad = v2pol_target.theta - (M_PI / 2.);
+    /* The center is on the left of the robot when it goes forward
+     * counterclockwise or backward clockwise, and on its right otherwise.
+     * Positive values mean the robot drifts away from the center. */
+    if (!(traj->target.circle.flags & TRIGO) == !(traj->target.circle.flags & FORWARD)) {
+        angle_to_center_rad = v2pol_target.theta - (M_PI / 2.);
+    } else {
+        angle_to_center_rad = -(v2pol_target.theta + (M_PI / 2.));
+    }
     angle_to_center_rad = simple_modulo_2pi(angle_to_center_rad);
+    if (!(traj->target.circle.flags & FORWARD)) {
+        angle_to_center_rad = -angle_to_center_rad;
+    }
     if (angle_to_center_rad > 0.5) {
         angle_to_center_rad = 0.5;
     }
@@ -676,6 +827,10 @@ void trajectory_manager_manage(struct trajectory* traj)
                 trajectory_manager_line_event(traj);
                 break;
 
+            case RUNNING_PATH:
+                trajectory_manager_path_event(traj);
+                break;
+
             default:
                 break;
         }
@@ -706,10 +861,16 @@ void trajectory_circle_rel(struct trajectory* traj,
     traj->target.circle.radius = radius_mm;
     traj->target.circle.flags = flags;
 
-    /* convert in steps  */
-    dst_angle = RAD(rel_a_deg) * (traj->position->phys.distance_imp_per_mm) * (traj->position->phys.track_mm) / 2.0;
+    /* convert in steps, the direction being given by the flags */
+    dst_angle = fabs(RAD(rel_a_deg)) * (traj->position->phys.distance_imp_per_mm) * (traj->position->phys.track_mm) / 2.0;
+    if (!(flags & TRIGO)) {
+        dst_angle = -dst_angle;
+    }
 
-    dst_distance = RAD(rel_a_deg) * (traj->position->phys.distance_imp_per_mm) * radius_mm;
+    dst_distance = fabs(RAD(rel_a_deg)) * (traj->position->phys.distance_imp_per_mm) * radius_mm;
+    if (!(flags & FORWARD)) {
+        dst_distance = -dst_distance;
+    }
 
     traj->target.circle.dest_angle = rs_get_angle(traj->robot);
     traj->target.circle.dest_angle += dst_angle;
@@ -777,6 +938,326 @@ void trajectory_line_abs(struct trajectory* traj,
     schedule_event(traj);
 }
 
+/*********** *PATH */
+
+/* Convergence of the path tracking, see trajectory_manager_path_event() */
+#define PATH_DAMPING 0.7 /* damping of the error */
+#define PATH_LATERAL_GAIN 2.5e-5 /* in 1 / mm^2, the error to the side is corrected at sqrt(gain) * speed */
+#define PATH_MIN_GAIN_S 0.2 /* time to correct the error when the reference does not move, in s */
+#define PATH_ACC_RATIO 0.8 /* the reference accelerates slower than the ramps, so that the robot can catch up */
+
+/** Highest speed of a move over length from speed v0 to speed v1 */
+static double ramp_peak_speed(double length, double v0, double v1, double max_speed, double acc)
+{
+    return fmin(max_speed, sqrt(acc * length + (v0 * v0 + v1 * v1) / 2));
+}
+
+/** Duration of a move over length from speed v0 to speed v1 going at most
+ * at speed vp, with constant acceleration and deceleration. The speeds must
+ * be reachable over length. */
+static double ramp_duration(double length, double v0, double vp, double v1, double acc)
+{
+    if (length <= 0) {
+        return 0;
+    }
+
+    double cruise = length - (vp * vp - v0 * v0) / (2 * acc) - (vp * vp - v1 * v1) / (2 * acc);
+    return (vp - v0) / acc + (vp - v1) / acc + cruise / vp;
+}
+
+/** Distance gone at time t of the move of ramp_duration(), with the speed
+ * at that time in speed */
+static double ramp_position(double length, double v0, double vp, double v1, double acc, double t, double* speed)
+{
+    double duration = ramp_duration(length, v0, vp, v1, acc);
+    double t_acc = (vp - v0) / acc;
+    double t_dec = (vp - v1) / acc;
+    double t_left = duration - t;
+
+    if (t >= duration) {
+        *speed = v1;
+        return length;
+    }
+    if (t < t_acc) {
+        *speed = v0 + acc * t;
+        return v0 * t + acc * t * t / 2;
+    }
+    if (t_left < t_dec) {
+        *speed = v1 + acc * t_left;
+        return length - v1 * t_left - acc * t_left * t_left / 2;
+    }
+    *speed = vp;
+    return (vp * vp - v0 * v0) / (2 * acc) + vp * (t - t_acc);
+}
+
+/** Duration of a turn in place of the path */
+static double path_turn_duration(const struct path_target* path, int i)
+{
+    double angle = fabs(path->heading_out[i] - path->heading_in[i]);
+    double peak = ramp_peak_speed(angle, 0, 0, path->turn_speed, path->turn_acc);
+    return ramp_duration(angle, 0, peak, 0, path->turn_acc);
+}
+
+/** Computes the headings of the path, and at which points to stop and turn
+ * in place. The robot starts with heading a. */
+static void plan_path_headings(struct trajectory* traj, double a) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_)
+{
+    struct path_target* path = &traj->target.path;
+    double heading = a;
+
+    path->heading_in[0] = a;
+
+    for (int i = 0; i < path->count - 1; i++) {
+        point_t* from = &path->points[i];
+        point_t* to = &path->points[i + 1];
+
+        /* Segments too short to have a meaningful direction do not turn */
+        double turn = 0;
+        if (pt_norm(from, to) >= traj->d_win) {
+            turn = modulo_2pi(atan2(to->y - from->y, to->x - from->x) - heading);
+        }
+
+        /* The reference follows the curve going through the points,
+         * tangent to the bisector of the segments at each of them */
+        if (fabs(turn) > traj->a_start_rad) {
+            path->heading_out[i] = heading + turn;
+        } else if (i == 0 || pt_norm(&path->points[i - 1], from) < traj->d_win) {
+            path->heading_out[i] = heading;
+        } else {
+            path->heading_in[i] += turn / 2;
+            path->heading_out[i] = path->heading_in[i];
+        }
+
+        heading += turn;
+        path->heading_in[i + 1] = heading;
+    }
+
+    path->heading_out[path->count - 1] = path->heading_in[path->count - 1];
+}
+
+/** Plans the speed at each point of the path and when the reference gets
+ * there, going at most at the given speed. The robot starts at start_speed. */
+static void plan_path_timing(struct trajectory* traj, double start_speed, double speed, const float* speed_factors, const float* arrival_s) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_)
+{
+    struct path_target* path = &traj->target.path;
+    double max_speed[TRAJECTORY_MAX_WAYPOINTS + 1];
+
+    /* Speed limits on the way to each point, the angular speed being the
+     * speed times the change of heading per mm */
+    for (int i = 1; i < path->count; i++) {
+        double length = pt_norm(&path->points[i - 1], &path->points[i]);
+        double turn = fabs(path->heading_in[i] - path->heading_out[i - 1]);
+
+        max_speed[i] = speed;
+        if (speed_factors) {
+            max_speed[i] *= speed_factors[i - 1];
+        }
+        if (turn > 0) {
+            max_speed[i] = fmin(max_speed[i], path->turn_speed * length / turn);
+        }
+    }
+
+    /* The speed at each point must fit the segments on both sides, and the
+     * robot stops to turn in place */
+    path->speed[0] = start_speed;
+    for (int i = 0; i < path->count; i++) {
+        if (i > 0) {
+            path->speed[i] = max_speed[i];
+        }
+        if (i + 1 < path->count) {
+            path->speed[i] = fmin(path->speed[i], max_speed[i + 1]);
+        }
+        if (path->heading_out[i] != path->heading_in[i] || i == path->count - 1) {
+            path->speed[i] = 0;
+        }
+    }
+
+    /* Speeding up and slowing down must be possible */
+    for (int i = 1; i < path->count; i++) {
+        double length = pt_norm(&path->points[i - 1], &path->points[i]);
+        path->speed[i] = fmin(path->speed[i], sqrt(path->speed[i - 1] * path->speed[i - 1] + 2 * path->acc * length));
+    }
+    for (int i = path->count - 2; i >= 0; i--) {
+        double length = pt_norm(&path->points[i], &path->points[i + 1]);
+        path->speed[i] = fmin(path->speed[i], sqrt(path->speed[i + 1] * path->speed[i + 1] + 2 * path->acc * length));
+    }
+
+    path->arrival[0] = 0;
+    path->departure[0] = path_turn_duration(path, 0);
+
+    for (int i = 1; i < path->count; i++) {
+        double length = pt_norm(&path->points[i - 1], &path->points[i]);
+        double v0 = path->speed[i - 1], v1 = path->speed[i];
+
+        path->peak_speed[i] = ramp_peak_speed(length, v0, v1, max_speed[i], path->acc);
+        path->arrival[i] = path->departure[i - 1] + ramp_duration(length, v0, path->peak_speed[i], v1, path->acc);
+
+        /* Arriving later stretches the whole segment */
+        if (arrival_s && arrival_s[i - 1] * traj->cs_hz > path->arrival[i]) {
+            path->arrival[i] = arrival_s[i - 1] * traj->cs_hz;
+        }
+
+        path->departure[i] = path->arrival[i] + path_turn_duration(path, i);
+    }
+}
+
+void trajectory_follow_path_abs(struct trajectory* traj, const point_t* points, const float* speed_factors, const float* arrival_s, int count)
+{
+    DEBUG("Follow path of %d points", count);
+
+    absl::MutexLock l(&traj->lock_);
+    absl::ReaderMutexLock lp(&traj->position->lock_);
+    struct path_target* path = &traj->target.path;
+    struct quadramp_filter* q_d = static_cast<struct quadramp_filter*>(traj->csm_distance->consign_filter_params);
+    double imp_per_mm = traj->position->phys.distance_imp_per_mm;
+    double imp_per_rad = imp_per_mm * traj->position->phys.track_mm / 2;
+
+    delete_event(traj);
+
+    if (count <= 0) {
+        return;
+    }
+    if (count > TRAJECTORY_MAX_WAYPOINTS) {
+        count = TRAJECTORY_MAX_WAYPOINTS;
+    }
+
+    path->points[0].x = position_get_x_double_unsafe(traj->position);
+    path->points[0].y = position_get_y_double_unsafe(traj->position);
+    for (int i = 0; i < count; i++) {
+        path->points[i + 1] = points[i];
+    }
+    path->count = count + 1;
+    path->current = 0;
+    path->time = 0;
+
+    /* Without acceleration limit, the reference gets to full speed in one
+     * period */
+    path->acc = traj->d_acc > 0 ? PATH_ACC_RATIO * traj->d_acc / imp_per_mm : traj->d_speed / imp_per_mm;
+    path->turn_speed = traj->a_speed / imp_per_rad;
+    path->turn_acc = traj->a_acc > 0 ? PATH_ACC_RATIO * traj->a_acc / imp_per_rad : path->turn_speed;
+
+    plan_path_headings(traj, position_get_a_rad_double_unsafe(traj->position));
+    plan_path_timing(traj, fmax(q_d->previous_var / imp_per_mm, 0), traj->d_speed / imp_per_mm, speed_factors, arrival_s);
+
+    traj->state = RUNNING_PATH;
+    schedule_event(traj);
+}
+
+/** Position, heading, speed and angular speed of the reference of the path
+ * at its current time */
+static void path_reference(struct path_target* path, double* x, double* y, double* heading, double* v, double* omega)
+{
+    double t = path->time;
+
+    while (path->current < path->count - 1 && t >= path->departure[path->current]) {
+        path->current++;
+    }
+
+    int i = path->current;
+    *v = 0;
+    *omega = 0;
+
+    /* Turning in place, or stopped at the end */
+    if (i == 0 || t >= path->arrival[i]) {
+        double angle = path->heading_out[i] - path->heading_in[i];
+        double peak = ramp_peak_speed(fabs(angle), 0, 0, path->turn_speed, path->turn_acc);
+        double turned = ramp_position(fabs(angle), 0, peak, 0, path->turn_acc, t - path->arrival[i], omega);
+
+        *x = path->points[i].x;
+        *y = path->points[i].y;
+        *heading = path->heading_in[i] + (angle < 0 ? -turned : turned);
+        if (angle < 0) {
+            *omega = -*omega;
+        }
+        return;
+    }
+
+    point_t* from = &path->points[i - 1];
+    point_t* to = &path->points[i];
+    double length = pt_norm(from, to);
+    double v0 = path->speed[i - 1], vp = path->peak_speed[i], v1 = path->speed[i];
+
+    /* Slower than planned to arrive in time */
+    double duration = path->arrival[i] - path->departure[i - 1];
+    double scale = duration > 0 ? ramp_duration(length, v0, vp, v1, path->acc) / duration : 1;
+
+    double s = ramp_position(length, v0, vp, v1, path->acc, (t - path->departure[i - 1]) * scale, v);
+    double ratio = length > 0 ? s / length : 1;
+    double turn = path->heading_in[i] - path->heading_out[i - 1];
+
+    *v *= scale;
+    *x = from->x + ratio * (to->x - from->x);
+    *y = from->y + ratio * (to->y - from->y);
+    *heading = path->heading_out[i - 1] + ratio * turn;
+    *omega = length > 0 ? *v * turn / length : 0;
+}
+
+/* trajectory event for timed paths */
+void trajectory_manager_path_event(struct trajectory* traj)
+{
+    struct path_target* path = &traj->target.path;
+    double x = position_get_x_double_unsafe(traj->position);
+    double y = position_get_y_double_unsafe(traj->position);
+    double a = position_get_a_rad_double_unsafe(traj->position);
+    double imp_per_mm = traj->position->phys.distance_imp_per_mm;
+    double imp_per_rad = imp_per_mm * traj->position->phys.track_mm / 2;
+    double x_ref, y_ref, a_ref, v_ref, omega_ref;
+    int32_t d_consign, a_consign;
+
+    path_reference(path, &x_ref, &y_ref, &a_ref, &v_ref, &omega_ref);
+    path->time++;
+
+    /* error in the frame of the robot */
+    double err_x = cos(a) * (x_ref - x) + sin(a) * (y_ref - y);
+    double err_y = -sin(a) * (x_ref - x) + cos(a) * (y_ref - y);
+    double err_a = modulo_2pi(a_ref - a);
+
+    /* The reference stopped at the end and the robot caught up */
+    bool finished = path->current == path->count - 1 && path->time > path->departure[path->current];
+    if (finished && fabs(err_x) < traj->d_win) {
+        DEBUG("Path done");
+        delete_event(traj);
+        cs_set_consign(traj->csm_distance, cs_get_filtered_consign(traj->csm_distance) + (int32_t)(err_x * imp_per_mm));
+        cs_set_consign(traj->csm_angle, cs_get_filtered_consign(traj->csm_angle));
+        return;
+    }
+
+    /* Tracking control law of a unicycle, with gains increasing with the
+     * speed of the reference so that the errors decay over the same
+     * distance. The error to the side can only be corrected while moving. */
+    double gain = 2 * PATH_DAMPING * sqrt(omega_ref * omega_ref + PATH_LATERAL_GAIN * v_ref * v_ref);
+    gain = fmax(gain, 1 / (PATH_MIN_GAIN_S * traj->cs_hz));
+    double sinc_a = fabs(err_a) > 1e-6 ? sin(err_a) / err_a : 1;
+
+    double v = v_ref * cos(err_a) + gain * err_x;
+    double omega = omega_ref + PATH_LATERAL_GAIN * v_ref * sinc_a * err_y + gain * err_a;
+
+    v = fmin(fmax(v, 0), traj->d_speed / imp_per_mm) * imp_per_mm;
+    omega = fmin(fmax(omega, -path->turn_speed), path->turn_speed) * imp_per_rad;
+
+    /* The ramps go at the computed speeds, the consigns being far enough
+     * for them not to slow down before the next period. */
+    set_quadramp_speed(traj, v, omega);
+
+    double d_lead = v + 2;
+    if (traj->d_acc > 0) {
+        d_lead += v * v / (2 * traj->d_acc);
+    }
+    double a_lead = fabs(omega) + 2;
+    if (traj->a_acc > 0) {
+        a_lead += omega * omega / (2 * traj->a_acc);
+    }
+
+    d_consign = cs_get_filtered_consign(traj->csm_distance) + (int32_t)d_lead;
+    a_consign = cs_get_filtered_consign(traj->csm_angle) + (int32_t)(omega < 0 ? -a_lead : a_lead);
+
+    EVT_DEBUG("EVENT PATH ref=(%2.2f, %2.2f, %2.2f) err=(%2.2f, %2.2f, %2.2f) v=%2.2f omega=%2.2f",
+              x_ref, y_ref, a_ref, err_x, err_y, err_a, v, omega);
+
+    cs_set_consign(traj->csm_angle, a_consign);
+    cs_set_consign(traj->csm_distance, d_consign);
+}
+
 /*** CLOTHOID */
 
 /**
@@ -81,6 +81,7 @@ void delete_event(struct trajectory* traj)
     set_quadramp_speed(traj, traj->d_speed, traj->a_speed);
     set_quadramp_acc(traj, traj->d_acc, traj->a_acc);
     traj->scheduled = false;
+    traj->waypoints.count = 0;
 }
 
 /** schedule the trajectory event */
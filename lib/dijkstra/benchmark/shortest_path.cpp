@@ -0,0 +1,102 @@
+#include <cmath>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <dijkstra/dijkstra.hpp>
+
+// Square grid with diagonals, like a roadmap of arm configurations
+static pathfinding::Graph make_grid(int size)
+{
+    std::vector<pathfinding::Edge> edges;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    const int nx = x + dx, ny = y + dy;
+                    if ((dx || dy) && nx >= 0 && nx < size && ny >= 0 && ny < size) {
+                        edges.push_back({y * size + x, ny * size + nx, std::hypot(float(dx), float(dy))});
+                    }
+                }
+            }
+        }
+    }
+    return pathfinding::Graph(size * size, edges);
+}
+
+static void BM_ShortestPath(benchmark::State& bench)
+{
+    const int size = bench.range(0);
+    const bool use_heuristic = bench.range(1);
+    const auto grid = make_grid(size);
+    const int end = grid.node_count() - 1;
+    std::vector<int> path;
+
+    auto distance_to_end = [&](int n) {
+        const int dx = size - 1 - n % size;
+        const int dy = size - 1 - n / size;
+        return std::hypot(float(dx), float(dy));
+    };
+
+    for (auto _ : bench) {
+        float cost;
+        if (use_heuristic) {
+            cost = pathfinding::shortest_path(grid, 0, end, path, distance_to_end);
+        } else {
+            cost = pathfinding::shortest_path(grid, 0, end, path);
+        }
+        benchmark::DoNotOptimize(cost);
+    }
+
+    bench.counters["nodes"] = grid.node_count();
+    bench.counters["edges"] = grid.edge_count();
+}
+
+BENCHMARK(BM_ShortestPath)->ArgNames({"size", "astar"})->RangeMultiplier(2)->Ranges({{8, 64}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+// Same grid through the linked nodes interface, without diagonals
+static std::vector<pathfinding::Node<int, 4>> make_node_grid(int size)
+{
+    std::vector<pathfinding::Node<int, 4>> nodes;
+    for (int i = 0; i < size * size; i++) {
+        nodes.emplace_back(i);
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (x + 1 < size) {
+                connect_bidirectional(nodes[y * size + x], nodes[y * size + x + 1]);
+            }
+            if (y + 1 < size) {
+                connect_bidirectional(nodes[y * size + x], nodes[(y + 1) * size + x]);
+            }
+        }
+    }
+    return nodes;
+}
+
+// Converts the nodes to a graph at every search
+static void BM_NodeDijkstra(benchmark::State& bench)
+{
+    auto nodes = make_node_grid(bench.range(0));
+
+    for (auto _ : bench) {
+        auto len = pathfinding::dijkstra(nodes.data(), nodes.size(), nodes.front(), nodes.back());
+        benchmark::DoNotOptimize(len);
+    }
+}
+
+BENCHMARK(BM_NodeDijkstra)->RangeMultiplier(2)->Range(8, 64)->Unit(benchmark::kMicrosecond);
+
+// Converts the nodes to a graph once
+static void BM_NodeGraphDijkstra(benchmark::State& bench)
+{
+    auto nodes = make_node_grid(bench.range(0));
+    pathfinding::NodeGraph<pathfinding::Node<int, 4>> graph(nodes.data(), nodes.size());
+
+    for (auto _ : bench) {
+        auto len = graph.dijkstra(nodes.front(), nodes.back());
+        benchmark::DoNotOptimize(len);
+    }
+}
+
+BENCHMARK(BM_NodeGraphDijkstra)->RangeMultiplier(2)->Range(8, 64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -2,6 +2,8 @@
 
 #include <iterator>
 #include <climits>
+#include <vector>
+#include "graph.hpp"
 
 namespace pathfinding {
 
@@ -13,94 +15,152 @@ namespace pathfinding {
 template <typename Data, int N = 10>
 class Node {
 protected:
-    Node<Data>* edges[N];
+    Node* edges[N];
+    float weights[N];
     int edge_count;
 
-    /* Used for dijkstra */
-    bool visited;
-    int distance;
-    Node<Data>* parent;
-
 public:
     template <typename T>
-    friend int dijkstra(T* nodes, int node_count, T& start, T& end);
+    friend class NodeGraph;
 
     Node(Data d)
         : edge_count(0)
+        , path_next(nullptr)
         , data{d}
     {
     }
 
-    void connect(Node<Data>& n)
+    /** Adds an edge to n, costing weight to follow.
+     *
+     * @returns false if this node already has N neighbors.
+     */
+    bool connect(Node& n, float weight = 1)
     {
+        if (edge_count == N) {
+            return false;
+        }
         edges[edge_count] = &n;
+        weights[edge_count] = weight;
         edge_count += 1;
+        return true;
     }
 
-    Node<Data>* path_next; ///< Pointer to the next node in the calculated path
+    /** True if another edge can be added to this node */
+    bool can_connect() const
+    {
+        return edge_count < N;
+    }
+
+    Node* path_next; ///< Pointer to the next node in the calculated path
     Data data;
 };
 
 /** Connects two nodes in both directions
+ *
+ * @returns false if either node already has N neighbors, in which case none
+ * of them is connected.
  */
-template <typename Data>
-void connect_bidirectional(Node<Data>& lhs, Node<Data>& rhs)
+template <typename Data, int N>
+bool connect_bidirectional(Node<Data, N>& lhs, Node<Data, N>& rhs, float weight = 1)
 {
-    lhs.connect(rhs);
-    rhs.connect(lhs);
+    if (!lhs.can_connect() || !rhs.can_connect()) {
+        return false;
+    }
+    return lhs.connect(rhs, weight) && rhs.connect(lhs, weight);
 }
 
-/** Computes the shortest path in the given graph.
- *
- * The path will be stored in the nodes themselves as a linked list. To traverse the path, follow the path_next pointer.
- * Ex:
+/** Linked nodes converted to a Graph once, to be searched several times.
  *
- * for (auto *p = &start; p->path_next != nullptr; p = p->path_next) {
- *   move_to(p.data);
- * }
- *
- * @returns The path length.
+ * All the nodes connected to must be in the nodes array, and the nodes must
+ * not be connected anymore once this is built.
  */
 template <typename Node>
-int dijkstra(Node* nodes, int node_count, Node& start, Node& end)
-{
-    for (auto i = 0; i < node_count; i++) {
-        nodes[i].visited = false;
-        nodes[i].distance = INT_MAX;
-        nodes[i].parent = nullptr;
-        nodes[i].path_next = nullptr;
-    }
+class NodeGraph {
+    Node* nodes;
+    int node_count;
+    Graph graph;
+    std::vector<int> path;
 
-    start.distance = 0;
+public:
+    NodeGraph(Node* nodes_, int node_count_)
+        : nodes(nodes_)
+        , node_count(node_count_)
+    {
+        std::vector<Edge> edges;
+        for (auto i = 0; i < node_count; i++) {
+            for (auto j = 0; j < nodes[i].edge_count; j++) {
+                edges.push_back({i, int(nodes[i].edges[j] - nodes), nodes[i].weights[j]});
+            }
+        }
+        graph = Graph(node_count, edges);
+    }
 
-    auto v = &start;
+    /** Computes the cheapest path from start to end, guided by heuristic.
+     *
+     * heuristic(node) must return a lower bound of the cost from node to end.
+     * The path is stored in the nodes the same way as for dijkstra().
+     *
+     * @returns The path length, or -1 if end cannot be reached.
+     */
+    template <typename Heuristic>
+    int astar(Node& start, Node& end, Heuristic heuristic)
+    {
+        for (auto i = 0; i < node_count; i++) {
+            nodes[i].path_next = nullptr;
+        }
 
-    while (v->visited == false) {
-        v->visited = true;
+        auto cost = shortest_path(graph, &start - nodes, &end - nodes, path, [&](int n) {
+            return heuristic(nodes[n]);
+        });
 
-        for (auto i = 0; i < v->edge_count; i++) {
-            if (v->edges[i]->distance > v->distance + 1) {
-                v->edges[i]->distance = v->distance + 1;
-                v->edges[i]->parent = v;
-            }
+        if (cost == kNoPath) {
+            return -1;
         }
 
-        int min_distance = INT_MAX;
-
-        for (auto i = 0; i < node_count; i++) {
-            if (!nodes[i].visited && min_distance > nodes[i].distance) {
-                min_distance = nodes[i].distance;
-                v = &nodes[i];
-            }
+        for (auto i = 0u; i + 1 < path.size(); i++) {
+            nodes[path[i]].path_next = &nodes[path[i + 1]];
         }
+
+        return path.size() - 1;
     }
 
-    int len = 0;
-    for (auto* p = &end; p != &start; p = p->parent) {
-        p->parent->path_next = p;
-        len++;
+    /** Computes the shortest path from start to end, like dijkstra(). */
+    int dijkstra(Node& start, Node& end)
+    {
+        return astar(start, end, [](const Node&) { return 0.f; });
     }
+};
+
+/** Computes the cheapest path in the given graph, guided by heuristic.
+ *
+ * heuristic(node) must return a lower bound of the cost from node to end.
+ * All the nodes connected to must be in the nodes array.
+ *
+ * The path is stored in the nodes the same way as for dijkstra(). The graph
+ * is converted at every call, use a NodeGraph to search it several times.
+ *
+ * @returns The path length, or -1 if end cannot be reached.
+ */
+template <typename Node, typename Heuristic>
+int astar(Node* nodes, int node_count, Node& start, Node& end, Heuristic heuristic)
+{
+    return NodeGraph<Node>(nodes, node_count).astar(start, end, heuristic);
+}
 
-    return len;
+/** Computes the shortest path in the given graph.
+ *
+ * The path will be stored in the nodes themselves as a linked list. To traverse the path, follow the path_next pointer.
+ * Ex:
+ *
+ * for (auto *p = &start; p->path_next != nullptr; p = p->path_next) {
+ *   move_to(p.data);
+ * }
+ *
+ * @returns The path length, or -1 if end cannot be reached.
+ */
+template <typename Node>
+int dijkstra(Node* nodes, int node_count, Node& start, Node& end)
+{
+    return astar(nodes, node_count, start, end, [](const Node&) { return 0.f; });
 }
 } // namespace pathfinding
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace pathfinding {
+
+/** Cost returned by shortest_path when the end cannot be reached. */
+const float kNoPath = std::numeric_limits<float>::infinity();
+
+/** Directed, weighted edge between two nodes, given by their index. */
+struct Edge {
+    int from;
+    int to;
+    float weight;
+};
+
+/** Graph stored in compressed sparse row form: the edges leaving a node are
+ * contiguous in memory, and nodes can have any number of them.
+ *
+ * The graph cannot be modified once built.
+ */
+class Graph {
+public:
+    Graph() = default;
+
+    /** Builds a graph of node_count nodes from a list of directed edges,
+     * given in any order. Weights must not be negative. */
+    Graph(int node_count, const std::vector<Edge>& edges)
+        : offsets(node_count + 1, 0)
+        , targets(edges.size())
+        , weights(edges.size())
+    {
+        for (const auto& e : edges) {
+            offsets[e.from + 1]++;
+        }
+        for (int i = 0; i < node_count; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);
+        for (const auto& e : edges) {
+            const int slot = next[e.from]++;
+            targets[slot] = e.to;
+            weights[slot] = e.weight;
+        }
+    }
+
+    int node_count() const
+    {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    int edge_count() const
+    {
+        return targets.size();
+    }
+
+    /** Edges leaving node are the ones in [edges_begin(node), edges_end(node)) */
+    int edges_begin(int node) const
+    {
+        return offsets[node];
+    }
+
+    int edges_end(int node) const
+    {
+        return offsets[node + 1];
+    }
+
+    int target(int edge) const
+    {
+        return targets[edge];
+    }
+
+    float weight(int edge) const
+    {
+        return weights[edge];
+    }
+
+private:
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<float> weights;
+};
+
+/** Computes the cheapest path from start to end, using A*.
+ *
+ * heuristic(node) must return a lower bound of the cost from node to end,
+ * such as the straight line distance when weights are distances. When it
+ * always returns zero, this is Dijkstra's algorithm.
+ *
+ * The nodes of the path, start and end included, are stored in path.
+ *
+ * @returns The cost of the path, or kNoPath if end cannot be reached.
+ */
+template <typename Heuristic>
+float shortest_path(const Graph& graph, int start, int end, std::vector<int>& path, Heuristic heuristic)
+{
+    struct Candidate {
+        float priority;
+        float cost;
+        int node;
+
+        bool operator>(const Candidate& other) const
+        {
+            return priority > other.priority;
+        }
+    };
+
+    std::vector<float> cost(graph.node_count(), kNoPath);
+    std::vector<int> parent(graph.node_count(), -1);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> open;
+
+    path.clear();
+    cost[start] = 0;
+    open.push({heuristic(start), 0, start});
+
+    while (!open.empty()) {
+        const auto current = open.top();
+        open.pop();
+
+        // Nodes are pushed again instead of updated in the heap, skip the
+        // outdated copies
+        if (current.cost > cost[current.node]) {
+            continue;
+        }
+
+        if (current.node == end) {
+            for (int n = end; n != -1; n = parent[n]) {
+                path.push_back(n);
+            }
+            std::reverse(path.begin(), path.end());
+            return current.cost;
+        }
+
+        for (int e = graph.edges_begin(current.node); e < graph.edges_end(current.node); e++) {
+            const int next = graph.target(e);
+            const float next_cost = current.cost + graph.weight(e);
+            if (next_cost < cost[next]) {
+                cost[next] = next_cost;
+                parent[next] = current.node;
+                open.push({next_cost + heuristic(next), next_cost, next});
+            }
+        }
+    }
+
+    return kNoPath;
+}
+
+/** Computes the cheapest path from start to end, using Dijkstra's algorithm. */
+inline float shortest_path(const Graph& graph, int start, int end, std::vector<int>& path)
+{
+    return shortest_path(graph, start, end, path, [](int) { return 0.f; });
+}
+
+} // namespace pathfinding
@@ -58,3 +58,94 @@ TEST(DijkstraTestGroup, MoreComplexSituation)
     POINTERS_EQUAL(&nodes[DEPLOY], nodes[RETRACT].path_next);
     POINTERS_EQUAL(&nodes[PICK], nodes[DEPLOY].path_next);
 }
+
+TEST(DijkstraTestGroup, FollowsCheapestPath)
+{
+    pathfinding::Node<int> nodes[] = {{0}, {1}, {2}, {3}};
+
+    // The direct edge costs more than going through 1 and 2
+    nodes[0].connect(nodes[3], 10);
+    nodes[0].connect(nodes[1], 2);
+    nodes[1].connect(nodes[2], 2);
+    nodes[2].connect(nodes[3], 2);
+
+    auto n = pathfinding::dijkstra(nodes, 4, nodes[0], nodes[3]);
+
+    CHECK_EQUAL(3, n);
+    POINTERS_EQUAL(&nodes[1], nodes[0].path_next);
+    POINTERS_EQUAL(&nodes[2], nodes[1].path_next);
+    POINTERS_EQUAL(&nodes[3], nodes[2].path_next);
+}
+
+TEST(DijkstraTestGroup, UnreachableNode)
+{
+    pathfinding::Node<int> nodes[] = {{0}, {1}, {2}};
+    nodes[0].connect(nodes[1]);
+    nodes[2].connect(nodes[0]);
+
+    CHECK_EQUAL(-1, pathfinding::dijkstra(nodes, 3, nodes[0], nodes[2]));
+    POINTERS_EQUAL(nullptr, nodes[0].path_next);
+}
+
+TEST(DijkstraTestGroup, PathToStartIsEmpty)
+{
+    pathfinding::Node<int> nodes[] = {{0}, {1}};
+    connect_bidirectional(nodes[0], nodes[1]);
+
+    CHECK_EQUAL(0, pathfinding::dijkstra(nodes, 2, nodes[0], nodes[0]));
+    POINTERS_EQUAL(nullptr, nodes[0].path_next);
+}
+
+TEST(DijkstraTestGroup, CannotConnectMoreThanMaximumNeighbors)
+{
+    pathfinding::Node<int, 2> nodes[] = {{0}, {1}, {2}, {3}};
+
+    CHECK_TRUE(nodes[0].connect(nodes[1]));
+    CHECK_TRUE(connect_bidirectional(nodes[0], nodes[2]));
+    CHECK_FALSE(nodes[0].connect(nodes[3]));
+
+    CHECK_EQUAL(-1, pathfinding::dijkstra(nodes, 4, nodes[0], nodes[3]));
+}
+
+TEST(DijkstraTestGroup, AStarFindsSamePath)
+{
+    pathfinding::Node<int> nodes[] = {{0}, {1}, {2}, {3}, {4}};
+    for (auto i = 0; i < 4; i++) {
+        connect_bidirectional(nodes[i], nodes[i + 1]);
+    }
+    nodes[0].connect(nodes[4], 5);
+
+    // Each edge costs at least one, so the difference of data is a lower bound
+    auto n = pathfinding::astar(nodes, 5, nodes[0], nodes[4], [](const pathfinding::Node<int>& node) {
+        return float(4 - node.data);
+    });
+
+    CHECK_EQUAL(4, n);
+    POINTERS_EQUAL(&nodes[1], nodes[0].path_next);
+    POINTERS_EQUAL(&nodes[4], nodes[3].path_next);
+}
+
+TEST(DijkstraTestGroup, FullNodesAreNotConnectedOneWay)
+{
+    pathfinding::Node<int, 1> nodes[] = {{0}, {1}, {2}};
+    nodes[1].connect(nodes[2]);
+
+    CHECK_FALSE(connect_bidirectional(nodes[0], nodes[1]));
+
+    CHECK_EQUAL(-1, pathfinding::dijkstra(nodes, 3, nodes[0], nodes[1]));
+}
+
+TEST(DijkstraTestGroup, NodeGraphCanBeSearchedSeveralTimes)
+{
+    pathfinding::Node<int> nodes[] = {{0}, {1}, {2}};
+    connect_bidirectional(nodes[0], nodes[1]);
+    connect_bidirectional(nodes[1], nodes[2]);
+    pathfinding::NodeGraph<pathfinding::Node<int>> graph(nodes, 3);
+
+    CHECK_EQUAL(2, graph.dijkstra(nodes[0], nodes[2]));
+    POINTERS_EQUAL(&nodes[1], nodes[0].path_next);
+
+    CHECK_EQUAL(1, graph.dijkstra(nodes[2], nodes[1]));
+    POINTERS_EQUAL(&nodes[1], nodes[2].path_next);
+    POINTERS_EQUAL(nullptr, nodes[0].path_next);
+}
@@ -0,0 +1,120 @@
+#include <cmath>
+#include <vector>
+#include <CppUTest/TestHarness.h>
+#include "dijkstra/graph.hpp"
+
+using pathfinding::Edge;
+using pathfinding::Graph;
+
+TEST_GROUP (GraphTestGroup) {
+};
+
+TEST(GraphTestGroup, EmptyGraph)
+{
+    Graph graph;
+
+    CHECK_EQUAL(0, graph.node_count());
+    CHECK_EQUAL(0, graph.edge_count());
+}
+
+TEST(GraphTestGroup, EdgesAreGroupedBySourceNode)
+{
+    Graph graph(3, {{2, 0, 1.}, {0, 1, 2.}, {2, 1, 3.}, {0, 2, 4.}});
+
+    CHECK_EQUAL(3, graph.node_count());
+    CHECK_EQUAL(4, graph.edge_count());
+
+    CHECK_EQUAL(2, graph.edges_end(0) - graph.edges_begin(0));
+    CHECK_EQUAL(0, graph.edges_end(1) - graph.edges_begin(1));
+    CHECK_EQUAL(2, graph.edges_end(2) - graph.edges_begin(2));
+
+    auto e = graph.edges_begin(2);
+    CHECK_EQUAL(0, graph.target(e));
+    DOUBLES_EQUAL(1., graph.weight(e), 1e-6);
+    CHECK_EQUAL(1, graph.target(e + 1));
+    DOUBLES_EQUAL(3., graph.weight(e + 1), 1e-6);
+}
+
+TEST_GROUP (ShortestPathTestGroup) {
+    // Grid of size x size nodes, connected to their four neighbours. Moving
+    // horizontally costs 1, moving vertically costs 2.
+    static const int size = 10;
+    Graph grid;
+    std::vector<int> path;
+
+    void setup()
+    {
+        std::vector<Edge> edges;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                if (x + 1 < size) {
+                    edges.push_back({index(x, y), index(x + 1, y), 1});
+                    edges.push_back({index(x + 1, y), index(x, y), 1});
+                }
+                if (y + 1 < size) {
+                    edges.push_back({index(x, y), index(x, y + 1), 2});
+                    edges.push_back({index(x, y + 1), index(x, y), 2});
+                }
+            }
+        }
+        grid = Graph(size * size, edges);
+    }
+
+    static int index(int x, int y)
+    {
+        return y * size + x;
+    }
+};
+
+TEST(ShortestPathTestGroup, PathToItself)
+{
+    auto cost = pathfinding::shortest_path(grid, 5, 5, path);
+
+    DOUBLES_EQUAL(0, cost, 1e-6);
+    CHECK_EQUAL(1, path.size());
+    CHECK_EQUAL(5, path[0]);
+}
+
+TEST(ShortestPathTestGroup, FindsCheapestPath)
+{
+    auto cost = pathfinding::shortest_path(grid, index(0, 0), index(3, 2), path);
+
+    DOUBLES_EQUAL(3 * 1 + 2 * 2, cost, 1e-6);
+    CHECK_EQUAL(6, path.size());
+    CHECK_EQUAL(index(0, 0), path.front());
+    CHECK_EQUAL(index(3, 2), path.back());
+}
+
+TEST(ShortestPathTestGroup, PathFollowsEdges)
+{
+    pathfinding::shortest_path(grid, index(9, 0), index(0, 9), path);
+
+    for (auto i = 0u; i + 1 < path.size(); i++) {
+        const int dx = std::abs(path[i] % size - path[i + 1] % size);
+        const int dy = std::abs(path[i] / size - path[i + 1] / size);
+        CHECK_EQUAL(1, dx + dy);
+    }
+}
+
+TEST(ShortestPathTestGroup, AStarFindsSameCost)
+{
+    const int end = index(7, 8);
+    auto manhattan = [&](int n) {
+        return float(std::abs(n % size - 7) + 2 * std::abs(n / size - 8));
+    };
+
+    auto cost = pathfinding::shortest_path(grid, index(1, 2), end, path, manhattan);
+
+    DOUBLES_EQUAL(6 * 1 + 6 * 2, cost, 1e-6);
+    CHECK_EQUAL(13, path.size());
+}
+
+TEST(ShortestPathTestGroup, UnreachableNode)
+{
+    Graph graph(3, {{0, 1, 1.}, {2, 0, 1.}});
+
+    auto cost = pathfinding::shortest_path(graph, 0, 2, path);
+
+    CHECK_EQUAL(pathfinding::kNoPath, cost);
+    CHECK_TRUE(path.empty());
+}
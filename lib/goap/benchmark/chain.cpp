@@ -0,0 +1,126 @@
+// Chain of steps which have to be done in order, next to switches which can be
+// flipped at any time but are useless. The planner has to walk the whole chain,
+// and the switches multiply the number of states it can reach on the way.
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <goap/goap.hpp>
+#include "report.hpp"
+
+struct ChainState {
+    int step;
+    uint32_t switches;
+};
+
+bool operator==(const ChainState& lhs, const ChainState& rhs)
+{
+    return lhs.step == rhs.step && lhs.switches == rhs.switches;
+}
+
+struct NextStep : goap::Action<ChainState> {
+    int index;
+
+    explicit NextStep(int i)
+        : index(i)
+    {
+    }
+
+    bool can_run(const ChainState& state) override
+    {
+        return state.step == index;
+    }
+
+    void plan_effects(ChainState& state) override
+    {
+        state.step++;
+    }
+
+    bool execute(ChainState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct FlipSwitch : goap::Action<ChainState> {
+    int index;
+
+    explicit FlipSwitch(int i)
+        : index(i)
+    {
+    }
+
+    bool can_run(const ChainState& state) override
+    {
+        (void)state;
+        return true;
+    }
+
+    void plan_effects(ChainState& state) override
+    {
+        state.switches ^= 1u << index;
+    }
+
+    bool execute(ChainState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct EndOfChain : goap::Goal<ChainState> {
+    int length;
+
+    explicit EndOfChain(int l)
+        : length(l)
+    {
+    }
+
+    int distance_to(const ChainState& state) const override
+    {
+        return length - state.step;
+    }
+};
+
+template <typename Planner>
+static void BM_ChainPlan(benchmark::State& bench)
+{
+    const int length = bench.range(0);
+    const int switch_count = bench.range(1);
+
+    std::vector<NextStep> steps;
+    std::vector<FlipSwitch> switches;
+    std::vector<goap::Action<ChainState>*> actions;
+    for (int i = 0; i < length; i++) {
+        steps.emplace_back(i);
+    }
+    for (int i = 0; i < switch_count; i++) {
+        switches.emplace_back(i);
+    }
+    for (auto& s : switches) {
+        actions.push_back(&s);
+    }
+    for (auto& s : steps) {
+        actions.push_back(&s);
+    }
+
+    EndOfChain goal(length);
+    ChainState start{0, 0};
+
+    auto planner = std::make_unique<Planner>();
+    std::vector<goap::Action<ChainState>*> path(length);
+    int len = 0;
+
+    for (auto _ : bench) {
+        len = planner->plan(start, goal, actions.data(), actions.size(), path.data(), path.size());
+        if (len < 0) {
+            bench.SkipWithError("Did not find a plan");
+            break;
+        }
+    }
+
+    report_plan(bench, *planner, start, path.data(), len);
+}
+
+BENCHMARK_TEMPLATE(BM_ChainPlan, goap::Planner<ChainState, 2048>)->Args({8, 0})->Args({32, 0})->Args({128, 0})->Args({8, 4})->Args({32, 4});
+BENCHMARK_TEMPLATE(BM_ChainPlan, goap::DynamicPlanner<ChainState>)->Args({8, 0})->Args({32, 0})->Args({128, 0})->Args({512, 0})->Args({8, 4})->Args({32, 4})->Args({128, 4})->Args({32, 8});
@@ -0,0 +1,291 @@
+// Planning time on synthetic state spaces of thousands of states.
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <goap/goap.hpp>
+#include <goap/anytime_planner.hpp>
+#include <goap/planning_service.hpp>
+#include "report.hpp"
+
+// Robot moving on a square grid, one cell at a time. The goal is the opposite
+// corner, so the planner visits a large part of the grid.
+struct GridState {
+    int x, y;
+};
+
+bool operator==(const GridState& lhs, const GridState& rhs)
+{
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+struct GridMove : goap::Action<GridState> {
+    int dx, dy, size;
+
+    GridMove(int dx_, int dy_, int size_)
+        : dx(dx_)
+        , dy(dy_)
+        , size(size_)
+    {
+    }
+
+    bool can_run(const GridState& state) override
+    {
+        const int x = state.x + dx, y = state.y + dy;
+        return x >= 0 && x < size && y >= 0 && y < size;
+    }
+
+    void plan_effects(GridState& state) override
+    {
+        state.x += dx;
+        state.y += dy;
+    }
+
+    bool execute(GridState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct GridGoal : goap::Goal<GridState> {
+    int size;
+
+    explicit GridGoal(int size_)
+        : size(size_)
+    {
+    }
+
+    int distance_to(const GridState& state) const override
+    {
+        return goap::Distance().shouldBeEqual(size - 1, state.x).shouldBeEqual(size - 1, state.y);
+    }
+};
+
+template <typename Planner>
+static void BM_GridPlan(benchmark::State& bench)
+{
+    const int size = bench.range(0);
+    GridMove moves[] = {{1, 0, size}, {-1, 0, size}, {0, 1, size}, {0, -1, size}};
+    goap::Action<GridState>* actions[] = {&moves[0], &moves[1], &moves[2], &moves[3]};
+    GridGoal goal(size);
+    GridState start{0, 0};
+
+    auto planner = std::make_unique<Planner>();
+    std::vector<goap::Action<GridState>*> path(size * size);
+    int len = 0;
+
+    for (auto _ : bench) {
+        len = planner->plan(start, goal, actions, 4, path.data(), path.size());
+        if (len < 0) {
+            bench.SkipWithError("Did not find a plan");
+            break;
+        }
+    }
+
+    report_plan(bench, *planner, start, path.data(), len);
+}
+
+BENCHMARK_TEMPLATE(BM_GridPlan, goap::Planner<GridState, 4096>)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+BENCHMARK_TEMPLATE(BM_GridPlan, goap::DynamicPlanner<GridState>)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+// A fixed planner too small for the state space has to drop states, and fails
+// to find a plan here.
+BENCHMARK_TEMPLATE(BM_GridPlan, goap::Planner<GridState, 256>)->Arg(32)->Arg(64);
+
+// Time until the anytime planner has a first plan, and how long it is
+static void BM_GridAnytimeFirstPlan(benchmark::State& bench)
+{
+    const int size = bench.range(0);
+    GridMove moves[] = {{1, 0, size}, {-1, 0, size}, {0, 1, size}, {0, -1, size}};
+    goap::Action<GridState>* actions[] = {&moves[0], &moves[1], &moves[2], &moves[3]};
+    GridGoal goal(size);
+    GridState start{0, 0};
+
+    goap::AnytimePlanner<GridState> planner;
+    const auto deadline = goap::AnytimePlanner<GridState>::Clock::time_point::max();
+    std::vector<goap::Action<GridState>*> path(size * size);
+    int len = 0;
+
+    for (auto _ : bench) {
+        planner.start(start, goal, actions, 4);
+        do {
+            len = planner.improve(deadline, path.data(), path.size(), 16);
+        } while (len == goap::kErrorOutOfTime);
+    }
+
+    report_plan(bench, planner, start, path.data(), len);
+}
+
+BENCHMARK(BM_GridAnytimeFirstPlan)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+struct CellGoal : goap::Goal<GridState> {
+    int x, y;
+
+    CellGoal(int x_, int y_)
+        : x(x_)
+        , y(y_)
+    {
+    }
+
+    int distance_to(const GridState& state) const override
+    {
+        return goap::Distance().shouldBeEqual(x, state.x).shouldBeEqual(y, state.y);
+    }
+};
+
+// Time to plan and rank several goals on a 32x32 grid, depending on the
+// number of goals and of planning threads.
+static void BM_GridPlanningService(benchmark::State& bench)
+{
+    const int size = 32;
+    const int goal_count = bench.range(0);
+    const int threads = bench.range(1);
+    GridMove moves[] = {{1, 0, size}, {-1, 0, size}, {0, 1, size}, {0, -1, size}};
+    goap::Action<GridState>* actions[] = {&moves[0], &moves[1], &moves[2], &moves[3]};
+    GridState start{0, 0};
+
+    std::vector<CellGoal> goals;
+    for (int i = 0; i < goal_count; i++) {
+        goals.emplace_back(size - 1 - i, size - 1);
+    }
+
+    goap::PlanningService<GridState> service(actions, 4, size * size, threads - 1, 1.f);
+    for (auto& goal : goals) {
+        service.add_goal(goal, 1.f);
+    }
+
+    const auto deadline = goap::PlanningService<GridState>::Clock::time_point::max();
+    size_t plans = 0;
+
+    for (auto _ : bench) {
+        plans = service.plan(start, deadline).size();
+    }
+
+    bench.counters["plans"] = plans;
+}
+
+BENCHMARK(BM_GridPlanningService)->RangeMultiplier(2)->Ranges({{1, 8}, {1, 4}})->UseRealTime();
+
+// World made of boolean flags, where each flag can only be raised once the
+// previous one is. Raising a flag also lowers the next one, so the reachable
+// space is large and the planner has to look past many dead ends.
+struct FlagState {
+    uint32_t flags;
+};
+
+bool operator==(const FlagState& lhs, const FlagState& rhs)
+{
+    return lhs.flags == rhs.flags;
+}
+
+struct RaiseFlag : goap::Action<FlagState> {
+    int index;
+
+    explicit RaiseFlag(int i)
+        : index(i)
+    {
+    }
+
+    bool can_run(const FlagState& state) override
+    {
+        return index == 0 || (state.flags & (1u << (index - 1)));
+    }
+
+    void plan_effects(FlagState& state) override
+    {
+        state.flags |= 1u << index;
+        state.flags &= ~(1u << (index + 1));
+    }
+
+    bool execute(FlagState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct ToggleFlag : goap::Action<FlagState> {
+    int index;
+
+    explicit ToggleFlag(int i)
+        : index(i)
+    {
+    }
+
+    bool can_run(const FlagState& state) override
+    {
+        (void)state;
+        return true;
+    }
+
+    void plan_effects(FlagState& state) override
+    {
+        state.flags ^= 1u << index;
+    }
+
+    bool execute(FlagState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct AllFlagsGoal : goap::Goal<FlagState> {
+    int width;
+
+    explicit AllFlagsGoal(int w)
+        : width(w)
+    {
+    }
+
+    int distance_to(const FlagState& state) const override
+    {
+        const uint32_t mask = (1u << width) - 1;
+        return __builtin_popcount(~state.flags & mask);
+    }
+};
+
+template <typename Planner>
+static void BM_FlagWorldPlan(benchmark::State& bench)
+{
+    const int width = bench.range(0);
+    std::vector<RaiseFlag> raise;
+    std::vector<ToggleFlag> toggle;
+    std::vector<goap::Action<FlagState>*> actions;
+    for (int i = 0; i < width; i++) {
+        raise.emplace_back(i);
+        toggle.emplace_back(i);
+    }
+    for (int i = 0; i < width; i++) {
+        actions.push_back(&raise[i]);
+        // Only the even flags can be toggled freely
+        if (i % 2 == 0) {
+            actions.push_back(&toggle[i]);
+        }
+    }
+
+    AllFlagsGoal goal(width);
+    FlagState start{0};
+
+    auto planner = std::make_unique<Planner>();
+    std::vector<goap::Action<FlagState>*> path(4 * width);
+
+    int len = 0;
+
+    for (auto _ : bench) {
+        len = planner->plan(start, goal, actions.data(), actions.size(), path.data(), path.size());
+        if (len < 0) {
+            bench.SkipWithError("Did not find a plan");
+            break;
+        }
+    }
+
+    report_plan(bench, *planner, start, path.data(), len);
+}
+
+BENCHMARK_TEMPLATE(BM_FlagWorldPlan, goap::Planner<FlagState, 8192>)->DenseRange(6, 12, 2);
+BENCHMARK_TEMPLATE(BM_FlagWorldPlan, goap::DynamicPlanner<FlagState>)->DenseRange(6, 20, 2);
+
+BENCHMARK_MAIN();
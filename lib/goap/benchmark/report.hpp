@@ -0,0 +1,19 @@
+#ifndef GOAP_BENCHMARK_REPORT_HPP
+#define GOAP_BENCHMARK_REPORT_HPP
+
+#include <benchmark/benchmark.h>
+#include <goap/goap.hpp>
+
+/** Reports the last plan of planner, found from start, as benchmark counters.
+ * Time per plan is the time reported by the benchmark itself. */
+template <typename Planner, typename State>
+void report_plan(benchmark::State& bench, const Planner& planner, const State& start, goap::Action<State>** path, int len)
+{
+    bench.counters["plan_length"] = len;
+    bench.counters["plan_cost"] = len >= 0 ? goap::plan_cost(start, path, len) : -1;
+    bench.counters["nodes_expanded"] = planner.stats().expanded;
+    bench.counters["nodes_generated"] = planner.stats().generated;
+    bench.counters["peak_bytes"] = benchmark::Counter(planner.reserved_bytes(), benchmark::Counter::kDefaults, benchmark::Counter::OneK::kIs1024);
+}
+
+#endif
@@ -0,0 +1,300 @@
+// Domain mirroring the StrategyState of the master firmware: the robot picks
+// glasses from dispensers, brings them to the port, raises windsocks and
+// enables the lighthouse. Actions cost the time they take in milliseconds,
+// including the travel from where the previous action ended.
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <goap/goap.hpp>
+#include <goap/anytime_planner.hpp>
+#include "report.hpp"
+
+enum Glass : uint8_t {
+    NoGlass = 0,
+    RedGlass,
+    GreenGlass,
+};
+
+struct __attribute__((packed)) RobotLikeState {
+    Glass front[3];
+    Glass back[3];
+    int16_t x, y;
+};
+
+struct __attribute__((packed)) StrategyLikeState {
+    RobotLikeState robot;
+    Glass dispensers[3][5];
+    Glass port_green[6];
+    Glass port_red[6];
+    bool windsocks_are_up[2];
+    bool lighthouse_is_on;
+};
+
+bool operator==(const StrategyLikeState& lhs, const StrategyLikeState& rhs)
+{
+    return !memcmp(&lhs, &rhs, sizeof(StrategyLikeState));
+}
+
+static StrategyLikeState initial_strategy_state()
+{
+    StrategyLikeState state;
+    memset(&state, 0, sizeof(state));
+    state.robot.x = 250;
+    state.robot.y = 450;
+
+    const Glass dispenser[5] = {RedGlass, GreenGlass, RedGlass, GreenGlass, RedGlass};
+    for (auto& d : state.dispensers) {
+        memcpy(d, dispenser, sizeof(dispenser));
+    }
+    return state;
+}
+
+static int glasses_in_port(const StrategyLikeState& state)
+{
+    int count = 0;
+    for (int i = 0; i < 6; i++) {
+        count += state.port_green[i] != NoGlass;
+        count += state.port_red[i] != NoGlass;
+    }
+    return count;
+}
+
+/* Action happening at (x, y), taking duration_ms once there, and leaving the
+ * robot at the same place. */
+struct TimedAction : goap::Action<StrategyLikeState> {
+    int x, y, duration_ms;
+
+    TimedAction(int x_, int y_, int duration_ms_)
+        : x(x_)
+        , y(y_)
+        , duration_ms(duration_ms_)
+    {
+    }
+
+    int cost(const StrategyLikeState& state) override
+    {
+        // Straight line at 0.5 m/s, plus a quarter turn
+        const float distance = std::hypot(x - state.robot.x, y - state.robot.y);
+        return 1 + int(2 * distance) + 300 + duration_ms;
+    }
+
+    void move_robot(StrategyLikeState& state)
+    {
+        state.robot.x = x;
+        state.robot.y = y;
+    }
+
+    bool execute(StrategyLikeState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct EnableLighthouse : TimedAction {
+    EnableLighthouse()
+        : TimedAction(225, 350, 3000)
+    {
+    }
+
+    bool can_run(const StrategyLikeState& state) override
+    {
+        return !state.lighthouse_is_on;
+    }
+
+    void plan_effects(StrategyLikeState& state) override
+    {
+        state.lighthouse_is_on = true;
+        move_robot(state);
+    }
+};
+
+struct RaiseWindsock : TimedAction {
+    int index;
+
+    explicit RaiseWindsock(int i)
+        : TimedAction(i == 0 ? 2870 : 2465, 1850, 2000)
+        , index(i)
+    {
+    }
+
+    bool can_run(const StrategyLikeState& state) override
+    {
+        return !state.windsocks_are_up[index];
+    }
+
+    void plan_effects(StrategyLikeState& state) override
+    {
+        state.windsocks_are_up[index] = true;
+        move_robot(state);
+    }
+};
+
+/* Picks the next three glasses of a dispenser, on one side of the robot */
+struct DispenserPickup : TimedAction {
+    int dispenser;
+    bool front;
+
+    DispenserPickup(int dispenser_, bool front_)
+        : TimedAction(500 + 700 * dispenser_, 1525 - 200 * dispenser_, 1500)
+        , dispenser(dispenser_)
+        , front(front_)
+    {
+    }
+
+    Glass* side(StrategyLikeState& state)
+    {
+        return front ? state.robot.front : state.robot.back;
+    }
+
+    bool can_run(const StrategyLikeState& state) override
+    {
+        const Glass* glasses = front ? state.robot.front : state.robot.back;
+        for (int i = 0; i < 3; i++) {
+            if (glasses[i] != NoGlass) {
+                return false;
+            }
+        }
+        return state.dispensers[dispenser][4] != NoGlass;
+    }
+
+    void plan_effects(StrategyLikeState& state) override
+    {
+        Glass* glasses = side(state);
+        Glass* d = state.dispensers[dispenser];
+        int slot = 0;
+        for (int i = 0; i < 5 && slot < 3; i++) {
+            if (d[i] != NoGlass) {
+                glasses[slot++] = d[i];
+                d[i] = NoGlass;
+            }
+        }
+        move_robot(state);
+    }
+};
+
+/* Drops the glasses of one side of the robot in the matching port lines */
+struct PortDrop : TimedAction {
+    bool front;
+
+    explicit PortDrop(bool front_)
+        : TimedAction(1800, 1700, 1000)
+        , front(front_)
+    {
+    }
+
+    bool can_run(const StrategyLikeState& state) override
+    {
+        const Glass* glasses = front ? state.robot.front : state.robot.back;
+        return glasses[0] != NoGlass && glasses_in_port(state) + 3 <= 12;
+    }
+
+    void plan_effects(StrategyLikeState& state) override
+    {
+        Glass* glasses = front ? state.robot.front : state.robot.back;
+        for (int i = 0; i < 3 && glasses[i] != NoGlass; i++) {
+            Glass* line = glasses[i] == RedGlass ? state.port_red : state.port_green;
+            for (int j = 0; j < 6; j++) {
+                if (line[j] == NoGlass) {
+                    line[j] = glasses[i];
+                    break;
+                }
+            }
+            glasses[i] = NoGlass;
+        }
+        move_robot(state);
+    }
+};
+
+struct MatchGoal : goap::Goal<StrategyLikeState> {
+    int glasses;
+
+    explicit MatchGoal(int glasses_)
+        : glasses(glasses_)
+    {
+    }
+
+    int distance_to(const StrategyLikeState& state) const override
+    {
+        const int missing = glasses - glasses_in_port(state);
+        return goap::Distance()
+                   .shouldBeTrue(state.lighthouse_is_on)
+                   .shouldBeTrue(state.windsocks_are_up[0])
+                   .shouldBeTrue(state.windsocks_are_up[1])
+            + (missing > 0 ? missing : 0);
+    }
+};
+
+struct StrategyDomain {
+    EnableLighthouse lighthouse;
+    RaiseWindsock windsocks[2] = {RaiseWindsock(0), RaiseWindsock(1)};
+    DispenserPickup pickups[6] = {{0, true}, {0, false}, {1, true}, {1, false}, {2, true}, {2, false}};
+    PortDrop drops[2] = {PortDrop(true), PortDrop(false)};
+    std::vector<goap::Action<StrategyLikeState>*> actions;
+
+    StrategyDomain()
+    {
+        actions.push_back(&lighthouse);
+        for (auto& w : windsocks) {
+            actions.push_back(&w);
+        }
+        for (auto& p : pickups) {
+            actions.push_back(&p);
+        }
+        for (auto& d : drops) {
+            actions.push_back(&d);
+        }
+    }
+};
+
+template <typename Planner>
+static void BM_StrategyPlan(benchmark::State& bench)
+{
+    StrategyDomain domain;
+    MatchGoal goal(bench.range(0));
+    const auto start = initial_strategy_state();
+
+    auto planner = std::make_unique<Planner>();
+    goap::Action<StrategyLikeState>* path[20];
+    int len = 0;
+
+    for (auto _ : bench) {
+        len = planner->plan(start, goal, domain.actions.data(), domain.actions.size(), path, 20);
+        if (len < 0) {
+            bench.SkipWithError("Did not find a plan");
+            break;
+        }
+    }
+
+    report_plan(bench, *planner, start, path, len);
+}
+
+BENCHMARK_TEMPLATE(BM_StrategyPlan, goap::Planner<StrategyLikeState, 4096>)->DenseRange(0, 9, 3)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_StrategyPlan, goap::DynamicPlanner<StrategyLikeState>)->DenseRange(0, 9, 3)->Unit(benchmark::kMicrosecond);
+
+// Time for the anytime planner to find a first plan, and to prove the best one
+static void BM_StrategyAnytime(benchmark::State& bench)
+{
+    StrategyDomain domain;
+    MatchGoal goal(bench.range(0));
+    const bool until_optimal = bench.range(1);
+    const auto start = initial_strategy_state();
+
+    goap::AnytimePlanner<StrategyLikeState> planner;
+    const auto deadline = goap::AnytimePlanner<StrategyLikeState>::Clock::time_point::max();
+    goap::Action<StrategyLikeState>* path[20];
+    int len = 0;
+
+    for (auto _ : bench) {
+        planner.start(start, goal, domain.actions.data(), domain.actions.size());
+        do {
+            len = planner.improve(deadline, path, 20, 16);
+        } while (len == goap::kErrorOutOfTime || (until_optimal && !planner.is_complete()));
+    }
+
+    report_plan(bench, planner, start, path, len);
+}
+
+BENCHMARK(BM_StrategyAnytime)->ArgNames({"glasses", "optimal"})->Args({6, 0})->Args({6, 1})->Args({9, 0})->Args({9, 1})->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,334 @@
+/** Anytime action planner
+ *
+ * This implements ARA* as described in "ARA*: Anytime A* with Provable Bounds
+ * on Sub-Optimality" by Likhachev, Gordon and Thrun (2003).
+ */
+#ifndef GOAP_ANYTIME_PLANNER_HPP
+#define GOAP_ANYTIME_PLANNER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <goap/goap.hpp>
+
+namespace goap {
+
+/** Planner which quickly finds a plan, then improves it while time allows.
+ *
+ * It runs a series of weighted A* searches, where the priority of a state is
+ * its cost plus weight times its distance to the goal. The first search uses
+ * a high weight, which finds a plan quickly, at most weight times longer than
+ * the best one. Each following search lowers the weight and reuses the states
+ * of the previous ones, only revisiting those whose cost improved. The search
+ * with a weight of one gives the optimal plan, provided the distance to the
+ * goal never overestimates the number of actions left.
+ *
+ * The search can be spread over several calls to improve(), each one given a
+ * deadline or a number of states to expand. resume() does so as long as the
+ * planner is asked for the same plan, which lets callers planning
+ * periodically keep the work of the previous periods.
+ */
+template <typename State, typename Hash = StateHash<State>>
+class AnytimePlanner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    // Weights are stored as fixed point numbers
+    static constexpr int WeightScale = 100;
+    static constexpr unsigned NotExpanded = std::numeric_limits<unsigned>::max();
+
+    ArenaNodeStorage<State> storage;
+    Hash hash;
+
+    int initial_weight;
+    int weight_step;
+    int weight;
+    unsigned round;
+
+    Goal<State>* goal = nullptr;
+    Action<State>** actions = nullptr;
+    unsigned action_count = 0;
+    State start_state;
+
+    // Cheapest state reaching the goal found so far
+    VisitedState<State>* best = nullptr;
+
+    // States whose cost improved after they were expanded in this round
+    std::vector<VisitedState<State>*> inconsistent;
+
+    bool complete = false;
+    bool pruned = false;
+
+    SearchStats search_stats;
+
+    int priority(const VisitedState<State>* node) const
+    {
+        return WeightScale * node->cost + weight * goal->distance_to(node->state);
+    }
+
+    /** A round ends when no queued state can lead to a cheaper plan, at the
+     * current weight. */
+    bool round_done() const
+    {
+        return storage.open.empty() || (best && WeightScale * best->cost <= storage.open.top()->priority);
+    }
+
+    void next_round()
+    {
+        weight = std::max(int(WeightScale), weight - weight_step);
+        round++;
+
+        for (auto node : inconsistent) {
+            if (node->heap_index < 0) {
+                storage.open.push(node);
+            }
+        }
+        inconsistent.clear();
+
+        storage.open.reprioritize([this](const VisitedState<State>* node) { return priority(node); });
+    }
+
+    void expand(VisitedState<State>* current)
+    {
+        current->search_round = round;
+        search_stats.expanded++;
+
+        // Nothing after the goal can give a cheaper plan
+        if (goal->is_reached(current->state)) {
+            return;
+        }
+
+        for (auto i = 0u; i < action_count; i++) {
+            auto action = actions[i];
+
+            if (!action->can_run(current->state)) {
+                continue;
+            }
+
+            VisitedState<State> candidate;
+            candidate.state = current->state;
+            action->plan_effects(candidate.state);
+            candidate.cost = current->cost + action->cost(current->state);
+            candidate.parent = current;
+            candidate.action = action;
+            candidate.hash = hash(candidate.state);
+            candidate.next = nullptr;
+            candidate.search_round = NotExpanded;
+            candidate.priority = priority(&candidate);
+
+            auto node = storage.known.find(candidate.state, candidate.hash);
+
+            if (node) {
+                if (!update_queued_state(node, &candidate)) {
+                    continue;
+                }
+
+                if (node->search_round == round) {
+                    // Already expanded in this round, it will be revisited
+                    // with the next weight.
+                    inconsistent.push_back(node);
+                } else {
+                    if (node->heap_index >= 0) {
+                        storage.open.update(node);
+                    } else {
+                        storage.open.push(node);
+                    }
+                }
+            } else {
+                node = storage.allocate();
+
+                // Out of nodes: the search goes on without this state, but
+                // the plan is not guaranteed to be optimal anymore.
+                if (!node) {
+                    pruned = true;
+                    search_stats.dropped++;
+                    continue;
+                }
+
+                *node = candidate;
+                search_stats.generated++;
+                storage.open.push(node);
+                storage.known.insert(node);
+            }
+
+            if (goal->is_reached(node->state) && (!best || node->cost < best->cost)) {
+                best = node;
+            }
+        }
+    }
+
+    int best_plan(Action<State>** path, int path_len) const
+    {
+        if (!best) {
+            if (!complete) {
+                return kErrorOutOfTime;
+            }
+            return pruned ? kErrorNotEnoughMemory : kErrorNoPathFound;
+        }
+
+        auto len = 0;
+        for (auto p = best->parent; p; p = p->parent) {
+            len++;
+        }
+
+        if (len > path_len) {
+            return -1;
+        }
+
+        if (path) {
+            auto i = len - 1;
+            for (auto p = best; p->parent; p = p->parent, i--) {
+                path[i] = p->action;
+            }
+        }
+
+        return len;
+    }
+
+public:
+    /** Creates a planner whose first search uses initial_weight, lowering it
+     * by weight_step for every following search. If node_budget is not
+     * zero, at most that many states are used by a plan. */
+    explicit AnytimePlanner(float initial_weight_ = 3.f, float weight_step_ = 0.5f, size_t node_budget = 0)
+        : storage(node_budget)
+        , initial_weight(std::max(int(WeightScale), int(initial_weight_ * WeightScale)))
+        , weight_step(std::max(1, int(weight_step_ * WeightScale)))
+        , weight(initial_weight)
+        , round(0)
+    {
+    }
+
+    /** Starts a new search from state to goal, forgetting the previous one.
+     *
+     * The goal and the actions must stay valid until the search is done.
+     */
+    void start(const State& state, Goal<State>& goal_, Action<State>* actions_[], unsigned action_count_)
+    {
+        goal = &goal_;
+        actions = actions_;
+        action_count = action_count_;
+        start_state = state;
+
+        storage.reset();
+        inconsistent.clear();
+        weight = initial_weight;
+        round = 0;
+        best = nullptr;
+        complete = false;
+        pruned = false;
+        search_stats = SearchStats();
+
+        auto node = storage.allocate();
+        if (!node) {
+            complete = true;
+            pruned = true;
+            return;
+        }
+
+        node->state = state;
+        node->cost = 0;
+        node->parent = nullptr;
+        node->action = nullptr;
+        node->hash = hash(state);
+        node->search_round = NotExpanded;
+        node->priority = priority(node);
+        storage.open.push(node);
+        storage.known.insert(node);
+        search_stats.generated++;
+
+        if (goal->is_reached(state)) {
+            best = node;
+        }
+    }
+
+    /** Goes on with the search until the deadline, or until max_expansions
+     * states were expanded if it is not zero.
+     *
+     * Returns the length of the best plan found so far, and stores it in path
+     * if given. Returns kErrorOutOfTime if no plan was found yet.
+     */
+    int improve(Clock::time_point deadline, Action<State>** path = nullptr, int path_len = 10, unsigned max_expansions = 0)
+    {
+        if (!goal) {
+            return kErrorNoPathFound;
+        }
+
+        unsigned expansions = 0;
+
+        while (!complete) {
+            if (round_done()) {
+                if (weight == WeightScale) {
+                    complete = true;
+                    break;
+                }
+                next_round();
+                continue;
+            }
+
+            if ((max_expansions && expansions >= max_expansions) || Clock::now() >= deadline) {
+                break;
+            }
+
+            expand(storage.open.pop());
+            expansions++;
+        }
+
+        return best_plan(path, path_len);
+    }
+
+    /** Finds a plan from state to goal within the deadline, and returns its
+     * length like improve(). */
+    int plan(const State& state, Goal<State>& goal_, Action<State>* actions_[], unsigned action_count_, Clock::time_point deadline, Action<State>** path = nullptr, int path_len = 10)
+    {
+        start(state, goal_, actions_, action_count_);
+        return improve(deadline, path, path_len);
+    }
+
+    /** Continues the current search if it goes from state to goal with the
+     * same actions, and starts a new one otherwise. Returns the length of the
+     * plan like improve(). */
+    int resume(const State& state, Goal<State>& goal_, Action<State>* actions_[], unsigned action_count_, Clock::time_point deadline, Action<State>** path = nullptr, int path_len = 10)
+    {
+        if (goal != &goal_ || actions != actions_ || action_count != action_count_ || !(start_state == state)) {
+            start(state, goal_, actions_, action_count_);
+        }
+        return improve(deadline, path, path_len);
+    }
+
+    /** True once the search is over and the best plan is optimal */
+    bool is_optimal() const
+    {
+        return complete && !pruned && best;
+    }
+
+    /** True once the search cannot improve the plan anymore */
+    bool is_complete() const
+    {
+        return complete;
+    }
+
+    /** Statistics about the current search, over all the calls to improve() */
+    const SearchStats& stats() const
+    {
+        return search_stats;
+    }
+
+    /** Memory kept by the planner between searches, in bytes */
+    size_t reserved_bytes() const
+    {
+        return storage.reserved_bytes();
+    }
+
+    /** Weight of the current search. Once it completes, the plan is at most
+     * that many times longer than the optimal one. */
+    float current_weight() const
+    {
+        return float(weight) / WeightScale;
+    }
+};
+
+} // namespace goap
+
+#endif
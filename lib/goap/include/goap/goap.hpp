@@ -15,6 +15,7 @@ namespace goap {
 
 const int kErrorNoPathFound = -1;
 const int kErrorNotEnoughMemory = -2;
+const int kErrorOutOfTime = -3;
 
 template <typename State>
 class Action {
@@ -28,6 +29,16 @@ public:
     /** Tries to execute the task and returns true if it suceeded. */
     virtual bool execute(State& state) = 0;
 
+    /** Cost of running this action from the given state, for example the
+     * time it takes. The planner minimizes the total cost of the plan. Costs
+     * must be at least one, so that the distance to the goal stays a lower
+     * bound of the cost left. */
+    virtual int cost(const State& state)
+    {
+        (void)state;
+        return 1;
+    }
+
     virtual ~Action() = default;
 };
 
@@ -46,117 +57,221 @@ public:
     virtual ~Goal() = default;
 };
 
-template <typename State, int N = 100>
-class Planner {
-    VisitedState<State> nodes[N];
+/** Returns the total cost of running the given plan from state. */
+template <typename State>
+int plan_cost(State state, Action<State>* const* path, int len)
+{
+    int cost = 0;
+    for (int i = 0; i < len; i++) {
+        cost += path[i]->cost(state);
+        path[i]->plan_effects(state);
+    }
+    return cost;
+}
+
+/** Statistics about a search, to evaluate the performance of planners. */
+struct SearchStats {
+    // States taken out of the queue to generate their successors
+    unsigned expanded = 0;
+    // States added to the search
+    unsigned generated = 0;
+    // Queued states dropped because the planner ran out of nodes
+    unsigned dropped = 0;
+};
 
-public:
-    /** Finds a plan from state to goal and returns its length.
-     *
-     * If path is given, then the found path is stored there.
-     */
-    int plan(const State& state, Goal<State>& goal, Action<State>* actions[], unsigned action_count, Action<State>** path = nullptr, int path_len = 10)
-    {
-        visited_states_array_to_list(nodes, N);
+/** Finds a plan from state to goal using A*, taking the nodes of the search
+ * from storage, and returns its length.
+ *
+ * States scheduled to be visited are kept in a binary heap and every known
+ * state is indexed in a hash set, using hash to hash states, so that a search
+ * costs O(n log n) in the number of visited states.
+ *
+ * When the storage runs out of nodes, the queued state that is the least
+ * likely to be visited is dropped.
+ */
+template <typename State, typename Storage, typename Hash>
+int plan_search(Storage& storage, Hash& hash, SearchStats& stats, const State& state, Goal<State>& goal, Action<State>* actions[], unsigned action_count, Action<State>** path, int path_len)
+{
+    storage.reset();
+    stats = SearchStats();
+
+    auto& open = storage.open;
+    auto& known = storage.known;
+
+    auto start = storage.allocate();
+    if (!start) {
+        return kErrorNotEnoughMemory;
+    }
 
-        auto free_nodes = &nodes[0];
+    start->state = state;
+    start->cost = 0;
+    start->priority = 0;
+    start->parent = nullptr;
+    start->action = nullptr;
+    start->hash = hash(state);
+    open.push(start);
+    known.insert(start);
+    stats.generated++;
+
+    while (!open.empty()) {
+        auto current = open.pop();
+        stats.expanded++;
+
+        if (goal.is_reached(current->state)) {
+            auto len = 0;
+            for (auto p = current->parent; p; p = p->parent) {
+                len++;
+            }
 
-        auto open = list_pop_head(free_nodes);
-        VisitedState<State>* close = nullptr;
+            if (len > path_len) {
+                return -1;
+            }
 
-        open->state = state;
-        open->cost = 0;
-        open->priority = 0;
-        open->parent = nullptr;
-        open->action = nullptr;
+            if (path) {
+                auto i = len - 1;
+                for (auto p = current; p->parent; p = p->parent, i--) {
+                    path[i] = p->action;
+                }
+            }
 
-        while (open) {
-            auto current = priority_list_pop(open);
-            list_push_head(close, current);
+            return len;
+        }
 
-            if (goal.is_reached(current->state)) {
-                auto len = 0;
-                for (auto p = current->parent; p; p = p->parent) {
-                    len++;
+        for (auto i = 0u; i < action_count; i++) {
+            auto action = actions[i];
+
+            if (action->can_run(current->state)) {
+                VisitedState<State> candidate;
+                candidate.state = current->state;
+                action->plan_effects(candidate.state);
+                candidate.cost = current->cost + action->cost(current->state);
+                candidate.priority = candidate.cost + goal.distance_to(candidate.state);
+                candidate.parent = current;
+                candidate.action = action;
+                candidate.hash = hash(candidate.state);
+                candidate.next = nullptr;
+
+                // Check if the state is already scheduled to be visited
+                // or was visited already.
+                auto previous = known.find(candidate.state, candidate.hash);
+
+                if (previous) {
+                    if (update_queued_state(previous, &candidate) && previous->heap_index >= 0) {
+                        open.update(previous);
+                    }
+                    continue;
                 }
 
-                if (len > path_len) {
-                    return -1;
-                }
+                auto neighbor = storage.allocate();
 
-                if (path) {
-                    auto i = len - 1;
-                    for (auto p = current; p->parent; p = p->parent, i--) {
-                        path[i] = p->action;
+                // Cannot allocate a new node, so garbage collect the node
+                // that is most unlikely to be visited (i.e. lowest
+                // priority). Only queued states can be dropped, as visited
+                // states are the parents of the others.
+                if (neighbor == nullptr) {
+                    neighbor = open.pop_worst();
+
+                    if (!neighbor) {
+                        return kErrorNotEnoughMemory;
                     }
+
+                    known.remove(neighbor);
+                    stats.dropped++;
                 }
 
-                return len;
+                *neighbor = candidate;
+                stats.generated++;
+                open.push(neighbor);
+                known.insert(neighbor);
             }
+        }
+    }
+
+    // Reaching here means we did not find a path
+    return kErrorNoPathFound;
+}
+
+/** Planner using at most N states, without any dynamic memory allocation. */
+template <typename State, int N = 100, typename Hash = StateHash<State>>
+class Planner {
+    FixedNodeStorage<State, N> storage;
+    Hash hash;
+    SearchStats last_stats;
+
+public:
+    /** Finds a plan from state to goal and returns its length.
+     *
+     * If path is given, then the found path is stored there.
+     */
+    int plan(const State& state, Goal<State>& goal, Action<State>* actions[], unsigned action_count, Action<State>** path = nullptr, int path_len = 10)
+    {
+        return plan_search(storage, hash, last_stats, state, goal, actions, action_count, path, path_len);
+    }
 
-            for (auto i = 0u; i < action_count; i++) {
-                auto action = actions[i];
+    /** Statistics about the last plan */
+    const SearchStats& stats() const
+    {
+        return last_stats;
+    }
 
-                if (action->can_run(current->state)) {
-                    // Cannot allocate a new node, abort
-                    if (free_nodes == nullptr) {
-                        // Garbage collect the node that is most unlikely to be
-                        // visited (i.e. lowest priority)
-                        VisitedState<State>*gc, *gc_prev = nullptr;
-                        for (gc = open; gc && gc->next; gc = gc->next) {
-                            gc_prev = gc;
-                        }
+    /** Memory used by the planner, in bytes */
+    size_t reserved_bytes() const
+    {
+        return sizeof(storage);
+    }
+};
 
-                        if (!gc) {
-                            return kErrorNotEnoughMemory;
-                        }
+/** Planner allocating its states as needed.
+ *
+ * The memory is kept between plans, so that planning only allocates memory
+ * when a search needs more states than any of the previous ones. A node budget
+ * can be given to bound the memory used by a single plan, in which case the
+ * planner drops the least promising states like Planner does.
+ */
+template <typename State, typename Hash = StateHash<State>>
+class DynamicPlanner {
+    ArenaNodeStorage<State> storage;
+    Hash hash;
+    SearchStats last_stats;
 
-                        if (gc_prev) {
-                            gc_prev->next = nullptr;
-                        }
+public:
+    /** Creates a planner using at most node_budget states per plan, or as
+     * many as needed if node_budget is zero. */
+    explicit DynamicPlanner(size_t node_budget = 0)
+        : storage(node_budget)
+    {
+    }
 
-                        free_nodes = gc;
-                    }
+    void set_node_budget(size_t node_budget)
+    {
+        storage.set_budget(node_budget);
+    }
 
-                    auto neighbor = list_pop_head(free_nodes);
-                    neighbor->state = current->state;
-                    action->plan_effects(neighbor->state);
-                    neighbor->cost = current->cost + 1;
-                    neighbor->priority = current->priority + 1 + goal.distance_to(neighbor->state);
-                    neighbor->parent = current;
-                    neighbor->action = action;
-
-                    bool should_insert = true;
-
-                    // Check if the node is already in the list of nodes
-                    // scheduled to be visited
-                    for (auto p = open; p; p = p->next) {
-                        if (p->state == neighbor->state) {
-                            should_insert = false;
-                            update_queued_state(p, neighbor);
-                        }
-                    }
+    /** Finds a plan from state to goal and returns its length.
+     *
+     * If path is given, then the found path is stored there.
+     */
+    int plan(const State& state, Goal<State>& goal, Action<State>* actions[], unsigned action_count, Action<State>** path = nullptr, int path_len = 10)
+    {
+        return plan_search(storage, hash, last_stats, state, goal, actions, action_count, path, path_len);
+    }
 
-                    // Check if the state is in the list of already visited
-                    // state
-                    for (auto p = close; p; p = p->next) {
-                        if (p->state == neighbor->state) {
-                            should_insert = false;
-                            update_queued_state(p, neighbor);
-                        }
-                    }
+    /** Statistics about the last plan */
+    const SearchStats& stats() const
+    {
+        return last_stats;
+    }
 
-                    if (should_insert) {
-                        list_push_head(open, neighbor);
-                    } else {
-                        list_push_head(free_nodes, neighbor);
-                    }
-                }
-            }
-        }
+    /** Number of states used by the last plan */
+    size_t node_count() const
+    {
+        return storage.size();
+    }
 
-        // Reaching here means we did not find a path
-        return kErrorNoPathFound;
+    /** Memory kept by the planner between plans, in bytes */
+    size_t reserved_bytes() const
+    {
+        return storage.reserved_bytes();
     }
 };
 
@@ -1,7 +1,10 @@
 #ifndef GOAP_INTERNALS_HPP
 #define GOAP_INTERNALS_HPP
 
-#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace goap {
 
@@ -20,6 +23,38 @@ struct VisitedState {
 
     // Only used for linked list management
     VisitedState<State>* next;
+
+    // Position in the open heap, or -1 if the state is not queued
+    int heap_index;
+
+    // Insertion order in the open heap, used to break ties
+    unsigned sequence;
+
+    // Cached hash of the state
+    size_t hash;
+
+    // Round of the anytime search in which the state was last expanded
+    unsigned search_round;
+};
+
+/** Default hash for planner states.
+ *
+ * It hashes the object representation of the state (FNV-1a), which is
+ * consistent with an operator== implemented with memcmp. States compared
+ * field by field and containing padding bytes should specialize this template.
+ */
+template <typename State>
+struct StateHash {
+    size_t operator()(const State& state) const
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(&state);
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < sizeof(State); i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
 };
 
 template <typename State>
@@ -31,36 +66,6 @@ void visited_states_array_to_list(VisitedState<State>* nodes, int len)
     nodes[len - 1].next = nullptr;
 }
 
-/** Returns the node element in the list with the minimal priority */
-template <typename State>
-VisitedState<State>* priority_list_pop(VisitedState<State>*& list)
-{
-    VisitedState<State>* min_elem = nullptr;
-    auto min_prio = std::numeric_limits<int>::max();
-
-    // Find the element with the lowest priority
-    for (auto p = list; p != nullptr; p = p->next) {
-        if (p->priority < min_prio) {
-            min_elem = p;
-            min_prio = p->priority;
-        }
-    }
-
-    // Remove it from the list
-    if (min_elem == list) {
-        list = list->next;
-    } else {
-        for (auto p = list; p != nullptr; p = p->next) {
-            if (p->next == min_elem) {
-                p->next = p->next->next;
-                min_elem->next = nullptr;
-            }
-        }
-    }
-
-    return min_elem;
-}
-
 template <typename State>
 VisitedState<State>* list_pop_head(VisitedState<State>*& head)
 {
@@ -77,17 +82,453 @@ void list_push_head(VisitedState<State>*& head, VisitedState<State>* elem)
     head = elem;
 }
 
+/** Replaces the path to an already known state if the new one is cheaper.
+ * Returns true if the state was updated. */
 template <typename State>
-void update_queued_state(VisitedState<State>* previous, const VisitedState<State>* current)
+bool update_queued_state(VisitedState<State>* previous, const VisitedState<State>* current)
 {
     if (previous->cost > current->cost) {
-        previous->priority = current->cost;
+        previous->cost = current->cost;
         previous->priority = current->priority;
         previous->parent = current->parent;
         previous->action = current->action;
+        return true;
+    }
+    return false;
+}
+
+/** Binary min-heap of the states scheduled to be visited, ordered by
+ * priority. Each state knows its position in the heap, so that its priority
+ * can be decreased in place. Among states of equal priority, the most recently
+ * pushed one comes out first. */
+template <typename State>
+class OpenHeap {
+    VisitedState<State>** heap;
+    int capacity;
+    int count = 0;
+    unsigned next_sequence = 0;
+
+    static bool before(const VisitedState<State>* a, const VisitedState<State>* b)
+    {
+        if (a->priority != b->priority) {
+            return a->priority < b->priority;
+        }
+        return a->sequence > b->sequence;
+    }
+
+    void place(VisitedState<State>* node, int index)
+    {
+        heap[index] = node;
+        node->heap_index = index;
+    }
+
+    void sift_up(int index)
+    {
+        auto node = heap[index];
+        while (index > 0) {
+            int parent = (index - 1) / 2;
+            if (!before(node, heap[parent])) {
+                break;
+            }
+            place(heap[parent], index);
+            index = parent;
+        }
+        place(node, index);
+    }
+
+    void sift_down(int index)
+    {
+        auto node = heap[index];
+        while (true) {
+            int child = 2 * index + 1;
+            if (child >= count) {
+                break;
+            }
+            if (child + 1 < count && before(heap[child + 1], heap[child])) {
+                child++;
+            }
+            if (!before(heap[child], node)) {
+                break;
+            }
+            place(heap[child], index);
+            index = child;
+        }
+        place(node, index);
+    }
+
+    VisitedState<State>* remove_at(int index)
+    {
+        auto node = heap[index];
+        node->heap_index = -1;
+        count--;
+        if (index != count) {
+            place(heap[count], index);
+            sift_down(index);
+            sift_up(heap[index]->heap_index);
+        }
+        return node;
+    }
+
+public:
+    /** Uses the given storage, which must hold up to capacity states. */
+    OpenHeap(VisitedState<State>** storage, int capacity_)
+        : heap(storage)
+        , capacity(capacity_)
+    {
+    }
+
+    /** Moves the heap to a bigger storage, holding a copy of the current
+     * one. */
+    void rebind(VisitedState<State>** storage, int capacity_)
+    {
+        heap = storage;
+        capacity = capacity_;
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    /** Returns false if the heap is full. */
+    bool push(VisitedState<State>* node)
+    {
+        if (count == capacity) {
+            return false;
+        }
+        node->sequence = next_sequence++;
+        place(node, count++);
+        sift_up(count - 1);
+        return true;
+    }
+
+    /** Returns the state with the lowest priority, without removing it. */
+    VisitedState<State>* top() const
+    {
+        return heap[0];
     }
+
+    /** Removes and returns the state with the lowest priority. */
+    VisitedState<State>* pop()
+    {
+        return remove_at(0);
+    }
+
+    /** Recomputes the priority of every queued state with the given function
+     * and restores the heap order. */
+    template <typename F>
+    void reprioritize(F priority)
+    {
+        for (int i = 0; i < count; i++) {
+            heap[i]->priority = priority(heap[i]);
+        }
+        for (int i = count / 2 - 1; i >= 0; i--) {
+            sift_down(i);
+        }
+    }
+
+    /** Restores the heap order after the priority of a queued state was
+     * decreased. */
+    void update(VisitedState<State>* node)
+    {
+        sift_up(node->heap_index);
+    }
+
+    /** Removes and returns the state that is the least likely to be visited
+     * (highest priority), or nullptr if the heap is empty. It is always one of
+     * the leaves. */
+    VisitedState<State>* pop_worst()
+    {
+        if (empty()) {
+            return nullptr;
+        }
+
+        int worst = count / 2;
+        for (int i = worst + 1; i < count; i++) {
+            if (before(heap[worst], heap[i])) {
+                worst = i;
+            }
+        }
+        return remove_at(worst);
+    }
+};
+
+/** Returns the smallest power of two able to hold n states at a load factor
+ * of at most one half. */
+constexpr size_t state_table_size(size_t n)
+{
+    size_t size = 1;
+    while (size < 2 * n) {
+        size *= 2;
+    }
+    return size;
 }
 
+/** Hash set of all the states known to the planner, queued or visited.
+ *
+ * It uses open addressing with linear probing, the hash of each state being
+ * cached in the state itself.
+ */
+template <typename State>
+class StateTable {
+    VisitedState<State>** slots;
+    size_t mask;
+
+public:
+    /** Uses the given storage, whose size must be a power of two (see
+     * state_table_size). */
+    StateTable(VisitedState<State>** storage, size_t size)
+        : slots(storage)
+        , mask(size - 1)
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; i++) {
+            slots[i] = nullptr;
+        }
+    }
+
+    VisitedState<State>* find(const State& state, size_t hash) const
+    {
+        for (size_t i = hash & mask; slots[i]; i = (i + 1) & mask) {
+            if (slots[i]->hash == hash && slots[i]->state == state) {
+                return slots[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /** Inserts a state, which must not be in the table yet. */
+    void insert(VisitedState<State>* node)
+    {
+        size_t i = node->hash & mask;
+        while (slots[i]) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = node;
+    }
+
+    void remove(VisitedState<State>* node)
+    {
+        size_t i = node->hash & mask;
+        while (slots[i] != node) {
+            if (!slots[i]) {
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+
+        // Shift back the following entries of the cluster which would not be
+        // found anymore because of the hole.
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask; slots[j]; j = (j + 1) & mask) {
+            size_t home = slots[j]->hash & mask;
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole] = nullptr;
+    }
+};
+
+/** Nodes of a search, with a capacity fixed at compile time. */
+template <typename State, int N>
+class FixedNodeStorage {
+    static constexpr size_t TableSize = state_table_size(N);
+
+    VisitedState<State> nodes[N];
+    VisitedState<State>* heap_storage[N];
+    VisitedState<State>* table_storage[TableSize];
+    VisitedState<State>* free_nodes = nullptr;
+
+public:
+    OpenHeap<State> open{heap_storage, N};
+    StateTable<State> known{table_storage, TableSize};
+
+    /** Forgets about all the nodes, to start a new search. */
+    void reset()
+    {
+        visited_states_array_to_list(nodes, N);
+        free_nodes = &nodes[0];
+        open.clear();
+        known.clear();
+    }
+
+    /** Returns a new node, or nullptr if all the nodes are in use. */
+    VisitedState<State>* allocate()
+    {
+        if (!free_nodes) {
+            return nullptr;
+        }
+        return list_pop_head(free_nodes);
+    }
+};
+
+/** Allocator handing out nodes from blocks of growing size.
+ *
+ * Nodes are never freed individually, instead the whole arena is reset once a
+ * search is done. The blocks are kept, so that the next searches do not
+ * allocate memory unless they need more nodes. Nodes never move, as they
+ * point to each other.
+ */
+template <typename State>
+class NodeArena {
+    std::vector<std::unique_ptr<VisitedState<State>[]>> blocks;
+    std::vector<size_t> block_sizes;
+    size_t first_block_size;
+    size_t block = 0;
+    size_t used_in_block = 0;
+    size_t used = 0;
+    size_t reserved = 0;
+
+public:
+    explicit NodeArena(size_t first_block_size_ = 256)
+        : first_block_size(first_block_size_)
+    {
+    }
+
+    VisitedState<State>* allocate()
+    {
+        if (block < blocks.size() && used_in_block == block_sizes[block]) {
+            block++;
+            used_in_block = 0;
+        }
+
+        if (block == blocks.size()) {
+            // Doubles the capacity of the arena every time
+            const size_t size = reserved ? reserved : first_block_size;
+            blocks.emplace_back(new VisitedState<State>[size]);
+            block_sizes.push_back(size);
+            reserved += size;
+        }
+
+        used++;
+        return &blocks[block][used_in_block++];
+    }
+
+    /** Makes all the nodes available again, without freeing memory. */
+    void reset()
+    {
+        block = 0;
+        used_in_block = 0;
+        used = 0;
+    }
+
+    /** Number of nodes handed out since the last reset */
+    size_t size() const
+    {
+        return used;
+    }
+
+    /** Number of nodes the arena can hand out without allocating memory */
+    size_t capacity() const
+    {
+        return reserved;
+    }
+};
+
+/** Nodes of a search, allocated as needed from an arena.
+ *
+ * If a node budget is given, at most that many nodes are used by a search.
+ */
+template <typename State>
+class ArenaNodeStorage {
+    NodeArena<State> arena;
+    std::vector<VisitedState<State>*> heap_storage;
+    std::vector<VisitedState<State>*> table_storage;
+    size_t budget;
+
+    void grow_table()
+    {
+        std::vector<VisitedState<State>*> old(2 * table_storage.size(), nullptr);
+        old.swap(table_storage);
+        known = StateTable<State>(table_storage.data(), table_storage.size());
+
+        for (auto node : old) {
+            if (node) {
+                known.insert(node);
+            }
+        }
+    }
+
+public:
+    OpenHeap<State> open;
+    StateTable<State> known;
+
+    /** Number of nodes of the first block of the arena */
+    static constexpr size_t arena_initial_size = 256;
+
+    explicit ArenaNodeStorage(size_t node_budget = 0)
+        : heap_storage(arena_initial_size)
+        , table_storage(state_table_size(arena_initial_size))
+        , budget(node_budget)
+        , open(heap_storage.data(), heap_storage.size())
+        , known(table_storage.data(), table_storage.size())
+    {
+    }
+
+    void set_budget(size_t node_budget)
+    {
+        budget = node_budget;
+    }
+
+    void reset()
+    {
+        arena.reset();
+        open.clear();
+        known.clear();
+    }
+
+    /** Returns a new node, or nullptr if the budget is exhausted. */
+    VisitedState<State>* allocate()
+    {
+        if (budget && arena.size() >= budget) {
+            return nullptr;
+        }
+
+        auto node = arena.allocate();
+
+        // Every node can be in the heap and in the table at once
+        if (arena.size() > heap_storage.size()) {
+            heap_storage.resize(2 * heap_storage.size());
+            open.rebind(heap_storage.data(), heap_storage.size());
+        }
+
+        if (state_table_size(arena.size()) > table_storage.size()) {
+            grow_table();
+        }
+
+        return node;
+    }
+
+    /** Number of nodes used by the last search */
+    size_t size() const
+    {
+        return arena.size();
+    }
+
+    /** Memory kept for the next searches, in bytes */
+    size_t reserved_bytes() const
+    {
+        return arena.capacity() * sizeof(VisitedState<State>)
+            + (heap_storage.size() + table_storage.size()) * sizeof(VisitedState<State>*);
+    }
+};
+
 } // namespace goap
 
 #endif
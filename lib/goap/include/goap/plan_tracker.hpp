@@ -0,0 +1,145 @@
+/** Reuse of plans between actions
+ *
+ * Most of the time, executing an action changes the world exactly as planned,
+ * and the rest of the plan is still the best thing to do. Instead of planning
+ * again from scratch after every action, the plan is checked against the new
+ * state and only the invalid part of it is planned again.
+ */
+#ifndef GOAP_PLAN_TRACKER_HPP
+#define GOAP_PLAN_TRACKER_HPP
+
+#include <algorithm>
+#include <vector>
+#include <goap/goap.hpp>
+
+namespace goap {
+
+/** Runs the plan on a copy of state and returns the number of leading steps
+ * that can run. Once the function returns, state is the state predicted
+ * before the first step that cannot run (or at the end of the plan). */
+template <typename State>
+int valid_plan_prefix(State& state, Action<State>* const* path, int len)
+{
+    for (int i = 0; i < len; i++) {
+        if (!path[i]->can_run(state)) {
+            return i;
+        }
+        path[i]->plan_effects(state);
+    }
+    return len;
+}
+
+/** Keeps track of the plan being executed for a goal, to reuse it when the
+ * world evolves as predicted. */
+template <typename State>
+class PlanTracker {
+public:
+    enum class Outcome {
+        // The remaining plan was still valid
+        Reused,
+        // The plan was valid up to some step, and planned again from there
+        Repaired,
+        // The plan was planned again from the current state
+        Replanned,
+    };
+
+private:
+    std::vector<Action<State>*> steps;
+    const Goal<State>* goal = nullptr;
+    Outcome outcome = Outcome::Replanned;
+
+    int store(const Goal<State>& goal_, Action<State>** path, int len)
+    {
+        if (len < 0) {
+            clear();
+            return len;
+        }
+        goal = &goal_;
+        steps.assign(path, path + len);
+        return len;
+    }
+
+public:
+    /** Returns a plan from state to goal, and stores it in path.
+     *
+     * If the remaining steps of the previous plan for this goal are still
+     * valid from state and reach the goal, they are returned as is. If only
+     * their beginning is valid, the end is planned again from the state
+     * predicted at the first invalid step. Otherwise the plan is found from
+     * scratch.
+     *
+     * Plans are found with plan_fn, called as plan_fn(from, path, path_len)
+     * and returning the length of the plan like Planner::plan().
+     */
+    template <typename PlanFunction>
+    int plan(const State& state, const Goal<State>& goal_, Action<State>** path, int path_len, PlanFunction plan_fn)
+    {
+        if (goal_.is_reached(state)) {
+            clear();
+            outcome = Outcome::Reused;
+            return 0;
+        }
+
+        if (goal == &goal_ && !steps.empty() && int(steps.size()) <= path_len) {
+            State predicted = state;
+            const int valid = valid_plan_prefix(predicted, steps.data(), steps.size());
+
+            if (valid == int(steps.size()) && goal_.is_reached(predicted)) {
+                outcome = Outcome::Reused;
+                std::copy(steps.begin(), steps.end(), path);
+                return steps.size();
+            }
+
+            if (valid > 0) {
+                const int len = plan_fn(predicted, path + valid, path_len - valid);
+                if (len >= 0) {
+                    outcome = Outcome::Repaired;
+                    std::copy(steps.begin(), steps.begin() + valid, path);
+                    return store(goal_, path, valid + len);
+                }
+            }
+        }
+
+        outcome = Outcome::Replanned;
+        return store(goal_, path, plan_fn(state, path, path_len));
+    }
+
+    /** Tracks a plan for goal found elsewhere, for example by a
+     * PlanningService. */
+    void follow(const Goal<State>& goal_, Action<State>* const* path, int len)
+    {
+        goal = &goal_;
+        steps.assign(path, path + len);
+    }
+
+    /** Marks the first step of the plan as executed. */
+    void step_done()
+    {
+        if (!steps.empty()) {
+            steps.erase(steps.begin());
+        }
+    }
+
+    /** Forgets about the plan, for example after an action failed. */
+    void clear()
+    {
+        steps.clear();
+        goal = nullptr;
+    }
+
+    /** How the last plan was obtained */
+    Outcome last_outcome() const
+    {
+        return outcome;
+    }
+
+    /** Steps of the plan not executed yet */
+    const std::vector<Action<State>*>& remaining_steps() const
+    {
+        return steps;
+    }
+};
+
+} // namespace goap
+
+#endif
@@ -0,0 +1,209 @@
+/** Planning of several goals at once
+ *
+ * Choosing what to do next means finding a plan for every goal, and picking
+ * the one giving the most value for its cost. The goals are independent, so
+ * they are planned concurrently, on a small pool of threads.
+ */
+#ifndef GOAP_PLANNING_SERVICE_HPP
+#define GOAP_PLANNING_SERVICE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <goap/anytime_planner.hpp>
+
+namespace goap {
+
+/** Plans all of its goals from a given state, and ranks the resulting plans.
+ *
+ * Each goal has its own planner, and thus its own memory, reused from one
+ * call to the next. As long as the state does not change, the searches
+ * started by the previous calls go on where they stopped, so a goal too hard
+ * to plan in one call gets a plan after a few of them. The actions are shared between all the planning threads:
+ * can_run(), plan_effects() and cost() must not modify the action.
+ */
+template <typename State, typename Hash = StateHash<State>>
+class PlanningService {
+public:
+    using Clock = typename AnytimePlanner<State, Hash>::Clock;
+
+    struct Plan {
+        Goal<State>* goal;
+        float value;
+        // Total cost of the actions, see Action::cost()
+        int cost;
+        std::vector<Action<State>*> path;
+    };
+
+private:
+    struct GoalPlanner {
+        Goal<State>* goal;
+        float value;
+        AnytimePlanner<State, Hash> planner;
+        std::vector<Action<State>*> path;
+        int len;
+        int cost;
+
+        GoalPlanner(Goal<State>& goal_, float value_, float initial_weight, float weight_step, size_t node_budget, int max_path_len)
+            : goal(&goal_)
+            , value(value_)
+            , planner(initial_weight, weight_step, node_budget)
+            , path(max_path_len)
+            , len(kErrorNoPathFound)
+            , cost(0)
+        {
+        }
+    };
+
+    Action<State>** actions;
+    unsigned action_count;
+    int max_path_len;
+    float initial_weight;
+    float weight_step;
+    size_t node_budget;
+    std::vector<std::unique_ptr<GoalPlanner>> goals;
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+
+    // Current request, protected by lock
+    const State* state = nullptr;
+    typename Clock::time_point deadline;
+    size_t next_goal = 0;
+    size_t pending = 0;
+    unsigned generation = 0;
+    unsigned out_of_time = 0;
+    bool stopping = false;
+
+    /** Plans goals until none is left. Called with the lock held. */
+    void run(std::unique_lock<std::mutex>& l)
+    {
+        while (next_goal < goals.size()) {
+            auto& g = *goals[next_goal++];
+            l.unlock();
+            g.len = g.planner.resume(*state, *g.goal, actions, action_count, deadline, g.path.data(), g.path.size());
+            if (g.len > 0) {
+                g.cost = plan_cost(*state, g.path.data(), g.len);
+            }
+            l.lock();
+            if (g.len == kErrorOutOfTime) {
+                out_of_time++;
+            }
+            if (--pending == 0) {
+                work_done.notify_all();
+            }
+        }
+    }
+
+    void worker()
+    {
+        std::unique_lock<std::mutex> l(lock);
+        auto seen = generation;
+        while (true) {
+            work_ready.wait(l, [&]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            run(l);
+        }
+    }
+
+public:
+    /** Creates a service planning with the given actions, using thread_count
+     * threads in addition to the calling one. The planners are configured
+     * like AnytimePlanner. */
+    PlanningService(Action<State>* actions_[], unsigned action_count_, int max_path_len_, unsigned thread_count,
+                    float initial_weight_ = 3.f, float weight_step_ = 0.5f, size_t node_budget_ = 0)
+        : actions(actions_)
+        , action_count(action_count_)
+        , max_path_len(max_path_len_)
+        , initial_weight(initial_weight_)
+        , weight_step(weight_step_)
+        , node_budget(node_budget_)
+    {
+        for (auto i = 0u; i < thread_count; i++) {
+            workers.emplace_back([this]() { worker(); });
+        }
+    }
+
+    ~PlanningService()
+    {
+        {
+            std::lock_guard<std::mutex> l(lock);
+            stopping = true;
+        }
+        work_ready.notify_all();
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+    PlanningService(const PlanningService&) = delete;
+    PlanningService& operator=(const PlanningService&) = delete;
+
+    /** Adds a goal worth value. Must not be called while planning. */
+    void add_goal(Goal<State>& goal, float value)
+    {
+        goals.emplace_back(new GoalPlanner(goal, value, initial_weight, weight_step, node_budget, max_path_len));
+    }
+
+    /** Plans every goal from state, with the given deadline.
+     *
+     * Returns the plans found, the best first. Plans are ranked by value per
+     * unit of cost, then in the order the goals were added. Goals which are
+     * already reached or cannot be reached are left out.
+     */
+    std::vector<Plan> plan(const State& state_, typename Clock::time_point deadline_)
+    {
+        {
+            std::unique_lock<std::mutex> l(lock);
+            state = &state_;
+            deadline = deadline_;
+            next_goal = 0;
+            pending = goals.size();
+            out_of_time = 0;
+            generation++;
+            work_ready.notify_all();
+
+            run(l);
+            work_done.wait(l, [&]() { return pending == 0; });
+        }
+
+        std::vector<Plan> plans;
+        for (auto& g : goals) {
+            if (g->len <= 0) {
+                continue;
+            }
+            plans.push_back({g->goal, g->value, g->cost, {g->path.begin(), g->path.begin() + g->len}});
+        }
+
+        std::stable_sort(plans.begin(), plans.end(), [](const Plan& a, const Plan& b) {
+            return a.value * b.cost > b.value * a.cost;
+        });
+
+        return plans;
+    }
+
+    /** Number of goals left out of the last plans because their search ran
+     * out of time before finding any plan. */
+    unsigned goals_out_of_time() const
+    {
+        return out_of_time;
+    }
+
+    /** Number of threads planning besides the calling one */
+    unsigned thread_count() const
+    {
+        return workers.size();
+    }
+};
+
+} // namespace goap
+
+#endif
@@ -0,0 +1,250 @@
+#include <cstring>
+#include <CppUTest/TestHarness.h>
+#include <goap/anytime_planner.hpp>
+
+namespace {
+// Robot moving on a line, either one or three cells at a time. Going three
+// cells at a time can overshoot the target, so the distance to the goal is
+// always admissible but greedy plans are not the shortest.
+struct LineState {
+    int position;
+};
+
+bool operator==(const LineState& lhs, const LineState& rhs)
+{
+    return lhs.position == rhs.position;
+}
+
+struct Move : goap::Action<LineState> {
+    int step;
+
+    explicit Move(int s)
+        : step(s)
+    {
+    }
+
+    bool can_run(const LineState& state) override
+    {
+        return state.position + step >= -20 && state.position + step <= 20;
+    }
+
+    void plan_effects(LineState& state) override
+    {
+        state.position += step;
+    }
+
+    bool execute(LineState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct ReachPosition : goap::Goal<LineState> {
+    int target;
+
+    explicit ReachPosition(int t)
+        : target(t)
+    {
+    }
+
+    int distance_to(const LineState& state) const override
+    {
+        return (abs(target - state.position) + 2) / 3;
+    }
+};
+
+// Small graph where the weighted search first reaches X through an expensive
+// edge and expands it, before finding a cheaper way there through Y.
+enum Node { S,
+            X,
+            Y,
+            Z,
+            G };
+
+struct Edge : goap::Action<LineState> {
+    int from, to, edge_cost;
+
+    Edge(int f, int t, int c)
+        : from(f)
+        , to(t)
+        , edge_cost(c)
+    {
+    }
+
+    bool can_run(const LineState& state) override
+    {
+        return state.position == from;
+    }
+
+    void plan_effects(LineState& state) override
+    {
+        state.position = to;
+    }
+
+    bool execute(LineState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+
+    int cost(const LineState&) override
+    {
+        return edge_cost;
+    }
+};
+
+struct ReachG : goap::Goal<LineState> {
+    bool is_reached(const LineState& state) const override
+    {
+        return state.position == G;
+    }
+
+    int distance_to(const LineState& state) const override
+    {
+        const int distance[] = {1, 0, 2, 1, 0};
+        return distance[state.position];
+    }
+};
+} // namespace
+
+TEST_GROUP (AnytimePlannerTestGroup) {
+    Move forward{1}, backward{-1}, jump{3}, jump_back{-3};
+    goap::Action<LineState>* actions[4] = {&forward, &backward, &jump, &jump_back};
+    goap::Action<LineState>* path[20];
+    LineState start{0};
+    goap::AnytimePlanner<LineState> planner;
+
+    goap::AnytimePlanner<LineState>::Clock::time_point far_future()
+    {
+        return goap::AnytimePlanner<LineState>::Clock::now() + std::chrono::hours(1);
+    }
+};
+
+TEST(AnytimePlannerTestGroup, FindsOptimalPlanGivenEnoughTime)
+{
+    ReachPosition goal(11);
+
+    auto len = planner.plan(start, goal, actions, 4, far_future(), path, 20);
+
+    // 3 + 3 + 3 + 1 + 1
+    CHECK_EQUAL(5, len);
+    CHECK_TRUE(planner.is_optimal());
+
+    LineState s = start;
+    for (int i = 0; i < len; i++) {
+        path[i]->execute(s);
+    }
+    CHECK_EQUAL(11, s.position);
+}
+
+TEST(AnytimePlannerTestGroup, GoalAlreadyReached)
+{
+    ReachPosition goal(0);
+
+    CHECK_EQUAL(0, planner.plan(start, goal, actions, 4, far_future(), path, 20));
+}
+
+TEST(AnytimePlannerTestGroup, ReportsWhenOutOfTime)
+{
+    ReachPosition goal(11);
+    planner.start(start, goal, actions, 4);
+
+    CHECK_EQUAL(goap::kErrorOutOfTime, planner.improve(far_future(), path, 20, 1));
+    CHECK_FALSE(planner.is_complete());
+}
+
+TEST(AnytimePlannerTestGroup, CanContinueSearchOverSeveralCalls)
+{
+    ReachPosition goal(11);
+    planner.start(start, goal, actions, 4);
+
+    int len = goap::kErrorOutOfTime;
+    int calls = 0;
+    while (!planner.is_complete()) {
+        len = planner.improve(far_future(), path, 20, 2);
+        calls++;
+    }
+
+    CHECK_TRUE(calls > 1);
+    CHECK_EQUAL(5, len);
+    CHECK_TRUE(planner.is_optimal());
+}
+
+TEST(AnytimePlannerTestGroup, StatisticsCoverAllCalls)
+{
+    ReachPosition goal(11);
+    planner.start(start, goal, actions, 4);
+    CHECK_EQUAL(1, planner.stats().generated);
+
+    planner.improve(far_future(), path, 20, 2);
+    planner.improve(far_future(), path, 20, 2);
+
+    CHECK_EQUAL(4, planner.stats().expanded);
+    CHECK_TRUE(planner.stats().generated > 4);
+}
+
+TEST(AnytimePlannerTestGroup, ExpiredDeadlineStillReturnsPreviousPlan)
+{
+    ReachPosition goal(11);
+    planner.start(start, goal, actions, 4);
+    while (planner.improve(far_future(), path, 20, 1) < 0) {
+    }
+
+    auto past = goap::AnytimePlanner<LineState>::Clock::now() - std::chrono::seconds(1);
+    CHECK_TRUE(planner.improve(past, path, 20) > 0);
+}
+
+TEST(AnytimePlannerTestGroup, ReportsImpossiblePlans)
+{
+    ReachPosition goal(42);
+
+    CHECK_EQUAL(goap::kErrorNoPathFound, planner.plan(start, goal, actions, 4, far_future(), path, 20));
+}
+
+TEST(AnytimePlannerTestGroup, LowersWeightBetweenSearches)
+{
+    ReachPosition goal(11);
+    planner.start(start, goal, actions, 4);
+    CHECK_EQUAL(3.f, planner.current_weight());
+
+    planner.improve(far_future(), path, 20);
+
+    CHECK_EQUAL(1.f, planner.current_weight());
+}
+
+TEST(AnytimePlannerTestGroup, ExpandsStatesImprovedAfterTheirExpansion)
+{
+    Edge s_x{S, X, 4}, s_y{S, Y, 1}, y_x{Y, X, 1}, x_z{X, Z, 1}, z_g{Z, G, 1};
+    goap::Action<LineState>* edges[] = {&s_x, &s_y, &y_x, &x_z, &z_g};
+    ReachG goal;
+
+    auto len = planner.plan(LineState{S}, goal, edges, 5, far_future(), path, 20);
+
+    CHECK_EQUAL(4, len);
+    POINTERS_EQUAL(&s_y, path[0]);
+    POINTERS_EQUAL(&y_x, path[1]);
+}
+
+TEST(AnytimePlannerTestGroup, ResumeContinuesTheSearchFromTheSameState)
+{
+    ReachPosition goal(11);
+    auto past = goap::AnytimePlanner<LineState>::Clock::now() - std::chrono::seconds(1);
+
+    CHECK_EQUAL(goap::kErrorOutOfTime, planner.resume(start, goal, actions, 4, past, path, 20));
+    planner.improve(far_future(), path, 20, 2);
+    auto expanded = planner.stats().expanded;
+
+    CHECK_EQUAL(5, planner.resume(start, goal, actions, 4, far_future(), path, 20));
+    CHECK_TRUE(planner.stats().expanded > expanded);
+    CHECK_TRUE(planner.is_optimal());
+}
+
+TEST(AnytimePlannerTestGroup, ResumeStartsOverFromAnotherState)
+{
+    ReachPosition goal(11);
+    planner.plan(start, goal, actions, 4, far_future(), path, 20);
+
+    CHECK_EQUAL(1, planner.resume(LineState{10}, goal, actions, 4, far_future(), path, 20));
+    POINTERS_EQUAL(&forward, path[0]);
+}
@@ -1,6 +1,7 @@
 #include <CppUTest/TestHarness.h>
 #include <CppUTestExt/MockSupport.h>
 #include <array>
+#include <set>
 #include <goap/goap_internals.hpp>
 
 using namespace goap;
@@ -9,6 +10,11 @@ struct MyState {
     bool dummy;
 };
 
+bool operator==(const MyState& lhs, const MyState& rhs)
+{
+    return lhs.dummy == rhs.dummy;
+}
+
 TEST_GROUP (InternalVisitedListState) {
     std::array<VisitedState<MyState>, 10> nodes;
 };
@@ -23,34 +29,6 @@ TEST(InternalVisitedListState, CanConvertToLinkedList)
     POINTERS_EQUAL(nullptr, nodes[nodes.size() - 1].next);
 }
 
-TEST(InternalVisitedListState, CanPopMinimumPriorityEvent)
-{
-    visited_states_array_to_list<MyState>(nodes.data(), nodes.size());
-
-    for (auto& p : nodes) {
-        p.priority = 42;
-    }
-
-    nodes[2].priority = 10;
-    auto* head = nodes.data();
-    auto* p = priority_list_pop<MyState>(head);
-
-    CHECK_EQUAL(p, &nodes[2]);
-
-    // The element should have been removed from the list
-    POINTERS_EQUAL(&nodes[3], nodes[1].next);
-    POINTERS_EQUAL(nullptr, p->next);
-}
-
-TEST(InternalVisitedListState, CanPopPriorityEventHead)
-{
-    visited_states_array_to_list<MyState>(nodes.data(), 1);
-    auto* head = nodes.data();
-    priority_list_pop<MyState>(head);
-
-    POINTERS_EQUAL(nullptr, head);
-}
-
 TEST(InternalVisitedListState, CanPopFromListHead)
 {
     visited_states_array_to_list<MyState>(nodes.data(), nodes.size());
@@ -90,3 +68,208 @@ TEST(InternalVisitedListState, CanPushEmptyList)
     POINTERS_EQUAL(&new_elem, head);
     POINTERS_EQUAL(nullptr, head->next);
 }
+
+TEST_GROUP (InternalOpenHeap) {
+    std::array<VisitedState<MyState>, 10> nodes;
+    std::array<VisitedState<MyState>*, 10> storage;
+    OpenHeap<MyState> heap{storage.data(), 10};
+};
+
+TEST(InternalOpenHeap, PopsInPriorityOrder)
+{
+    const int priorities[] = {5, 3, 8, 1, 9, 2, 7, 4, 6, 0};
+    for (auto i = 0u; i < nodes.size(); i++) {
+        nodes[i].priority = priorities[i];
+        heap.push(&nodes[i]);
+    }
+
+    for (int expected = 0; expected < 10; expected++) {
+        auto p = heap.pop();
+        CHECK_EQUAL(expected, p->priority);
+        CHECK_EQUAL(-1, p->heap_index);
+    }
+    CHECK_TRUE(heap.empty());
+}
+
+TEST(InternalOpenHeap, LastPushedWinsTies)
+{
+    nodes[0].priority = 1;
+    nodes[1].priority = 1;
+    heap.push(&nodes[0]);
+    heap.push(&nodes[1]);
+
+    POINTERS_EQUAL(&nodes[1], heap.pop());
+}
+
+TEST(InternalOpenHeap, CanDecreasePriority)
+{
+    for (auto i = 0u; i < nodes.size(); i++) {
+        nodes[i].priority = 10 + i;
+        heap.push(&nodes[i]);
+    }
+
+    nodes[7].priority = 0;
+    heap.update(&nodes[7]);
+
+    POINTERS_EQUAL(&nodes[7], heap.pop());
+    POINTERS_EQUAL(&nodes[0], heap.pop());
+}
+
+TEST(InternalOpenHeap, CanPopWorstElement)
+{
+    for (auto i = 0u; i < nodes.size(); i++) {
+        nodes[i].priority = (i * 7) % 10;
+        heap.push(&nodes[i]);
+    }
+
+    CHECK_EQUAL(9, heap.pop_worst()->priority);
+    CHECK_EQUAL(8, heap.pop_worst()->priority);
+    CHECK_EQUAL(8, heap.size());
+    CHECK_EQUAL(0, heap.pop()->priority);
+}
+
+TEST(InternalOpenHeap, RefusesToGrowPastCapacity)
+{
+    for (auto& n : nodes) {
+        n.priority = 0;
+        CHECK_TRUE(heap.push(&n));
+    }
+
+    VisitedState<MyState> extra{};
+    CHECK_FALSE(heap.push(&extra));
+}
+
+TEST_GROUP (InternalStateTable) {
+    std::array<VisitedState<int>, 10> nodes;
+    std::array<VisitedState<int>*, 16> storage;
+    StateTable<int> table{storage.data(), storage.size()};
+
+    void setup() override
+    {
+        // All the states collide, to exercise probing
+        for (auto i = 0u; i < nodes.size(); i++) {
+            nodes[i].state = i;
+            nodes[i].hash = 3;
+        }
+    }
+};
+
+TEST(InternalStateTable, CanFindInsertedStates)
+{
+    for (auto& n : nodes) {
+        table.insert(&n);
+    }
+
+    for (auto i = 0u; i < nodes.size(); i++) {
+        POINTERS_EQUAL(&nodes[i], table.find(i, 3));
+    }
+    POINTERS_EQUAL(nullptr, table.find(42, 3));
+    POINTERS_EQUAL(nullptr, table.find(1, 4));
+}
+
+TEST(InternalStateTable, CanRemoveFromCluster)
+{
+    for (auto& n : nodes) {
+        table.insert(&n);
+    }
+
+    table.remove(&nodes[2]);
+    table.remove(&nodes[5]);
+
+    POINTERS_EQUAL(nullptr, table.find(2, 3));
+    POINTERS_EQUAL(nullptr, table.find(5, 3));
+    for (auto i : {0, 1, 3, 4, 6, 7, 8, 9}) {
+        POINTERS_EQUAL(&nodes[i], table.find(i, 3));
+    }
+}
+
+TEST(InternalStateTable, TableSizeIsAPowerOfTwo)
+{
+    CHECK_EQUAL(1, state_table_size(0));
+    CHECK_EQUAL(256, state_table_size(100));
+    CHECK_EQUAL(256, state_table_size(128));
+    CHECK_EQUAL(512, state_table_size(129));
+}
+
+TEST_GROUP (InternalStateHash) {
+};
+
+TEST(InternalStateHash, EqualStatesHaveEqualHashes)
+{
+    StateHash<int> hash;
+    CHECK_EQUAL(hash(42), hash(42));
+    CHECK(hash(42) != hash(43));
+}
+
+TEST_GROUP (InternalNodeArena) {
+    NodeArena<MyState> arena{4};
+};
+
+TEST(InternalNodeArena, NodesAreDistinct)
+{
+    std::set<VisitedState<MyState>*> nodes;
+    for (int i = 0; i < 100; i++) {
+        nodes.insert(arena.allocate());
+    }
+
+    CHECK_EQUAL(100, nodes.size());
+    CHECK_EQUAL(100, arena.size());
+}
+
+TEST(InternalNodeArena, CapacityDoubles)
+{
+    for (int i = 0; i < 5; i++) {
+        arena.allocate();
+    }
+
+    CHECK_EQUAL(8, arena.capacity());
+}
+
+TEST(InternalNodeArena, ResetReusesNodes)
+{
+    auto first = arena.allocate();
+    for (int i = 0; i < 10; i++) {
+        arena.allocate();
+    }
+    auto capacity = arena.capacity();
+
+    arena.reset();
+
+    CHECK_EQUAL(0, arena.size());
+    POINTERS_EQUAL(first, arena.allocate());
+    CHECK_EQUAL(capacity, arena.capacity());
+}
+
+TEST_GROUP (InternalArenaNodeStorage) {
+};
+
+TEST(InternalArenaNodeStorage, GrowsHeapAndTable)
+{
+    ArenaNodeStorage<int> storage;
+    storage.reset();
+
+    const int count = 10 * ArenaNodeStorage<int>::arena_initial_size;
+    for (int i = 0; i < count; i++) {
+        auto node = storage.allocate();
+        node->state = i;
+        node->priority = count - i;
+        node->hash = StateHash<int>()(i);
+        storage.open.push(node);
+        storage.known.insert(node);
+    }
+
+    for (int i = 0; i < count; i++) {
+        CHECK(storage.known.find(i, StateHash<int>()(i)) != nullptr);
+    }
+    CHECK_EQUAL(count - 1, storage.open.pop()->state);
+}
+
+TEST(InternalArenaNodeStorage, BudgetLimitsAllocations)
+{
+    ArenaNodeStorage<int> storage(2);
+    storage.reset();
+
+    CHECK(storage.allocate() != nullptr);
+    CHECK(storage.allocate() != nullptr);
+    POINTERS_EQUAL(nullptr, storage.allocate());
+}
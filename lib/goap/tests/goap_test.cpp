@@ -52,6 +52,33 @@ struct GrabAxe : public goap::Action<TestState> {
     }
 };
 
+struct BuyWood : public goap::Action<TestState> {
+    int price = 5;
+
+    bool can_run(const TestState& state) override
+    {
+        (void)state;
+        return true;
+    }
+
+    void plan_effects(TestState& state) override
+    {
+        state.has_wood = true;
+    }
+
+    bool execute(TestState& state) override
+    {
+        state.has_wood = true;
+        return true;
+    }
+
+    int cost(const TestState& state) override
+    {
+        (void)state;
+        return price;
+    }
+};
+
 struct SimpleGoal : goap::Goal<TestState> {
     int distance_to(const TestState& state) const override
     {
@@ -170,6 +197,33 @@ TEST(SimpleScenario, MinimizeCost)
     CHECK_EQUAL(1, cost);
 }
 
+TEST(SimpleScenario, LongerPlanIsChosenIfCheaper)
+{
+    BuyWood buy_wood;
+    goap::Action<TestState>* actions[] = {&buy_wood, &grab_axe_action, &cut_wood_action};
+    goap::Action<TestState>* path[10];
+    goap::Planner<TestState> planner;
+
+    auto len = planner.plan(state, goal, actions, 3, path, 10);
+
+    CHECK_EQUAL(2, len);
+    CHECK_EQUAL(2, goap::plan_cost(state, path, len));
+
+    buy_wood.price = 1;
+    len = planner.plan(state, goal, actions, 3, path, 10);
+
+    CHECK_EQUAL(1, len);
+    POINTERS_EQUAL(&buy_wood, path[0]);
+}
+
+TEST(SimpleScenario, PlanCostIsSumOfActionCosts)
+{
+    BuyWood buy_wood;
+    goap::Action<TestState>* path[] = {&grab_axe_action, &buy_wood};
+
+    CHECK_EQUAL(6, goap::plan_cost(state, path, 2));
+}
+
 TEST(SimpleScenario, WhatHappensIfThereIsNoPath)
 {
     int action_count = 1;
@@ -254,6 +308,82 @@ TEST(TooLongPathTestGroup, RespectsMaxOutputLength)
     CHECK_TEXT(cost < 0, "Should not have found a path");
 }
 
+TEST_GROUP (DynamicPlannerTestGroup) {
+    FarAwayAction a;
+    FarAwayGoal goal;
+    goap::Action<FarAwayState>* actions[1] = {&a};
+};
+
+TEST(DynamicPlannerTestGroup, FindsPlansLongerThanFixedPlanner)
+{
+    FarAwayState state;
+    state.farDistance = 1000;
+    goap::DynamicPlanner<FarAwayState> planner;
+
+    auto len = planner.plan(state, goal, actions, 1, nullptr, 1000);
+
+    CHECK_EQUAL(1000, len);
+    CHECK_EQUAL(1001, planner.node_count());
+}
+
+TEST(DynamicPlannerTestGroup, RespectsNodeBudget)
+{
+    FarAwayState state;
+    state.farDistance = 1000;
+    goap::DynamicPlanner<FarAwayState> planner(100);
+
+    auto len = planner.plan(state, goal, actions, 1, nullptr, 1000);
+
+    CHECK_EQUAL(goap::kErrorNotEnoughMemory, len);
+    CHECK_EQUAL(100, planner.node_count());
+}
+
+TEST(DynamicPlannerTestGroup, CountsExpandedStates)
+{
+    FarAwayState state;
+    state.farDistance = 10;
+    goap::DynamicPlanner<FarAwayState> planner;
+
+    planner.plan(state, goal, actions, 1, nullptr, 1000);
+
+    // Every state from 10 down to 0 is created and visited once
+    CHECK_EQUAL(11, planner.stats().expanded);
+    CHECK_EQUAL(11, planner.stats().generated);
+    CHECK_EQUAL(0, planner.stats().dropped);
+}
+
+TEST(DynamicPlannerTestGroup, ReusesMemoryBetweenPlans)
+{
+    FarAwayState state;
+    state.farDistance = 1000;
+    goap::DynamicPlanner<FarAwayState> planner;
+
+    planner.plan(state, goal, actions, 1, nullptr, 1000);
+    auto reserved = planner.reserved_bytes();
+
+    state.farDistance = 500;
+    CHECK_EQUAL(500, planner.plan(state, goal, actions, 1, nullptr, 1000));
+    CHECK_EQUAL(reserved, planner.reserved_bytes());
+}
+
+TEST(DynamicPlannerTestGroup, FindsSamePlanAsFixedPlanner)
+{
+    TestState state;
+    memset(&state, 0, sizeof(state));
+    SimpleGoal simple_goal;
+    CutWood cut_wood;
+    GrabAxe grab_axe;
+    goap::Action<TestState>* wood_actions[] = {&cut_wood, &grab_axe};
+    goap::Action<TestState>* path[10] = {nullptr};
+    goap::DynamicPlanner<TestState> planner;
+
+    auto len = planner.plan(state, simple_goal, wood_actions, 2, path, 10);
+
+    CHECK_EQUAL(2, len);
+    POINTERS_EQUAL(&grab_axe, path[0]);
+    POINTERS_EQUAL(&cut_wood, path[1]);
+}
+
 TEST_GROUP (InternalDistanceGroup) {
 };
 
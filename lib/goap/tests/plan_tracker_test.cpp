@@ -0,0 +1,215 @@
+#include <CppUTest/TestHarness.h>
+#include <goap/plan_tracker.hpp>
+
+namespace {
+// Robot which has to bring a cube to a tower, going through a door which can
+// get closed behind its back.
+struct RoomState {
+    bool door_open;
+    bool has_cube;
+    bool cube_on_tower;
+};
+
+bool operator==(const RoomState& lhs, const RoomState& rhs)
+{
+    return lhs.door_open == rhs.door_open && lhs.has_cube == rhs.has_cube && lhs.cube_on_tower == rhs.cube_on_tower;
+}
+
+struct OpenDoor : goap::Action<RoomState> {
+    bool can_run(const RoomState& state) override
+    {
+        return !state.door_open;
+    }
+
+    void plan_effects(RoomState& state) override
+    {
+        state.door_open = true;
+    }
+
+    bool execute(RoomState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct PickCube : goap::Action<RoomState> {
+    bool can_run(const RoomState& state) override
+    {
+        return !state.has_cube && !state.cube_on_tower;
+    }
+
+    void plan_effects(RoomState& state) override
+    {
+        state.has_cube = true;
+    }
+
+    bool execute(RoomState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct BuildTower : goap::Action<RoomState> {
+    bool can_run(const RoomState& state) override
+    {
+        return state.door_open && state.has_cube;
+    }
+
+    void plan_effects(RoomState& state) override
+    {
+        state.has_cube = false;
+        state.cube_on_tower = true;
+    }
+
+    bool execute(RoomState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct TowerBuilt : goap::Goal<RoomState> {
+    int distance_to(const RoomState& state) const override
+    {
+        return state.cube_on_tower ? 0 : 1;
+    }
+};
+} // namespace
+
+TEST_GROUP (PlanTrackerTestGroup) {
+    OpenDoor open_door;
+    PickCube pick_cube;
+    BuildTower build_tower;
+    goap::Action<RoomState>* actions[3] = {&open_door, &pick_cube, &build_tower};
+    goap::Action<RoomState>* path[10];
+    TowerBuilt goal;
+    RoomState state{false, false, false};
+
+    goap::Planner<RoomState, 20> planner;
+    goap::PlanTracker<RoomState> tracker;
+    int planner_calls = 0;
+
+    int plan()
+    {
+        return tracker.plan(state, goal, path, 10, [&](const RoomState& from, goap::Action<RoomState>** p, int len) {
+            planner_calls++;
+            return planner.plan(from, goal, actions, 3, p, len);
+        });
+    }
+};
+
+TEST(PlanTrackerTestGroup, ValidPrefixStopsAtFirstStepWhichCannotRun)
+{
+    goap::Action<RoomState>* plan[] = {&pick_cube, &build_tower, &open_door};
+
+    auto len = goap::valid_plan_prefix(state, plan, 3);
+
+    CHECK_EQUAL(1, len);
+    CHECK_TRUE(state.has_cube);
+    CHECK_FALSE(state.door_open);
+}
+
+TEST(PlanTrackerTestGroup, FirstPlanComesFromThePlanner)
+{
+    auto len = plan();
+
+    CHECK_EQUAL(3, len);
+    CHECK_EQUAL(1, planner_calls);
+    CHECK_TRUE(tracker.last_outcome() == goap::PlanTracker<RoomState>::Outcome::Replanned);
+    CHECK_EQUAL(3, tracker.remaining_steps().size());
+}
+
+TEST(PlanTrackerTestGroup, PlanIsReusedWhenWorldEvolvesAsPredicted)
+{
+    plan();
+    auto first = path[0];
+    first->execute(state);
+    tracker.step_done();
+
+    auto len = plan();
+
+    CHECK_EQUAL(2, len);
+    CHECK_EQUAL(1, planner_calls);
+    CHECK_TRUE(tracker.last_outcome() == goap::PlanTracker<RoomState>::Outcome::Reused);
+    CHECK_TRUE(path[0] != first);
+}
+
+TEST(PlanTrackerTestGroup, PlanIsRepairedFromFirstInvalidStep)
+{
+    state.door_open = true;
+    plan();
+    POINTERS_EQUAL(&pick_cube, path[0]);
+    POINTERS_EQUAL(&build_tower, path[1]);
+
+    // The door got closed, so only picking the cube is still valid
+    state.door_open = false;
+    auto len = plan();
+
+    CHECK_TRUE(tracker.last_outcome() == goap::PlanTracker<RoomState>::Outcome::Repaired);
+    CHECK_EQUAL(3, len);
+    POINTERS_EQUAL(&pick_cube, path[0]);
+    POINTERS_EQUAL(&open_door, path[1]);
+    POINTERS_EQUAL(&build_tower, path[2]);
+    CHECK_EQUAL(3, tracker.remaining_steps().size());
+}
+
+TEST(PlanTrackerTestGroup, PlanIsFoundAgainWhenFirstStepIsInvalid)
+{
+    state.has_cube = true;
+    plan();
+    POINTERS_EQUAL(&open_door, path[0]);
+
+    // Someone opened the door for us
+    state.door_open = true;
+    auto len = plan();
+
+    CHECK_TRUE(tracker.last_outcome() == goap::PlanTracker<RoomState>::Outcome::Replanned);
+    CHECK_EQUAL(1, len);
+    POINTERS_EQUAL(&build_tower, path[0]);
+    CHECK_EQUAL(2, planner_calls);
+}
+
+TEST(PlanTrackerTestGroup, CanFollowPlanFoundElsewhere)
+{
+    goap::Action<RoomState>* found[] = {&open_door, &pick_cube, &build_tower};
+    tracker.follow(goal, found, 3);
+
+    auto len = plan();
+
+    CHECK_EQUAL(3, len);
+    CHECK_EQUAL(0, planner_calls);
+    POINTERS_EQUAL(&open_door, path[0]);
+}
+
+TEST(PlanTrackerTestGroup, PlanForAnotherGoalIsNotReused)
+{
+    TowerBuilt other_goal;
+    plan();
+
+    tracker.plan(state, other_goal, path, 10, [&](const RoomState& from, goap::Action<RoomState>** p, int len) {
+        planner_calls++;
+        return planner.plan(from, other_goal, actions, 3, p, len);
+    });
+
+    CHECK_EQUAL(2, planner_calls);
+}
+
+TEST(PlanTrackerTestGroup, ReachedGoalNeedsNoPlan)
+{
+    state.cube_on_tower = true;
+
+    CHECK_EQUAL(0, plan());
+    CHECK_EQUAL(0, planner_calls);
+}
+
+TEST(PlanTrackerTestGroup, FailedPlanIsForgotten)
+{
+    TowerBuilt other_goal;
+    plan();
+
+    tracker.plan(state, other_goal, path, 10, [](const RoomState&, goap::Action<RoomState>**, int) { return goap::kErrorNoPathFound; });
+
+    CHECK_TRUE(tracker.remaining_steps().empty());
+}
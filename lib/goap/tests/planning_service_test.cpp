@@ -0,0 +1,156 @@
+#include <cstdlib>
+#include <CppUTest/TestHarness.h>
+#include <goap/planning_service.hpp>
+
+namespace {
+// Robot moving on a line, one cell at a time, between -10 and 10
+struct LineState {
+    int position;
+};
+
+bool operator==(const LineState& lhs, const LineState& rhs)
+{
+    return lhs.position == rhs.position;
+}
+
+struct Move : goap::Action<LineState> {
+    int step;
+
+    explicit Move(int s)
+        : step(s)
+    {
+    }
+
+    bool can_run(const LineState& state) override
+    {
+        return abs(state.position + step) <= 10;
+    }
+
+    void plan_effects(LineState& state) override
+    {
+        state.position += step;
+    }
+
+    bool execute(LineState& state) override
+    {
+        plan_effects(state);
+        return true;
+    }
+};
+
+struct ReachPosition : goap::Goal<LineState> {
+    int target;
+
+    explicit ReachPosition(int t)
+        : target(t)
+    {
+    }
+
+    int distance_to(const LineState& state) const override
+    {
+        return abs(target - state.position);
+    }
+};
+} // namespace
+
+TEST_GROUP (PlanningServiceTestGroup) {
+    Move forward{1}, backward{-1};
+    goap::Action<LineState>* actions[2] = {&forward, &backward};
+    LineState start{0};
+
+    ReachPosition near{2}, far{-8}, unreachable{20}, here{0};
+
+    goap::PlanningService<LineState>::Clock::time_point far_future()
+    {
+        return goap::PlanningService<LineState>::Clock::now() + std::chrono::hours(1);
+    }
+};
+
+TEST(PlanningServiceTestGroup, RanksPlansByValuePerCost)
+{
+    goap::PlanningService<LineState> service(actions, 2, 20, 2);
+    service.add_goal(near, 1);
+    service.add_goal(far, 8);
+
+    auto plans = service.plan(start, far_future());
+
+    CHECK_EQUAL(2, plans.size());
+    POINTERS_EQUAL(&far, plans[0].goal);
+    CHECK_EQUAL(8, plans[0].cost);
+    CHECK_EQUAL(8, plans[0].path.size());
+    POINTERS_EQUAL(&backward, plans[0].path[0]);
+    POINTERS_EQUAL(&near, plans[1].goal);
+    CHECK_EQUAL(2, plans[1].cost);
+}
+
+TEST(PlanningServiceTestGroup, TiesAreRankedInGoalOrder)
+{
+    goap::PlanningService<LineState> service(actions, 2, 20, 2);
+    service.add_goal(near, 1);
+    service.add_goal(far, 4);
+
+    auto plans = service.plan(start, far_future());
+
+    POINTERS_EQUAL(&near, plans[0].goal);
+    POINTERS_EQUAL(&far, plans[1].goal);
+}
+
+TEST(PlanningServiceTestGroup, ReachedAndUnreachableGoalsAreLeftOut)
+{
+    goap::PlanningService<LineState> service(actions, 2, 20, 1);
+    service.add_goal(unreachable, 100);
+    service.add_goal(here, 100);
+    service.add_goal(near, 1);
+
+    auto plans = service.plan(start, far_future());
+
+    CHECK_EQUAL(1, plans.size());
+    POINTERS_EQUAL(&near, plans[0].goal);
+}
+
+TEST(PlanningServiceTestGroup, CanPlanWithoutExtraThreads)
+{
+    goap::PlanningService<LineState> service(actions, 2, 20, 0);
+    service.add_goal(near, 1);
+    service.add_goal(far, 8);
+
+    auto plans = service.plan(start, far_future());
+
+    CHECK_EQUAL(0, service.thread_count());
+    CHECK_EQUAL(2, plans.size());
+    POINTERS_EQUAL(&far, plans[0].goal);
+}
+
+TEST(PlanningServiceTestGroup, CanPlanSeveralTimes)
+{
+    goap::PlanningService<LineState> service(actions, 2, 20, 3);
+    service.add_goal(near, 1);
+    service.add_goal(far, 8);
+
+    for (int i = 0; i < 20; i++) {
+        LineState state{-7 + i % 5};
+        auto plans = service.plan(state, far_future());
+
+        CHECK_EQUAL(2, plans.size());
+        CHECK_EQUAL(2 - state.position, plans.back().cost);
+    }
+}
+
+TEST(PlanningServiceTestGroup, GoalsOutOfTimeAreCountedAndPlannedLater)
+{
+    goap::PlanningService<LineState> service(actions, 2, 20, 1);
+    service.add_goal(near, 1);
+    service.add_goal(far, 8);
+    service.add_goal(here, 1);
+
+    auto past = goap::PlanningService<LineState>::Clock::now() - std::chrono::seconds(1);
+    auto plans = service.plan(start, past);
+
+    CHECK_EQUAL(0, plans.size());
+    CHECK_EQUAL(2, service.goals_out_of_time());
+
+    plans = service.plan(start, far_future());
+
+    CHECK_EQUAL(2, plans.size());
+    CHECK_EQUAL(0, service.goals_out_of_time());
+}
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+
+extern "C" {
+#include <quadramp/quadramp.h>
+#include <quadramp/scurve.h>
+}
+
+// Filters run once per control period, on inputs changing like a trajectory
+// going back and forth. The cost of a period is what matters.
+static int32_t next_input(int& period)
+{
+    period++;
+    return (period / 500) % 2 ? 0 : 20000;
+}
+
+static void BM_QuadRamp(benchmark::State& bench)
+{
+    struct quadramp_filter filter;
+    quadramp_init(&filter);
+    quadramp_set_1st_order_vars(&filter, 100, 100);
+    quadramp_set_2nd_order_vars(&filter, 1, 1);
+    int period = 0;
+
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(quadramp_do_filter(&filter, next_input(period)));
+    }
+}
+BENCHMARK(BM_QuadRamp);
+
+static void BM_SCurve(benchmark::State& bench)
+{
+    struct scurve_filter filter;
+    scurve_init(&filter);
+    scurve_set_limits(&filter, 100, 1, 1. / bench.range(0));
+    int period = 0;
+
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(scurve_do_filter(&filter, next_input(period)));
+    }
+}
+BENCHMARK(BM_SCurve)->Arg(1)->Arg(16)->Arg(SCURVE_MAX_PERIODS);
+
+static void BM_SCurveFixed(benchmark::State& bench)
+{
+    struct scurve_fixed_filter filter;
+    scurve_fixed_init(&filter);
+    scurve_fixed_set_limits(&filter, 100, 1, 1. / bench.range(0));
+    int period = 0;
+
+    for (auto _ : bench) {
+        benchmark::DoNotOptimize(scurve_fixed_do_filter(&filter, next_input(period)));
+    }
+}
+BENCHMARK(BM_SCurveFixed)->Arg(1)->Arg(16)->Arg(SCURVE_MAX_PERIODS);
+
+BENCHMARK_MAIN();
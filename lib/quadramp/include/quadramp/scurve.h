@@ -0,0 +1,156 @@
+#ifndef _SCURVE_H_
+#define _SCURVE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** @file scurve.h
+ * Jerk limited ramps, a smoother alternative to quadramp.
+ * Its functions are compatible with control_system_manager.
+ *
+ * The quadramp switches from accelerating to braking in a single period,
+ * which shakes the robot and makes the wheels slip. This filter computes the
+ * same kind of trapezoidal speed profile, then averages the speed over the
+ * time it takes to reach full acceleration. This ramps the acceleration up
+ * and down, giving S shaped speed profiles, while keeping the speed and
+ * acceleration within the limits and ending exactly on the input. The
+ * profile never switches between speeding up and slowing down faster than
+ * the averaging window, as the acceleration would change twice as fast.
+ *
+ * Two implementations are provided: one in single precision floating point,
+ * for processors with an FPU, and one in fixed point for the others. Both
+ * give the same output up to rounding.
+ *
+ * @sa quadramp.h control_system_manager.h
+ */
+
+/** Longest averaging window, in periods. Lower jerks reduce the acceleration
+ * to keep the window within this. */
+#define SCURVE_MAX_PERIODS 64
+
+/** @brief A jerk limited ramp instance, in floating point.
+ *
+ * All limits are in units per control period (to the power of their order).
+ */
+struct scurve_filter {
+    float speed; /**< Maximum speed (> 0) */
+    float acc; /**< Maximum acceleration and deceleration (> 0) */
+    uint16_t periods; /**< Time to reach full acceleration, acc / jerk */
+
+    int32_t ramp_pos; /**< Position of the trapezoidal profile. */
+    float ramp_frac; /**< Fractional part of ramp_pos. */
+    float ramp_speed; /**< Speed of the trapezoidal profile. */
+    uint16_t since_acc; /**< Periods since the profile sped up. */
+    uint16_t since_dec; /**< Periods since the profile slowed down. */
+
+    float speeds[SCURVE_MAX_PERIODS]; /**< Last speeds of the profile. */
+    float speed_sum; /**< Sum of speeds, periods times the output speed. */
+    uint16_t index; /**< Oldest speed in speeds. */
+    uint16_t stopped; /**< Number of periods the profile has not moved. */
+
+    int32_t out; /**< Output at the previous filter iteration. */
+    float out_frac; /**< Fractional part of the output. */
+    int32_t previous_in; /**< Input at the previous filter iteration. */
+};
+
+/** @brief A jerk limited ramp instance, in fixed point.
+ *
+ * Values have 16 fractional bits. Speeds and accelerations are limited to
+ * 16383 units per period.
+ */
+struct scurve_fixed_filter {
+    int32_t speed; /**< Maximum speed (> 0) */
+    int32_t acc; /**< Maximum acceleration and deceleration (> 0) */
+    uint16_t periods; /**< Time to reach full acceleration, acc / jerk */
+
+    int64_t ramp_pos; /**< Position of the trapezoidal profile. */
+    int32_t ramp_speed; /**< Speed of the trapezoidal profile. */
+    uint16_t since_acc; /**< Periods since the profile sped up. */
+    uint16_t since_dec; /**< Periods since the profile slowed down. */
+
+    int32_t speeds[SCURVE_MAX_PERIODS]; /**< Last speeds of the profile. */
+    int64_t speed_sum; /**< Sum of speeds, periods times the output speed. */
+    int64_t speed_rem; /**< Part of speed_sum not output yet. */
+    uint16_t index; /**< Oldest speed in speeds. */
+    uint16_t stopped; /**< Number of periods the profile has not moved. */
+
+    int64_t out; /**< Output at the previous filter iteration. */
+    int32_t previous_in; /**< Input at the previous filter iteration. */
+};
+
+/** Initialization of the filter.
+ * @param [in] s The scurve instance.
+ */
+void scurve_init(struct scurve_filter* s);
+
+/** @brief Set the limits of the ramp.
+ *
+ * An acceleration or a jerk of zero disables the corresponding limit.
+ * @param [in] s The scurve instance.
+ * @param [in] speed The maximum speed.
+ * @param [in] acc The maximum acceleration, used for deceleration as well.
+ * @param [in] jerk The maximum change of acceleration in one period.
+ */
+void scurve_set_limits(struct scurve_filter* s, float speed, float acc, float jerk);
+
+/** @brief Set position.
+ *
+ * Forces the new position and sets the speed and acceleration to zero.
+ * @param [in] s The scurve instance.
+ * @param [in] pos The new position.
+ */
+void scurve_set_position(struct scurve_filter* s, int32_t pos);
+
+/** @brief Is the ramp finished.
+ *
+ * @returns 1 when filter_input == filter_output and the output is not moving.
+ * @param [in] s The scurve instance.
+ */
+uint8_t scurve_is_finished(struct scurve_filter* s);
+
+/** @brief Process the ramp.
+ *
+ * \param [in] data A pointer to a scurve instance, casted to void *.
+ * \param [in] in The input of the filter.
+ *
+ * @returns The output of the filter.
+ */
+int32_t scurve_do_filter(void* data, int32_t in);
+
+/** Initialization of the filter.
+ * @param [in] s The scurve instance.
+ */
+void scurve_fixed_init(struct scurve_fixed_filter* s);
+
+/** @brief Set the limits of the ramp, converted to fixed point.
+ * @sa scurve_set_limits
+ */
+void scurve_fixed_set_limits(struct scurve_fixed_filter* s, float speed, float acc, float jerk);
+
+/** @brief Set position.
+ * @sa scurve_set_position
+ */
+void scurve_fixed_set_position(struct scurve_fixed_filter* s, int32_t pos);
+
+/** @brief Is the ramp finished.
+ * @sa scurve_is_finished
+ */
+uint8_t scurve_fixed_is_finished(struct scurve_fixed_filter* s);
+
+/** @brief Process the ramp.
+ *
+ * \param [in] data A pointer to a scurve_fixed instance, casted to void *.
+ * \param [in] in The input of the filter.
+ *
+ * @returns The output of the filter.
+ */
+int32_t scurve_fixed_do_filter(void* data, int32_t in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
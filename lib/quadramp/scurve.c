@@ -0,0 +1,383 @@
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <quadramp/scurve.h>
+
+#define FIXED_ONE 65536
+
+/* The profile brakes slightly below the maximum acceleration, so that rounding
+ * errors never leave it too fast to stop on the input */
+#define BRAKE_ACC(acc) ((acc) - (acc) / 128)
+
+/* Largest limit in fixed point, low enough for the braking computation not
+ * to overflow */
+#define SCURVE_FIXED_MAX 16383
+
+/* Averaging window giving a jerk of at most acc / periods. The acceleration
+ * is reduced when the window would be too long. */
+static uint16_t averaging_periods(float* acc, float jerk)
+{
+    float periods;
+
+    if (*acc <= 0 || jerk <= 0) {
+        return 1;
+    }
+
+    periods = ceilf(*acc / jerk);
+    if (periods > SCURVE_MAX_PERIODS) {
+        *acc = jerk * SCURVE_MAX_PERIODS;
+        return SCURVE_MAX_PERIODS;
+    }
+
+    return periods < 1 ? 1 : (uint16_t)periods;
+}
+
+/* Counts the periods since the profile sped up or slowed down */
+static void update_since(uint16_t* since_acc, uint16_t* since_dec, int change)
+{
+    *since_acc = change > 0 ? 0 : *since_acc + (*since_acc < SCURVE_MAX_PERIODS);
+    *since_dec = change < 0 ? 0 : *since_dec + (*since_dec < SCURVE_MAX_PERIODS);
+}
+
+void scurve_init(struct scurve_filter* s)
+{
+    memset(s, 0, sizeof(*s));
+    s->periods = 1;
+    s->stopped = SCURVE_MAX_PERIODS;
+    s->since_acc = SCURVE_MAX_PERIODS;
+    s->since_dec = SCURVE_MAX_PERIODS;
+}
+
+void scurve_set_limits(struct scurve_filter* s, float speed, float acc, float jerk)
+{
+    const uint16_t periods = averaging_periods(&acc, jerk);
+    float average;
+    int i;
+
+    s->speed = speed;
+    s->acc = acc;
+
+    if (periods == s->periods) {
+        return;
+    }
+
+    /* Keeps the output speed when changing the window */
+    average = s->speed_sum / s->periods;
+    for (i = 0; i < periods; i++) {
+        s->speeds[i] = average;
+    }
+    s->speed_sum = average * periods;
+    s->index = 0;
+    s->periods = periods;
+    if (average != 0) {
+        s->stopped = 0;
+    }
+}
+
+void scurve_set_position(struct scurve_filter* s, int32_t pos)
+{
+    memset(s->speeds, 0, sizeof(s->speeds));
+    s->speed_sum = 0;
+    s->stopped = SCURVE_MAX_PERIODS;
+    s->ramp_pos = pos;
+    s->ramp_frac = 0;
+    s->ramp_speed = 0;
+    s->since_acc = SCURVE_MAX_PERIODS;
+    s->since_dec = SCURVE_MAX_PERIODS;
+    s->out = pos;
+    s->out_frac = 0;
+    s->previous_in = pos;
+}
+
+uint8_t scurve_is_finished(struct scurve_filter* s)
+{
+    return s->out == s->previous_in && s->out_frac == 0 && s->stopped >= s->periods;
+}
+
+/* Fastest speed from which the profile stops exactly on the input: the last
+ * step is at most acc, and each step before it is acc faster. */
+static float brake_speed(float distance, float acc)
+{
+    const float steps = ceilf((sqrtf(1 + 8 * distance / acc) - 1) / 2);
+    return steps > 0 ? distance / steps + acc * (steps - 1) / 2 : 0;
+}
+
+/* Highest speed, up to the given one, the profile can speed up to and still
+ * stop on the input, as it keeps it for periods before slowing down */
+static float coast_speed(float distance, float acc, float speed, uint16_t periods)
+{
+    if (distance - speed * periods >= speed * (speed + acc) / (2 * acc)) {
+        return speed;
+    }
+    return distance / (periods + (speed + acc) / (2 * acc));
+}
+
+int32_t scurve_do_filter(void* data, int32_t in)
+{
+    struct scurve_filter* s = data;
+    const float acc = s->acc, brake_acc = BRAKE_ACC(s->acc);
+    const float previous = s->ramp_speed;
+    float e, distance, dir, speed, step;
+
+    s->previous_in = in;
+
+    /* Trapezoidal profile, like the quadramp, worked out towards positive
+     * positions and mirrored when the input is behind */
+    e = (float)(in - s->ramp_pos) - s->ramp_frac;
+    dir = e >= 0 ? 1 : -1;
+    distance = fabsf(e);
+
+    speed = s->speed;
+    if (acc > 0) {
+        speed = fminf(speed, brake_speed(distance, brake_acc));
+        speed = fmaxf(dir * previous - acc, fminf(speed, dir * previous + acc));
+
+        /* Waits for the opposite acceleration to leave the window */
+        if ((dir * speed > previous && s->since_dec + 1 < s->periods)
+            || (dir * speed < previous && s->since_acc + 1 < s->periods)) {
+            speed = dir * previous;
+        }
+
+        /* Speeds up only as long as it can still stop after that */
+        if (speed > fabsf(previous)) {
+            speed = fmaxf(fabsf(previous), coast_speed(distance, brake_acc, speed, s->periods));
+        }
+    }
+    speed *= dir;
+
+    /* last step, we can jump to dest */
+    if (distance <= fabsf(speed) && (e > 0) == (speed > 0)) {
+        speed = e;
+        s->ramp_pos = in;
+        s->ramp_frac = 0;
+    } else {
+        s->ramp_frac += speed;
+        step = floorf(s->ramp_frac);
+        s->ramp_pos += (int32_t)step;
+        s->ramp_frac -= step;
+    }
+    update_since(&s->since_acc, &s->since_dec, (speed > previous) - (speed < previous));
+    s->ramp_speed = speed;
+
+    /* Averages the speed of the profile */
+    s->speed_sum += speed - s->speeds[s->index];
+    s->speeds[s->index] = speed;
+    s->index = (s->index + 1) % s->periods;
+
+    /* Sums the window again from time to time, as the rounding errors of the
+     * running sum add up */
+    if (s->index == 0) {
+        int i;
+        s->speed_sum = 0;
+        for (i = 0; i < s->periods; i++) {
+            s->speed_sum += s->speeds[i];
+        }
+    }
+
+    if (speed != 0) {
+        s->stopped = 0;
+    } else if (s->stopped < SCURVE_MAX_PERIODS) {
+        s->stopped++;
+    }
+
+    /* The whole window is still: we caught up with the profile, without the
+     * rounding errors of the sum */
+    if (s->stopped >= s->periods) {
+        s->speed_sum = 0;
+        s->out = s->ramp_pos;
+        s->out_frac = s->ramp_frac;
+    } else {
+        s->out_frac += s->speed_sum / s->periods;
+        step = floorf(s->out_frac);
+        s->out += (int32_t)step;
+        s->out_frac -= step;
+    }
+
+    return s->out + (s->out_frac >= 0.5f);
+}
+
+static int32_t to_fixed(float x)
+{
+    return (int32_t)(fminf(x, SCURVE_FIXED_MAX) * FIXED_ONE);
+}
+
+/* Square root, rounded down */
+static int64_t isqrt64(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+void scurve_fixed_init(struct scurve_fixed_filter* s)
+{
+    memset(s, 0, sizeof(*s));
+    s->periods = 1;
+    s->stopped = SCURVE_MAX_PERIODS;
+    s->since_acc = SCURVE_MAX_PERIODS;
+    s->since_dec = SCURVE_MAX_PERIODS;
+}
+
+void scurve_fixed_set_limits(struct scurve_fixed_filter* s, float speed, float acc, float jerk)
+{
+    const uint16_t periods = averaging_periods(&acc, jerk);
+    int32_t average;
+    int i;
+
+    s->speed = to_fixed(speed);
+    s->acc = to_fixed(acc);
+
+    if (periods == s->periods) {
+        return;
+    }
+
+    /* Keeps the output speed when changing the window */
+    average = s->speed_sum / s->periods;
+    for (i = 0; i < periods; i++) {
+        s->speeds[i] = average;
+    }
+    s->speed_sum = (int64_t)average * periods;
+    s->speed_rem = 0;
+    s->index = 0;
+    s->periods = periods;
+    if (average != 0) {
+        s->stopped = 0;
+    }
+}
+
+void scurve_fixed_set_position(struct scurve_fixed_filter* s, int32_t pos)
+{
+    memset(s->speeds, 0, sizeof(s->speeds));
+    s->speed_sum = 0;
+    s->speed_rem = 0;
+    s->stopped = SCURVE_MAX_PERIODS;
+    s->ramp_pos = (int64_t)pos * FIXED_ONE;
+    s->ramp_speed = 0;
+    s->since_acc = SCURVE_MAX_PERIODS;
+    s->since_dec = SCURVE_MAX_PERIODS;
+    s->out = s->ramp_pos;
+    s->previous_in = pos;
+}
+
+uint8_t scurve_fixed_is_finished(struct scurve_fixed_filter* s)
+{
+    return s->out == (int64_t)s->previous_in * FIXED_ONE && s->stopped >= s->periods;
+}
+
+/* Fixed point version of brake_speed */
+static int64_t brake_speed_fixed(int64_t distance, int64_t acc)
+{
+    /* The root is rounded down, the loop fixes the number of steps */
+    int64_t steps = (isqrt64((uint64_t)acc * acc + 8 * (uint64_t)acc * distance) - acc) / (2 * acc);
+    while (acc * steps * (steps + 1) / 2 < distance) {
+        steps++;
+    }
+    return steps > 0 ? distance / steps + acc * (steps - 1) / 2 : 0;
+}
+
+/* Fixed point version of coast_speed */
+static int64_t coast_speed_fixed(int64_t distance, int64_t acc, int64_t speed, uint16_t periods)
+{
+    int64_t steps;
+
+    if (distance - speed * periods >= speed * (speed + acc) / (2 * acc)) {
+        return speed;
+    }
+
+    steps = periods * FIXED_ONE + (speed + acc) * FIXED_ONE / (2 * acc);
+    return distance / steps * FIXED_ONE + distance % steps * FIXED_ONE / steps;
+}
+
+int32_t scurve_fixed_do_filter(void* data, int32_t in)
+{
+    struct scurve_fixed_filter* s = data;
+    const int64_t acc = s->acc, brake_acc = BRAKE_ACC(acc);
+    const int64_t previous = s->ramp_speed;
+    int64_t e, distance, dir, speed;
+
+    s->previous_in = in;
+
+    /* Trapezoidal profile, like the quadramp */
+    e = (int64_t)in * FIXED_ONE - s->ramp_pos;
+    dir = e >= 0 ? 1 : -1;
+    distance = dir * e;
+
+    speed = s->speed;
+    if (acc > 0) {
+        /* The braking speed is above the limit past this distance, which
+         * keeps the computation from overflowing */
+        if (distance < speed * (speed + brake_acc) / (2 * brake_acc)) {
+            const int64_t brake = brake_speed_fixed(distance, brake_acc);
+            speed = brake < speed ? brake : speed;
+        }
+
+        if (speed > dir * previous + acc) {
+            speed = dir * previous + acc;
+        } else if (speed < dir * previous - acc) {
+            speed = dir * previous - acc;
+        }
+
+        /* Waits for the opposite acceleration to leave the window */
+        if ((dir * speed > previous && s->since_dec + 1 < s->periods)
+            || (dir * speed < previous && s->since_acc + 1 < s->periods)) {
+            speed = dir * previous;
+        }
+
+        /* Speeds up only as long as it can still stop after that */
+        if (speed > llabs(previous)) {
+            const int64_t coast = coast_speed_fixed(distance, brake_acc, speed, s->periods);
+            speed = coast > llabs(previous) ? coast : llabs(previous);
+        }
+    }
+    speed *= dir;
+
+    /* last step, we can jump to dest */
+    if (distance <= llabs(speed) && (e > 0) == (speed > 0)) {
+        speed = e;
+    }
+    s->ramp_pos += speed;
+    update_since(&s->since_acc, &s->since_dec, (speed > previous) - (speed < previous));
+    s->ramp_speed = speed;
+
+    /* Averages the speed of the profile */
+    s->speed_sum += speed - s->speeds[s->index];
+    s->speeds[s->index] = speed;
+    s->index = (s->index + 1) % s->periods;
+
+    if (speed != 0) {
+        s->stopped = 0;
+    } else if (s->stopped < SCURVE_MAX_PERIODS) {
+        s->stopped++;
+    }
+
+    if (s->stopped >= s->periods) {
+        s->speed_sum = 0;
+        s->speed_rem = 0;
+        s->out = s->ramp_pos;
+    } else {
+        /* Keeps the remainder of the division, so that no distance is lost */
+        s->speed_rem += s->speed_sum;
+        s->out += s->speed_rem / s->periods;
+        s->speed_rem %= s->periods;
+    }
+
+    /* Rounds to the nearest, like the floating point version */
+    return (s->out + FIXED_ONE / 2) >> 16;
+}
@@ -0,0 +1,229 @@
+#include <cmath>
+#include <cstdlib>
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include <quadramp/scurve.h>
+}
+
+TEST_GROUP (AnSCurve) {
+    struct scurve_filter filter;
+    const float speed = 10, acc = 0.5, jerk = 0.02;
+
+    // Speeds of the last iterations, to check the limits
+    float speeds[3] = {0, 0, 0};
+    float max_speed = 0, max_acc = 0, max_jerk = 0;
+
+    void setup() override
+    {
+        scurve_init(&filter);
+        scurve_set_limits(&filter, speed, acc, jerk);
+    }
+
+    int32_t step(int32_t in)
+    {
+        const int32_t out = scurve_do_filter(&filter, in);
+
+        speeds[2] = speeds[1];
+        speeds[1] = speeds[0];
+        speeds[0] = filter.speed_sum / filter.periods;
+        max_speed = std::fmax(max_speed, std::fabs(speeds[0]));
+        max_acc = std::fmax(max_acc, std::fabs(speeds[0] - speeds[1]));
+        max_jerk = std::fmax(max_jerk, std::fabs(speeds[0] - 2 * speeds[1] + speeds[2]));
+
+        return out;
+    }
+
+    int run_until_finished(int32_t in)
+    {
+        int periods = 0;
+        do {
+            step(in);
+            periods++;
+        } while (!scurve_is_finished(&filter) && periods < 100000);
+        return periods;
+    }
+};
+
+TEST(AnSCurve, IsFinishedAfterInit)
+{
+    CHECK_TRUE(scurve_is_finished(&filter));
+}
+
+TEST(AnSCurve, ReachesTheInput)
+{
+    run_until_finished(2000);
+
+    CHECK_EQUAL(2000, filter.out);
+    CHECK_TRUE(scurve_is_finished(&filter));
+}
+
+TEST(AnSCurve, ReachesNegativeInput)
+{
+    run_until_finished(-2000);
+
+    CHECK_EQUAL(-2000, filter.out);
+}
+
+TEST(AnSCurve, IsNotFinishedWhileMoving)
+{
+    step(2000);
+
+    CHECK_FALSE(scurve_is_finished(&filter));
+}
+
+TEST(AnSCurve, StaysWithinTheLimits)
+{
+    run_until_finished(2000);
+
+    // Up to the rounding errors in the sum of speeds
+    CHECK_TRUE(max_speed <= speed * 1.001);
+    CHECK_TRUE(max_acc <= acc * 1.001);
+    CHECK_TRUE(max_jerk <= jerk * 1.001);
+}
+
+TEST(AnSCurve, StaysWithinTheLimitsOnShortMoves)
+{
+    run_until_finished(30);
+
+    CHECK_EQUAL(30, filter.out);
+    CHECK_TRUE(max_acc <= acc * 1.001);
+    CHECK_TRUE(max_jerk <= jerk * 1.001);
+}
+
+TEST(AnSCurve, ReachesFullSpeedAndAcceleration)
+{
+    // Speeds up for longer than it takes to reach full acceleration
+    scurve_set_limits(&filter, 4 * speed, acc, jerk);
+
+    run_until_finished(20000);
+
+    DOUBLES_EQUAL(4 * speed, max_speed, 0.01);
+    DOUBLES_EQUAL(acc, max_acc, 0.01);
+}
+
+TEST(AnSCurve, RampsTheAccelerationUp)
+{
+    step(2000);
+    DOUBLES_EQUAL(jerk, speeds[0], 1e-6);
+
+    step(2000);
+    DOUBLES_EQUAL(2 * jerk, speeds[0] - speeds[1], 1e-6);
+}
+
+TEST(AnSCurve, NeverOvershoots)
+{
+    int32_t previous = 0;
+    for (auto i = 0; i < 1000; i++) {
+        const int32_t out = step(2000);
+        CHECK_TRUE(out >= previous);
+        CHECK_TRUE(out <= 2000);
+        previous = out;
+    }
+}
+
+TEST(AnSCurve, FollowsInputChangingDirection)
+{
+    for (auto i = 0; i < 100; i++) {
+        step(2000);
+    }
+    run_until_finished(-500);
+
+    CHECK_EQUAL(-500, filter.out);
+    CHECK_TRUE(max_acc <= acc * 1.001);
+    CHECK_TRUE(max_jerk <= jerk * 1.001);
+}
+
+TEST(AnSCurve, ReducesAccelerationForLowJerk)
+{
+    scurve_set_limits(&filter, speed, acc, 0.001);
+
+    CHECK_EQUAL(SCURVE_MAX_PERIODS, filter.periods);
+    DOUBLES_EQUAL(0.001 * SCURVE_MAX_PERIODS, filter.acc, 1e-6);
+}
+
+TEST(AnSCurve, ZeroJerkGivesTrapezoidalProfile)
+{
+    scurve_set_limits(&filter, speed, acc, 0);
+
+    CHECK_EQUAL(1, filter.periods);
+    step(2000);
+    DOUBLES_EQUAL(acc, speeds[0], 1e-6);
+}
+
+TEST(AnSCurve, KeepsSpeedWhenChangingLimits)
+{
+    for (auto i = 0; i < 100; i++) {
+        step(2000);
+    }
+    const float before = speeds[0];
+
+    scurve_set_limits(&filter, speed, acc, 2 * jerk);
+
+    DOUBLES_EQUAL(before, filter.speed_sum / filter.periods, 1e-4);
+}
+
+TEST(AnSCurve, SetPositionStopsTheRamp)
+{
+    for (auto i = 0; i < 100; i++) {
+        step(2000);
+    }
+
+    scurve_set_position(&filter, 42);
+
+    CHECK_TRUE(scurve_is_finished(&filter));
+    CHECK_EQUAL(42, step(42));
+}
+
+TEST_GROUP (AFixedPointSCurve) {
+    struct scurve_fixed_filter filter;
+    struct scurve_filter reference;
+
+    void setup() override
+    {
+        scurve_fixed_init(&filter);
+        scurve_fixed_set_limits(&filter, 10, 0.5, 0.02);
+        scurve_init(&reference);
+        scurve_set_limits(&reference, 10, 0.5, 0.02);
+    }
+};
+
+TEST(AFixedPointSCurve, ReachesTheInput)
+{
+    auto periods = 0;
+    while (periods < 1000 && !(scurve_fixed_do_filter(&filter, 2000) == 2000 && scurve_fixed_is_finished(&filter))) {
+        periods++;
+    }
+
+    CHECK_TRUE(periods < 1000);
+}
+
+TEST(AFixedPointSCurve, IsNotFinishedWhileMoving)
+{
+    scurve_fixed_do_filter(&filter, 2000);
+
+    CHECK_FALSE(scurve_fixed_is_finished(&filter));
+}
+
+TEST(AFixedPointSCurve, MatchesFloatingPointVersion)
+{
+    const int32_t inputs[] = {2000, -500, 30};
+
+    for (auto in : inputs) {
+        for (auto i = 0; i < 400; i++) {
+            const int32_t out = scurve_fixed_do_filter(&filter, in);
+            CHECK_TRUE(std::abs(out - scurve_do_filter(&reference, in)) <= 1);
+        }
+        CHECK_TRUE(scurve_fixed_is_finished(&filter));
+    }
+}
+
+TEST(AFixedPointSCurve, SetPositionStopsTheRamp)
+{
+    scurve_fixed_do_filter(&filter, 2000);
+
+    scurve_fixed_set_position(&filter, -42);
+
+    CHECK_TRUE(scurve_fixed_is_finished(&filter));
+    CHECK_EQUAL(-42, scurve_fixed_do_filter(&filter, -42));
+}
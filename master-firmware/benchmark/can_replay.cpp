@@ -0,0 +1,120 @@
+// Cost of processing recorded CAN traffic in the UAVCAN handlers. A capture
+// made with uavcan_capture is replayed as fast as possible into an in-process
+// node running the proxies of the master firmware:
+//
+//     uavcan_capture --can_iface can0 --output match.bin --duration 100
+//     CAN_REPLAY_CAPTURE=match.bin ./can_replay_benchmark
+//
+// The reported items per second are frames per second.
+#include <cstdlib>
+#include <fstream>
+#include <benchmark/benchmark.h>
+#include <absl/strings/str_cat.h>
+#include <uavcan_linux/uavcan_linux.hpp>
+#include <msgbus/messagebus.h>
+#include "can/UavcanToMessagebusProxy.hpp"
+#include "can/can_capture.hpp"
+#include "can/replay_can_driver.hpp"
+
+#include <protobuf/beacons.pb.h>
+#include <protobuf/sensors.pb.h>
+#include <cvra/proximity_beacon/Signal.hpp>
+#include <cvra/sensor/DistanceVL6180X.hpp>
+
+using BeaconProxyBase = UavcanToMessagebusProxy<cvra::proximity_beacon::Signal, BeaconSignal, BeaconSignal_fields, BeaconSignal_msgid>;
+struct BeaconProxy : public BeaconProxyBase {
+    using BeaconProxyBase::BeaconProxyBase;
+
+    std::string topic_name(absl::string_view board_name) override
+    {
+        return absl::StrCat("/beacon/", board_name);
+    }
+
+    absl::optional<BeaconSignal> translate(const cvra::proximity_beacon::Signal& in) override
+    {
+        BeaconSignal out;
+        out.range.range.distance = in.length;
+        return {out};
+    }
+};
+
+using RangeProxyBase = UavcanToMessagebusProxy<cvra::sensor::DistanceVL6180X, Range, Range_fields, Range_msgid>;
+struct RangeProxy : public RangeProxyBase {
+    using RangeProxyBase::RangeProxyBase;
+
+    std::string topic_name(absl::string_view board_name) override
+    {
+        return absl::StrCat("/distance/", board_name);
+    }
+
+    absl::optional<Range> translate(const cvra::sensor::DistanceVL6180X& in) override
+    {
+        Range out;
+        out.distance = in.distance_mm / 1000.f;
+        out.type = Range_RangeType_LASER;
+        return {out};
+    }
+};
+
+static void BM_ReplayCapture(benchmark::State& state)
+{
+    const char* path = std::getenv("CAN_REPLAY_CAPTURE");
+    if (!path) {
+        state.SkipWithError("CAN_REPLAY_CAPTURE is not set");
+        return;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    CaptureReader reader(file);
+    if (!reader.valid()) {
+        state.SkipWithError("Could not read the capture");
+        return;
+    }
+
+    std::vector<CaptureRecord> records;
+    CaptureRecord record;
+    while (reader.read(record)) {
+        records.push_back(record);
+    }
+
+    // Gives a name to every possible node ID, so that the messages of all
+    // nodes in the capture get forwarded.
+    static bus_enumerator_entry_allocator bea[uavcan::NodeID::Max + 1];
+    std::vector<std::string> names;
+    bus_enumerator_t be;
+    bus_enumerator_init(&be, bea, uavcan::NodeID::Max + 1);
+    names.reserve(uavcan::NodeID::Max + 1);
+    for (int id = 1; id <= uavcan::NodeID::Max; id++) {
+        names.push_back(absl::StrCat("node-", id));
+        bus_enumerator_add_node(&be, names.back().c_str(), nullptr);
+        bus_enumerator_update_node_info(&be, names.back().c_str(), id);
+    }
+
+    messagebus_t bus;
+    MESSAGEBUS_POSIX_SYNC_DECL(bus_sync);
+    messagebus_init(&bus, &bus_sync, &bus_sync);
+
+    uavcan_linux::SystemClock clock;
+    ReplayCanDriver driver(clock, records, 0.f);
+    uavcan::Node<16384> node(driver, clock);
+
+    BeaconProxy beacon_proxy(&be, &bus);
+    RangeProxy range_proxy(&be, &bus);
+    beacon_proxy.start(node);
+    range_proxy.start(node);
+
+    size_t frames = 0;
+    for (auto _ : state) {
+        driver.restart();
+        while (!driver.done()) {
+            node.spinOnce();
+        }
+        frames += driver.getFramesReplayed();
+    }
+
+    state.SetItemsProcessed(frames);
+}
+
+BENCHMARK(BM_ReplayCapture)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
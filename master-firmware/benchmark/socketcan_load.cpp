@@ -0,0 +1,114 @@
+// Load test of the SocketCAN drivers, run against a virtual CAN interface:
+//
+//     sudo ip link add dev vcan0 type vcan
+//     sudo ip link set up vcan0
+//     ./socketcan_load_benchmark
+//
+// Each iteration sends a burst of frames from one driver instance and waits
+// until another instance received all of them. The number of syscalls per
+// frame is reported as a counter.
+#include <benchmark/benchmark.h>
+#include <uavcan_linux/uavcan_linux.hpp>
+#include "can/batched_socketcan_driver.hpp"
+
+static const char* iface_name = "vcan0";
+
+static uavcan::CanFrame make_frame(int i)
+{
+    const uint8_t data[8] = {uint8_t(i), uint8_t(i >> 8), 0, 0, 0, 0, 0, 0xc0};
+    return uavcan::CanFrame((i & uavcan::CanFrame::MaskExtID) | uavcan::CanFrame::FlagEFF, data, 8);
+}
+
+static void BM_BatchedDriverLoad(benchmark::State& state)
+{
+    uavcan_linux::SystemClock clock;
+    batched_socketcan::Driver tx_driver(clock), rx_driver(clock);
+
+    if (tx_driver.addIface(iface_name) < 0 || rx_driver.addIface(iface_name) < 0) {
+        state.SkipWithError("vcan0 is not available");
+        return;
+    }
+
+    auto* tx = tx_driver.getIface(0);
+    auto* rx = rx_driver.getIface(0);
+    const int burst = state.range(0);
+
+    for (auto _ : state) {
+        const auto deadline = clock.getMonotonic() + uavcan::MonotonicDuration::fromMSec(100);
+        for (int i = 0; i < burst; i++) {
+            tx->send(make_frame(i), deadline, 0);
+        }
+        tx_driver.flush();
+
+        int received = 0;
+        while (received < burst) {
+            uavcan::CanSelectMasks masks;
+            masks.read = 1;
+            const uavcan::CanFrame* pending[uavcan::MaxCanIfaces] = {};
+            if (rx_driver.select(masks, pending, deadline) <= 0) {
+                state.SkipWithError("Frames were lost");
+                return;
+            }
+
+            uavcan::CanFrame frame;
+            uavcan::MonotonicTime ts_mono;
+            uavcan::UtcTime ts_utc;
+            uavcan::CanIOFlags flags;
+            while (rx->receive(frame, ts_mono, ts_utc, flags) > 0) {
+                received++;
+            }
+        }
+    }
+
+    const double frames = double(state.iterations()) * burst;
+    state.SetItemsProcessed(state.iterations() * burst);
+    state.counters["tx_syscalls_per_frame"] = tx->getTxSyscallCount() / frames;
+    state.counters["rx_syscalls_per_frame"] = rx->getRxSyscallCount() / frames;
+}
+
+BENCHMARK(BM_BatchedDriverLoad)->RangeMultiplier(4)->Range(1, 256);
+
+static void BM_StockDriverLoad(benchmark::State& state)
+{
+    uavcan_linux::SystemClock clock;
+    uavcan_linux::SocketCanDriver tx_driver(clock), rx_driver(clock);
+
+    if (tx_driver.addIface(iface_name) < 0 || rx_driver.addIface(iface_name) < 0) {
+        state.SkipWithError("vcan0 is not available");
+        return;
+    }
+
+    const int burst = state.range(0);
+
+    for (auto _ : state) {
+        const auto deadline = clock.getMonotonic() + uavcan::MonotonicDuration::fromMSec(100);
+        for (int i = 0; i < burst; i++) {
+            tx_driver.getIface(0)->send(make_frame(i), deadline, 0);
+        }
+
+        int received = 0;
+        while (received < burst) {
+            uavcan::CanSelectMasks masks;
+            masks.read = 1;
+            const uavcan::CanFrame* pending[uavcan::MaxCanIfaces] = {};
+            if (rx_driver.select(masks, pending, deadline) <= 0) {
+                state.SkipWithError("Frames were lost");
+                return;
+            }
+
+            uavcan::CanFrame frame;
+            uavcan::MonotonicTime ts_mono;
+            uavcan::UtcTime ts_utc;
+            uavcan::CanIOFlags flags;
+            while (rx_driver.getIface(0)->receive(frame, ts_mono, ts_utc, flags) > 0) {
+                received++;
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+BENCHMARK(BM_StockDriverLoad)->RangeMultiplier(4)->Range(1, 256);
+
+BENCHMARK_MAIN();
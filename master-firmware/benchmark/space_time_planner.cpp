@@ -0,0 +1,34 @@
+// Cost of planning a path on the game table while opponents move across it.
+// This runs in the map server thread every time an opponent moves, so it
+// must stay well below the map server period.
+#include <benchmark/benchmark.h>
+#include "base/path_planner.h"
+
+static void BM_PlanAroundMovingOpponents(benchmark::State& state)
+{
+    MapWriter map(260, 300, true);
+    map.opponent_tracked(0, 1500, 600, 0, 250);
+    map.opponent_tracked(1, 2200, 1400, -200, -100);
+    auto snapshot = map.snapshot();
+
+    PathPlanner planner;
+    Path path = Path_init_default;
+    uint32_t goal_id = 0;
+
+    for (auto _ : state) {
+        PathGoal goal = PathGoal_init_default;
+        goal.id = ++goal_id;
+        goal.active = true;
+        goal.x = 2500;
+        goal.y = 1000;
+        planner.set_goal(goal);
+
+        benchmark::DoNotOptimize(planner.plan(*snapshot, 400, 1200, path));
+    }
+
+    state.counters["waypoints"] = path.waypoints_count;
+}
+
+BENCHMARK(BM_PlanAroundMovingOpponents)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
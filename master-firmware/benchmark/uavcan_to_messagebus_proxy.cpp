@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+#include <absl/strings/str_cat.h>
+#include "can/UavcanToMessagebusProxy.hpp"
+#include <msgbus/messagebus.h>
+
+#include <protobuf/beacons.pb.h>
+#include <cvra/proximity_beacon/Signal.hpp>
+
+using ProxyBase = UavcanToMessagebusProxy<cvra::proximity_beacon::Signal, BeaconSignal, BeaconSignal_fields, BeaconSignal_msgid>;
+struct Proxy : public ProxyBase {
+    Proxy(bus_enumerator_t* be, messagebus_t* bus)
+        : ProxyBase(be, bus)
+    {
+    }
+
+    std::string topic_name(absl::string_view board_name) override
+    {
+        return absl::StrCat("/distance/", board_name);
+    }
+
+    absl::optional<BeaconSignal> translate(const cvra::proximity_beacon::Signal& in) override
+    {
+        BeaconSignal out;
+        out.range.range.distance = in.length;
+        return {out};
+    }
+
+    // Exposes process, which would usually be called from UAVCAN
+    void process(const cvra::proximity_beacon::Signal& msg, uint8_t src_id)
+    {
+        ProxyBase::process(msg, src_id);
+    }
+};
+
+static const char* board_names[] = {"front-left", "front-right", "back-left", "back-right"};
+static const int board_count = sizeof(board_names) / sizeof(board_names[0]);
+
+/** Cost of forwarding one message, once all boards have been seen. */
+static void BM_ProxySteadyState(benchmark::State& state)
+{
+    bus_enumerator_t be;
+    bus_enumerator_entry_allocator bea[board_count];
+    messagebus_t bus;
+    MESSAGEBUS_POSIX_SYNC_DECL(bus_sync);
+    cvra::proximity_beacon::Signal signal;
+
+    messagebus_init(&bus, &bus_sync, &bus_sync);
+    bus_enumerator_init(&be, bea, board_count);
+    for (int i = 0; i < board_count; i++) {
+        bus_enumerator_add_node(&be, board_names[i], nullptr);
+        bus_enumerator_update_node_info(&be, board_names[i], 10 + i);
+    }
+
+    Proxy proxy{&be, &bus};
+    for (int i = 0; i < board_count; i++) {
+        proxy.process(signal, 10 + i);
+    }
+
+    int i = 0;
+    for (auto _ : state) {
+        signal.length = i;
+        proxy.process(signal, 10 + (i % board_count));
+        i++;
+    }
+}
+
+BENCHMARK(BM_ProxySteadyState);
+
+/** Cost of the first message of a board, which advertises its topic. */
+static void BM_ProxyFirstMessage(benchmark::State& state)
+{
+    bus_enumerator_t be;
+    bus_enumerator_entry_allocator bea[1];
+    MESSAGEBUS_POSIX_SYNC_DECL(bus_sync);
+    cvra::proximity_beacon::Signal signal;
+
+    bus_enumerator_init(&be, bea, 1);
+    bus_enumerator_add_node(&be, board_names[0], nullptr);
+    bus_enumerator_update_node_info(&be, board_names[0], 10);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        messagebus_t bus;
+        messagebus_init(&bus, &bus_sync, &bus_sync);
+        auto proxy = std::make_unique<Proxy>(&be, &bus);
+        state.ResumeTiming();
+
+        proxy->process(signal, 10);
+
+        state.PauseTiming();
+        proxy.reset();
+        state.ResumeTiming();
+    }
+}
+
+BENCHMARK(BM_ProxyFirstMessage);
+
+BENCHMARK_MAIN();
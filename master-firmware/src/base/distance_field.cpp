@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include "distance_field.h"
+
+/** Signed distance from p to the border of polygon, negative inside */
+static float polygon_distance(const poly_t& polygon, float x, float y)
+{
+    float distance = INFINITY;
+    bool inside = false;
+
+    for (auto i = 0, j = polygon.l - 1; i < polygon.l; j = i++) {
+        const point_t& a = polygon.pts[j];
+        const point_t& b = polygon.pts[i];
+
+        // Distance to the edge from a to b
+        const float dx = b.x - a.x, dy = b.y - a.y;
+        const float length2 = dx * dx + dy * dy;
+        float t = 0;
+        if (length2 > 0) {
+            t = std::min(1.f, std::max(0.f, ((x - a.x) * dx + (y - a.y) * dy) / length2));
+        }
+        distance = std::min(distance, std::hypot(x - (a.x + t * dx), y - (a.y + t * dy)));
+
+        // Counts the edges crossed by a ray going towards +x
+        if ((a.y > y) != (b.y > y) && x < a.x + (y - a.y) * dx / dy) {
+            inside = !inside;
+        }
+    }
+
+    return inside ? -distance : distance;
+}
+
+DistanceField::Region DistanceField::Region::merge(const Region& other) const
+{
+    if (empty()) {
+        return other;
+    }
+    if (other.empty()) {
+        return *this;
+    }
+
+    return {std::min(x1, other.x1), std::min(y1, other.y1), std::max(x2, other.x2), std::max(y2, other.y2)};
+}
+
+DistanceField::DistanceField(float width_, float height_, float cell_size_, float max_distance_)
+    : width(std::ceil(width_ / cell_size_))
+    , height(std::ceil(height_ / cell_size_))
+    , cell_size(cell_size_)
+    , max_distance(max_distance_)
+    , cells(width * height, max_distance_)
+{
+}
+
+bool DistanceField::segment_is_clear(point_t p1, point_t p2, float min_clearance) const
+{
+    const float length = std::hypot(p2.x - p1.x, p2.y - p1.y);
+    const float half_diagonal = cell_size * M_SQRT1_2;
+    float t = 0;
+
+    while (true) {
+        const float ratio = length > 0 ? t / length : 0;
+        const float clearance = distance(p1.x + ratio * (p2.x - p1.x), p1.y + ratio * (p2.y - p1.y));
+
+        if (clearance < min_clearance) {
+            return false;
+        }
+        if (t >= length) {
+            return true;
+        }
+
+        // Distances change at most as fast as the position, so no point
+        // closer than the margin can be too close to an obstacle.
+        const float margin = clearance - min_clearance - half_diagonal;
+        t = std::min(length, t + std::max(margin, cell_size / 2));
+    }
+}
+
+void DistanceField::add_boundingbox(const bounding_box_t& box)
+{
+    for (auto j = 0; j < height; j++) {
+        const float y = (j + 0.5f) * cell_size;
+        for (auto i = 0; i < width; i++) {
+            const float x = (i + 0.5f) * cell_size;
+            const float inside = std::min({x - box.x1, box.x2 - x, y - box.y1, box.y2 - y});
+            float& cell = cells[j * width + i];
+            cell = std::min(cell, inside);
+        }
+    }
+}
+
+void DistanceField::add_polygon(const poly_t& polygon, const Region& region)
+{
+    const Region around = region_around(polygon);
+    const int x1 = std::max(region.x1, around.x1), x2 = std::min(region.x2, around.x2);
+    const int y1 = std::max(region.y1, around.y1), y2 = std::min(region.y2, around.y2);
+
+    for (auto j = y1; j < y2; j++) {
+        const float y = (j + 0.5f) * cell_size;
+        for (auto i = x1; i < x2; i++) {
+            const float x = (i + 0.5f) * cell_size;
+            float& cell = cells[j * width + i];
+            cell = std::min(cell, polygon_distance(polygon, x, y));
+        }
+    }
+}
+
+DistanceField::Region DistanceField::region_around(const poly_t& polygon) const
+{
+    if (polygon.l == 0) {
+        return {0, 0, 0, 0};
+    }
+
+    float x_min = INFINITY, y_min = INFINITY, x_max = -INFINITY, y_max = -INFINITY;
+    for (auto i = 0; i < polygon.l; i++) {
+        x_min = std::min(x_min, polygon.pts[i].x);
+        y_min = std::min(y_min, polygon.pts[i].y);
+        x_max = std::max(x_max, polygon.pts[i].x);
+        y_max = std::max(y_max, polygon.pts[i].y);
+    }
+
+    auto clamp = [](float value, int max) { return std::min(max, std::max(0, int(value))); };
+    return {
+        clamp(std::floor((x_min - max_distance) / cell_size), width),
+        clamp(std::floor((y_min - max_distance) / cell_size), height),
+        clamp(std::ceil((x_max + max_distance) / cell_size), width),
+        clamp(std::ceil((y_max + max_distance) / cell_size), height),
+    };
+}
+
+void DistanceField::restore(const DistanceField& other, const Region& region)
+{
+    for (auto j = region.y1; j < region.y2; j++) {
+        std::copy(other.cells.begin() + j * width + region.x1,
+                  other.cells.begin() + j * width + region.x2,
+                  cells.begin() + j * width + region.x1);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef BASE_DISTANCE_FIELD_H
+#define BASE_DISTANCE_FIELD_H
+
+#include <vector>
+#include <aversive/math/geometry/polygon.h>
+
+/** Signed distance from the points of the table to the closest obstacle,
+ * sampled on a grid.
+ *
+ * Distances are in mm, positive outside of the obstacles and negative inside
+ * of them, so the grid is also an occupancy grid. They are clamped to
+ * max_distance, so an obstacle only changes the cells close to it.
+ *
+ * The distance of a cell is the one of its center, points of the cell can be
+ * closer to an obstacle by up to half the diagonal of a cell.
+ */
+class DistanceField {
+public:
+    /** Rectangle of cells, from (x1, y1) included to (x2, y2) excluded. */
+    struct Region {
+        int x1, y1, x2, y2;
+
+        bool empty() const
+        {
+            return x1 >= x2 || y1 >= y2;
+        }
+
+        Region merge(const Region& other) const;
+    };
+
+    /** Creates a field covering [0, width] x [0, height] without any obstacle. */
+    DistanceField(float width, float height, float cell_size, float max_distance);
+
+    /** Distance from (x, y) to the closest obstacle, in O(1). Points outside
+     * of the field are inside an obstacle. */
+    float distance(float x, float y) const
+    {
+        const int i = x / cell_size;
+        const int j = y / cell_size;
+
+        if (x < 0 || y < 0 || i >= width || j >= height) {
+            return -max_distance;
+        }
+
+        return cells[j * width + i];
+    }
+
+    bool is_occupied(float x, float y) const
+    {
+        return distance(x, y) <= 0;
+    }
+
+    /** True if every point of the segment from p1 to p2 is at least
+     * min_clearance away from the obstacles.
+     *
+     * The segment is sampled every half cell, except where it is far from the
+     * obstacles, where the distance is used to skip the parts which cannot be
+     * too close.
+     */
+    bool segment_is_clear(point_t p1, point_t p2, float min_clearance) const;
+
+    /** Makes everything outside of box an obstacle. */
+    void add_boundingbox(const bounding_box_t& box);
+
+    /** Adds an obstacle, only updating the cells in region. */
+    void add_polygon(const poly_t& polygon, const Region& region);
+    void add_polygon(const poly_t& polygon)
+    {
+        add_polygon(polygon, region_around(polygon));
+    }
+
+    /** Cells whose distance can be changed by polygon */
+    Region region_around(const poly_t& polygon) const;
+
+    /** Copies the cells of region from other, which must have the same size.
+     * This removes the obstacles added since other was copied. */
+    void restore(const DistanceField& other, const Region& region);
+
+private:
+    int width;
+    int height;
+    float cell_size;
+    float max_distance;
+    std::vector<float> cells;
+};
+
+#endif /* BASE_DISTANCE_FIELD_H */
@@ -1,31 +1,20 @@
 #include <aversive/math/geometry/discrete_circles.h>
 
 #include "robot_helpers/math_helpers.h"
-#include "base_controller.h"
 #include "map.h"
 #include "strategy/table.h"
 
 #define TABLE_POINT_X(x) math_clamp_value(x, 0, MAP_SIZE_X_MM)
 #define TABLE_POINT_Y(y) math_clamp_value(y, 0, MAP_SIZE_Y_MM)
 
-static void map_lock(mutex_t* lock)
-{
-    chMtxLock(lock);
-}
-static void map_unlock(mutex_t* lock)
-{
-    chMtxUnlock(lock);
-}
-
 void map_init(struct _map* map, int robot_size, bool enable_wall)
 {
     // Initialise obstacle avoidance state
     oa_init(&map->oa);
-    chMtxObjectInit(&map->lock);
 
     /* Define table borders */
-    polygon_set_boundingbox(robot_size / 2, robot_size / 2,
-                            MAP_SIZE_X_MM - robot_size / 2, MAP_SIZE_Y_MM - robot_size / 2);
+    oa_set_boundingbox(&map->oa, robot_size / 2, robot_size / 2,
+                       MAP_SIZE_X_MM - robot_size / 2, MAP_SIZE_Y_MM - robot_size / 2);
 
     /* Add ally obstacle at origin */
     map->ally = oa_new_poly(&map->oa, MAP_NUM_ALLY_EDGES);
@@ -53,8 +42,6 @@ void map_init(struct _map* map, int robot_size, bool enable_wall)
     /* Add ramp as obstacle */
     map->ramp_obstacle = oa_new_poly(&map->oa, 4);
     map_set_rectangular_obstacle_from_corners(map->ramp_obstacle, 450, 1578, 2550, 2000, robot_size);
-
-    map->enable_opponent = true;
 }
 
 void map_set_ally_obstacle(struct _map* map, int32_t x, int32_t y, int32_t ally_size, int32_t robot_size)
@@ -63,16 +50,12 @@ void map_set_ally_obstacle(struct _map* map, int32_t x, int32_t y, int32_t ally_
     ally.x = x;
     ally.y = y;
     ally.r = MAP_ALLY_SIZE_FACTOR * (robot_size + ally_size) / 2;
-    map_lock(&map->lock);
     discretize_circle(map->ally, ally, MAP_NUM_ALLY_EDGES, 0);
-    map_unlock(&map->lock);
 }
 
 void map_set_opponent_obstacle(struct _map* map, int index, int32_t x, int32_t y, int32_t opponent_size, int32_t robot_size)
 {
-    map_lock(&map->lock);
     map_set_rectangular_obstacle(map->opponents[index], x, y, opponent_size, opponent_size, robot_size);
-    map_unlock(&map->lock);
 }
 
 poly_t* map_get_opponent_obstacle(struct _map* map, int index)
@@ -114,7 +97,6 @@ void map_set_rectangular_obstacle_from_corners(poly_t* opponent, int bottom_left
 
 void map_update_opponent_obstacle(struct _map* map, int32_t x, int32_t y, int32_t opponent_size, int32_t robot_size)
 {
-    map_lock(&map->lock);
     map_set_rectangular_obstacle(map->opponents[map->last_opponent_index], x, y,
                                  opponent_size, opponent_size, robot_size);
 
@@ -122,5 +104,4 @@ void map_update_opponent_obstacle(struct _map* map, int32_t x, int32_t y, int32_
     if (map->last_opponent_index >= MAP_NUM_OPPONENT) {
         map->last_opponent_index = 0;
     }
-    map_unlock(&map->lock);
 }
@@ -1,14 +1,13 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <stdbool.h>
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#include <ch.h>
-
 #define MAP_SIZE_X_MM 3000
 #define MAP_SIZE_Y_MM 2000
 #define MAP_NUM_ALLY_EDGES 4
@@ -16,6 +15,11 @@ extern "C" {
 #define MAP_NUM_OPPONENT 2
 #define MAP_NUM_OPPONENT_EDGES 4
 
+/** Obstacles of the table.
+ *
+ * It is not thread safe: it must only be used by the thread owning it. Other
+ * threads read the obstacles from a MapSnapshot.
+ */
 struct _map {
     poly_t* the_wall;
     poly_t* ramp_obstacle;
@@ -26,10 +30,7 @@ struct _map {
     poly_t* opponents[MAP_NUM_OPPONENT];
     uint8_t last_opponent_index;
 
-    mutex_t lock;
     struct obstacle_avoidance oa;
-
-    bool enable_opponent;
 };
 
 /** Initialize the map of the Eurobot table with the static obstacles and
@@ -1,123 +1,148 @@
-#include <ch.h>
-#include <hal.h>
-#include <string.h>
+#include <thread>
 #include <error/error.h>
-#include <timestamp/timestamp.h>
 
 #include "config.h"
 #include "main.h"
-#include "priorities.h"
+#include "timestamp.h"
 
 #include "base/base_controller.h"
-#include "base/map.h"
 #include "base/map_server.h"
-#include "robot_helpers/beacon_helpers.h"
+#include "base/map_snapshot.h"
+#include "base/path_planner.h"
 #include "robot_helpers/trajectory_helpers.h"
-#include "strategy/state.h"
 
 #include "protobuf/beacons.pb.h"
 #include "protobuf/ally_position.pb.h"
+#include "protobuf/path.pb.h"
 
-#define MAP_SERVER_STACKSIZE 1024
+using namespace std::chrono_literals;
 
-static struct {
-    struct _map map;
-    MUTEX_DECL(map_lock);
-} map_data;
+static TOPIC_DECL(path_topic, Path);
+static TOPIC_DECL(path_goal_topic, PathGoal);
 
-static THD_FUNCTION(map_server_thd, arg)
+/** Keeps each tracked opponent in the same slot of the map, so that the
+ * planner does not see them jump when a track appears or disappears. */
+static void update_opponents(MapWriter& map, uint32_t (&slot_ids)[MAP_NUM_OPPONENT], const OpponentTracks& tracks)
 {
-    enum strat_color_t color = *(enum strat_color_t*)arg;
-    (void)color;
-    chRegSetThreadName(__FUNCTION__);
+    bool slot_used[MAP_NUM_OPPONENT] = {};
+    bool track_placed[sizeof(tracks.opponents) / sizeof(tracks.opponents[0])] = {};
 
-    int robot_size = config_get_integer("master/robot_size_x_mm");
-    int opponent_size = config_get_integer("master/opponent_size_x_mm_default");
-    bool enable_wall = config_get_boolean("master/is_main_robot");
-    map_init(&map_data.map, robot_size, enable_wall);
-
-    BeaconSignal beacon_signal;
-    messagebus_topic_t* proximity_beacon_topic = messagebus_find_topic_blocking(&bus, "/proximity_beacon");
-
-    AllyPosition ally_position;
-    messagebus_topic_t* allied_position_topic = messagebus_find_topic_blocking(&bus, "/ally_pos");
-
-    StrategyState state = initial_state();
-    messagebus_topic_t* strategy_state_topic = messagebus_find_topic_blocking(&bus, "/state");
+    for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+        for (auto j = 0; j < tracks.opponents_count; j++) {
+            if (slot_ids[i] == tracks.opponents[j].id) {
+                slot_used[i] = track_placed[j] = true;
+            }
+        }
+    }
 
-    static messagebus_watcher_t watchers[3];
+    for (auto j = 0; j < tracks.opponents_count; j++) {
+        for (auto i = 0; i < MAP_NUM_OPPONENT && !track_placed[j]; i++) {
+            if (!slot_used[i]) {
+                slot_ids[i] = tracks.opponents[j].id;
+                slot_used[i] = track_placed[j] = true;
+            }
+        }
+    }
 
-    static struct {
-        mutex_t lock;
-        condition_variable_t cv;
-        messagebus_watchgroup_t group;
-    } watchgroup;
+    for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+        if (!slot_used[i]) {
+            slot_ids[i] = 0;
+            map.opponent_lost(i);
+            continue;
+        }
 
-    chMtxObjectInit(&watchgroup.lock);
-    chCondObjectInit(&watchgroup.cv);
+        for (auto j = 0; j < tracks.opponents_count; j++) {
+            const TrackedOpponent& track = tracks.opponents[j];
+            if (track.id == slot_ids[i]) {
+                map.opponent_tracked(i, track.x, track.y, track.vx, track.vy);
+            }
+        }
+    }
+}
 
-    messagebus_watchgroup_init(&watchgroup.group, &watchgroup.lock, &watchgroup.cv);
-    messagebus_watchgroup_watch(&watchers[0], &watchgroup.group, proximity_beacon_topic);
-    messagebus_watchgroup_watch(&watchers[1], &watchgroup.group, allied_position_topic);
-    messagebus_watchgroup_watch(&watchers[2], &watchgroup.group, strategy_state_topic);
+static void map_server_thd()
+{
+    int robot_size = config_get_integer("master/robot_size_x_mm");
+    int opponent_size = config_get_integer("master/opponent_size_x_mm_default");
+    bool enable_wall = config_get_boolean("master/is_main_robot");
+    MapWriter map(robot_size, opponent_size * 1.25, enable_wall);
+    map_snapshot_publish(map.snapshot());
 
     NOTICE("Map initialized");
 
+    /* Id of the track in each opponent slot of the map */
+    uint32_t slot_ids[MAP_NUM_OPPONENT] = {};
+
     while (true) {
-        auto map = map_server_map_lock_and_get();
-        robot_size = config_get_integer("master/robot_size_x_mm");
-        opponent_size = config_get_integer("master/opponent_size_x_mm_default");
-
-        /* Create obstacle at opponent position, only consider recent beacon signal */
-        if (messagebus_topic_read(proximity_beacon_topic, &beacon_signal, sizeof(beacon_signal))) {
-            if (timestamp_duration_s(beacon_signal.timestamp.us, timestamp_get()) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION) {
-                float x_opp, y_opp;
-                beacon_cartesian_convert(&robot.pos,
-                                         1000 * beacon_signal.range.range.distance,
-                                         beacon_signal.range.angle,
-                                         &x_opp, &y_opp);
-                map_update_opponent_obstacle(map, x_opp, y_opp, opponent_size * 1.25, robot_size);
-            } else {
-                map_update_opponent_obstacle(map, 0, 0, 0, 0); // reset opponent position
-            }
+        /* Create obstacles at the tracked opponent positions, only if the
+         * tracker is still running */
+        OpponentTracks tracks;
+        messagebus_topic_t* opponents_topic = messagebus_find_topic(&bus, "/opponents");
+        if (opponents_topic && messagebus_topic_read(opponents_topic, &tracks, sizeof(tracks))
+            && absl::ToDoubleSeconds(timestamp_get() - absl::FromUnixMicros(tracks.timestamp.us)) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION) {
+            update_opponents(map, slot_ids, tracks);
+        } else {
+            map.opponents_lost();
         }
 
         /* Create obstacle at ally position */
-        if (messagebus_topic_read(allied_position_topic, &ally_position, sizeof(ally_position))) {
-            map_set_ally_obstacle(map,
-                                  ally_position.x,
-                                  ally_position.y,
-                                  robot_size,
-                                  robot_size);
+        AllyPosition ally_position;
+        messagebus_topic_t* allied_position_topic = messagebus_find_topic(&bus, "/ally_pos");
+        if (allied_position_topic && messagebus_topic_read(allied_position_topic, &ally_position, sizeof(ally_position))) {
+            map.ally_seen(ally_position.x, ally_position.y);
         } else {
-            map_set_ally_obstacle(map, 0, 0, 0, 0); // reset ally position
+            map.ally_lost();
+        }
+
+        if (map.has_changed()) {
+            map_snapshot_publish(map.snapshot());
         }
 
-        map_server_map_release(map);
-        messagebus_watchgroup_wait(&watchgroup.group);
+        std::this_thread::sleep_for(1000ms / MAP_SERVER_FREQUENCY);
     }
 }
 
-void map_server_start(enum strat_color_t color)
+static void path_planner_thd()
 {
-    static THD_WORKING_AREA(map_server_thd_wa, MAP_SERVER_STACKSIZE);
-    chThdCreateStatic(map_server_thd_wa, sizeof(map_server_thd_wa),
-                      MAP_SERVER_PRIO, map_server_thd, &color);
-}
+    PathPlanner planner;
 
-struct _map* map_server_map_lock_and_get(void)
-{
-    chMtxLock(&map_data.map_lock);
-    return &map_data.map;
-}
+    while (true) {
+        PathGoal goal;
+        if (messagebus_topic_read(&path_goal_topic.topic, &goal, sizeof(goal))) {
+            planner.set_goal(goal);
+        }
 
-void map_server_map_release(struct _map* map_ptr)
-{
-    osalDbgAssert(map_ptr == &map_data.map, "wrong map ptr");
-    chMtxUnlock(&map_data.map_lock);
+        /* Planning only reads a snapshot, so obstacles keep being updated
+         * while it runs */
+        auto map = map_snapshot_get();
+        if (map && planner.needs_replan(*map)) {
+            float x, y;
+            {
+                absl::MutexLock _(&robot.lock);
+                x = position_get_x_float(&robot.pos);
+                y = position_get_y_float(&robot.pos);
+            }
+
+            Path path = Path_init_default;
+            if (planner.plan(*map, x, y, path)) {
+                path.timestamp.us = timestamp_get_us();
+                DEBUG("Path %d to goal %d has %d points", path.version, path.goal_id, path.waypoints_count);
+                messagebus_topic_publish(&path_topic.topic, &path, sizeof(path));
+            }
+        }
+
+        std::this_thread::sleep_for(1000ms / MAP_SERVER_FREQUENCY);
+    }
 }
 
-void map_server_enable_opponent(struct _map* map_ptr, bool enable)
+void map_server_start()
 {
-    map_ptr->enable_opponent = enable;
+    messagebus_advertise_topic(&bus, &path_topic.topic, "/path");
+    messagebus_advertise_topic(&bus, &path_goal_topic.topic, "/path/goal");
+
+    std::thread map_thd(map_server_thd);
+    map_thd.detach();
+
+    std::thread planner_thd(path_planner_thd);
+    planner_thd.detach();
 }
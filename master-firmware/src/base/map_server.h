@@ -1,18 +1,23 @@
 #ifndef MAP_SERVER_H
 #define MAP_SERVER_H
 
-#include "robot_helpers/autoposition.h"
-#include "base/map.h"
-
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void map_server_start(enum strat_color_t color);
-struct _map* map_server_map_lock_and_get(void);
-void map_server_map_release(struct _map* map);
+/** Frequency at which the map server checks the obstacles and the goal (in Hz) */
+#define MAP_SERVER_FREQUENCY 20
 
-void map_server_enable_opponent(struct _map* map_ptr, bool enable);
+/** Starts the thread owning the map, and the path planner.
+ *
+ * The map thread places the opponents published by the opponent tracker and
+ * the ally, and publishes snapshots of the obstacles, see map_snapshot_get().
+ *
+ * The path planner publishes on /path a path to the goal published on
+ * /path/goal. The path is computed again every time the goal changes or the
+ * obstacles move.
+ */
+void map_server_start(void);
 
 #ifdef __cplusplus
 }
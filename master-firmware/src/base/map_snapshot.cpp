@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include "map_snapshot.h"
+
+MapSnapshot::MapSnapshot(const struct _map& map, uint32_t version, const MapRobot (&opponents_)[MAP_NUM_OPPONENT], MapRobot ally, float opponent_half_size, const DistanceField& field_)
+    : version_(version)
+    , bbox(map.oa.bbox)
+    , ally_(ally)
+    , opponent_half_size_(opponent_half_size)
+    , field(field_)
+{
+    std::copy(std::begin(opponents_), std::end(opponents_), opponents);
+
+    // The first polygon holds the start and end points, not an obstacle
+    for (auto i = 1; i < map.oa.cur_poly_idx; i++) {
+        const poly_t* poly = &map.oa.polys[i];
+        Polygon polygon;
+        polygon.points.assign(poly->pts, poly->pts + poly->l);
+        polygon.is_opponent = false;
+        polygon.present = true;
+
+        for (auto j = 0; j < MAP_NUM_OPPONENT; j++) {
+            if (poly == map.opponents[j]) {
+                polygon.is_opponent = true;
+                polygon.present = opponents[j].present;
+            }
+        }
+        if (poly == map.ally) {
+            polygon.present = ally_.present;
+        }
+
+        polygons.push_back(polygon);
+    }
+}
+
+struct oa_capacity MapSnapshot::oa_capacity(bool with_opponents) const
+{
+    int polys = 0, points = 0;
+    for (const auto& polygon : polygons) {
+        if (!polygon.present || (polygon.is_opponent && !with_opponents)) {
+            continue;
+        }
+        polys++;
+        points += polygon.points.size();
+    }
+
+    return oa_capacity_for(polys, points);
+}
+
+bool MapSnapshot::fill(struct obstacle_avoidance* oa, bool with_opponents) const
+{
+    oa_set_boundingbox(oa, bbox.x1, bbox.y1, bbox.x2, bbox.y2);
+
+    for (const auto& polygon : polygons) {
+        if (!polygon.present || (polygon.is_opponent && !with_opponents)) {
+            continue;
+        }
+
+        poly_t* poly = oa_new_poly(oa, polygon.points.size());
+        if (!poly) {
+            return false;
+        }
+        std::copy(polygon.points.begin(), polygon.points.end(), poly->pts);
+    }
+
+    return true;
+}
+
+MapWriter::MapWriter(int robot_size_, int opponent_size_, bool enable_wall)
+    : robot_size(robot_size_)
+    , opponent_size(opponent_size_)
+    , static_field(MAP_SIZE_X_MM, MAP_SIZE_Y_MM, MAP_DISTANCE_FIELD_CELL_MM, MAP_DISTANCE_FIELD_MAX_MM)
+    , field(static_field)
+    , opponents{}
+    , ally{}
+    , changed(true)
+    , version(0)
+{
+    map_init(&map, robot_size, enable_wall);
+
+    static_field.add_boundingbox(map.oa.bbox);
+    for (auto i = 1; i < map.oa.cur_poly_idx; i++) {
+        const poly_t* poly = &map.oa.polys[i];
+        if (poly != map.ally && std::find(std::begin(map.opponents), std::end(map.opponents), poly) == std::end(map.opponents)) {
+            static_field.add_polygon(*poly);
+        }
+    }
+    field = static_field;
+}
+
+void MapWriter::update_field(const DistanceField::Region& region)
+{
+    field.restore(static_field, region);
+
+    for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+        if (opponents[i].present) {
+            field.add_polygon(*map.opponents[i], region);
+        }
+    }
+    if (ally.present) {
+        field.add_polygon(*map.ally, region);
+    }
+}
+
+void MapWriter::opponent_tracked(int index, float x, float y, float vx, float vy)
+{
+    const MapRobot& old = opponents[index];
+    if (old.present && old.x == x && old.y == y && old.vx == vx && old.vy == vy) {
+        return;
+    }
+
+    poly_t* poly = map.opponents[index];
+    auto region = old.present ? field.region_around(*poly) : DistanceField::Region{0, 0, 0, 0};
+
+    opponents[index] = {true, x, y, vx, vy};
+
+    /* Cover the opponent from where it is to where it is going */
+    const float x_end = x + vx * MAP_OPPONENT_PREDICTION_S;
+    const float y_end = y + vy * MAP_OPPONENT_PREDICTION_S;
+    map_set_rectangular_obstacle_from_corners(poly,
+                                              std::min(x, x_end) - opponent_size / 2,
+                                              std::min(y, y_end) - opponent_size / 2,
+                                              std::max(x, x_end) + opponent_size / 2,
+                                              std::max(y, y_end) + opponent_size / 2,
+                                              robot_size);
+
+    update_field(region.merge(field.region_around(*poly)));
+    changed = true;
+}
+
+void MapWriter::opponent_lost(int index)
+{
+    if (!opponents[index].present) {
+        return;
+    }
+
+    auto region = field.region_around(*map.opponents[index]);
+    opponents[index].present = false;
+    map_set_opponent_obstacle(&map, index, 0, 0, 0, 0);
+    update_field(region);
+    changed = true;
+}
+
+void MapWriter::opponents_lost()
+{
+    for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+        opponent_lost(i);
+    }
+}
+
+void MapWriter::ally_seen(float x, float y)
+{
+    if (ally.present && ally.x == x && ally.y == y) {
+        return;
+    }
+
+    auto region = ally.present ? field.region_around(*map.ally) : DistanceField::Region{0, 0, 0, 0};
+
+    ally = {true, x, y, 0, 0};
+    map_set_ally_obstacle(&map, x, y, robot_size, robot_size);
+    update_field(region.merge(field.region_around(*map.ally)));
+    changed = true;
+}
+
+void MapWriter::ally_lost()
+{
+    if (!ally.present) {
+        return;
+    }
+
+    auto region = field.region_around(*map.ally);
+    ally.present = false;
+    map_set_ally_obstacle(&map, 0, 0, 0, 0);
+    update_field(region);
+    changed = true;
+}
+
+std::shared_ptr<const MapSnapshot> MapWriter::snapshot()
+{
+    if (changed) {
+        last_snapshot = std::make_shared<const MapSnapshot>(map, ++version, opponents, ally, (opponent_size + robot_size) / 2.f, field);
+        changed = false;
+    }
+
+    return last_snapshot;
+}
+
+static std::shared_ptr<const MapSnapshot> published_snapshot;
+
+void map_snapshot_publish(std::shared_ptr<const MapSnapshot> snapshot)
+{
+    std::atomic_store(&published_snapshot, std::move(snapshot));
+}
+
+std::shared_ptr<const MapSnapshot> map_snapshot_get()
+{
+    return std::atomic_load(&published_snapshot);
+}
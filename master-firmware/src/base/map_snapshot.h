@@ -0,0 +1,169 @@
+#ifndef BASE_MAP_SNAPSHOT_H
+#define BASE_MAP_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "base/map.h"
+#include "base/distance_field.h"
+
+/** Size of the cells of the distance field (in mm) */
+#define MAP_DISTANCE_FIELD_CELL_MM 20
+
+/** Distances above this are not tracked by the distance field (in mm) */
+#define MAP_DISTANCE_FIELD_MAX_MM 500
+
+/** Opponent obstacles cover the positions predicted from their speed up to
+ * this far in the future [s] */
+#define MAP_OPPONENT_PREDICTION_S 0.5f
+
+/** Position of a robot seen on the table, in mm, and its speed in mm/s */
+struct MapRobot {
+    bool present;
+    float x;
+    float y;
+    float vx;
+    float vy;
+};
+
+/** Obstacles of the map at one point in time.
+ *
+ * A snapshot is never modified once built, so any number of threads can read
+ * it at the same time without locking, and keep it as long as they need.
+ */
+class MapSnapshot {
+public:
+    MapSnapshot(const struct _map& map, uint32_t version, const MapRobot (&opponents)[MAP_NUM_OPPONENT], MapRobot ally, float opponent_half_size, const DistanceField& field);
+
+    /** Incremented every time the obstacles change */
+    uint32_t version() const
+    {
+        return version_;
+    }
+
+    const MapRobot& opponent(int index) const
+    {
+        return opponents[index];
+    }
+
+    const MapRobot& ally() const
+    {
+        return ally_;
+    }
+
+    /** Half the side of the square obstacle of a standing opponent, robot
+     * size included [mm] */
+    float opponent_half_size() const
+    {
+        return opponent_half_size_;
+    }
+
+    /** Adds the obstacles to oa, which must not have any obstacle yet.
+     * Opponents are left out if with_opponents is false.
+     *
+     * @returns false if the obstacles do not fit in oa.
+     */
+    bool fill(struct obstacle_avoidance* oa, bool with_opponents) const;
+
+    /** Capacity of an obstacle avoidance instance able to hold the obstacles
+     * added by fill(), see oa_init_with_arena(). */
+    struct oa_capacity oa_capacity(bool with_opponents) const;
+
+    /** Distance from the robot center at (x, y) to the closest obstacle,
+     * negative if the robot cannot be there. Obstacles are already grown by
+     * the robot size, so this is the free space around the robot.
+     *
+     * It is a lookup in the distance field, so it is cheap enough to be
+     * called at every control loop iteration.
+     */
+    float clearance(float x, float y) const
+    {
+        return field.distance(x, y);
+    }
+
+    /** True if the robot can go from p1 to p2 in a straight line while
+     * staying at least min_clearance away from the obstacles. */
+    bool segment_is_clear(point_t p1, point_t p2, float min_clearance = 0) const
+    {
+        return field.segment_is_clear(p1, p2, min_clearance);
+    }
+
+private:
+    struct Polygon {
+        std::vector<point_t> points;
+        bool is_opponent;
+        bool present; // Opponents and ally which were not seen are not used
+    };
+
+    uint32_t version_;
+    bounding_box_t bbox;
+    std::vector<Polygon> polygons;
+    MapRobot opponents[MAP_NUM_OPPONENT];
+    MapRobot ally_;
+    float opponent_half_size_;
+    DistanceField field;
+};
+
+/** Owns the map, and takes snapshots of it for the other threads.
+ *
+ * It must only be used by one thread.
+ */
+class MapWriter {
+public:
+    MapWriter(int robot_size, int opponent_size, bool enable_wall);
+    MapWriter(const MapWriter&) = delete;
+    MapWriter& operator=(const MapWriter&) = delete;
+
+    /** The opponent in slot index is at (x, y), moving at (vx, vy). Its
+     * obstacle covers where it will be in the next MAP_OPPONENT_PREDICTION_S. */
+    void opponent_tracked(int index, float x, float y, float vx, float vy);
+
+    /** Forgets the position of the opponent in slot index */
+    void opponent_lost(int index);
+
+    /** Forgets the position of all opponents, for example when the beacon
+     * stopped seeing them. */
+    void opponents_lost();
+
+    void ally_seen(float x, float y);
+    void ally_lost();
+
+    /** True if the obstacles changed since the last snapshot */
+    bool has_changed() const
+    {
+        return changed;
+    }
+
+    /** Snapshot of the current obstacles. It is only built again if they
+     * changed. */
+    std::shared_ptr<const MapSnapshot> snapshot();
+
+private:
+    /** Stamps the robots again in the cells of region of the distance field */
+    void update_field(const DistanceField::Region& region);
+
+    struct _map map;
+    int robot_size;
+    int opponent_size;
+
+    /** The static obstacles are rasterized once in static_field, the robots
+     * are then only stamped in field around their old and new positions. */
+    DistanceField static_field;
+    DistanceField field;
+
+    MapRobot opponents[MAP_NUM_OPPONENT];
+    MapRobot ally;
+
+    bool changed;
+    uint32_t version;
+    std::shared_ptr<const MapSnapshot> last_snapshot;
+};
+
+/** Makes snapshot the one returned by map_snapshot_get(). Threads still
+ * holding the previous one can keep using it. */
+void map_snapshot_publish(std::shared_ptr<const MapSnapshot> snapshot);
+
+/** Latest published snapshot, or nullptr if none was published yet. */
+std::shared_ptr<const MapSnapshot> map_snapshot_get();
+
+#endif /* BASE_MAP_SNAPSHOT_H */
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+#include "opponent_tracker.h"
+
+OpponentTracker::OpponentTracker(float acceleration_stddev, uint64_t max_age_us_)
+    : acceleration_variance(acceleration_stddev * acceleration_stddev)
+    , max_age_us(max_age_us_)
+    , next_id(1)
+    , tracks_{}
+{
+}
+
+void OpponentTracker::predict(OpponentTrack& track, uint64_t timestamp_us) const
+{
+    if (timestamp_us <= track.last_seen_us) {
+        return;
+    }
+
+    const float dt = (timestamp_us - track.last_seen_us) * 1e-6f;
+    auto& P = track.covariance;
+
+    track.x += track.vx * dt;
+    track.y += track.vy * dt;
+
+    // P = F P F^T, with F adding dt times the speed to the position
+    for (auto i = 0; i < 2; i++) {
+        for (auto j = 0; j < 4; j++) {
+            P[i][j] += dt * P[i + 2][j];
+        }
+    }
+    for (auto i = 0; i < 4; i++) {
+        for (auto j = 0; j < 2; j++) {
+            P[i][j] += dt * P[i][j + 2];
+        }
+    }
+
+    // Random acceleration between the two instants
+    const float q = acceleration_variance;
+    for (auto i = 0; i < 2; i++) {
+        P[i][i] += q * dt * dt * dt * dt / 4;
+        P[i][i + 2] += q * dt * dt * dt / 2;
+        P[i + 2][i] += q * dt * dt * dt / 2;
+        P[i + 2][i + 2] += q * dt * dt;
+    }
+
+    track.last_seen_us = timestamp_us;
+}
+
+void OpponentTracker::update(uint64_t timestamp_us, float x, float y, const float (&R)[2][2])
+{
+    // Associate the reading to the closest track
+    Track* closest = nullptr;
+    OpponentTrack predicted;
+    float S_inv[2][2];
+    float closest_distance = OPPONENT_TRACKER_GATE;
+
+    for (auto& track : tracks_) {
+        if (!track.active) {
+            continue;
+        }
+
+        OpponentTrack candidate = track.state;
+        predict(candidate, timestamp_us);
+
+        const auto& P = candidate.covariance;
+        const float S[2][2] = {{P[0][0] + R[0][0], P[0][1] + R[0][1]},
+                               {P[1][0] + R[1][0], P[1][1] + R[1][1]}};
+        const float det = S[0][0] * S[1][1] - S[0][1] * S[1][0];
+        if (det <= 0) {
+            continue;
+        }
+        const float inv[2][2] = {{S[1][1] / det, -S[0][1] / det},
+                                 {-S[1][0] / det, S[0][0] / det}};
+
+        const float dx = x - candidate.x, dy = y - candidate.y;
+        const float distance = dx * (inv[0][0] * dx + inv[0][1] * dy) + dy * (inv[1][0] * dx + inv[1][1] * dy);
+        if (distance < closest_distance) {
+            closest = &track;
+            closest_distance = distance;
+            predicted = candidate;
+            std::copy(&inv[0][0], &inv[0][0] + 4, &S_inv[0][0]);
+        }
+    }
+
+    if (!closest) {
+        Track& track = free_track();
+        track.active = true;
+        track.state = OpponentTrack{};
+        track.state.id = next_id++;
+        track.state.x = x;
+        track.state.y = y;
+        track.state.last_seen_us = timestamp_us;
+        track.state.hits = 1;
+
+        auto& P = track.state.covariance;
+        P[0][0] = R[0][0];
+        P[0][1] = R[0][1];
+        P[1][0] = R[1][0];
+        P[1][1] = R[1][1];
+        P[2][2] = P[3][3] = OPPONENT_TRACKER_INITIAL_SPEED_STDDEV * OPPONENT_TRACKER_INITIAL_SPEED_STDDEV;
+        return;
+    }
+
+    // Kalman update, the measurement being the first two states
+    auto& P = predicted.covariance;
+    float K[4][2];
+    for (auto i = 0; i < 4; i++) {
+        for (auto j = 0; j < 2; j++) {
+            K[i][j] = P[i][0] * S_inv[0][j] + P[i][1] * S_inv[1][j];
+        }
+    }
+
+    const float innovation[2] = {x - predicted.x, y - predicted.y};
+    float* state[4] = {&predicted.x, &predicted.y, &predicted.vx, &predicted.vy};
+    for (auto i = 0; i < 4; i++) {
+        *state[i] += K[i][0] * innovation[0] + K[i][1] * innovation[1];
+    }
+
+    float updated[4][4];
+    for (auto i = 0; i < 4; i++) {
+        for (auto j = 0; j < 4; j++) {
+            updated[i][j] = P[i][j] - K[i][0] * P[0][j] - K[i][1] * P[1][j];
+        }
+    }
+    // Keep it symmetric despite rounding errors
+    for (auto i = 0; i < 4; i++) {
+        for (auto j = 0; j < 4; j++) {
+            P[i][j] = (updated[i][j] + updated[j][i]) / 2;
+        }
+    }
+
+    predicted.hits++;
+    closest->state = predicted;
+}
+
+std::vector<OpponentTrack> OpponentTracker::tracks(uint64_t now_us)
+{
+    std::vector<OpponentTrack> result;
+
+    for (auto& track : tracks_) {
+        if (track.active && now_us > track.state.last_seen_us + max_age_us) {
+            track.active = false;
+        }
+
+        if (track.active && track.state.hits >= OPPONENT_TRACKER_CONFIRMATION_HITS) {
+            OpponentTrack predicted = track.state;
+            predict(predicted, now_us);
+            // Prediction does not count as being seen
+            predicted.last_seen_us = track.state.last_seen_us;
+            result.push_back(predicted);
+        }
+    }
+
+    return result;
+}
+
+OpponentTracker::Track& OpponentTracker::free_track()
+{
+    Track* oldest = &tracks_[0];
+
+    for (auto& track : tracks_) {
+        if (!track.active) {
+            return track;
+        }
+        if (track.state.last_seen_us < oldest->state.last_seen_us) {
+            oldest = &track;
+        }
+    }
+
+    return *oldest;
+}
+
+void OpponentTracker::range_bearing_covariance(float distance, float bearing,
+                                               float distance_stddev, float bearing_stddev,
+                                               float (&covariance)[2][2])
+{
+    // Rotate the errors along and across the bearing to the table frame
+    const float along = distance_stddev * distance_stddev;
+    const float across = distance * distance * bearing_stddev * bearing_stddev;
+    const float c = cosf(bearing), s = sinf(bearing);
+
+    covariance[0][0] = c * c * along + s * s * across;
+    covariance[0][1] = c * s * (along - across);
+    covariance[1][0] = covariance[0][1];
+    covariance[1][1] = s * s * along + c * c * across;
+}
@@ -0,0 +1,89 @@
+#ifndef BASE_OPPONENT_TRACKER_H
+#define BASE_OPPONENT_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+
+/** Maximum number of robots tracked at the same time, including the tracks of
+ * false detections which are not confirmed yet */
+#define OPPONENT_TRACKER_MAX_TRACKS 4
+
+/** Standard deviation of the opponent acceleration, which is the uncertainty
+ * added to the tracks as time passes [mm/s^2] */
+#define OPPONENT_TRACKER_ACCELERATION_STDDEV 1500.f
+
+/** Standard deviation of the speed of an opponent seen for the first time
+ * [mm/s] */
+#define OPPONENT_TRACKER_INITIAL_SPEED_STDDEV 1000.f
+
+/** Readings whose Mahalanobis distance to a track is above this are not
+ * associated to it. This is the 99.9% quantile of the chi-square
+ * distribution with 2 degrees of freedom. */
+#define OPPONENT_TRACKER_GATE 13.8f
+
+/** Number of readings needed before a track is reported */
+#define OPPONENT_TRACKER_CONFIRMATION_HITS 2
+
+/** Tracks which were not seen for this long are dropped [us] */
+#define OPPONENT_TRACKER_MAX_AGE_US 500000
+
+/** Opponent estimated by the tracker. Distances are in mm, speeds in mm/s. */
+struct OpponentTrack {
+    uint32_t id; // Stays the same as long as the opponent is tracked
+    float x, y;
+    float vx, vy;
+
+    /** Covariance of (x, y, vx, vy) */
+    float covariance[4][4];
+
+    uint64_t last_seen_us;
+    int hits;
+};
+
+/** Follows the opponents seen by the proximity beacon with a constant
+ * velocity Kalman filter per opponent.
+ *
+ * Each reading goes to the closest track in the sense of the Mahalanobis
+ * distance, or starts a new one if none is close enough. Tracks which were not
+ * seen for a while are dropped.
+ *
+ * It must only be used by one thread at a time.
+ */
+class OpponentTracker {
+public:
+    explicit OpponentTracker(float acceleration_stddev = OPPONENT_TRACKER_ACCELERATION_STDDEV,
+                             uint64_t max_age_us = OPPONENT_TRACKER_MAX_AGE_US);
+
+    /** An opponent was seen at (x, y), with the given covariance [mm^2]. */
+    void update(uint64_t timestamp_us, float x, float y, const float (&covariance)[2][2]);
+
+    /** Confirmed tracks which were seen in the last max_age_us, predicted at
+     * now_us. Older tracks are dropped. */
+    std::vector<OpponentTrack> tracks(uint64_t now_us);
+
+    /** Covariance of a position measured at distance and bearing from the
+     * robot, with the given standard deviations [mm, rad]. The error is
+     * mostly along the bearing at close range, and across it far away. */
+    static void range_bearing_covariance(float distance, float bearing,
+                                         float distance_stddev, float bearing_stddev,
+                                         float (&covariance)[2][2]);
+
+private:
+    struct Track {
+        bool active;
+        OpponentTrack state;
+    };
+
+    /** Moves the track forward to timestamp_us, increasing its uncertainty */
+    void predict(OpponentTrack& track, uint64_t timestamp_us) const;
+
+    /** Slot for a new track, replacing the oldest one if all are used */
+    Track& free_track();
+
+    float acceleration_variance;
+    uint64_t max_age_us;
+    uint32_t next_id;
+    Track tracks_[OPPONENT_TRACKER_MAX_TRACKS];
+};
+
+#endif /* BASE_OPPONENT_TRACKER_H */
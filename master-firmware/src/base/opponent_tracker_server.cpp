@@ -0,0 +1,87 @@
+#include <cmath>
+#include <thread>
+#include <error/error.h>
+
+#include "main.h"
+#include "timestamp.h"
+
+#include "base/base_controller.h"
+#include "base/opponent_tracker.h"
+#include "base/opponent_tracker_server.h"
+#include "robot_helpers/beacon_helpers.h"
+
+#include "protobuf/beacons.pb.h"
+
+using namespace std::chrono_literals;
+
+static TOPIC_DECL(opponents_topic, OpponentTracks);
+
+static void opponent_tracker_thd()
+{
+    OpponentTracker tracker;
+    uint64_t last_beacon_us = 0;
+
+    messagebus_topic_t* beacon_topic = messagebus_find_topic_blocking(&bus, "/proximity_beacon");
+
+    NOTICE("Opponent tracker initialized");
+
+    while (true) {
+        BeaconSignal beacon_signal;
+        if (messagebus_topic_read(beacon_topic, &beacon_signal, sizeof(beacon_signal))
+            && beacon_signal.timestamp.us != last_beacon_us) {
+            last_beacon_us = beacon_signal.timestamp.us;
+
+            /* The beacon range is in meters */
+            const float distance = 1000 * beacon_signal.range.range.distance;
+            float x, y, robot_x, robot_y;
+            {
+                absl::MutexLock _(&robot.lock);
+                robot_x = position_get_x_float(&robot.pos);
+                robot_y = position_get_y_float(&robot.pos);
+                beacon_cartesian_convert(&robot.pos, distance, beacon_signal.range.angle, &x, &y);
+            }
+
+            float covariance[2][2];
+            OpponentTracker::range_bearing_covariance(distance, atan2f(y - robot_y, x - robot_x),
+                                                      OPPONENT_TRACKER_RANGE_STDDEV_MM,
+                                                      OPPONENT_TRACKER_BEARING_STDDEV_RAD,
+                                                      covariance);
+            tracker.update(beacon_signal.timestamp.us, x, y, covariance);
+        }
+
+        OpponentTracks msg = OpponentTracks_init_default;
+        msg.timestamp.us = timestamp_get_us();
+
+        const int max_opponents = sizeof(msg.opponents) / sizeof(msg.opponents[0]);
+        for (const auto& track : tracker.tracks(msg.timestamp.us)) {
+            if (msg.opponents_count == max_opponents) {
+                break;
+            }
+
+            TrackedOpponent& opponent = msg.opponents[msg.opponents_count++];
+            opponent.id = track.id;
+            opponent.x = track.x;
+            opponent.y = track.y;
+            opponent.vx = track.vx;
+            opponent.vy = track.vy;
+            opponent.var_x = track.covariance[0][0];
+            opponent.var_y = track.covariance[1][1];
+            opponent.cov_xy = track.covariance[0][1];
+            opponent.var_vx = track.covariance[2][2];
+            opponent.var_vy = track.covariance[3][3];
+            opponent.cov_vx_vy = track.covariance[2][3];
+        }
+
+        messagebus_topic_publish(&opponents_topic.topic, &msg, sizeof(msg));
+
+        std::this_thread::sleep_for(1000ms / OPPONENT_TRACKER_FREQUENCY);
+    }
+}
+
+void opponent_tracker_start()
+{
+    messagebus_advertise_topic(&bus, &opponents_topic.topic, "/opponents");
+
+    std::thread tracker_thd(opponent_tracker_thd);
+    tracker_thd.detach();
+}
@@ -0,0 +1,26 @@
+#ifndef OPPONENT_TRACKER_SERVER_H
+#define OPPONENT_TRACKER_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Frequency at which tracks are published (in Hz) */
+#define OPPONENT_TRACKER_FREQUENCY 50
+
+/** Standard deviations of the proximity beacon readings */
+#define OPPONENT_TRACKER_RANGE_STDDEV_MM 100.f
+#define OPPONENT_TRACKER_BEARING_STDDEV_RAD 0.05f
+
+/** Starts the thread following the opponents seen by the proximity beacon.
+ *
+ * The opponents are published on /opponents, with their position, speed and
+ * covariances predicted at the time of publication.
+ */
+void opponent_tracker_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPPONENT_TRACKER_SERVER_H */
@@ -0,0 +1,179 @@
+#include <cmath>
+#include <error/error.h>
+#include "path_planner.h"
+
+PathPlanner::PathPlanner(float replan_threshold_mm)
+    : space_time(PATH_PLANNER_ROBOT_SPEED_MM_S, PATH_PLANNER_PREDICTION_HORIZON_S)
+    , replan_threshold(replan_threshold_mm)
+    , goal(PathGoal_init_default)
+    , goal_changed(false)
+    , goal_has_path(false)
+    , version(0)
+    , planned_opponents{}
+    , planned_ally{}
+{
+}
+
+void PathPlanner::set_goal(const PathGoal& new_goal)
+{
+    if (new_goal.id == goal.id && new_goal.active == goal.active) {
+        return;
+    }
+
+    goal = new_goal;
+    goal_changed = true;
+    goal_has_path = false;
+}
+
+bool PathPlanner::has_moved(const MapRobot& planned, const MapRobot& current, float threshold)
+{
+    if (planned.present != current.present) {
+        return true;
+    }
+
+    if (!current.present) {
+        return false;
+    }
+
+    // Obstacles cover the predicted motion, so it can change their far end
+    // while the robot itself barely moves
+    const float dvx = (current.vx - planned.vx) * MAP_OPPONENT_PREDICTION_S;
+    const float dvy = (current.vy - planned.vy) * MAP_OPPONENT_PREDICTION_S;
+    const float dx = current.x - planned.x, dy = current.y - planned.y;
+
+    return std::hypot(dx, dy) > threshold || std::hypot(dx + dvx, dy + dvy) > threshold;
+}
+
+bool PathPlanner::needs_replan(const MapSnapshot& map) const
+{
+    if (!goal.active) {
+        return false;
+    }
+
+    if (goal_changed) {
+        return true;
+    }
+
+    // Opponents do not matter when they are ignored
+    if (!goal.ignore_opponent) {
+        for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+            if (has_moved(planned_opponents[i], map.opponent(i), replan_threshold)) {
+                return true;
+            }
+        }
+    }
+
+    return has_moved(planned_ally, map.ally(), replan_threshold);
+}
+
+bool PathPlanner::plan(const MapSnapshot& map, float x, float y, Path& path)
+{
+    for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+        planned_opponents[i] = map.opponent(i);
+    }
+    planned_ally = map.ally();
+    goal_changed = false;
+
+    waypoints.clear();
+
+    // Moving opponents are avoided by planning when to cross their way. Most
+    // other goals can be reached in a straight line, which the distance
+    // field checks much faster than the obstacle avoidance. It contains the
+    // opponents, so it cannot be used when ignoring them.
+    if (!goal.ignore_opponent && plan_in_space_time(map, x, y)) {
+        DEBUG("Planned around moving opponents");
+    } else if (!goal.ignore_opponent && map.segment_is_clear({x, y}, {goal.x, goal.y}, PATH_PLANNER_STRAIGHT_LINE_MARGIN_MM)) {
+        waypoints.push_back({{goal.x, goal.y}, 1, 0, 0});
+    } else {
+        plan_around_obstacles(map, x, y);
+
+        // Space-time paths are not shortcut, as each waypoint has its timing
+        path_shortcut(map, {x, y}, waypoints, PATH_PLANNER_STRAIGHT_LINE_MARGIN_MM);
+    }
+    path_round_corners(map, {x, y}, waypoints, PATH_PLANNER_CORNER_CUT_MM);
+
+    int num_points = waypoints.size();
+
+    const int max_points = sizeof(path.waypoints) / sizeof(path.waypoints[0]);
+    if (num_points > max_points) {
+        WARNING("Path to (%.0f, %.0f) has too many points (%d)", goal.x, goal.y, num_points);
+        num_points = 0;
+    }
+
+    if (num_points == 0 && goal_has_path) {
+        NOTICE("No path to (%.0f, %.0f) anymore, keeping the previous one", goal.x, goal.y);
+        return false;
+    }
+
+    path.goal_id = goal.id;
+    path.version = ++version;
+    path.waypoints_count = num_points;
+    for (auto i = 0; i < num_points; i++) {
+        path.waypoints[i].x = waypoints[i].point.x;
+        path.waypoints[i].y = waypoints[i].point.y;
+        path.waypoints[i].speed_factor = waypoints[i].speed_factor;
+        path.waypoints[i].turn_radius = waypoints[i].turn_radius;
+    }
+    goal_has_path = num_points > 0;
+
+    return true;
+}
+
+bool PathPlanner::plan_in_space_time(const MapSnapshot& map, float x, float y)
+{
+    bool opponent_moves = false;
+    moving_opponents.clear();
+    for (auto i = 0; i < MAP_NUM_OPPONENT; i++) {
+        const MapRobot& opponent = map.opponent(i);
+        if (opponent.present) {
+            moving_opponents.push_back({opponent.x, opponent.y, opponent.vx, opponent.vy, map.opponent_half_size()});
+            opponent_moves = opponent_moves || std::hypot(opponent.vx, opponent.vy) > PATH_PLANNER_MOVING_OPPONENT_MM_S;
+        }
+    }
+
+    if (!opponent_moves) {
+        return false;
+    }
+
+    waypoints.clear();
+
+    // Opponents are checked along the way instead of being obstacles
+    init_oa(map, false, x, y);
+
+    return space_time.plan(&oa, moving_opponents, waypoints);
+}
+
+void PathPlanner::plan_around_obstacles(const MapSnapshot& map, float x, float y)
+{
+    init_oa(map, !goal.ignore_opponent, x, y);
+
+    // On failure the result of a previous search may still be there
+    const int res = oa_process(&oa);
+    if (res < 0) {
+        if (res != -2) {
+            WARNING("Obstacle avoidance failed (%d)", res);
+        }
+        return;
+    }
+
+    point_t* points;
+    const int num_points = oa_get_path(&oa, &points);
+    for (auto i = 0; i < num_points; i++) {
+        waypoints.push_back({points[i], 1, 0, 0});
+    }
+}
+
+void PathPlanner::init_oa(const MapSnapshot& map, bool with_opponents, float x, float y)
+{
+    const struct oa_capacity capacity = map.oa_capacity(with_opponents);
+    const size_t size = oa_arena_size(capacity);
+    if (oa_arena.size() < size) {
+        oa_arena.resize(size);
+    }
+
+    oa_init_with_arena(&oa, capacity, oa_arena.data(), oa_arena.size());
+    if (!map.fill(&oa, with_opponents)) {
+        WARNING("Too many obstacles in the map");
+    }
+    oa_start_end_points(&oa, x, y, goal.x, goal.y);
+}
@@ -0,0 +1,106 @@
+#ifndef BASE_PATH_PLANNER_H
+#define BASE_PATH_PLANNER_H
+
+#include <vector>
+#include "base/map_snapshot.h"
+#include "base/path_smoother.h"
+#include "base/space_time_planner.h"
+#include "protobuf/path.pb.h"
+
+/** Obstacles moving by less than this since the last path was computed do not
+ * trigger a new one [mm] */
+#define PATH_PLANNER_REPLAN_THRESHOLD_MM 50.f
+
+/** Straight paths must stay this far from the obstacles, to make up for the
+ * resolution of the distance field [mm] */
+#define PATH_PLANNER_STRAIGHT_LINE_MARGIN_MM 15.f
+
+/** Corner arcs may cut this far into the obstacles. Their corners are about
+ * (sqrt(2) - 1) * robot radius further than needed, see path_round_corners()
+ * [mm] */
+#define PATH_PLANNER_CORNER_CUT_MM 30.f
+
+/** Speed at which the robot follows the paths, used to know when it meets the
+ * moving opponents [mm/s] */
+#define PATH_PLANNER_ROBOT_SPEED_MM_S 300.f
+
+/** Opponents moving faster than this are avoided by planning in space and
+ * time [mm/s] */
+#define PATH_PLANNER_MOVING_OPPONENT_MM_S 100.f
+
+/** Opponents are assumed to stop moving after this [s] */
+#define PATH_PLANNER_PREDICTION_HORIZON_S 2.f
+
+/** Keeps a path to the current goal, avoiding the obstacles of the map.
+ *
+ * Paths are computed on snapshots of the map, and needs_replan() tells when
+ * the obstacles of a new snapshot moved enough for the path to be computed
+ * again.
+ *
+ * When an opponent moves, the path is planned in space and time, see
+ * SpaceTimePlanner, so the robot can slow down to pass behind the opponent
+ * instead of going around everywhere it could be.
+ *
+ * The waypoints the robot does not need to go through are removed, and the
+ * corners are rounded, see path_smoother.h, so the robot does not have to
+ * stop at each of them.
+ *
+ * It must only be used by one thread at a time.
+ */
+class PathPlanner {
+public:
+    explicit PathPlanner(float replan_threshold_mm = PATH_PLANNER_REPLAN_THRESHOLD_MM);
+    PathPlanner(const PathPlanner&) = delete;
+    PathPlanner& operator=(const PathPlanner&) = delete;
+
+    /** Plans towards goal from now on, or stops planning if it is not active. */
+    void set_goal(const PathGoal& goal);
+
+    /** True if there is an active goal, and it changed since the last call to
+     * plan(), or the obstacles of map moved compared to the snapshot it
+     * used. */
+    bool needs_replan(const MapSnapshot& map) const;
+
+    /** Computes a path from (x, y) to the goal.
+     *
+     * @returns true if path was filled and must be published. When the goal
+     * cannot be reached, this is only the case if no path to this goal was
+     * returned yet, and path has no waypoints. Otherwise the previous path is
+     * kept.
+     */
+    bool plan(const MapSnapshot& map, float x, float y, Path& path);
+
+private:
+    static bool has_moved(const MapRobot& planned, const MapRobot& current, float threshold);
+
+    /** Fills waypoints with a path avoiding the moving opponents at the time
+     * the robot meets them. False if no opponent moves or there is no path. */
+    bool plan_in_space_time(const MapSnapshot& map, float x, float y);
+
+    /** Fills waypoints with a path around the obstacles of map, leaving it
+     * empty if there is none or the obstacle avoidance failed. */
+    void plan_around_obstacles(const MapSnapshot& map, float x, float y);
+
+    /** Sets oa up with the obstacles of map, in an arena sized for them, and
+     * the given start and end points. */
+    void init_oa(const MapSnapshot& map, bool with_opponents, float x, float y);
+
+    struct obstacle_avoidance oa;
+    std::vector<char> oa_arena; // Only grows, to avoid allocating at each plan
+    SpaceTimePlanner space_time;
+    float replan_threshold;
+
+    std::vector<MovingObstacle> moving_opponents;
+    std::vector<TimedWaypoint> waypoints;
+
+    PathGoal goal;
+    bool goal_changed;
+    bool goal_has_path;
+    uint32_t version;
+
+    /* Obstacles as they were when the last path was computed */
+    MapRobot planned_opponents[MAP_NUM_OPPONENT];
+    MapRobot planned_ally;
+};
+
+#endif /* BASE_PATH_PLANNER_H */
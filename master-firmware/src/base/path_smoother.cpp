@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cmath>
+#include "path_smoother.h"
+
+/** Angle between the segments a -> b and b -> c, positive counterclockwise */
+static float turn_angle(point_t a, point_t b, point_t c)
+{
+    const float in_x = b.x - a.x, in_y = b.y - a.y;
+    const float out_x = c.x - b.x, out_y = c.y - b.y;
+    return std::atan2(in_x * out_y - in_y * out_x, in_x * out_x + in_y * out_y);
+}
+
+bool path_corner_arc(point_t prev, point_t corner, point_t next, float radius, CornerArc& arc)
+{
+    const float in_length = std::hypot(corner.x - prev.x, corner.y - prev.y);
+    const float out_length = std::hypot(next.x - corner.x, next.y - corner.y);
+    if (in_length == 0 || out_length == 0) {
+        return false;
+    }
+
+    const float angle = turn_angle(prev, corner, next);
+    if (std::fabs(angle) < PATH_SMOOTHER_ALIGNED_RAD) {
+        return false;
+    }
+
+    // Distance from the corner to the points where the arc is tangent
+    const float tangent = radius * std::tan(std::fabs(angle) / 2);
+    if (tangent > in_length || tangent > out_length) {
+        return false;
+    }
+
+    const float in_x = (corner.x - prev.x) / in_length, in_y = (corner.y - prev.y) / in_length;
+    const float out_x = (next.x - corner.x) / out_length, out_y = (next.y - corner.y) / out_length;
+    const float side = angle > 0 ? 1 : -1;
+
+    arc.entry = {corner.x - tangent * in_x, corner.y - tangent * in_y};
+    arc.exit = {corner.x + tangent * out_x, corner.y + tangent * out_y};
+    arc.center = {arc.entry.x - side * radius * in_y, arc.entry.y + side * radius * in_x};
+    arc.radius = radius;
+    arc.angle = angle;
+
+    return true;
+}
+
+void path_shortcut(const MapSnapshot& map, point_t start, std::vector<TimedWaypoint>& waypoints, float min_clearance)
+{
+    // Goes from every kept point to the furthest one reachable in a straight
+    // line. The paths are short enough for this to be cheap.
+    point_t from = start;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < waypoints.size();) {
+        size_t next = i;
+        for (size_t j = waypoints.size() - 1; j > i; j--) {
+            if (map.segment_is_clear(from, waypoints[j].point, min_clearance)) {
+                next = j;
+                break;
+            }
+        }
+
+        while (next + 1 < waypoints.size()
+               && std::fabs(turn_angle(from, waypoints[next].point, waypoints[next + 1].point)) < PATH_SMOOTHER_ALIGNED_RAD) {
+            next++;
+        }
+
+        waypoints[kept++] = waypoints[next];
+        from = waypoints[next].point;
+        i = next + 1;
+    }
+
+    waypoints.resize(kept);
+}
+
+/** True if no point of arc is deeper than min_clearance in the obstacles */
+static bool arc_is_clear(const MapSnapshot& map, const CornerArc& arc, float min_clearance)
+{
+    const int steps = std::ceil(std::fabs(arc.angle) * arc.radius / MAP_DISTANCE_FIELD_CELL_MM);
+    const float start = std::atan2(arc.entry.y - arc.center.y, arc.entry.x - arc.center.x);
+
+    for (auto i = 0; i <= steps; i++) {
+        const float a = start + arc.angle * i / std::max(steps, 1);
+        if (map.clearance(arc.center.x + arc.radius * std::cos(a), arc.center.y + arc.radius * std::sin(a)) < min_clearance) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void path_round_corners(const MapSnapshot& map, point_t start, std::vector<TimedWaypoint>& waypoints, float max_corner_cut)
+{
+    const int count = waypoints.size();
+
+    for (auto i = 0; i < count; i++) {
+        waypoints[i].turn_radius = 0;
+
+        // The robot stops at the goal, so there is no corner to round
+        if (i == count - 1) {
+            break;
+        }
+
+        const point_t prev = i == 0 ? start : waypoints[i - 1].point;
+        const point_t corner = waypoints[i].point;
+        const point_t next = waypoints[i + 1].point;
+
+        const float half_angle = std::fabs(turn_angle(prev, corner, next)) / 2;
+        if (half_angle < PATH_SMOOTHER_ALIGNED_RAD / 2) {
+            continue;
+        }
+
+        // Neighbouring corners share the segment between them. The arc moves
+        // away from the corner by radius * (1 / cos(half_angle) - 1).
+        float in_length = std::hypot(corner.x - prev.x, corner.y - prev.y);
+        float out_length = std::hypot(next.x - corner.x, next.y - corner.y);
+        if (i > 0) {
+            in_length /= 2;
+        }
+        if (i + 1 < count - 1) {
+            out_length /= 2;
+        }
+
+        float radius = PATH_SMOOTHER_MAX_RADIUS_MM;
+        radius = std::min(radius, std::min(in_length, out_length) / std::tan(half_angle));
+        radius = std::min(radius, max_corner_cut / (1 / std::cos(half_angle) - 1));
+
+        // The corner clearance accounts for the resolution of the distance
+        // field, as the corners are on the boundary of the obstacles
+        const float min_clearance = map.clearance(corner.x, corner.y) - max_corner_cut;
+
+        CornerArc arc;
+        while (radius >= PATH_SMOOTHER_MIN_RADIUS_MM) {
+            if (path_corner_arc(prev, corner, next, radius, arc) && arc_is_clear(map, arc, min_clearance)) {
+                waypoints[i].turn_radius = radius;
+                break;
+            }
+            radius /= 2;
+        }
+    }
+}
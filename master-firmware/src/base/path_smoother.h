@@ -0,0 +1,53 @@
+#ifndef BASE_PATH_SMOOTHER_H
+#define BASE_PATH_SMOOTHER_H
+
+#include <vector>
+#include "base/map_snapshot.h"
+#include "base/space_time_planner.h"
+
+/** Corners turning by less than this are considered straight [rad] */
+#define PATH_SMOOTHER_ALIGNED_RAD 0.02f
+
+/** Arcs tighter than this are not worth it, the robot turns in place
+ * instead [mm] */
+#define PATH_SMOOTHER_MIN_RADIUS_MM 50.f
+
+/** Wider arcs take the robot too far from the planned path [mm] */
+#define PATH_SMOOTHER_MAX_RADIUS_MM 400.f
+
+/** Arc rounding the corner between two straight segments */
+struct CornerArc {
+    point_t entry; // Where the arc leaves the incoming segment
+    point_t exit; // Where it joins the outgoing segment
+    point_t center;
+    float radius;
+    float angle; // Angle turned by, positive counterclockwise [rad]
+};
+
+/** Computes the arc of the given radius which is tangent to the segments
+ * prev -> corner and corner -> next.
+ *
+ * @returns false if the segments are aligned, or too short for the arc.
+ */
+bool path_corner_arc(point_t prev, point_t corner, point_t next, float radius, CornerArc& arc);
+
+/** Removes the waypoints the robot does not need to stop by: the ones
+ * aligned with their neighbours, and the ones it can skip by going straight
+ * from an earlier point while staying min_clearance away from the obstacles.
+ *
+ * The path starts at start. It must be driven at a single speed, as the
+ * speed factors of the removed waypoints are lost.
+ */
+void path_shortcut(const MapSnapshot& map, point_t start, std::vector<TimedWaypoint>& waypoints, float min_clearance);
+
+/** Sets the turn radius of every corner of the path starting at start, as
+ * wide as the segments around it and the obstacles allow. Corners which
+ * cannot be rounded get a radius of zero.
+ *
+ * Arcs cut into the obstacles by up to max_corner_cut. The obstacles are
+ * grown by a square around the robot, which is round, so this is fine as
+ * long as it stays below the extra margin this gives at their corners.
+ */
+void path_round_corners(const MapSnapshot& map, point_t start, std::vector<TimedWaypoint>& waypoints, float max_corner_cut);
+
+#endif /* BASE_PATH_SMOOTHER_H */
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "space_time_planner.h"
+
+SpaceTimePlanner::SpaceTimePlanner(float speed_, float horizon_)
+    : speed(speed_)
+    , horizon(horizon_)
+{
+}
+
+/** Narrows [s_min, s_max] to the values of s for which r0 + d * s is in
+ * ]-h, h[, and tells if some are left. */
+static bool enters_interval(float r0, float d, float h, float& s_min, float& s_max)
+{
+    if (d == 0) {
+        return std::fabs(r0) < h;
+    }
+
+    float s1 = (-h - r0) / d, s2 = (h - r0) / d;
+    if (s1 > s2) {
+        std::swap(s1, s2);
+    }
+
+    s_min = std::max(s_min, s1);
+    s_max = std::min(s_max, s2);
+    return s_min <= s_max;
+}
+
+bool SpaceTimePlanner::collides(point_t a, point_t b, float t0, float t1, const MovingObstacle& obstacle) const
+{
+    const float duration = t1 - t0;
+    const float robot_vx = duration > 0 ? (b.x - a.x) / duration : 0;
+    const float robot_vy = duration > 0 ? (b.y - a.y) / duration : 0;
+
+    // The obstacle moves until the horizon, then stays there, so the motion
+    // relative to the robot has two straight parts
+    const float split = std::min(std::max(horizon, t0), t1);
+    const struct {
+        float start, end;
+        float obstacle_vx, obstacle_vy;
+    } parts[] = {
+        {t0, split, obstacle.vx, obstacle.vy},
+        {split, t1, 0, 0},
+    };
+
+    for (const auto& part : parts) {
+        const float obstacle_t = std::min(part.start, horizon);
+        const float rx = a.x + robot_vx * (part.start - t0) - (obstacle.x + obstacle.vx * obstacle_t);
+        const float ry = a.y + robot_vy * (part.start - t0) - (obstacle.y + obstacle.vy * obstacle_t);
+
+        float s_min = 0, s_max = part.end - part.start;
+        if (enters_interval(rx, robot_vx - part.obstacle_vx, obstacle.half_size, s_min, s_max)
+            && enters_interval(ry, robot_vy - part.obstacle_vy, obstacle.half_size, s_min, s_max)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SpaceTimePlanner::plan(struct obstacle_avoidance* oa, const std::vector<MovingObstacle>& obstacles,
+                            std::vector<TimedWaypoint>& path)
+{
+    path.clear();
+
+    const int ray_count = oa_compute_rays(oa);
+    if (ray_count < 0) {
+        return false;
+    }
+
+    // Points are numbered by their position in the points array, the first
+    // two being the end and the start
+    const int point_count = oa->cur_pt_idx;
+    const int start = 1, end = 0;
+    auto point = [&](int poly, int index) { return int(&oa->polys[poly].pts[index] - oa->points); };
+
+    edges.resize(point_count);
+    for (auto& e : edges) {
+        e.clear();
+    }
+    for (auto i = 0; i < ray_count; i++) {
+        const int* ray = &oa->rays[4 * i];
+        const int from = point(ray[0], ray[1]), to = point(ray[2], ray[3]);
+        edges[from].push_back({to, float(oa->weight[i])});
+        edges[to].push_back({from, float(oa->weight[i])});
+    }
+
+    nodes.assign(point_count, Node{INFINITY, 1, -1, false});
+    queue.clear();
+
+    auto remaining = [&](int node) {
+        const point_t& p = oa->points[node];
+        return std::hypot(oa->points[end].x - p.x, oa->points[end].y - p.y) / speed;
+    };
+    auto push = [&](int node) {
+        queue.push_back({nodes[node].arrival + remaining(node), node});
+        std::push_heap(queue.begin(), queue.end(), std::greater<std::pair<float, int>>());
+    };
+
+    nodes[start].arrival = 0;
+    push(start);
+
+    const float speed_factors[] = SPACE_TIME_PLANNER_SPEED_FACTORS;
+
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<std::pair<float, int>>());
+        const int current = queue.back().second;
+        queue.pop_back();
+
+        if (nodes[current].done) {
+            continue;
+        }
+        nodes[current].done = true;
+
+        if (current == end) {
+            break;
+        }
+
+        const point_t a = oa->points[current];
+        const float t0 = nodes[current].arrival;
+
+        for (const auto& edge : edges[current]) {
+            if (nodes[edge.to].done) {
+                continue;
+            }
+
+            // Take the fastest speed which does not hit a moving obstacle
+            const point_t b = oa->points[edge.to];
+            for (auto factor : speed_factors) {
+                const float t1 = t0 + edge.length / (speed * factor);
+                if (t1 >= nodes[edge.to].arrival) {
+                    break;
+                }
+
+                auto hits = [&](const MovingObstacle& obstacle) { return collides(a, b, t0, t1, obstacle); };
+                if (std::none_of(obstacles.begin(), obstacles.end(), hits)) {
+                    nodes[edge.to] = {t1, factor, current, false};
+                    push(edge.to);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!nodes[end].done) {
+        return false;
+    }
+
+    for (auto node = end; node != start; node = nodes[node].parent) {
+        path.push_back({oa->points[node], nodes[node].speed_factor, nodes[node].arrival, 0.f});
+    }
+    std::reverse(path.begin(), path.end());
+
+    return true;
+}
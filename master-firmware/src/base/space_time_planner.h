@@ -0,0 +1,82 @@
+#ifndef BASE_SPACE_TIME_PLANNER_H
+#define BASE_SPACE_TIME_PLANNER_H
+
+#include <vector>
+#include <aversive/obstacle_avoidance/obstacle_avoidance.h>
+
+/** Fractions of the normal speed the robot can drive at. Driving slower is
+ * how the robot lets an opponent pass before crossing behind it. */
+#define SPACE_TIME_PLANNER_SPEED_FACTORS {1.f, 0.7f, 0.5f, 0.35f, 0.2f}
+
+/** Square obstacle moving in a straight line, in mm and mm/s. Its half size
+ * must include the robot size, as for the polygons of the map. */
+struct MovingObstacle {
+    float x, y;
+    float vx, vy;
+    float half_size;
+};
+
+struct TimedWaypoint {
+    point_t point;
+    float speed_factor; // Fraction of the normal speed to drive to this point
+    float arrival; // Time at which the robot gets there [s]
+    float turn_radius; // Radius of the arc rounding this corner, see path_round_corners() [mm]
+};
+
+/** Finds the fastest path between the start and end points of an obstacle
+ * avoidance instance, also avoiding obstacles which move.
+ *
+ * The static obstacles are avoided by following the visibility graph of the
+ * obstacle avoidance. Each edge of it is checked against the moving obstacles
+ * at the time the robot would drive along it, and driven slower if that
+ * avoids them.
+ *
+ * Only the earliest arrival at each point is kept, so a path which needs to
+ * get somewhere later than possible is only found by driving slower on the
+ * edge before.
+ *
+ * It must only be used by one thread at a time.
+ */
+class SpaceTimePlanner {
+public:
+    /**
+     * @param speed Normal speed of the robot [mm/s]
+     * @param horizon Moving obstacles are assumed to stop after this [s]
+     */
+    SpaceTimePlanner(float speed, float horizon);
+
+    /** Plans from the start to the end point of oa, which must have the
+     * static obstacles only.
+     *
+     * @returns false if there is no path. Otherwise path holds the points
+     * after the start one, the last being the end point.
+     */
+    bool plan(struct obstacle_avoidance* oa, const std::vector<MovingObstacle>& obstacles,
+              std::vector<TimedWaypoint>& path);
+
+    /** True if the robot driving from a at t0 to b at t1 hits obstacle */
+    bool collides(point_t a, point_t b, float t0, float t1, const MovingObstacle& obstacle) const;
+
+private:
+    struct Edge {
+        int to;
+        float length;
+    };
+
+    struct Node {
+        float arrival;
+        float speed_factor;
+        int parent;
+        bool done;
+    };
+
+    float speed;
+    float horizon;
+
+    /* Kept between calls to avoid allocating them every time */
+    std::vector<std::vector<Edge>> edges;
+    std::vector<Node> nodes;
+    std::vector<std::pair<float, int>> queue; // Heap of (estimated arrival at the end, node)
+};
+
+#endif /* BASE_SPACE_TIME_PLANNER_H */
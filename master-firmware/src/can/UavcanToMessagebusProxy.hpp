@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <absl/strings/string_view.h>
 #include <absl/types/optional.h>
@@ -20,6 +21,9 @@
 // It is templated over the types of the messages (both on the UAVCAN side, as
 // well as on the messagebus side), as well as some metadata required for
 // protobuf.
+// Topics are resolved once per sending node and cached by node ID, so that
+// forwarding a message does not allocate once a node has been seen. The cache
+// is emptied whenever the bus enumerator learns about new nodes.
 template <
     typename UavcanMessage,
     typename TopicMessage,
@@ -43,6 +47,11 @@ class UavcanToMessagebusProxy {
     std::unique_ptr<uavcan::Subscriber<UavcanMessage>> subscriber;
     std::unordered_map<std::string, TopicData> topic_map;
 
+    // Topics already resolved for each node, indexed by UAVCAN node ID. They
+    // are valid as long as the bus enumerator stays at the same generation.
+    std::array<messagebus_topic_t*, uavcan::NodeID::Max + 1> topic_by_node{};
+    uint32_t topic_by_node_generation = 0;
+
 public:
     // Constructor. Takes a bus enumerator that will be used to gather the
     // sender's board name from received messages, as well as the messagebus to
@@ -84,17 +93,13 @@ public:
 protected:
     void process(const UavcanMessage& msg, uint8_t src_id)
     {
-        // Finds out the name of the sender from the bus enumerator and abors
-        // if that sender is not known yet.
-        const char* board_name = bus_enumerator_get_str_id(bus_enumerator, src_id);
+        messagebus_topic_t* topic = topic_for_node(src_id);
 
-        if (!board_name) {
+        if (!topic) {
             // TODO(antoinealb): Maybe we want to log that failure
             return;
         }
 
-        messagebus_topic_t* topic = find_or_create_topic(topic_name(board_name));
-
         // Sends the message to messagebus if the user was able to translate it
         auto topic_msg_opt = translate(msg);
         if (topic_msg_opt) {
@@ -103,6 +108,39 @@ protected:
         }
     }
 
+    // Returns the topic for messages sent by the given node, or nullptr if
+    // that node is not known yet. Only the first message of each node goes
+    // through the bus enumerator and topic name lookup, afterwards the cached
+    // topic is returned.
+    messagebus_topic_t* topic_for_node(uint8_t src_id)
+    {
+        const uint32_t generation = bus_enumerator_generation(bus_enumerator);
+        if (generation != topic_by_node_generation) {
+            topic_by_node.fill(nullptr);
+            topic_by_node_generation = generation;
+        }
+
+        if (src_id < topic_by_node.size() && topic_by_node[src_id]) {
+            return topic_by_node[src_id];
+        }
+
+        // Finds out the name of the sender from the bus enumerator and abors
+        // if that sender is not known yet.
+        const char* board_name = bus_enumerator_get_str_id(bus_enumerator, src_id);
+
+        if (!board_name) {
+            return nullptr;
+        }
+
+        messagebus_topic_t* topic = find_or_create_topic(topic_name(board_name));
+
+        if (src_id < topic_by_node.size()) {
+            topic_by_node[src_id] = topic;
+        }
+
+        return topic;
+    }
+
     messagebus_topic_t* find_or_create_topic(std::string topic_name)
     {
         auto elem = topic_map.find(topic_name);
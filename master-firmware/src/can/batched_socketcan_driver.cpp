@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <error/error.h>
+#include "batched_socketcan_driver.hpp"
+
+namespace batched_socketcan {
+
+// Number of acceptance filters we accept to configure in the kernel
+static const uint16_t MaxFilters = 32;
+
+// SCM_TIMESTAMPING carries three timestamps: software, deprecated and raw
+// hardware. We only use the software one, which uses CLOCK_REALTIME.
+static const size_t TimestampControlSize = CMSG_SPACE(3 * sizeof(timespec));
+
+can_frame to_socketcan_frame(const uavcan::CanFrame& frame)
+{
+    can_frame out;
+    memset(&out, 0, sizeof(out));
+
+    if (frame.isExtended()) {
+        out.can_id = (frame.id & uavcan::CanFrame::MaskExtID) | CAN_EFF_FLAG;
+    } else {
+        out.can_id = frame.id & uavcan::CanFrame::MaskStdID;
+    }
+
+    if (frame.isRemoteTransmissionRequest()) {
+        out.can_id |= CAN_RTR_FLAG;
+    }
+
+    out.can_dlc = frame.dlc;
+    memcpy(out.data, frame.data, frame.dlc);
+
+    return out;
+}
+
+uavcan::CanFrame from_socketcan_frame(const can_frame& frame)
+{
+    uint32_t id;
+
+    if (frame.can_id & CAN_EFF_FLAG) {
+        id = (frame.can_id & CAN_EFF_MASK) | uavcan::CanFrame::FlagEFF;
+    } else {
+        id = frame.can_id & CAN_SFF_MASK;
+    }
+
+    if (frame.can_id & CAN_RTR_FLAG) {
+        id |= uavcan::CanFrame::FlagRTR;
+    }
+
+    return uavcan::CanFrame(id, frame.data, std::min<uint8_t>(frame.can_dlc, 8));
+}
+
+void timestamp_from_realtime(const timespec& ts,
+                             uavcan::MonotonicTime now_monotonic,
+                             uavcan::UtcTime now_utc,
+                             uavcan::MonotonicTime& out_monotonic,
+                             uavcan::UtcTime& out_utc)
+{
+    const uint64_t ts_usec = uint64_t(ts.tv_sec) * 1000000ULL + uint64_t(ts.tv_nsec) / 1000;
+    out_utc = uavcan::UtcTime::fromUSec(ts_usec);
+
+    // The frame was received some time ago, apply the same age to the
+    // monotonic clock. Clock adjustments could make it negative.
+    int64_t age_usec = (now_utc - out_utc).toUSec();
+    age_usec = std::max<int64_t>(0, std::min<int64_t>(age_usec, now_monotonic.toUSec()));
+
+    out_monotonic = now_monotonic - uavcan::MonotonicDuration::fromUSec(age_usec);
+}
+
+Iface::Iface(uavcan::ISystemClock& clock_, int fd_)
+    : clock(clock_)
+    , fd(fd_)
+{
+}
+
+std::unique_ptr<Iface> Iface::open(const std::string& name, uavcan::ISystemClock& clock)
+{
+    if (name.size() >= IFNAMSIZ) {
+        return nullptr;
+    }
+
+    int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    // Ask the kernel to timestamp frames on reception. If this is not
+    // supported, frames will be timestamped when read instead.
+    int ts_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags)) < 0) {
+        WARNING("%s: no kernel timestamps (%s)", name.c_str(), strerror(errno));
+    }
+
+    return std::unique_ptr<Iface>(new Iface(clock, fd));
+}
+
+Iface::~Iface()
+{
+    close(fd);
+}
+
+int16_t Iface::send(const uavcan::CanFrame& frame,
+                    uavcan::MonotonicTime tx_deadline,
+                    uavcan::CanIOFlags flags)
+{
+    if (tx_queue.full()) {
+        return 0;
+    }
+
+    auto& item = tx_queue.push();
+    item.frame = frame;
+    item.deadline = tx_deadline;
+    item.flags = flags;
+
+    return 1;
+}
+
+int16_t Iface::receive(uavcan::CanFrame& out_frame,
+                       uavcan::MonotonicTime& out_ts_monotonic,
+                       uavcan::UtcTime& out_ts_utc,
+                       uavcan::CanIOFlags& out_flags)
+{
+    if (rx_queue.empty()) {
+        return 0;
+    }
+
+    auto& item = rx_queue.front();
+    out_frame = item.frame;
+    out_ts_monotonic = item.ts_monotonic;
+    out_ts_utc = item.ts_utc;
+    out_flags = item.flags;
+    rx_queue.pop();
+
+    return 1;
+}
+
+int16_t Iface::configureFilters(const uavcan::CanFilterConfig* filter_configs,
+                                uint16_t num_configs)
+{
+    std::array<can_filter, MaxFilters> filters;
+
+    if (num_configs > MaxFilters) {
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < num_configs; i++) {
+        const auto& cfg = filter_configs[i];
+        filters[i].can_id = cfg.id & uavcan::CanFrame::MaskExtID;
+        filters[i].can_mask = cfg.mask & uavcan::CanFrame::MaskExtID;
+
+        if (cfg.id & uavcan::CanFrame::FlagEFF) {
+            filters[i].can_id |= CAN_EFF_FLAG;
+        }
+        if (cfg.id & uavcan::CanFrame::FlagRTR) {
+            filters[i].can_id |= CAN_RTR_FLAG;
+        }
+        if (cfg.mask & uavcan::CanFrame::FlagEFF) {
+            filters[i].can_mask |= CAN_EFF_FLAG;
+        }
+        if (cfg.mask & uavcan::CanFrame::FlagRTR) {
+            filters[i].can_mask |= CAN_RTR_FLAG;
+        }
+    }
+
+    // No filter means accepting everything
+    if (num_configs == 0) {
+        filters[0].can_id = 0;
+        filters[0].can_mask = 0;
+        num_configs = 1;
+    }
+
+    if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(), num_configs * sizeof(can_filter)) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+uint16_t Iface::getNumFilters() const
+{
+    return MaxFilters;
+}
+
+uint64_t Iface::getErrorCount() const
+{
+    return error_count;
+}
+
+int Iface::poll_rx()
+{
+    std::array<can_frame, BatchSize> frames;
+    std::array<iovec, BatchSize> iovecs;
+    std::array<mmsghdr, BatchSize> msgs;
+    alignas(cmsghdr) uint8_t control[BatchSize][TimestampControlSize];
+
+    int total = 0;
+
+    while (rx_queue.free_space() > 0) {
+        const unsigned count = std::min<size_t>(BatchSize, rx_queue.free_space());
+
+        for (unsigned i = 0; i < count; i++) {
+            iovecs[i].iov_base = &frames[i];
+            iovecs[i].iov_len = sizeof(can_frame);
+            memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = control[i];
+            msgs[i].msg_hdr.msg_controllen = TimestampControlSize;
+        }
+
+        int res = recvmmsg(fd, msgs.data(), count, MSG_DONTWAIT, nullptr);
+        rx_syscalls++;
+
+        if (res < 0) {
+            if (errno == EAGAIN) {
+                break;
+            }
+            error_count++;
+            return -1;
+        }
+
+        const auto now_monotonic = clock.getMonotonic();
+        const auto now_utc = clock.getUtc();
+
+        for (int i = 0; i < res; i++) {
+            if (msgs[i].msg_len < sizeof(can_frame) || frames[i].can_id & CAN_ERR_FLAG) {
+                error_count++;
+                continue;
+            }
+
+            auto& item = rx_queue.push();
+            item.frame = from_socketcan_frame(frames[i]);
+            item.flags = 0;
+            item.ts_monotonic = now_monotonic;
+            item.ts_utc = now_utc;
+
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg;
+                 cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPING) {
+                    continue;
+                }
+
+                timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                if (ts.tv_sec != 0 || ts.tv_nsec != 0) {
+                    timestamp_from_realtime(ts, now_monotonic, now_utc,
+                                            item.ts_monotonic, item.ts_utc);
+                }
+            }
+
+            if (observer) {
+                observer->frame_received(item.frame, item.ts_monotonic);
+            }
+
+            total++;
+        }
+
+        // The socket is empty
+        if (res < static_cast<int>(count)) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+int Iface::flush_tx()
+{
+    std::array<can_frame, BatchSize> frames;
+    std::array<iovec, BatchSize> iovecs;
+    std::array<mmsghdr, BatchSize> msgs;
+
+    const auto now = clock.getMonotonic();
+    int total = 0;
+
+    while (!tx_queue.empty()) {
+        // Frames which missed their deadline are dropped, as libuavcan would
+        // have done.
+        while (!tx_queue.empty() && tx_queue.front().deadline < now) {
+            tx_queue.pop();
+            tx_dropped++;
+        }
+
+        const unsigned count = std::min<size_t>(BatchSize, tx_queue.size());
+        if (count == 0) {
+            break;
+        }
+
+        for (unsigned i = 0; i < count; i++) {
+            frames[i] = to_socketcan_frame(tx_queue.at(i).frame);
+            iovecs[i].iov_base = &frames[i];
+            iovecs[i].iov_len = sizeof(can_frame);
+            memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int res = sendmmsg(fd, msgs.data(), count, MSG_DONTWAIT);
+        tx_syscalls++;
+
+        if (res < 0) {
+            if (errno == EAGAIN || errno == ENOBUFS) {
+                // The socket buffer is full, retry when it is writable
+                break;
+            }
+
+            // The interface is unusable (for example it is down). Drop the
+            // batch so that a dead interface cannot stall the redundant ones.
+            error_count++;
+            tx_dropped += count;
+            tx_queue.pop(count);
+            return -1;
+        }
+
+        // Frames sent with the loopback flag (used for time synchronization)
+        // are given back to libuavcan with their transmission time.
+        for (int i = 0; i < res; i++) {
+            const auto& item = tx_queue.at(i);
+
+            if (observer) {
+                observer->frame_sent(item.frame, now);
+            }
+
+            if ((item.flags & uavcan::CanIOFlagLoopback) && !rx_queue.full()) {
+                auto& rx = rx_queue.push();
+                rx.frame = item.frame;
+                rx.flags = uavcan::CanIOFlagLoopback;
+                rx.ts_monotonic = clock.getMonotonic();
+                rx.ts_utc = clock.getUtc();
+            }
+        }
+
+        tx_queue.pop(res);
+        total += res;
+
+        if (res < static_cast<int>(count)) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+int Driver::addIface(const std::string& name)
+{
+    if (num_ifaces >= uavcan::MaxCanIfaces) {
+        return -1;
+    }
+
+    auto iface = Iface::open(name, clock);
+    if (!iface) {
+        return -1;
+    }
+
+    iface->setFrameObserver(observer);
+    ifaces[num_ifaces] = std::move(iface);
+    return num_ifaces++;
+}
+
+void Driver::setFrameObserver(FrameObserver* obs)
+{
+    observer = obs;
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        ifaces[i]->setFrameObserver(obs);
+    }
+}
+
+Iface* Driver::getIface(uint8_t iface_index)
+{
+    if (iface_index >= num_ifaces) {
+        return nullptr;
+    }
+    return ifaces[iface_index].get();
+}
+
+uavcan::CanSelectMasks Driver::ready_masks() const
+{
+    uavcan::CanSelectMasks masks;
+
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        if (ifaces[i]->hasReadyRx()) {
+            masks.read |= 1 << i;
+        }
+        if (ifaces[i]->canAcceptTx()) {
+            masks.write |= 1 << i;
+        }
+    }
+
+    return masks;
+}
+
+static int16_t count_masks(const uavcan::CanSelectMasks& masks)
+{
+    return __builtin_popcount(masks.read) + __builtin_popcount(masks.write);
+}
+
+int16_t Driver::select(uavcan::CanSelectMasks& inout_masks,
+                       const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces],
+                       uavcan::MonotonicTime blocking_deadline)
+{
+    // Frames are accepted as long as the software queue has room, so the
+    // pending frames do not matter here.
+    (void)pending_tx;
+
+    flush();
+
+    auto ready = ready_masks();
+    if ((ready.read & inout_masks.read) || (ready.write & inout_masks.write)) {
+        inout_masks.read &= ready.read;
+        inout_masks.write &= ready.write;
+        return count_masks(inout_masks);
+    }
+
+    std::array<pollfd, uavcan::MaxCanIfaces> fds;
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        fds[i].fd = ifaces[i]->getFileDescriptor();
+        fds[i].events = POLLIN;
+        if (ifaces[i]->hasReadyTx()) {
+            fds[i].events |= POLLOUT;
+        }
+        fds[i].revents = 0;
+    }
+
+    int64_t timeout_us = (blocking_deadline - clock.getMonotonic()).toUSec();
+    timeout_us = std::max<int64_t>(0, timeout_us);
+
+    timespec timeout;
+    timeout.tv_sec = timeout_us / 1000000;
+    timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+
+    if (ppoll(fds.data(), num_ifaces, &timeout, nullptr) < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        if (fds[i].revents & POLLIN) {
+            ifaces[i]->poll_rx();
+        }
+        if (fds[i].revents & POLLOUT) {
+            ifaces[i]->flush_tx();
+        }
+    }
+
+    ready = ready_masks();
+    inout_masks.read &= ready.read;
+    inout_masks.write &= ready.write;
+    return count_masks(inout_masks);
+}
+
+void Driver::flush()
+{
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        ifaces[i]->flush_tx();
+    }
+}
+
+} // namespace batched_socketcan
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <linux/can.h>
+#include <uavcan/uavcan.hpp>
+
+// SocketCAN driver for libuavcan which moves frames in batches.
+//
+// Compared to the stock uavcan_linux driver, it reads and writes up to
+// BatchSize frames per syscall (using recvmmsg and sendmmsg) and uses the
+// kernel's receive timestamps (SO_TIMESTAMPING) as transfer timestamps, rather
+// than the time at which the frame was read from the socket.
+//
+// Several interfaces can be added for redundancy: libuavcan sends every frame
+// on all of them and deduplicates received transfers. An interface going down
+// only increases its error count, it does not prevent the others from working.
+namespace batched_socketcan {
+
+// Maximum number of frames moved by a single syscall
+const unsigned BatchSize = 32;
+
+// Size of the software queues, in frames
+const unsigned QueueSize = 256;
+
+// Conversion between libuavcan and SocketCAN frames
+can_frame to_socketcan_frame(const uavcan::CanFrame& frame);
+uavcan::CanFrame from_socketcan_frame(const can_frame& frame);
+
+// Converts a kernel CLOCK_REALTIME timestamp to libuavcan timestamps, given
+// the current time of the system clock.
+void timestamp_from_realtime(const timespec& ts,
+                             uavcan::MonotonicTime now_monotonic,
+                             uavcan::UtcTime now_utc,
+                             uavcan::MonotonicTime& out_monotonic,
+                             uavcan::UtcTime& out_utc);
+
+// Gets notified of every frame going through the driver, for example to gather
+// bus statistics. It is called from the thread spinning the node.
+class FrameObserver {
+public:
+    virtual ~FrameObserver() = default;
+    virtual void frame_received(const uavcan::CanFrame& frame, uavcan::MonotonicTime timestamp) = 0;
+    virtual void frame_sent(const uavcan::CanFrame& frame, uavcan::MonotonicTime timestamp) = 0;
+};
+
+// Fixed capacity FIFO used for the RX and TX queues
+template <typename T, size_t Size>
+class FrameQueue {
+    std::array<T, Size> items;
+    size_t head = 0;
+    size_t count = 0;
+
+public:
+    bool empty() const { return count == 0; }
+    bool full() const { return count == Size; }
+    size_t size() const { return count; }
+    size_t free_space() const { return Size - count; }
+
+    T& front() { return items[head]; }
+    T& at(size_t i) { return items[(head + i) % Size]; }
+
+    // Returns the slot at the back of the queue, to be filled by the caller
+    T& push() { return items[(head + count++) % Size]; }
+
+    void pop(size_t n = 1)
+    {
+        head = (head + n) % Size;
+        count -= n;
+    }
+};
+
+class Iface : public uavcan::ICanIface {
+    struct RxItem {
+        uavcan::CanFrame frame;
+        uavcan::MonotonicTime ts_monotonic;
+        uavcan::UtcTime ts_utc;
+        uavcan::CanIOFlags flags;
+    };
+
+    struct TxItem {
+        uavcan::CanFrame frame;
+        uavcan::MonotonicTime deadline;
+        uavcan::CanIOFlags flags;
+    };
+
+    uavcan::ISystemClock& clock;
+    int fd;
+    uint64_t error_count = 0;
+    uint64_t rx_syscalls = 0;
+    uint64_t tx_syscalls = 0;
+    uint64_t tx_dropped = 0;
+    FrameObserver* observer = nullptr;
+
+    FrameQueue<RxItem, QueueSize> rx_queue;
+    FrameQueue<TxItem, QueueSize> tx_queue;
+
+    Iface(uavcan::ISystemClock& clock, int fd);
+
+public:
+    // Opens the given SocketCAN interface, returns nullptr on failure
+    static std::unique_ptr<Iface> open(const std::string& name, uavcan::ISystemClock& clock);
+
+    ~Iface() override;
+    Iface(const Iface&) = delete;
+    Iface& operator=(const Iface&) = delete;
+
+    // Queues a frame, which will be written on the next flush.
+    int16_t send(const uavcan::CanFrame& frame,
+                 uavcan::MonotonicTime tx_deadline,
+                 uavcan::CanIOFlags flags) override;
+
+    // Pops a frame from the frames already read by poll_rx.
+    int16_t receive(uavcan::CanFrame& out_frame,
+                    uavcan::MonotonicTime& out_ts_monotonic,
+                    uavcan::UtcTime& out_ts_utc,
+                    uavcan::CanIOFlags& out_flags) override;
+
+    int16_t configureFilters(const uavcan::CanFilterConfig* filter_configs,
+                             uint16_t num_configs) override;
+    uint16_t getNumFilters() const override;
+    uint64_t getErrorCount() const override;
+
+    int getFileDescriptor() const { return fd; }
+    bool hasReadyRx() const { return !rx_queue.empty(); }
+    bool hasReadyTx() const { return !tx_queue.empty(); }
+    bool canAcceptTx() const { return !tx_queue.full(); }
+
+    size_t getTxQueueDepth() const { return tx_queue.size(); }
+
+    // Number of frames dropped because they missed their deadline or the
+    // interface failed.
+    uint64_t getTxDropCount() const { return tx_dropped; }
+
+    void setFrameObserver(FrameObserver* obs) { observer = obs; }
+
+    // Number of syscalls done so far, used for benchmarking
+    uint64_t getRxSyscallCount() const { return rx_syscalls; }
+    uint64_t getTxSyscallCount() const { return tx_syscalls; }
+
+    // Reads all frames available on the socket into the RX queue. Returns the
+    // number of frames read, or a negative value on error.
+    int poll_rx();
+
+    // Writes as many queued frames as the socket accepts. Returns the number
+    // of frames written, or a negative value on error.
+    int flush_tx();
+};
+
+class Driver : public uavcan::ICanDriver {
+    uavcan::ISystemClock& clock;
+    std::array<std::unique_ptr<Iface>, uavcan::MaxCanIfaces> ifaces;
+    uint8_t num_ifaces = 0;
+    FrameObserver* observer = nullptr;
+
+    uavcan::CanSelectMasks ready_masks() const;
+
+public:
+    explicit Driver(uavcan::ISystemClock& clock_)
+        : clock(clock_)
+    {
+    }
+
+    // Adds an interface (for example "can0"). Returns its index, or a
+    // negative value on error.
+    int addIface(const std::string& name);
+
+    // Sets an observer for the frames of all interfaces
+    void setFrameObserver(FrameObserver* obs);
+
+    Iface* getIface(uint8_t iface_index) override;
+    uint8_t getNumIfaces() const override { return num_ifaces; }
+
+    int16_t select(uavcan::CanSelectMasks& inout_masks,
+                   const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces],
+                   uavcan::MonotonicTime blocking_deadline) override;
+
+    // Writes the frames queued on all interfaces. Must be called after
+    // spinning the node, so that the last frames of a batch are not delayed
+    // until the next spin.
+    void flush();
+};
+
+} // namespace batched_socketcan
@@ -58,6 +58,7 @@ void bus_enumerator_init(bus_enumerator_t* en,
     en->buffer_len = buffer_len;
     en->nb_entries_str_to_can = 0;
     en->nb_entries_can_to_str = 0;
+    en->generation = 0;
 }
 
 void bus_enumerator_add_node(bus_enumerator_t* en, const char* str_id, void* driver)
@@ -84,6 +85,7 @@ void bus_enumerator_add_node(bus_enumerator_t* en, const char* str_id, void* dri
         en->str_to_can[imin].can_id = BUS_ENUMERATOR_CAN_ID_NOT_SET;
 
         en->nb_entries_str_to_can++;
+        en->generation++;
     }
 }
 
@@ -119,6 +121,7 @@ void bus_enumerator_update_node_info(bus_enumerator_t* en, const char* str_id, u
                sizeof(bus_enumerator_entry_t));
 
         en->nb_entries_can_to_str++;
+        en->generation++;
     }
 }
 
@@ -139,6 +142,11 @@ uint16_t bus_enumerator_discovered_nodes_count(bus_enumerator_t* en)
     return cnt;
 }
 
+uint32_t bus_enumerator_generation(const bus_enumerator_t* en)
+{
+    return en->generation;
+}
+
 uint8_t bus_enumerator_get_can_id(bus_enumerator_t* en, const char* str_id)
 {
     uint16_t index;
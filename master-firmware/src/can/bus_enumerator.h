@@ -44,6 +44,7 @@ typedef struct {
     uint16_t buffer_len;
     uint16_t nb_entries_str_to_can;
     uint16_t nb_entries_can_to_str;
+    uint32_t generation;
 } bus_enumerator_t;
 
 void bus_enumerator_init(bus_enumerator_t* en,
@@ -70,6 +71,13 @@ uint16_t bus_enumerator_total_nodes_count(bus_enumerator_t* en);
  */
 uint16_t bus_enumerator_discovered_nodes_count(bus_enumerator_t* en);
 
+/** Returns a counter incremented every time a node is added or discovered.
+ *
+ * Users caching the result of the lookups below can compare it to the value
+ * they saw when filling their cache, to know when it must be emptied.
+ */
+uint32_t bus_enumerator_generation(const bus_enumerator_t* en);
+
 uint8_t bus_enumerator_get_can_id(bus_enumerator_t* en, const char* str_id);
 void* bus_enumerator_get_driver(bus_enumerator_t* en, const char* str_id);
 void* bus_enumerator_get_driver_by_can_id(bus_enumerator_t* en, uint8_t can_id);
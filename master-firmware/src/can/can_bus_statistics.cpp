@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstring>
+#include "can_bus_statistics.hpp"
+#include "uavcan_frame_header.hpp"
+
+const uint64_t CanBusStatistics::BucketDurationUs;
+const unsigned CanBusStatistics::BucketCount;
+const unsigned CanBusStatistics::MaxDataTypes;
+const unsigned CanBusStatistics::MaxNodes;
+
+CanBusStatistics::CanBusStatistics(uint32_t bitrate_)
+    : bitrate(bitrate_)
+{
+    memset(buckets.data(), 0, sizeof(buckets));
+    memset(data_types.data(), 0, sizeof(data_types));
+    memset(nodes.data(), 0, sizeof(nodes));
+}
+
+uint32_t CanBusStatistics::frame_bits(bool extended, uint8_t dlc)
+{
+    // Fixed fields, from start of frame to interframe space
+    const uint32_t overhead = extended ? 67 : 47;
+
+    // Bits subject to stuffing go from start of frame to the end of the CRC,
+    // and a stuff bit can be inserted every 4 bits in the worst case.
+    const uint32_t stuffable = (extended ? 54 : 34) + 8 * dlc;
+
+    return overhead + 8 * dlc + (stuffable - 1) / 4;
+}
+
+void CanBusStatistics::frame_received(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, uint64_t timestamp_us)
+{
+    rx_frames++;
+    frame(id, extended, dlc, data, timestamp_us);
+}
+
+void CanBusStatistics::frame_sent(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, uint64_t timestamp_us)
+{
+    tx_frames++;
+    frame(id, extended, dlc, data, timestamp_us);
+}
+
+void CanBusStatistics::driver_state(uint32_t depth, uint32_t dropped, uint32_t error_count)
+{
+    tx_queue_depth = depth;
+    tx_queue_peak_depth = std::max(tx_queue_peak_depth, depth);
+    tx_dropped = dropped;
+    errors = error_count;
+}
+
+void CanBusStatistics::frame(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, uint64_t timestamp_us)
+{
+    const uint32_t bits = frame_bits(extended, dlc);
+
+    const uint64_t index = timestamp_us / BucketDurationUs;
+    auto& bucket = buckets[index % BucketCount];
+    if (bucket.index != index) {
+        bucket.index = index;
+        bucket.bits = 0;
+    }
+    bucket.bits += bits;
+
+    UavcanFrameHeader header;
+    if (!uavcan_decode_frame_header(id, extended, dlc, data, &header)) {
+        return;
+    }
+
+    Counters* counters[] = {find_or_add_data_type(header.data_type_id, header.service),
+                            &nodes[header.source_node]};
+    for (auto c : counters) {
+        if (!c) {
+            continue;
+        }
+        c->frames++;
+        c->bytes += dlc;
+        c->bits += bits;
+        if (header.end_of_transfer) {
+            c->transfers++;
+        }
+    }
+}
+
+CanBusStatistics::Counters* CanBusStatistics::find_or_add_data_type(uint16_t data_type_id, bool service)
+{
+    for (unsigned i = 0; i < data_type_count; i++) {
+        if (data_types[i].id == data_type_id && data_types[i].service == service) {
+            return &data_types[i].counters;
+        }
+    }
+
+    // Data types in excess are only accounted for in the bus load
+    if (data_type_count == MaxDataTypes) {
+        return nullptr;
+    }
+
+    auto& entry = data_types[data_type_count++];
+    entry.id = data_type_id;
+    entry.service = service;
+    return &entry.counters;
+}
+
+const CanBusStatistics::Counters* CanBusStatistics::data_type(uint16_t data_type_id, bool service) const
+{
+    for (unsigned i = 0; i < data_type_count; i++) {
+        if (data_types[i].id == data_type_id && data_types[i].service == service) {
+            return &data_types[i].counters;
+        }
+    }
+    return nullptr;
+}
+
+const CanBusStatistics::Counters* CanBusStatistics::node(uint8_t node_id) const
+{
+    if (node_id >= MaxNodes) {
+        return nullptr;
+    }
+    return &nodes[node_id];
+}
+
+unsigned CanBusStatistics::buckets_in(uint64_t window_us) const
+{
+    unsigned count = window_us / BucketDurationUs;
+    return std::max(1u, std::min(count, BucketCount));
+}
+
+float CanBusStatistics::bucket_load(uint32_t bits, unsigned bucket_count) const
+{
+    const float capacity = bitrate * (bucket_count * BucketDurationUs / 1e6f);
+    return 100.f * bits / capacity;
+}
+
+float CanBusStatistics::load(uint64_t now_us, uint64_t window_us) const
+{
+    const uint64_t now_index = now_us / BucketDurationUs;
+    const unsigned count = buckets_in(window_us);
+    uint32_t bits = 0;
+
+    for (const auto& bucket : buckets) {
+        if (bucket.index <= now_index && bucket.index + count > now_index) {
+            bits += bucket.bits;
+        }
+    }
+
+    return bucket_load(bits, count);
+}
+
+float CanBusStatistics::peak_load(uint64_t now_us, uint64_t window_us) const
+{
+    const uint64_t now_index = now_us / BucketDurationUs;
+    const unsigned count = buckets_in(window_us);
+    uint32_t bits = 0;
+
+    for (const auto& bucket : buckets) {
+        if (bucket.index <= now_index && bucket.index + count > now_index) {
+            bits = std::max(bits, bucket.bits);
+        }
+    }
+
+    return bucket_load(bits, 1);
+}
+
+void CanBusStatistics::report(uint64_t now_us, CanStatistics* msg)
+{
+    const float elapsed = (now_us - last_report_us) / 1e6f;
+    auto load_since_report = [&](Counters& c) {
+        float res = 0.f;
+        if (last_report_us != 0 && elapsed > 0) {
+            res = 100.f * (c.bits - c.bits_at_last_report) / (bitrate * elapsed);
+        }
+        c.bits_at_last_report = c.bits;
+        return res;
+    };
+
+    msg->load_1s = load(now_us, 1000000);
+    msg->load_10s = load(now_us, 10000000);
+    msg->peak_load = peak_load(now_us, 10000000);
+
+    msg->rx_frames = rx_frames;
+    msg->tx_frames = tx_frames;
+    msg->tx_queue_depth = tx_queue_depth;
+    msg->tx_queue_peak_depth = tx_queue_peak_depth;
+    msg->tx_dropped = tx_dropped;
+    msg->errors = errors;
+
+    const pb_size_t max_data_types = sizeof(msg->data_types) / sizeof(msg->data_types[0]);
+    msg->data_types_count = 0;
+    for (unsigned i = 0; i < data_type_count && msg->data_types_count < max_data_types; i++) {
+        auto& entry = data_types[i];
+        auto& out = msg->data_types[msg->data_types_count++];
+        out.data_type_id = entry.id;
+        out.service = entry.service;
+        out.frames = entry.counters.frames;
+        out.bytes = entry.counters.bytes;
+        out.transfers = entry.counters.transfers;
+        out.load = load_since_report(entry.counters);
+    }
+
+    const pb_size_t max_nodes = sizeof(msg->nodes) / sizeof(msg->nodes[0]);
+    msg->nodes_count = 0;
+    for (unsigned i = 0; i < MaxNodes && msg->nodes_count < max_nodes; i++) {
+        if (nodes[i].frames == 0) {
+            continue;
+        }
+        auto& out = msg->nodes[msg->nodes_count++];
+        out.node_id = i;
+        out.frames = nodes[i].frames;
+        out.bytes = nodes[i].bytes;
+        out.transfers = nodes[i].transfers;
+        out.load = load_since_report(nodes[i]);
+    }
+
+    last_report_us = now_us;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "protobuf/can_statistics.pb.h"
+
+// Accumulates statistics about the traffic on the CAN bus: frames, bytes and
+// transfers per UAVCAN data type and per source node, as well as the bus load
+// over sliding windows.
+//
+// It is fed with every frame sent or received by the CAN driver. It is not
+// thread safe, and is meant to be used from the UAVCAN thread only.
+class CanBusStatistics {
+public:
+    // The sliding windows are made of buckets of that duration
+    static const uint64_t BucketDurationUs = 100000;
+    static const unsigned BucketCount = 100;
+
+    static const unsigned MaxDataTypes = 32;
+    static const unsigned MaxNodes = 128;
+
+    struct Counters {
+        uint32_t frames;
+        uint32_t bytes;
+        uint32_t transfers;
+        uint64_t bits;
+        uint64_t bits_at_last_report;
+    };
+
+    explicit CanBusStatistics(uint32_t bitrate);
+
+    // Records a frame seen on the bus. The identifier must not contain any of
+    // the flag bits.
+    void frame_received(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, uint64_t timestamp_us);
+    void frame_sent(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, uint64_t timestamp_us);
+
+    // Records the state of the driver: depth of the transmission queue,
+    // number of frames dropped and number of errors since startup.
+    void driver_state(uint32_t tx_queue_depth, uint32_t tx_dropped, uint32_t errors);
+
+    // Bus load in percent, over the given window ending at now_us. The window
+    // is rounded to a whole number of buckets.
+    float load(uint64_t now_us, uint64_t window_us) const;
+
+    // Highest load of a single bucket in the given window, in percent
+    float peak_load(uint64_t now_us, uint64_t window_us) const;
+
+    const Counters* data_type(uint16_t data_type_id, bool service) const;
+    const Counters* node(uint8_t node_id) const;
+
+    // Fills the message with the current statistics. The per data type and
+    // per node loads are computed since the previous call.
+    void report(uint64_t now_us, CanStatistics* msg);
+
+    // Number of bits on the wire for the given frame, including worst case
+    // bit stuffing.
+    static uint32_t frame_bits(bool extended, uint8_t dlc);
+
+private:
+    struct DataTypeEntry {
+        uint16_t id;
+        bool service;
+        Counters counters;
+    };
+
+    struct Bucket {
+        uint64_t index;
+        uint32_t bits;
+    };
+
+    uint32_t bitrate;
+
+    std::array<Bucket, BucketCount> buckets;
+    std::array<DataTypeEntry, MaxDataTypes> data_types;
+    unsigned data_type_count = 0;
+    std::array<Counters, MaxNodes> nodes;
+
+    uint32_t rx_frames = 0;
+    uint32_t tx_frames = 0;
+    uint32_t tx_queue_depth = 0;
+    uint32_t tx_queue_peak_depth = 0;
+    uint32_t tx_dropped = 0;
+    uint32_t errors = 0;
+    uint64_t last_report_us = 0;
+
+    void frame(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, uint64_t timestamp_us);
+    Counters* find_or_add_data_type(uint16_t data_type_id, bool service);
+    unsigned buckets_in(uint64_t window_us) const;
+    float bucket_load(uint32_t bits, unsigned bucket_count) const;
+};
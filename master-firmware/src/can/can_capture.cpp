@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstring>
+#include "can_capture.hpp"
+#include "uavcan_frame_header.hpp"
+
+static const char capture_magic[7] = {'C', 'V', 'R', 'A', 'C', 'A', 'P'};
+static const uint8_t capture_version = 1;
+
+// A 64 bit varint takes at most 10 bytes
+static const int max_varint_len = 10;
+
+const uint32_t CaptureRecord::FlagExtended;
+const uint32_t CaptureRecord::FlagRemote;
+const uint32_t CaptureRecord::MaskExtendedId;
+const uint32_t CaptureRecord::MaskStandardId;
+
+CaptureWriter::CaptureWriter(std::ostream& out_)
+    : out(out_)
+{
+    out.write(capture_magic, sizeof(capture_magic));
+    out.put(capture_version);
+}
+
+bool CaptureWriter::write(const CaptureRecord& record)
+{
+    uint8_t buf[max_varint_len + 4 + 1 + 8];
+    size_t len = 0;
+
+    const uint64_t timestamp = std::max(record.timestamp_us, last_timestamp_us);
+    uint64_t delta = timestamp - last_timestamp_us;
+    last_timestamp_us = timestamp;
+
+    do {
+        uint8_t byte = delta & 0x7f;
+        delta >>= 7;
+        if (delta) {
+            byte |= 0x80;
+        }
+        buf[len++] = byte;
+    } while (delta);
+
+    for (int i = 0; i < 4; i++) {
+        buf[len++] = (record.id >> (8 * i)) & 0xff;
+    }
+
+    const uint8_t dlc = std::min<uint8_t>(record.dlc, 8);
+    buf[len++] = ((record.iface & 0xf) << 4) | dlc;
+
+    memcpy(&buf[len], record.data, dlc);
+    len += dlc;
+
+    out.write(reinterpret_cast<const char*>(buf), len);
+    return bool(out);
+}
+
+CaptureReader::CaptureReader(std::istream& in_)
+    : in(in_)
+{
+    char header[sizeof(capture_magic) + 1];
+    in.read(header, sizeof(header));
+
+    header_ok = in.gcount() == sizeof(header)
+        && !memcmp(header, capture_magic, sizeof(capture_magic))
+        && uint8_t(header[sizeof(capture_magic)]) == capture_version;
+}
+
+bool CaptureReader::read(CaptureRecord& record)
+{
+    if (!header_ok) {
+        return false;
+    }
+
+    uint64_t delta = 0;
+    int i;
+    for (i = 0; i < max_varint_len; i++) {
+        const int byte = in.get();
+        if (byte == EOF) {
+            return false;
+        }
+        delta |= uint64_t(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    if (i == max_varint_len) {
+        return false;
+    }
+
+    uint8_t buf[4 + 1];
+    in.read(reinterpret_cast<char*>(buf), sizeof(buf));
+    if (in.gcount() != sizeof(buf)) {
+        return false;
+    }
+
+    record.id = buf[0] | (buf[1] << 8) | (buf[2] << 16) | (uint32_t(buf[3]) << 24);
+    record.iface = buf[4] >> 4;
+    record.dlc = buf[4] & 0xf;
+
+    if (record.dlc > 8) {
+        return false;
+    }
+
+    in.read(reinterpret_cast<char*>(record.data), record.dlc);
+    if (in.gcount() != record.dlc) {
+        return false;
+    }
+
+    last_timestamp_us += delta;
+    record.timestamp_us = last_timestamp_us;
+
+    return true;
+}
+
+void CaptureNodeFilter::add(uint8_t node_id)
+{
+    if (node_id < nodes.size()) {
+        nodes.set(node_id);
+    }
+}
+
+bool CaptureNodeFilter::accepts(const CaptureRecord& record) const
+{
+    if (empty()) {
+        return true;
+    }
+
+    if (record.id & CaptureRecord::FlagRemote) {
+        return false;
+    }
+
+    UavcanFrameHeader header;
+    if (!uavcan_decode_frame_header(record.raw_id(), record.extended(), record.dlc, record.data, &header)) {
+        return false;
+    }
+
+    return nodes.test(header.source_node);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+// Compact binary format used to record the traffic of a CAN bus and replay it
+// later, for example to load test the UAVCAN handlers with real traffic.
+//
+// A capture starts with a header made of the magic string "CVRACAP" and a
+// version byte. It is followed by one record per frame:
+//
+// - the time elapsed since the previous record (or since the capture clock's
+//   epoch for the first one) in microseconds, as an unsigned LEB128 varint,
+// - the identifier and flags, as a little endian 32 bit integer using the
+//   same layout as SocketCAN,
+// - one byte containing the interface index in the high nibble and the
+//   length of the frame in the low nibble,
+// - the payload.
+//
+// At full bus load, a record for an 8 byte frame takes 15 bytes.
+
+struct CaptureRecord {
+    static const uint32_t FlagExtended = 1u << 31;
+    static const uint32_t FlagRemote = 1u << 30;
+    static const uint32_t MaskExtendedId = 0x1fffffff;
+    static const uint32_t MaskStandardId = 0x7ff;
+
+    // Timestamp of the frame, in microseconds
+    uint64_t timestamp_us;
+
+    // Identifier of the frame, combined with the flags above
+    uint32_t id;
+
+    // Index of the interface on which the frame was captured, at most 15
+    uint8_t iface;
+
+    uint8_t dlc;
+    uint8_t data[8];
+
+    bool extended() const { return id & FlagExtended; }
+
+    // Identifier without the flags
+    uint32_t raw_id() const { return id & (extended() ? MaskExtendedId : MaskStandardId); }
+};
+
+class CaptureWriter {
+    std::ostream& out;
+    uint64_t last_timestamp_us = 0;
+
+public:
+    // Writes the capture header to the stream
+    explicit CaptureWriter(std::ostream& out);
+
+    // Appends a record to the capture. Records must be written in order,
+    // timestamps going backwards are clamped to the previous one. Returns
+    // false if the stream failed.
+    bool write(const CaptureRecord& record);
+};
+
+class CaptureReader {
+    std::istream& in;
+    uint64_t last_timestamp_us = 0;
+    bool header_ok;
+
+public:
+    // Reads and checks the capture header from the stream
+    explicit CaptureReader(std::istream& in);
+
+    // True if the stream starts with a supported capture header
+    bool valid() const { return header_ok; }
+
+    // Reads the next record. Returns false at the end of the capture or if
+    // the record is truncated or malformed.
+    bool read(CaptureRecord& record);
+};
+
+// Selects the frames sent by a set of UAVCAN nodes, based on the source node
+// ID of the frames. An empty filter accepts every frame.
+class CaptureNodeFilter {
+    std::bitset<128> nodes;
+
+public:
+    void add(uint8_t node_id);
+    bool empty() const { return nodes.none(); }
+    bool accepts(const CaptureRecord& record) const;
+};
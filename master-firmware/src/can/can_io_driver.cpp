@@ -33,9 +33,17 @@ void can_io_set_pwm(const char* can_io_name, int channel, float pwm)
         return;
     }
 
-    cvra::io::ServoPWM pwm_signals;
-    pwm_signals.node_id = node_id;
-    pwm_signals.servo_pos[channel] = pwm;
-    can_io_pwm_pub->broadcast(pwm_signals);
+    /* This is called from the shell thread, so defer the publication to the
+     * UAVCAN thread. */
+    auto publish = [node_id, channel, pwm]() {
+        cvra::io::ServoPWM pwm_signals;
+        pwm_signals.node_id = node_id;
+        pwm_signals.servo_pos[channel] = pwm;
+        can_io_pwm_pub->broadcast(pwm_signals);
+    };
+
+    if (!uavcan_node_post(publish)) {
+        WARNING("UAVCAN request queue full, dropping PWM for %s", can_io_name);
+    }
 }
 }
@@ -0,0 +1,82 @@
+#include <memory>
+#include <uavcan/uavcan.hpp>
+#include <error/error.h>
+#include "can/can_bus_statistics.hpp"
+#include "can/can_statistics_handler.h"
+#include "main.h"
+#include "protobuf/can_statistics.pb.h"
+#include "timestamp.h"
+
+static TOPIC_DECL(can_statistics_topic, CanStatistics);
+
+class StatisticsObserver : public batched_socketcan::FrameObserver {
+    batched_socketcan::Driver& driver;
+
+public:
+    CanBusStatistics stats;
+
+    StatisticsObserver(batched_socketcan::Driver& driver_, uint32_t bitrate)
+        : driver(driver_)
+        , stats(bitrate)
+    {
+    }
+
+    void frame_received(const uavcan::CanFrame& frame, uavcan::MonotonicTime timestamp) override
+    {
+        stats.frame_received(frame.id & uavcan::CanFrame::MaskExtID, frame.isExtended(),
+                             frame.dlc, frame.data, timestamp.toUSec());
+    }
+
+    void frame_sent(const uavcan::CanFrame& frame, uavcan::MonotonicTime timestamp) override
+    {
+        stats.frame_sent(frame.id & uavcan::CanFrame::MaskExtID, frame.isExtended(),
+                         frame.dlc, frame.data, timestamp.toUSec());
+        update_driver_state();
+    }
+
+    /** Samples the state of the driver, summed over all interfaces. */
+    void update_driver_state()
+    {
+        uint32_t depth = 0, dropped = 0, errors = 0;
+        for (uint8_t i = 0; i < driver.getNumIfaces(); i++) {
+            auto* iface = driver.getIface(i);
+            depth += iface->getTxQueueDepth();
+            dropped += iface->getTxDropCount();
+            errors += iface->getErrorCount();
+        }
+        stats.driver_state(depth, dropped, errors);
+    }
+};
+
+static std::unique_ptr<StatisticsObserver> observer;
+static std::unique_ptr<uavcan::Timer> report_timer;
+
+int can_statistics_start(uavcan::INode& node, batched_socketcan::Driver& driver, uint32_t bitrate)
+{
+    /* Redundant interfaces carry the same traffic, so only the frames of the
+     * first one are counted. Otherwise the load would be counted once per
+     * interface. */
+    auto* first_iface = driver.getIface(0);
+    if (!first_iface) {
+        return -1;
+    }
+
+    observer = std::make_unique<StatisticsObserver>(driver, bitrate);
+    first_iface->setFrameObserver(observer.get());
+
+    messagebus_advertise_topic(&bus, &can_statistics_topic.topic, "/can/statistics");
+
+    report_timer = std::make_unique<uavcan::Timer>(node);
+    report_timer->setCallback([&node](const uavcan::TimerEvent& /*unused*/) {
+        static CanStatistics msg;
+
+        observer->update_driver_state();
+        observer->stats.report(node.getMonotonicTime().toUSec(), &msg);
+        msg.timestamp.us = timestamp_get_us();
+
+        messagebus_topic_publish(&can_statistics_topic.topic, &msg, sizeof(msg));
+    });
+
+    report_timer->startPeriodic(uavcan::MonotonicDuration::fromMSec(1000));
+    return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <uavcan/uavcan.hpp>
+#include "can/batched_socketcan_driver.hpp"
+
+/** Gathers statistics on the frames going through the first interface of the
+ * driver, and publishes them every second on the /can/statistics topic. The
+ * state of the driver (queue depth, drops and errors) is summed over all the
+ * interfaces. */
+int can_statistics_start(uavcan::INode& node, batched_socketcan::Driver& driver, uint32_t bitrate);
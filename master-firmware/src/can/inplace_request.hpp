@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Function object stored inline, used to post requests to the UAVCAN thread
+// without allocating memory.
+// Only small, trivially copyable functions fit, for example lambdas capturing
+// a few values by copy. This is checked at compile time.
+// A default constructed request, such as the free cells of a queue, is empty
+// and does nothing when called.
+template <size_t Size>
+class InplaceRequest {
+    alignas(std::max_align_t) unsigned char storage[Size] = {};
+    void (*invoke)(void*) = nullptr;
+
+public:
+    InplaceRequest() = default;
+
+    template <typename F>
+    InplaceRequest(F f)
+    {
+        static_assert(sizeof(F) <= Size, "Request does not fit, capture less or increase the size");
+        static_assert(alignof(F) <= alignof(std::max_align_t), "Request is over aligned");
+        static_assert(std::is_trivially_copyable<F>::value, "Request must be trivially copyable");
+
+        new (storage) F(f);
+        invoke = [](void* p) { (*static_cast<F*>(p))(); };
+    }
+
+    explicit operator bool() const
+    {
+        return invoke != nullptr;
+    }
+
+    void operator()()
+    {
+        if (invoke) {
+            invoke(storage);
+        }
+    }
+};
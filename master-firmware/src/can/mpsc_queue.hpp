@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Bounded queue with many producers and a single consumer, without locks.
+// It is used to hand work over from application threads to the UAVCAN thread:
+// producers never block and the UAVCAN thread never waits on a mutex held by
+// a lower priority thread.
+// This is the bounded queue described by Dmitry Vyukov, where each cell
+// carries a sequence number telling whether it is free or holds data.
+template <typename T, size_t Size>
+class MpscQueue {
+    static_assert(Size >= 2 && (Size & (Size - 1)) == 0, "Size must be a power of two");
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::array<Cell, Size> cells;
+
+    std::atomic<size_t> enqueue_pos{0};
+    size_t dequeue_pos{0};
+
+public:
+    MpscQueue()
+    {
+        for (size_t i = 0; i < Size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Adds an element to the queue. Can be called from any thread.
+    // Returns false if the queue is full.
+    bool push(T value)
+    {
+        Cell* cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+        while (true) {
+            cell = &cells[pos & (Size - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                // The cell is free, try to reserve it
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The cell still holds data from the previous lap
+                return false;
+            } else {
+                // Another producer took this cell, try the next one
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Takes the oldest element out of the queue. Must only be called from the
+    // consumer thread. Returns false if the queue is empty.
+    bool pop(T& value)
+    {
+        Cell* cell = &cells[dequeue_pos & (Size - 1)];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(dequeue_pos + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(dequeue_pos + Size, std::memory_order_release);
+        dequeue_pos++;
+        return true;
+    }
+};
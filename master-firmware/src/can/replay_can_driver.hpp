@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <uavcan/uavcan.hpp>
+#include "can_capture.hpp"
+
+// CAN driver for libuavcan which feeds a recorded capture into an in-process
+// node instead of talking to a real bus. It exposes a single interface, and
+// frames sent by the node are counted then discarded.
+//
+// Frames are delivered at the pace at which they were recorded, divided by the
+// speed factor. A speed factor of zero delivers them as fast as the node can
+// process them, which is used to measure the CPU cost of the handlers.
+class ReplayCanDriver : public uavcan::ICanDriver, public uavcan::ICanIface {
+    uavcan::ISystemClock& clock;
+    std::vector<CaptureRecord> records;
+    float speed;
+
+    size_t next = 0;
+    uint64_t frames_sent = 0;
+    uavcan::MonotonicTime start;
+
+    // Time at which the given record must be delivered
+    uavcan::MonotonicTime due_time(const CaptureRecord& record) const;
+    bool next_is_due() const;
+
+public:
+    ReplayCanDriver(uavcan::ISystemClock& clock, std::vector<CaptureRecord> records, float speed);
+
+    // Starts the replay over, from the first record
+    void restart();
+
+    // True once every record has been delivered
+    bool done() const { return next == records.size(); }
+
+    size_t getFramesReplayed() const { return next; }
+    uint64_t getFramesSent() const { return frames_sent; }
+
+    int16_t send(const uavcan::CanFrame& frame,
+                 uavcan::MonotonicTime tx_deadline,
+                 uavcan::CanIOFlags flags) override;
+
+    int16_t receive(uavcan::CanFrame& out_frame,
+                    uavcan::MonotonicTime& out_ts_monotonic,
+                    uavcan::UtcTime& out_ts_utc,
+                    uavcan::CanIOFlags& out_flags) override;
+
+    int16_t configureFilters(const uavcan::CanFilterConfig* filter_configs,
+                             uint16_t num_configs) override;
+    uint16_t getNumFilters() const override { return 0; }
+    uint64_t getErrorCount() const override { return 0; }
+
+    uavcan::ICanIface* getIface(uint8_t iface_index) override;
+    uint8_t getNumIfaces() const override { return 1; }
+
+    // Waits until the next record is due or the deadline expires. Once the
+    // capture is exhausted, it only waits for the deadline.
+    int16_t select(uavcan::CanSelectMasks& inout_masks,
+                   const uavcan::CanFrame* (&pending_tx)[uavcan::MaxCanIfaces],
+                   uavcan::MonotonicTime blocking_deadline) override;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+// Fields of a UAVCAN v0 frame, as encoded in its 29 bit identifier and in its
+// tail byte. This only looks at a single frame, it does not reassemble
+// multi-frame transfers.
+struct UavcanFrameHeader {
+    uint8_t priority;
+    bool service;
+    uint16_t data_type_id;
+    uint8_t source_node;
+
+    // Only meaningful for service frames
+    uint8_t destination_node;
+    bool request;
+
+    bool start_of_transfer;
+    bool end_of_transfer;
+    bool toggle;
+    uint8_t transfer_id;
+};
+
+// Decodes the header of a frame. The identifier must not contain any of the
+// flag bits. Returns false if the frame cannot be a UAVCAN frame: UAVCAN only
+// uses extended frames, and every frame carries a tail byte.
+inline bool uavcan_decode_frame_header(uint32_t id, bool extended, uint8_t dlc, const uint8_t* data, UavcanFrameHeader* header)
+{
+    if (!extended || dlc == 0) {
+        return false;
+    }
+
+    header->priority = (id >> 24) & 0x1f;
+    header->service = id & (1 << 7);
+    header->source_node = id & 0x7f;
+
+    if (header->service) {
+        header->data_type_id = (id >> 16) & 0xff;
+        header->request = id & (1 << 15);
+        header->destination_node = (id >> 8) & 0x7f;
+    } else {
+        header->data_type_id = (id >> 8) & 0xffff;
+        header->request = false;
+        header->destination_node = 0;
+    }
+
+    const uint8_t tail = data[dlc - 1];
+    header->start_of_transfer = tail & (1 << 7);
+    header->end_of_transfer = tail & (1 << 6);
+    header->toggle = tail & (1 << 5);
+    header->transfer_id = tail & 0x1f;
+
+    return true;
+}
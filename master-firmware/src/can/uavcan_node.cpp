@@ -1,6 +1,12 @@
 #include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_split.h>
+#include <algorithm>
+#include <array>
 #include <string>
 #include <thread>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <uavcan_linux/uavcan_linux.hpp>
 #include <uavcan/protocol/node_info_retriever.hpp>
 #include "emergency_stop_handler.hpp"
@@ -16,16 +22,23 @@
 #include <can/uavcan_node.h>
 #include "control_panel.h"
 #include "time_sync_server.h"
+#include "can_statistics_handler.h"
+#include "mpsc_queue.hpp"
+#include "batched_socketcan_driver.hpp"
 
 #include <error/error.h>
 
-#define UAVCAN_SPIN_FREQ 500 // [Hz]
+/* Upper bound on the time the node sleeps while waiting for an event. It only
+ * matters if no timer is scheduled, as the node otherwise wakes up for the
+ * earliest timer. */
+#define UAVCAN_MAX_WAIT_MS 1000
 
 #define UAVCAN_NODE_STACK_SIZE 8192
 
 #define UAVCAN_MEMORY_POOL_SIZE 65536
 #define UAVCAN_RX_QUEUE_SIZE 256
 #define UAVCAN_CAN_BITRATE 1000000UL
+#define UAVCAN_TX_REQUEST_QUEUE_SIZE 64
 
 #define CVRA_STATUS_CODE_NO_POWER (1 << 2)
 
@@ -35,6 +48,11 @@ static absl::flat_hash_map<uint8_t, uavcan::protocol::NodeStatus> node_health_st
 
 namespace uavcan_node {
 
+/* Requests posted by application threads, executed by the UAVCAN thread. The
+ * eventfd is signaled after each post to wake the UAVCAN thread up. */
+static MpscQueue<UavcanNodeRequest, UAVCAN_TX_REQUEST_QUEUE_SIZE> tx_requests;
+static int tx_wakeup_fd = -1;
+
 static void node_status_cb(const uavcan::ReceivedDataStructure<uavcan::protocol::NodeStatus>& msg);
 
 /** This class is used by libuavcan to connect node information to our bus
@@ -69,24 +87,98 @@ uavcan::ISystemClock& getSystemClock()
     return clock;
 }
 
-uavcan::ICanDriver& getCanDriver(std::string iface)
+/** Returns the CAN driver, opening the given interfaces on the first call.
+ *
+ * Several interfaces can be given separated by commas (e.g. "can0,can1"), in
+ * which case they are used redundantly. */
+batched_socketcan::Driver& getCanDriver(std::string ifaces)
 {
-    static uavcan_linux::SocketCanDriver driver(dynamic_cast<const uavcan_linux::SystemClock&>(getSystemClock()));
+    static batched_socketcan::Driver driver(getSystemClock());
     if (driver.getNumIfaces() == 0) // Will be executed once
     {
-        if (driver.addIface(iface) < 0) {
-            ERROR("Failed to add iface '%s'", iface.c_str());
+        for (const auto& iface : absl::StrSplit(ifaces, ',', absl::SkipEmpty())) {
+            if (driver.addIface(std::string(iface)) < 0) {
+                WARNING("Failed to add iface '%s'", std::string(iface).c_str());
+            }
+        }
+
+        if (driver.getNumIfaces() == 0) {
+            ERROR("No usable CAN interface in '%s'", ifaces.c_str());
         }
     }
     return driver;
 }
 
+/** Blocks until a frame is received, a pending frame can be sent, a request
+ * was posted by another thread, or the deadline is reached.
+ *
+ * This replaces spinning the node in fixed slices: incoming frames are
+ * dispatched as soon as they arrive and the thread sleeps otherwise. */
+static void wait_for_event(batched_socketcan::Driver& driver, uavcan::MonotonicTime deadline)
+{
+    std::array<pollfd, uavcan::MaxCanIfaces + 1> fds;
+    nfds_t fd_count = 0;
+    bool rx_pending = false;
+
+    for (uint8_t i = 0; i < driver.getNumIfaces(); i++) {
+        auto* iface = driver.getIface(i);
+        rx_pending |= iface->hasReadyRx();
+        fds[fd_count].fd = iface->getFileDescriptor();
+        fds[fd_count].events = POLLIN;
+        if (iface->hasReadyTx()) {
+            fds[fd_count].events |= POLLOUT;
+        }
+        fds[fd_count].revents = 0;
+        fd_count++;
+    }
+
+    fds[fd_count].fd = tx_wakeup_fd;
+    fds[fd_count].events = POLLIN;
+    fds[fd_count].revents = 0;
+    fd_count++;
+
+    const auto now = getSystemClock().getMonotonic();
+    int64_t timeout_us = 0;
+
+    /* Frames might already have been read from the socket while sending, in
+     * which case they must be dispatched without waiting. */
+    if (!rx_pending && deadline > now) {
+        timeout_us = std::min<int64_t>((deadline - now).toUSec(), UAVCAN_MAX_WAIT_MS * 1000);
+    }
+
+    timespec timeout;
+    timeout.tv_sec = timeout_us / 1000000;
+    timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+
+    if (ppoll(fds.data(), fd_count, &timeout, nullptr) < 0) {
+        WARNING("UAVCAN poll failed");
+        return;
+    }
+
+    /* Clears the wakeup counter, posted requests are then run by the caller. */
+    if (fds[fd_count - 1].revents & POLLIN) {
+        uint64_t count;
+        if (read(tx_wakeup_fd, &count, sizeof(count)) < 0) {
+            WARNING("UAVCAN wakeup read failed");
+        }
+    }
+}
+
+/** Runs all the requests posted by application threads. */
+static void run_tx_requests()
+{
+    UavcanNodeRequest request;
+    while (tx_requests.pop(request)) {
+        request();
+    }
+}
+
 static void main(std::string can_iface, uint8_t id)
 {
     int res;
 
-    uavcan::Node<UAVCAN_MEMORY_POOL_SIZE> node(getCanDriver(can_iface),
-                                               getSystemClock());
+    auto& driver = getCanDriver(can_iface);
+    uavcan::Node<UAVCAN_MEMORY_POOL_SIZE> node(driver, getSystemClock());
 
     node.setNodeID(uavcan::NodeID(id));
     node.setName("cvra.master");
@@ -151,6 +243,10 @@ static void main(std::string can_iface, uint8_t id)
         ERROR("time_sync_server_start");
     }
 
+    if (can_statistics_start(node, driver, UAVCAN_CAN_BITRATE) < 0) {
+        ERROR("CAN statistics");
+    }
+
     res = emergency_stop_init(node);
     if (res != 0) {
         ERROR("Emergency stop handler");
@@ -174,19 +270,34 @@ static void main(std::string can_iface, uint8_t id)
     node.getNodeStatusProvider().setHealthOk();
 
     while (true) {
-        res = node.spin(uavcan::MonotonicDuration::fromMSec(1000 / UAVCAN_SPIN_FREQ));
+        /* Sleeps until there is something to do, or until the earliest timer
+         * (setpoints, time sync, node status) is due. */
+        wait_for_event(driver, node.getScheduler().getDeadlineScheduler().getEarliestDeadline());
+
+        /* Runs the requests first so that their frames are sent by spinOnce
+         * right away. */
+        run_tx_requests();
+
+        res = node.spinOnce();
         if (res < 0) {
             WARNING("UAVCAN spin warning %d", res);
         }
 
-        // Set the "power failure" LED to true if any node reports an issue
-        // with power.
-        control_panel_clear(LED_POWER);
-        for (const auto& elem : node_health_statuses) {
-            if (elem.second.health != uavcan::protocol::NodeStatus::HEALTH_OK
-                && elem.second.vendor_specific_status_code & CVRA_STATUS_CODE_NO_POWER) {
-                control_panel_set(LED_POWER);
-            }
+        /* Sends the frames produced during this spin in as few syscalls as
+         * possible. */
+        driver.flush();
+    }
+}
+
+/* Set the "power failure" LED to true if any node reports an issue with
+ * power. */
+static void update_power_led()
+{
+    control_panel_clear(LED_POWER);
+    for (const auto& elem : node_health_statuses) {
+        if (elem.second.health != uavcan::protocol::NodeStatus::HEALTH_OK
+            && elem.second.vendor_specific_status_code & CVRA_STATUS_CODE_NO_POWER) {
+            control_panel_set(LED_POWER);
         }
     }
 }
@@ -195,12 +306,32 @@ static void node_status_cb(const uavcan::ReceivedDataStructure<uavcan::protocol:
 {
     node_health_statuses[msg.getSrcNodeID().get()] = msg;
     DEBUG("UAVCAN node %u health", msg.getSrcNodeID().get());
+    update_power_led();
 }
 
 } // namespace uavcan_node
 
+bool uavcan_node_post(UavcanNodeRequest request)
+{
+    if (!uavcan_node::tx_requests.push(std::move(request))) {
+        return false;
+    }
+
+    uint64_t one = 1;
+    if (write(uavcan_node::tx_wakeup_fd, &one, sizeof(one)) < 0) {
+        WARNING("UAVCAN wakeup write failed");
+    }
+
+    return true;
+}
+
 void uavcan_node_start(std::string can_iface, uint8_t id)
 {
+    uavcan_node::tx_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (uavcan_node::tx_wakeup_fd < 0) {
+        ERROR("Could not create UAVCAN wakeup eventfd");
+    }
+
     std::thread uavcan_thread(uavcan_node::main, can_iface, id);
     uavcan_thread.detach();
 }
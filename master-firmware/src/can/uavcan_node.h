@@ -3,9 +3,24 @@
 
 #ifdef __cplusplus
 #include <string>
+#include "inplace_request.hpp"
 
 void uavcan_node_start(std::string can_iface, uint8_t id);
 
+/** Request posted to the UAVCAN thread, able to hold a function capturing up
+ * to 32 bytes. */
+using UavcanNodeRequest = InplaceRequest<32>;
+
+/** Runs the given function from the UAVCAN thread.
+ *
+ * libuavcan is not thread safe, so other threads must use this to publish
+ * messages. The request is handed over through a lock-free queue and the
+ * UAVCAN thread is woken up immediately.
+ *
+ * Returns false if the request queue is full.
+ */
+bool uavcan_node_post(UavcanNodeRequest request);
+
 extern "C" {
 #endif
 
@@ -23,6 +23,7 @@
 #include "can/motor_manager.h"
 #include <error/error.h>
 #include "base/base_controller.h"
+#include "base/opponent_tracker_server.h"
 #include "robot_helpers/trajectory_helpers.h"
 #include "strategy.h"
 #include "gui.h"
@@ -42,7 +43,7 @@ motor_manager_t motor_manager;
 messagebus_t bus;
 static MESSAGEBUS_POSIX_SYNC_DECL(bus_sync);
 
-ABSL_FLAG(std::string, can_iface, "vcan0", "SocketCAN interface to use. If empty, disable UAVCAN.");
+ABSL_FLAG(std::string, can_iface, "vcan0", "SocketCAN interface to use. Several comma-separated interfaces are used redundantly. If empty, disable UAVCAN.");
 ABSL_FLAG(bool, verbose, false, "Enable verbose output");
 ABSL_FLAG(bool, enable_gui, true, "Enable on-robot GUI");
 ABSL_FLAG(bool, lock_memory, false, "Prevent the memory owned by the process from being paged out to disk. Required for realtime operations. Requires raising the MLOCK limit on Linux.");
@@ -165,6 +166,7 @@ int main(int argc, char** argv)
     base_controller_start();
     position_manager_start();
     trajectory_manager_start();
+    opponent_tracker_start();
 
     // Prevent memory from being paged out to disk.
     // See https://linux.die.net/man/2/mlockall
@@ -1,7 +1,6 @@
-// TODO: Define this once map is converted to Linux, then delete all USE_MAP
-// ifdefs
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
-#define USE_MAP 0
 #include <absl/time/time.h>
 #include <absl/synchronization/mutex.h>
 #include <absl/types/optional.h>
@@ -12,18 +11,20 @@
 #include <aversive/trajectory_manager/trajectory_manager_utils.h>
 #include <aversive/trajectory_manager/trajectory_manager_core.h>
 
-#if USE_MAP
 #include "base/map.h"
-#endif
+#include "base/map_server.h"
+#include "base/map_snapshot.h"
+#include "base/path_smoother.h"
 
 #include "math_helpers.h"
-#include "beacon_helpers.h"
 
 #include "protobuf/beacons.pb.h"
 #include "protobuf/ally_position.pb.h"
+#include "protobuf/path.pb.h"
 
 #include "trajectory_helpers.h"
 #include "main.h"
+#include "timestamp.h"
 
 using namespace std::chrono_literals;
 
@@ -35,6 +36,7 @@ static const std::unordered_map<int, std::string> trajectory_reasons = {
     {TRAJ_END_OPPONENT_NEAR, "opponent nearby"},
     {TRAJ_END_TIMER, "end of game timer"},
     {TRAJ_END_ALLY_NEAR, "ally nearby"},
+    {TRAJ_END_NO_PATH, "no path to goal"},
 };
 
 int trajectory_wait_for_end(int watched_end_reasons)
@@ -83,28 +85,32 @@ int trajectory_has_ended(int watched_end_reasons)
         }
     }
 
-#if USE_MAP
     if (watched_end_reasons & TRAJ_END_OPPONENT_NEAR) {
-        BeaconSignal beacon_signal;
-        messagebus_topic_t* proximity_beacon_topic = messagebus_find_topic_blocking(&bus, "/proximity_beacon");
-
-        // only consider recent beacon signal
-        if (messagebus_topic_read(proximity_beacon_topic, &beacon_signal, sizeof(beacon_signal)) && timestamp_duration_s(beacon_signal.timestamp.us, timestamp_get()) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION && beacon_signal.range.range.distance < TRAJ_MIN_DISTANCE_TO_OPPONENT) {
-            float x_opp, y_opp;
-            beacon_cartesian_convert(&robot.pos,
-                                     1000 * beacon_signal.range.range.distance,
-                                     beacon_signal.range.angle,
-                                     &x_opp,
-                                     &y_opp);
-
-            if (trajectory_is_on_collision_path(&robot, x_opp, y_opp)) {
-                return TRAJ_END_OPPONENT_NEAR;
+        OpponentTracks tracks;
+        messagebus_topic_t* opponents_topic = messagebus_find_topic(&bus, "/opponents");
+
+        // only consider recent tracks
+        if (opponents_topic && messagebus_topic_read(opponents_topic, &tracks, sizeof(tracks)) && absl::ToDoubleSeconds(timestamp_get() - absl::FromUnixMicros(tracks.timestamp.us)) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION) {
+            const float x = position_get_x_float(&robot.pos);
+            const float y = position_get_y_float(&robot.pos);
+
+            for (auto i = 0; i < tracks.opponents_count; i++) {
+                const TrackedOpponent& opponent = tracks.opponents[i];
+                if (hypotf(opponent.x - x, opponent.y - y) > 1000 * TRAJ_MIN_DISTANCE_TO_OPPONENT) {
+                    continue;
+                }
+
+                // An opponent moving out of the way does not stop the robot
+                const float x_next = opponent.x + opponent.vx * TRAJ_OPPONENT_PREDICTION_S;
+                const float y_next = opponent.y + opponent.vy * TRAJ_OPPONENT_PREDICTION_S;
+                if (trajectory_is_on_collision_path(&robot, opponent.x, opponent.y)
+                    && trajectory_is_on_collision_path(&robot, x_next, y_next)) {
+                    return TRAJ_END_OPPONENT_NEAR;
+                }
             }
         }
     }
-#endif
 
-#if USE_MAP
     if (watched_end_reasons & TRAJ_END_ALLY_NEAR) {
         messagebus_topic_t* topic = messagebus_find_topic(&bus, "/ally_pos");
         AllyPosition pos;
@@ -115,7 +121,6 @@ int trajectory_has_ended(int watched_end_reasons)
             }
         }
     }
-#endif
 
     if (watched_end_reasons & TRAJ_END_TIMER && trajectory_game_has_ended()) {
         trajectory_hardstop(&robot.traj);
@@ -152,6 +157,151 @@ void trajectory_move_to(int32_t x_mm, int32_t y_mm, int32_t a_deg)
     trajectory_wait_for_end(TRAJ_END_GOAL_REACHED);
 }
 
+int trajectory_goto_avoid(int32_t x_mm, int32_t y_mm, int watched_end_reasons)
+{
+    static uint32_t last_goal_id = 0;
+
+    messagebus_topic_t* goal_topic = messagebus_find_topic_blocking(&bus, "/path/goal");
+    messagebus_topic_t* path_topic = messagebus_find_topic_blocking(&bus, "/path");
+
+    PathGoal goal = PathGoal_init_default;
+    goal.id = ++last_goal_id;
+    goal.active = true;
+    goal.x = x_mm;
+    goal.y = y_mm;
+    goal.ignore_opponent = !(watched_end_reasons & TRAJ_END_OPPONENT_NEAR);
+    messagebus_topic_publish(goal_topic, &goal, sizeof(goal));
+
+    /* Wait for the map server to find a path to our goal. Nothing is
+     * published if there is none, so only wait for a few planner periods. */
+    Path path;
+    const auto path_deadline = std::chrono::steady_clock::now() + TRAJ_PATH_WAIT_PERIODS * 1000ms / MAP_SERVER_FREQUENCY;
+    while (!messagebus_topic_read(path_topic, &path, sizeof(path)) || path.goal_id != goal.id) {
+        if (std::chrono::steady_clock::now() > path_deadline) {
+            WARNING("No path to (%d, %d) found in time", x_mm, y_mm);
+            goal.active = false;
+            messagebus_topic_publish(goal_topic, &goal, sizeof(goal));
+            return TRAJ_END_NO_PATH;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+
+    int end_reason = TRAJ_END_NO_PATH;
+
+    /* The whole path is handed to the trajectory manager. Rounded corners
+     * are sampled in points turning a little at a time, and the resulting
+     * curve is tracked. A path without any rounded corner is a polyline, so
+     * the robot goes from one waypoint to the next, only slowing down at
+     * the corners. */
+    point_t points[TRAJECTORY_MAX_WAYPOINTS];
+    float speed_factors[TRAJECTORY_MAX_WAYPOINTS];
+    int count = 0;
+
+    auto follow_path = [&]() {
+        point_t prev;
+        {
+            absl::MutexLock _(&robot.lock);
+            prev = {position_get_x_float(&robot.pos), position_get_y_float(&robot.pos)};
+        }
+
+        count = 0;
+        bool rounded = false;
+        for (auto i = 0; i < path.waypoints_count; i++) {
+            const Waypoint& waypoint = path.waypoints[i];
+            const point_t corner = {waypoint.x, waypoint.y};
+            const int points_left = TRAJECTORY_MAX_WAYPOINTS - count - (path.waypoints_count - i);
+
+            CornerArc arc;
+            if (waypoint.turn_radius > 0 && i < path.waypoints_count - 1
+                && path_corner_arc(prev, corner, {path.waypoints[i + 1].x, path.waypoints[i + 1].y}, waypoint.turn_radius, arc)
+                && std::fabs(arc.angle) / TRAJ_ARC_STEP_RAD < points_left) {
+                const int steps = std::ceil(std::fabs(arc.angle) / TRAJ_ARC_STEP_RAD);
+                rounded = true;
+                const float start = atan2f(arc.entry.y - arc.center.y, arc.entry.x - arc.center.x);
+                for (auto j = 0; j <= steps; j++) {
+                    const float a = start + arc.angle * j / steps;
+                    points[count] = {arc.center.x + arc.radius * cosf(a), arc.center.y + arc.radius * sinf(a)};
+                    speed_factors[count++] = waypoint.speed_factor;
+                }
+            } else if (count < TRAJECTORY_MAX_WAYPOINTS) {
+                points[count] = corner;
+                speed_factors[count++] = waypoint.speed_factor;
+            }
+
+            prev = corner;
+        }
+
+        DEBUG("Following path of %d waypoints with %d points", path.waypoints_count, count);
+        if (rounded) {
+            trajectory_follow_path_abs(&robot.traj, points, speed_factors, nullptr, count);
+        } else {
+            trajectory_goto_waypoints_abs(&robot.traj, points, speed_factors, count);
+        }
+        std::this_thread::sleep_for(100ms);
+    };
+
+    if (path.waypoints_count > 0) {
+        follow_path();
+
+        while (true) {
+            end_reason = trajectory_has_ended(watched_end_reasons);
+            if (end_reason != 0) {
+                break;
+            }
+
+            /* The planner takes a moment to go around obstacles which just
+             * appeared, do not drive into them meanwhile */
+            float x, y;
+            {
+                absl::MutexLock _(&robot.lock);
+                x = position_get_x_float(&robot.pos);
+                y = position_get_y_float(&robot.pos);
+            }
+            const int i = std::max(trajectory_get_waypoint_index(&robot.traj), 0);
+            if (!goal.ignore_opponent && trajectory_obstacle_ahead(x, y, points[i].x, points[i].y)) {
+                WARNING("Stopping because of an obstacle ahead");
+                trajectory_hardstop(&robot.traj);
+                end_reason = TRAJ_END_OPPONENT_NEAR;
+                break;
+            }
+
+            /* Switch to the new path as soon as the obstacles moved. It
+             * starts from where the robot was when it was computed. */
+            Path new_path;
+            if (messagebus_topic_read(path_topic, &new_path, sizeof(new_path))
+                && new_path.goal_id == goal.id && new_path.version != path.version) {
+                DEBUG("Following new path with %d points", new_path.waypoints_count);
+                path = new_path;
+                follow_path();
+                continue;
+            }
+
+            std::this_thread::sleep_for(1ms);
+        }
+    } else {
+        WARNING("No path to (%d, %d)", x_mm, y_mm);
+    }
+
+    goal.active = false;
+    messagebus_topic_publish(goal_topic, &goal, sizeof(goal));
+
+    return end_reason;
+}
+
+bool trajectory_obstacle_ahead(float x, float y, float target_x, float target_y)
+{
+    auto map = map_snapshot_get();
+    if (!map || map->clearance(x, y) <= 0) {
+        return false;
+    }
+
+    const float distance = hypotf(target_x - x, target_y - y);
+    const float ratio = distance > TRAJ_OBSTACLE_LOOKAHEAD_MM ? TRAJ_OBSTACLE_LOOKAHEAD_MM / distance : 1.f;
+    point_t ahead = {x + ratio * (target_x - x), y + ratio * (target_y - y)};
+
+    return !map->segment_is_clear({x, y}, ahead);
+}
+
 static bool trajectory_is_cartesian(struct trajectory* traj) EXCLUSIVE_LOCKS_REQUIRED(traj->lock_)
 {
     switch (traj->state) {
@@ -184,6 +334,8 @@ bool trajectory_crosses_obstacle(struct _robot* arobot, poly_t* opponent, point_
     if (trajectory_is_cartesian(&arobot->traj)) {
         target_position.x = arobot->traj.target.cart.x;
         target_position.y = arobot->traj.target.cart.y;
+    } else if (arobot->traj.state == RUNNING_PATH) {
+        target_position = arobot->traj.target.path.points[arobot->traj.target.path.current];
     } else {
         vect2_pol delta_pol;
         delta_pol.r = arobot->traj.target.pol.distance - (float)rs_get_distance(&arobot->rs);
@@ -206,7 +358,6 @@ bool trajectory_crosses_obstacle(struct _robot* arobot, poly_t* opponent, point_
     return path_crosses_obstacle == 1 || current_pos_inside_obstacle;
 }
 
-#if USE_MAP
 bool trajectory_is_on_collision_path(struct _robot* robot, int x, int y)
 {
     point_t points[4];
@@ -221,7 +372,6 @@ bool trajectory_is_on_collision_path(struct _robot* robot, int x, int y)
     point_t intersection;
     return trajectory_crosses_obstacle(robot, &opponent, &intersection);
 }
-#endif
 
 void trajectory_set_mode_aligning(
     enum board_mode_t* robot_mode,
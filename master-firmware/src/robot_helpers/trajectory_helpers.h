@@ -15,10 +15,14 @@ extern "C" {
 /** Duration of a game in seconds. */
 #define GAME_DURATION 100
 
-#define TRAJ_MIN_DISTANCE_TO_OPPONENT 1.1f // minimum distance to opponent to stop, should be in meters, measurement is not linear though
+#define TRAJ_MIN_DISTANCE_TO_OPPONENT 1.1f // minimum distance to opponent to stop, in meters
 #define TRAJ_MIN_DIRECTION_TO_OPPONENT 0.5f // defines cone in which to consider opponents (cone is double the angle in size)
 #define TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION 0.5f // if delay bigger than this, beacon signal is discarded
 #define TRAJ_MAX_TIME_DELAY_ALLY_DETECTION 1.0f // if delay bigger that this, ally position is discarded
+#define TRAJ_OBSTACLE_LOOKAHEAD_MM 200.f // how far ahead of the robot obstacles of the map stop it
+#define TRAJ_ARC_STEP_RAD 0.17f // rounded corners are sampled in points turning by this much
+#define TRAJ_PATH_WAIT_PERIODS 5 // path planner periods to wait for a path before giving up
+#define TRAJ_OPPONENT_PREDICTION_S 0.5f // opponents only stop the robot if they are still in the way this long after
 
 #define TRAJ_END_GOAL_REACHED (1 << 0)
 #define TRAJ_END_COLLISION (1 << 1)
@@ -26,6 +30,7 @@ extern "C" {
 #define TRAJ_END_TIMER (1 << 3)
 #define TRAJ_END_ALLY_NEAR (1 << 4)
 #define TRAJ_END_NEAR_GOAL (1 << 5)
+#define TRAJ_END_NO_PATH (1 << 6) // Only returned by trajectory_goto_avoid()
 
 #define TRAJ_FLAGS_ALL (TRAJ_END_GOAL_REACHED | TRAJ_END_COLLISION | TRAJ_END_OPPONENT_NEAR | TRAJ_END_TIMER | TRAJ_END_ALLY_NEAR)
 #define TRAJ_FLAGS_ALL_IGNORE_OPPONENT (TRAJ_END_GOAL_REACHED | TRAJ_END_COLLISION | TRAJ_END_TIMER | TRAJ_END_ALLY_NEAR)
@@ -60,6 +65,31 @@ void trajectory_align_with_wall(void);
  */
 void trajectory_move_to(int32_t x_mm, int32_t y_mm, int32_t a_deg);
 
+/** Go to (x, y) on the table, following the path computed by the map server
+ * around the obstacles. The robot switches to a new path as soon as one is
+ * computed, for example when the opponent moved. It drives the smoothed path
+ * without stopping, except to turn in place at sharp corners, see
+ * trajectory_follow_path_abs(). Paths without rounded corners are driven
+ * with trajectory_goto_waypoints_abs() instead.
+ * @note This is a blocking call, see trajectory_wait_for_end()
+ *
+ * @param watched_end_reasons bitmask of the end reasons to watch for. The
+ *      opponent is only avoided if TRAJ_END_OPPONENT_NEAR is in it.
+ * @return The end reason of the trajectory, or TRAJ_END_NO_PATH if the goal
+ *      cannot be reached.
+ */
+int trajectory_goto_avoid(int32_t x_mm, int32_t y_mm, int watched_end_reasons);
+
+/** Check if an obstacle of the latest map snapshot is less than
+ * TRAJ_OBSTACLE_LOOKAHEAD_MM ahead of the robot at (x, y) going to the target.
+ * It is always false if the robot is already inside an obstacle, as it must be
+ * able to get out.
+ *
+ * It is a few lookups in the map distance field, so it can be checked at every
+ * iteration of the control loop.
+ */
+bool trajectory_obstacle_ahead(float x, float y, float target_x, float target_y);
+
 /** Check if current trajectory segment crosses the passed obstacle
  */
 bool trajectory_crosses_obstacle(struct _robot* robot, poly_t* opponent, point_t* intersection);
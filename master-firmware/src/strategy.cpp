@@ -1,6 +1,3 @@
-// TODO: Enable this once map is ported
-#define USE_MAP 0
-
 #include <array>
 #include <thread>
 
@@ -10,17 +7,15 @@
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
 #include <aversive/trajectory_manager/trajectory_manager_utils.h>
 #include <error/error.h>
-#include <goap/goap.hpp>
+#include <goap/anytime_planner.hpp>
+#include <goap/plan_tracker.hpp>
+#include <goap/planning_service.hpp>
 
 #include "robot_helpers/math_helpers.h"
 #include "robot_helpers/trajectory_helpers.h"
 #include "robot_helpers/autoposition.h"
 #include "base/base_controller.h"
-
-#if USE_MAP
-#include "base/map.h"
 #include "base/map_server.h"
-#endif
 
 #include "config.h"
 #include "control_panel.h"
@@ -30,6 +25,7 @@
 #include "strategy/color.h"
 #include "strategy/actions.h"
 #include "strategy/goals.h"
+#include "strategy/score.h"
 #include "strategy/state.h"
 
 ABSL_FLAG(bool, strat_autoposition, false, "Automatically calibrate the robot's position on the table. Not intended for simulation.");
@@ -40,7 +36,7 @@ using namespace std::chrono_literals;
 // TODO(antoinealb): Move GOAP defines to something shared with unit tests
 const int MAX_GOAP_PATH_LEN = 10;
 
-static goap::Planner<StrategyState, GOAP_SPACE_SIZE> planner;
+static goap::AnytimePlanner<StrategyState> planner(GOAP_INITIAL_WEIGHT, GOAP_WEIGHT_STEP, GOAP_NODE_BUDGET);
 
 static enum strat_color_t wait_for_color_selection();
 static void wait_for_autoposition_signal();
@@ -134,8 +130,6 @@ void strategy_order_play_game(StrategyState& state, enum strat_color_t color)
 
     goap::Action<StrategyState>* path[MAX_GOAP_PATH_LEN] = {nullptr};
 
-    std::array<goap::Goal<StrategyState>*, 2> goals = {&lighthouse_enabled, &windsocks_raised};
-
     /* Autoposition robot */
     if (absl::GetFlag(FLAGS_strat_autoposition)) {
         wait_for_autoposition_signal();
@@ -168,29 +162,84 @@ void strategy_order_play_game(StrategyState& state, enum strat_color_t color)
     std::transform(actions.begin(), actions.end(), std::back_inserter(action_ptrs),
                    [](actions::NamedAction<StrategyState>* p) { return p; });
 
-    // Always find a non complete goal, find actions to fulfill it, then apply
-    // those actions.
+    // Actions cost the time they take, estimated from the current speed and
+    // acceleration limits.
+    TravelTimeEstimator travel_time(motion_limits_from_trajectory(&robot.traj));
+    actions::set_travel_time_estimator(&travel_time);
+
+    auto update_robot_position = [&]() {
+        state.robot.x_mm = MIRROR_X(color, position_get_x_s16(&robot.pos));
+        state.robot.y_mm = position_get_y_s16(&robot.pos);
+    };
+
+    // All goals are planned at once, and ranked by the points they bring
+    // for the time they take.
+    goap::PlanningService<StrategyState> goal_planner(action_ptrs.data(), action_ptrs.size(), MAX_GOAP_PATH_LEN,
+                                                      GOAP_PLANNING_THREADS, GOAP_INITIAL_WEIGHT,
+                                                      GOAP_WEIGHT_STEP, GOAP_NODE_BUDGET);
+    goal_planner.add_goal(lighthouse_enabled, LIGHTHOUSE_ON_POINTS);
+    goal_planner.add_goal(windsocks_raised, BOTH_WINDSOCKS_UP_POINTS);
+
+    // The plan of the current goal is kept between actions, and only planned
+    // again when the world did not evolve as predicted.
+    goap::PlanTracker<StrategyState> plan;
+
+    // Always find the best non complete goal, find actions to fulfill it,
+    // then apply those actions one at a time, checking the plan after each
+    // of them.
     while (!trajectory_game_has_ended()) {
-        for (auto* goal : goals) {
-            int len = planner.plan(state, *goal,
-                                   action_ptrs.data(),
-                                   action_ptrs.size(), path, MAX_GOAP_PATH_LEN);
-            for (int i = 0; i < len; i++) {
-                bool success = path[i]->execute(state);
-                messagebus_topic_publish(state_topic, &state, sizeof(state));
-                if (!success) {
-                    break; // Break on failure
-                }
-                if (trajectory_game_has_ended()) {
-                    break;
-                }
+        travel_time.set_limits(motion_limits_from_trajectory(&robot.traj));
+        update_robot_position();
+
+        // The robot stands still while planning, so bound the time spent and
+        // use the best plans found so far. Searches which ran out of time go
+        // on at the next period if the state did not change.
+        auto plans = goal_planner.plan(state, std::chrono::steady_clock::now() + GOAP_PLANNING_TIME);
+        if (goal_planner.goals_out_of_time() > 0) {
+            NOTICE("%d goals are not planned yet", int(goal_planner.goals_out_of_time()));
+        }
+        if (plans.empty()) {
+            // Nothing left to do for now
+            std::this_thread::sleep_for(100ms);
+            continue;
+        }
+
+        auto* goal = plans[0].goal;
+        DEBUG("Found %d plans, best one takes %d ms", int(plans.size()), plans[0].cost);
+        plan.follow(*goal, plans[0].path.data(), plans[0].path.size());
+
+        while (!trajectory_game_has_ended()) {
+            // Plans which need more than one period keep being searched for
+            // while they are asked from the same state.
+            int len = plan.plan(state, *goal, path, MAX_GOAP_PATH_LEN,
+                                [&](const StrategyState& from, goap::Action<StrategyState>** p, int p_len) {
+                                    auto deadline = std::chrono::steady_clock::now() + GOAP_PLANNING_TIME;
+                                    return planner.resume(from, *goal, action_ptrs.data(), action_ptrs.size(),
+                                                          deadline, p, p_len);
+                                });
+            if (len == goap::kErrorOutOfTime) {
+                NOTICE("Could not plan again in time, choosing a goal again");
             }
-            if (trajectory_game_has_ended()) {
+            if (len <= 0) {
                 break;
             }
+            if (plan.last_outcome() != goap::PlanTracker<StrategyState>::Outcome::Reused) {
+                DEBUG("Found a plan of %d actions", len);
+            }
+
+            bool success = path[0]->execute(state);
+            update_robot_position();
+            messagebus_topic_publish(state_topic, &state, sizeof(state));
+            if (!success) {
+                plan.clear();
+                break; // Break on failure
+            }
+            plan.step_done();
         }
     }
 
+    actions::set_travel_time_estimator(nullptr);
+
     NOTICE("Deploying flags");
     WARNING("Unimplemented");
 
@@ -212,9 +261,7 @@ void strategy_play_game()
 
     NOTICE("Waiting for color selection...");
     //auto color = wait_for_color_selection();
-#if USE_MAP
-    map_server_start(color);
-#endif
+    map_server_start();
 
     strategy_order_play_game(state, YELLOW);
 }
@@ -1,17 +1,39 @@
 #ifndef STRATEGY_ACTIONS_H
 #define STRATEGY_ACTIONS_H
 
+#include <chrono>
 #include <goap/goap.hpp>
 #include "state.h"
 #include "color.h"
+#include "travel_time.h"
 #include "absl/strings/str_format.h"
 
-/** Number of states goap can visit before giving up. Increasing it means a
- * solution is found on more complex problems at the expense of RAM use. */
-#define GOAP_SPACE_SIZE 150
+/** Maximum number of states the strategy planner allocates for a single plan.
+ * Memory is allocated as needed and reused between plans. */
+#define GOAP_NODE_BUDGET 20000
+
+/** Time the strategy can spend planning before acting. The planner first
+ * finds a plan at most GOAP_INITIAL_WEIGHT times longer than the best one,
+ * then improves it while time allows. */
+#define GOAP_PLANNING_TIME std::chrono::milliseconds(50)
+#define GOAP_INITIAL_WEIGHT 3.f
+#define GOAP_WEIGHT_STEP 0.5f
+
+/** Number of threads planning the goals, in addition to the strategy one. */
+#define GOAP_PLANNING_THREADS 2
 
 namespace actions {
 
+/** Sets the estimator used to compute the cost of the actions, which is the
+ * time they take in milliseconds, including going to where they start. Until
+ * one is set, all actions cost the same. */
+void set_travel_time_estimator(const TravelTimeEstimator* estimator);
+
+/** Lower bound on the cost of any action, wherever the robot is. Goals count
+ * their distance in multiples of it, so that it stays comparable to the cost
+ * of the actions without ever overestimating it. */
+int min_action_cost();
+
 template <class T>
 class NamedAction : public goap::Action<T> {
 public:
@@ -25,6 +47,7 @@ public:
     bool can_run(const StrategyState& state) override;
     void plan_effects(StrategyState& state) override;
     bool execute(StrategyState& state) override;
+    int cost(const StrategyState& state) override;
     std::string get_name() override
     {
         return "lighthouse";
@@ -36,12 +59,16 @@ public:
 class RaiseWindsock : public NamedAction<StrategyState> {
     int windsock_index_;
 
+    /* X coordinate of the windsock, in mm. */
+    int windsock_x() const;
+
 public:
     /* Windsocks are indexed starting from the starting area. */
     RaiseWindsock(int windsock_index);
     bool can_run(const StrategyState& state) override;
     void plan_effects(StrategyState& state) override;
     bool execute(StrategyState& state) override;
+    int cost(const StrategyState& state) override;
 
     std::string get_name() override
     {
@@ -54,6 +81,7 @@ public:
     bool can_run(const StrategyState& state) override;
     void plan_effects(StrategyState& state) override;
     bool execute(StrategyState& state) override;
+    int cost(const StrategyState& state) override;
 
     std::string get_name() override
     {
@@ -4,10 +4,55 @@
  * should go to actions_impl.cpp
  */
 
+#include <algorithm>
+#include <cmath>
 #include "actions.h"
 
 using namespace actions;
 
+static const TravelTimeEstimator* travel_time_estimator = nullptr;
+
+void actions::set_travel_time_estimator(const TravelTimeEstimator* estimator)
+{
+    travel_time_estimator = estimator;
+}
+
+/* Cost of an action starting at (x, y), and taking duration seconds once
+ * there. */
+static int action_cost(const StrategyState& state, int x, int y, float duration)
+{
+    const float travel = travel_time_estimator->travel_time(state.robot.x_mm, state.robot.y_mm, x, y);
+    return std::max(1, int(1000 * (travel + duration)));
+}
+
+/* Duration of the actions once the robot is where they start, in seconds. */
+static float lighthouse_duration(const TravelTimeEstimator& e)
+{
+    return e.travel_time(525, 300, 225, 400) + e.turn_time(M_PI / 2) + e.move_time(300) + e.move_time(200);
+}
+
+static float windsock_duration(const TravelTimeEstimator& e)
+{
+    return e.travel_time(0, 1500, 0, 2000 - 150) + e.turn_time(M_PI / 2) + e.move_time(200);
+}
+
+static float reef_pickup_duration(const TravelTimeEstimator& e)
+{
+    // Includes the time waiting for the arms and the pumps
+    return e.turn_time(M_PI / 2) + 0.5f + e.move_time(300) + 0.4f + e.move_time(100);
+}
+
+int actions::min_action_cost()
+{
+    if (!travel_time_estimator) {
+        return 1;
+    }
+
+    auto& e = *travel_time_estimator;
+    const float duration = std::min({lighthouse_duration(e), windsock_duration(e), reef_pickup_duration(e)});
+    return std::max(1, int(1000 * duration));
+}
+
 bool EnableLighthouse::can_run(const StrategyState& state)
 {
     (void)state;
@@ -17,6 +62,19 @@ bool EnableLighthouse::can_run(const StrategyState& state)
 void EnableLighthouse::plan_effects(StrategyState& state)
 {
     state.lighthouse_is_on = true;
+    // The robot pushes the button 300mm ahead of (225, 400), then backs off
+    // by 200mm.
+    state.robot.x_mm = 225;
+    state.robot.y_mm = 300;
+}
+
+int EnableLighthouse::cost(const StrategyState& state)
+{
+    if (!travel_time_estimator) {
+        return 1;
+    }
+
+    return action_cost(state, 525, 300, lighthouse_duration(*travel_time_estimator));
 }
 
 RaiseWindsock::RaiseWindsock(int windsock_index)
@@ -24,6 +82,11 @@ RaiseWindsock::RaiseWindsock(int windsock_index)
 {
 }
 
+int RaiseWindsock::windsock_x() const
+{
+    return windsock_index_ == 0 ? 2770 : 2365;
+}
+
 bool RaiseWindsock::can_run(const StrategyState& state)
 {
     /* We don't want to retry a windsock which is already up. */
@@ -33,6 +96,17 @@ bool RaiseWindsock::can_run(const StrategyState& state)
 void RaiseWindsock::plan_effects(StrategyState& state)
 {
     state.windsocks_are_up[windsock_index_] = true;
+    state.robot.x_mm = windsock_x() + 100;
+    state.robot.y_mm = 2000 - 150;
+}
+
+int RaiseWindsock::cost(const StrategyState& state)
+{
+    if (!travel_time_estimator) {
+        return 1;
+    }
+
+    return action_cost(state, windsock_x() - 100, 1500, windsock_duration(*travel_time_estimator));
 }
 
 bool BackwardReefPickup::can_run(const StrategyState& state)
@@ -64,4 +138,16 @@ void BackwardReefPickup::plan_effects(StrategyState& state)
     state.our_dispenser.glasses[0] = GlassColor_UNKNOWN;
     state.our_dispenser.glasses[1] = GlassColor_UNKNOWN;
     state.our_dispenser.glasses[2] = GlassColor_UNKNOWN;
+
+    state.robot.x_mm = 300;
+    state.robot.y_mm = 1525;
+}
+
+int BackwardReefPickup::cost(const StrategyState& state)
+{
+    if (!travel_time_estimator) {
+        return 1;
+    }
+
+    return action_cost(state, 500, 1525, reef_pickup_duration(*travel_time_estimator));
 }
@@ -60,24 +60,18 @@ bool actions::RaiseWindsock::execute(StrategyState& state)
     (void)state;
     NOTICE("Raising windsock #%d", windsock_index_);
 
-    int windsock_x;
+    const int x = windsock_x();
     int res;
 
-    if (windsock_index_ == 0) {
-        windsock_x = 2770;
-    } else {
-        windsock_x = 2365;
-    }
-
     // TODO: Use proper obstacle avoidance instead
-    trajectory_goto_xy_abs(&robot.traj, windsock_x - 100, 1500);
+    trajectory_goto_xy_abs(&robot.traj, x - 100, 1500);
     res = trajectory_wait_for_end(TRAJ_FLAGS_ALL);
     if (res != TRAJ_END_GOAL_REACHED) {
         WARNING("Could not go to windsock!");
         return false;
     }
 
-    trajectory_goto_xy_abs(&robot.traj, windsock_x - 100, 2000 - 150);
+    trajectory_goto_xy_abs(&robot.traj, x - 100, 2000 - 150);
     res = trajectory_wait_for_end(TRAJ_FLAGS_ALL);
     if (res != TRAJ_END_GOAL_REACHED) {
         WARNING("Could not go to windsock!");
@@ -1,15 +1,17 @@
 #include "goals.h"
+#include "actions.h"
 
 namespace goals {
 int LighthouseEnabled::distance_to(const StrategyState& state) const
 {
-    return goap::Distance().shouldBeTrue(state.lighthouse_is_on);
+    return goap::Distance().shouldBeTrue(state.lighthouse_is_on) * actions::min_action_cost();
 }
 
 int WindsocksUp::distance_to(const StrategyState& state) const
 {
-    return goap::Distance()
-        .shouldBeTrue(state.windsocks_are_up[0])
-        .shouldBeTrue(state.windsocks_are_up[1]);
+    const int unmet = goap::Distance()
+                          .shouldBeTrue(state.windsocks_are_up[0])
+                          .shouldBeTrue(state.windsocks_are_up[1]);
+    return unmet * actions::min_action_cost();
 }
 } // namespace goals
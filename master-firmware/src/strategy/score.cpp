@@ -3,11 +3,11 @@
 static int compute_windsocks(const StrategyState& state)
 {
     if (state.windsocks_are_up[0] && state.windsocks_are_up[1]) {
-        return 15;
+        return BOTH_WINDSOCKS_UP_POINTS;
     }
 
     if (state.windsocks_are_up[0] || state.windsocks_are_up[1]) {
-        return 5;
+        return ONE_WINDSOCK_UP_POINTS;
     }
 
     return 0;
@@ -24,7 +24,7 @@ static int compute_lighthouse(const StrategyState& state, bool is_main_robot)
     }
 
     if (state.lighthouse_is_on) {
-        score += 13;
+        score += LIGHTHOUSE_ON_POINTS;
     }
 
     return score;
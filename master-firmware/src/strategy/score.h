@@ -3,6 +3,13 @@
 
 #include "strategy/state.h"
 
+/** Points brought by the lighthouse once it is on. */
+const int LIGHTHOUSE_ON_POINTS = 13;
+
+/** Points brought by the windsocks, when one or both of them are up. */
+const int ONE_WINDSOCK_UP_POINTS = 5;
+const int BOTH_WINDSOCKS_UP_POINTS = 15;
+
 int compute_score(const StrategyState& state, bool is_main_robot);
 
 #endif /* SCORE_H */
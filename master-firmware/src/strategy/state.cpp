@@ -6,6 +6,12 @@ StrategyState initial_state()
 {
     StrategyState state = StrategyState_init_default;
 
+    // Where the robot stands once positioned in its starting area
+    state.robot.has_x_mm = true;
+    state.robot.x_mm = 250;
+    state.robot.has_y_mm = true;
+    state.robot.y_mm = 450;
+
     return state;
 }
 
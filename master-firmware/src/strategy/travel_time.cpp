@@ -0,0 +1,80 @@
+#include <cmath>
+#include <aversive/trajectory_manager/trajectory_manager.h>
+#include <aversive/trajectory_manager/trajectory_manager_utils.h>
+#include "travel_time.h"
+
+MotionLimits motion_limits_from_trajectory(struct trajectory* traj)
+{
+    MotionLimits limits;
+    limits.speed = speed_imp2mm(traj, traj->d_speed);
+    limits.acceleration = acc_imp2mm(traj, traj->d_acc);
+    limits.angular_speed = speed_imp2rd(traj, traj->a_speed);
+    limits.angular_acceleration = acc_imp2rd(traj, traj->a_acc);
+    return limits;
+}
+
+float ramp_duration(float length, float max_speed, float max_acceleration)
+{
+    length = std::fabs(length);
+
+    if (length == 0.f || max_speed <= 0.f || max_acceleration <= 0.f) {
+        return 0.f;
+    }
+
+    // Too short to reach full speed: accelerate for half of the way, then
+    // brake for the other half.
+    if (length * max_acceleration < max_speed * max_speed) {
+        return 2.f * std::sqrt(length / max_acceleration);
+    }
+
+    return length / max_speed + max_speed / max_acceleration;
+}
+
+TravelTimeEstimator::TravelTimeEstimator(MotionLimits limits_)
+    : limits(limits_)
+{
+}
+
+void TravelTimeEstimator::set_limits(MotionLimits limits_)
+{
+    absl::MutexLock l(&lock);
+    limits = limits_;
+}
+
+MotionLimits TravelTimeEstimator::current_limits() const
+{
+    absl::ReaderMutexLock l(&lock);
+    return limits;
+}
+
+float TravelTimeEstimator::travel_time(int x1, int y1, int x2, int y2) const
+{
+    if (x1 == x2 && y1 == y2) {
+        return 0.f;
+    }
+
+    // Both parts of the move use the same limits, even if they change
+    // meanwhile.
+    const MotionLimits l = current_limits();
+    return turn_time(l, M_PI / 2) + move_time(l, std::hypot(x2 - x1, y2 - y1));
+}
+
+float TravelTimeEstimator::move_time(float length) const
+{
+    return move_time(current_limits(), length);
+}
+
+float TravelTimeEstimator::turn_time(float angle) const
+{
+    return turn_time(current_limits(), angle);
+}
+
+float TravelTimeEstimator::move_time(const MotionLimits& limits, float length)
+{
+    return ramp_duration(length, limits.speed, limits.acceleration);
+}
+
+float TravelTimeEstimator::turn_time(const MotionLimits& limits, float angle)
+{
+    return ramp_duration(angle, limits.angular_speed, limits.angular_acceleration);
+}
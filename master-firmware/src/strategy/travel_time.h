@@ -0,0 +1,56 @@
+#ifndef STRATEGY_TRAVEL_TIME_H
+#define STRATEGY_TRAVEL_TIME_H
+
+#include <absl/synchronization/mutex.h>
+
+struct trajectory;
+
+/** Speed and acceleration limits of the robot, in mm, radians and seconds. */
+struct MotionLimits {
+    float speed;
+    float acceleration;
+    float angular_speed;
+    float angular_acceleration;
+};
+
+/** Reads the limits currently used by the trajectory manager. */
+MotionLimits motion_limits_from_trajectory(struct trajectory* traj);
+
+/** Duration of a move of the given length, starting and ending at rest, with
+ * the trapezoidal speed profile used by the trajectory manager. */
+float ramp_duration(float length, float max_speed, float max_acceleration);
+
+/** Estimates the duration of the robot's moves, fast enough to be used by the
+ * planner for every action it considers.
+ *
+ * Moves follow a straight line, obstacles are not taken into account.
+ *
+ * It can be used from several threads at once.
+ */
+class TravelTimeEstimator {
+public:
+    explicit TravelTimeEstimator(MotionLimits limits);
+
+    void set_limits(MotionLimits limits);
+
+    /** Time to go from (x1, y1) to (x2, y2), turning towards the target
+     * first, in seconds. As the heading of the robot is not known, the turn
+     * is counted as a quarter turn. */
+    float travel_time(int x1, int y1, int x2, int y2) const;
+
+    /** Time to move straight ahead (or backwards) by length mm, in seconds */
+    float move_time(float length) const;
+
+    /** Time to turn in place by angle radians, in seconds */
+    float turn_time(float angle) const;
+
+private:
+    MotionLimits current_limits() const;
+    static float move_time(const MotionLimits& limits, float length);
+    static float turn_time(const MotionLimits& limits, float angle);
+
+    mutable absl::Mutex lock;
+    MotionLimits limits GUARDED_BY(lock);
+};
+
+#endif /* STRATEGY_TRAVEL_TIME_H */
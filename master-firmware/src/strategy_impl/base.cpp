@@ -12,7 +12,6 @@
 #include "robot_helpers/arm_helpers.h"
 
 #include "control_panel.h"
-#include "base/map_server.h"
 #include "protobuf/sensors.pb.h"
 #include "config.h"
 #include "main.h"
@@ -39,55 +38,13 @@ void strategy_hardstop_robot(strategy_context_t* strat)
 
 bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_deg, int traj_end_flags)
 {
-    auto map = map_server_map_lock_and_get();
-
     // Dangerous mode: removes opponent
     if (traj_end_flags == TRAJ_FLAGS_ALL_IGNORE_OPPONENT) {
         WARNING("Ignoring opponent, lalala");
-        map_server_enable_opponent(map, false);
-    }
-
-    /* Compute path */
-    const point_t start = {
-        position_get_x_float(&strat->robot->pos),
-        position_get_y_float(&strat->robot->pos)};
-    oa_start_end_points(&map->oa, start.x, start.y, x_mm, y_mm);
-    oa_process(&map->oa);
-
-    // Disable the dangerous mode that removes opponent
-    if (traj_end_flags == TRAJ_FLAGS_ALL_IGNORE_OPPONENT) {
-        map_server_enable_opponent(map, true);
     }
 
-    /* Retrieve path */
-    point_t* points;
-    int num_points = oa_get_path(&map->oa, &points);
-    DEBUG("Path to (%d, %d) computed with %d points", x_mm, y_mm, num_points);
-    if (num_points <= 0) {
-        WARNING("No path found!");
-        strategy_stop_robot(strat);
-        map_server_map_release(map);
-        return false;
-    }
-
-    /* Execute path, one waypoint at a time */
-    int end_reason = 0;
-
-    for (int i = 0; i < num_points; i++) {
-        DEBUG("Going to x: %.1fmm y: %.1fmm", points[i].x, points[i].y);
-
-        trajectory_goto_xy_abs(&strat->robot->traj, points[i].x, points[i].y);
-
-        if (i == num_points - 1) /* last point */ {
-            end_reason = trajectory_wait_for_end(traj_end_flags);
-        } else {
-            end_reason = trajectory_wait_for_end(traj_end_flags | TRAJ_END_NEAR_GOAL);
-        }
-
-        if (end_reason != TRAJ_END_GOAL_REACHED && end_reason != TRAJ_END_NEAR_GOAL) {
-            break;
-        }
-    }
+    /* Follow the path computed by the map server */
+    int end_reason = trajectory_goto_avoid(x_mm, y_mm, traj_end_flags);
 
     if (end_reason == TRAJ_END_GOAL_REACHED) {
         strat->wait_ms(200);
@@ -95,9 +52,11 @@ bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_de
         trajectory_wait_for_end(TRAJ_END_GOAL_REACHED);
 
         DEBUG("Goal reached successfully");
-        map_server_map_release(map);
 
         return true;
+    } else if (end_reason == TRAJ_END_NO_PATH) {
+        WARNING("No path found!");
+        strategy_stop_robot(strat);
     } else if (end_reason == TRAJ_END_OPPONENT_NEAR) {
         control_panel_set(LED_PC);
         strategy_hardstop_robot(strat);
@@ -118,7 +77,6 @@ bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_de
         WARNING("Trajectory ended with reason %d", end_reason);
     }
 
-    map_server_map_release(map);
     return false;
 }
 
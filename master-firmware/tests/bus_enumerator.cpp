@@ -215,6 +215,23 @@ TEST(BusEnumeratorTestGroup, GetStringId)
     STRCMP_EQUAL(MEDIUM_STR_ID, bus_enumerator_get_str_id(&en, MEDIUM_CAN_ID));
 }
 
+TEST(BusEnumeratorTestGroup, GenerationChangesWhenNodesAreAddedOrDiscovered)
+{
+    auto initial = bus_enumerator_generation(&en);
+
+    bus_enumerator_add_node(&en, SMALL_STR_ID, DRIVER_POINTER);
+    auto added = bus_enumerator_generation(&en);
+    CHECK_TRUE(initial != added);
+
+    bus_enumerator_update_node_info(&en, SMALL_STR_ID, SMALL_CAN_ID);
+    auto discovered = bus_enumerator_generation(&en);
+    CHECK_TRUE(added != discovered);
+
+    // Known nodes keep their first ID
+    bus_enumerator_update_node_info(&en, SMALL_STR_ID, LARGE_CAN_ID);
+    CHECK_EQUAL(discovered, bus_enumerator_generation(&en));
+}
+
 TEST_GROUP (BusEnumeratorBufferLengthTestGroup) {
     bus_enumerator_t en;
 
@@ -0,0 +1,114 @@
+#include <CppUTest/TestHarness.h>
+#include "can/batched_socketcan_driver.hpp"
+
+using namespace batched_socketcan;
+
+TEST_GROUP (BatchedSocketCanFrameConversion) {
+    const uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+};
+
+TEST(BatchedSocketCanFrameConversion, ExtendedFrame)
+{
+    uavcan::CanFrame frame(0x1234567 | uavcan::CanFrame::FlagEFF, data, 8);
+
+    auto out = to_socketcan_frame(frame);
+
+    CHECK_EQUAL(0x1234567 | CAN_EFF_FLAG, out.can_id);
+    CHECK_EQUAL(8, out.can_dlc);
+    MEMCMP_EQUAL(data, out.data, 8);
+}
+
+TEST(BatchedSocketCanFrameConversion, StandardRemoteFrame)
+{
+    uavcan::CanFrame frame(0x123 | uavcan::CanFrame::FlagRTR, data, 0);
+
+    auto out = to_socketcan_frame(frame);
+
+    CHECK_EQUAL(0x123 | CAN_RTR_FLAG, out.can_id);
+    CHECK_EQUAL(0, out.can_dlc);
+}
+
+TEST(BatchedSocketCanFrameConversion, RoundTrip)
+{
+    uavcan::CanFrame frame(0x1abcdef | uavcan::CanFrame::FlagEFF, data, 5);
+
+    auto out = from_socketcan_frame(to_socketcan_frame(frame));
+
+    CHECK_TRUE(frame == out);
+}
+
+TEST(BatchedSocketCanFrameConversion, InvalidLengthIsClamped)
+{
+    can_frame in = {};
+    in.can_id = 0x42;
+    in.can_dlc = 15;
+
+    auto out = from_socketcan_frame(in);
+
+    CHECK_EQUAL(8, out.dlc);
+}
+
+TEST_GROUP (BatchedSocketCanTimestamps) {
+    const uavcan::MonotonicTime now_monotonic = uavcan::MonotonicTime::fromUSec(5000000);
+    const uavcan::UtcTime now_utc = uavcan::UtcTime::fromUSec(1600000000000000ULL);
+    uavcan::MonotonicTime ts_monotonic;
+    uavcan::UtcTime ts_utc;
+};
+
+TEST(BatchedSocketCanTimestamps, KernelTimestampGivesFrameAge)
+{
+    // The frame was received 1.5 ms ago according to the kernel
+    timespec ts = {1599999999, 998500000};
+
+    timestamp_from_realtime(ts, now_monotonic, now_utc, ts_monotonic, ts_utc);
+
+    CHECK_EQUAL(1599999999998500ULL, ts_utc.toUSec());
+    CHECK_EQUAL(4998500ULL, ts_monotonic.toUSec());
+}
+
+TEST(BatchedSocketCanTimestamps, TimestampInTheFutureIsClamped)
+{
+    // This can happen if the system clock was adjusted in between
+    timespec ts = {1600000001, 0};
+
+    timestamp_from_realtime(ts, now_monotonic, now_utc, ts_monotonic, ts_utc);
+
+    CHECK_EQUAL(now_monotonic.toUSec(), ts_monotonic.toUSec());
+}
+
+TEST_GROUP (BatchedSocketCanQueue) {
+    FrameQueue<int, 4> queue;
+};
+
+TEST(BatchedSocketCanQueue, IsFifo)
+{
+    queue.push() = 1;
+    queue.push() = 2;
+
+    CHECK_EQUAL(2, queue.size());
+    CHECK_EQUAL(1, queue.front());
+    queue.pop();
+    CHECK_EQUAL(2, queue.front());
+}
+
+TEST(BatchedSocketCanQueue, WrapsAround)
+{
+    for (int i = 0; i < 10; i++) {
+        queue.push() = i;
+        queue.push() = i + 1;
+        CHECK_EQUAL(i, queue.front());
+        CHECK_EQUAL(i + 1, queue.at(1));
+        queue.pop(2);
+    }
+    CHECK_TRUE(queue.empty());
+}
+
+TEST(BatchedSocketCanQueue, CanBeFilled)
+{
+    for (int i = 0; i < 4; i++) {
+        CHECK_FALSE(queue.full());
+        queue.push() = i;
+    }
+    CHECK_TRUE(queue.full());
+    CHECK_EQUAL(0, queue.free_space());
+}
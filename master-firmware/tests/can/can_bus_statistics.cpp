@@ -0,0 +1,135 @@
+#include <CppUTest/TestHarness.h>
+#include "can/can_bus_statistics.hpp"
+
+static uint32_t message_id(uint16_t data_type_id, uint8_t source)
+{
+    return (16 << 24) | (data_type_id << 8) | source;
+}
+
+static uint32_t service_id(uint8_t data_type_id, uint8_t source, uint8_t destination)
+{
+    return (16 << 24) | (data_type_id << 16) | (1 << 15) | (destination << 8) | (1 << 7) | source;
+}
+
+TEST_GROUP (CanBusStatisticsTestGroup) {
+    CanBusStatistics stats{1000000};
+    // Single frame transfer: start and end of transfer set in the tail byte
+    uint8_t single_frame[8] = {1, 2, 3, 4, 5, 6, 7, 0xc0};
+};
+
+TEST(CanBusStatisticsTestGroup, ComputesFrameLengthWithStuffing)
+{
+    CHECK_EQUAL(160, CanBusStatistics::frame_bits(true, 8));
+    CHECK_EQUAL(80, CanBusStatistics::frame_bits(true, 0));
+    CHECK_EQUAL(55, CanBusStatistics::frame_bits(false, 0));
+}
+
+TEST(CanBusStatisticsTestGroup, CountsPerDataType)
+{
+    stats.frame_received(message_id(20160, 42), true, 8, single_frame, 0);
+    stats.frame_received(message_id(20160, 43), true, 8, single_frame, 0);
+    stats.frame_received(message_id(341, 42), true, 8, single_frame, 0);
+
+    auto* encoders = stats.data_type(20160, false);
+    CHECK_TRUE(encoders);
+    CHECK_EQUAL(2, encoders->frames);
+    CHECK_EQUAL(16, encoders->bytes);
+    CHECK_EQUAL(2, encoders->transfers);
+
+    CHECK_EQUAL(1, stats.data_type(341, false)->frames);
+    CHECK_FALSE(stats.data_type(1, false));
+}
+
+TEST(CanBusStatisticsTestGroup, CountsPerNode)
+{
+    stats.frame_received(message_id(20160, 42), true, 8, single_frame, 0);
+    stats.frame_received(message_id(341, 42), true, 4, single_frame, 0);
+    stats.frame_received(message_id(341, 43), true, 8, single_frame, 0);
+
+    CHECK_EQUAL(2, stats.node(42)->frames);
+    CHECK_EQUAL(12, stats.node(42)->bytes);
+    CHECK_EQUAL(1, stats.node(43)->frames);
+    CHECK_EQUAL(0, stats.node(44)->frames);
+}
+
+TEST(CanBusStatisticsTestGroup, CountsTransfersOnLastFrame)
+{
+    uint8_t first[8] = {0, 0, 0, 0, 0, 0, 0, 0x80};
+    uint8_t middle[8] = {0, 0, 0, 0, 0, 0, 0, 0x20};
+    uint8_t last[3] = {0, 0, 0x40};
+
+    stats.frame_received(message_id(20160, 42), true, 8, first, 0);
+    stats.frame_received(message_id(20160, 42), true, 8, middle, 0);
+    stats.frame_received(message_id(20160, 42), true, 3, last, 0);
+
+    CHECK_EQUAL(3, stats.data_type(20160, false)->frames);
+    CHECK_EQUAL(1, stats.data_type(20160, false)->transfers);
+}
+
+TEST(CanBusStatisticsTestGroup, ServicesAreSeparateFromMessages)
+{
+    stats.frame_sent(service_id(11, 10, 42), true, 8, single_frame, 0);
+
+    CHECK_TRUE(stats.data_type(11, true));
+    CHECK_FALSE(stats.data_type(11, false));
+    CHECK_EQUAL(1, stats.node(10)->frames);
+}
+
+TEST(CanBusStatisticsTestGroup, ComputesLoadOverWindow)
+{
+    // 1000 frames of 160 bits over one second is 16% of 1 Mbit/s
+    for (int i = 0; i < 1000; i++) {
+        stats.frame_received(message_id(20160, 42), true, 8, single_frame, 10000000 + i * 1000);
+    }
+
+    DOUBLES_EQUAL(16., stats.load(10999999, 1000000), 0.01);
+
+    // Averaged over 10 seconds, this is ten times less
+    DOUBLES_EQUAL(1.6, stats.load(10999999, 10000000), 0.01);
+
+    // And all the frames are out of the 1 second window later on
+    DOUBLES_EQUAL(0., stats.load(12000000, 1000000), 0.01);
+}
+
+TEST(CanBusStatisticsTestGroup, ComputesPeakLoad)
+{
+    // 100 frames in a single 100 ms bucket is 16% as well
+    for (int i = 0; i < 100; i++) {
+        stats.frame_received(message_id(20160, 42), true, 8, single_frame, 10000000 + i * 10);
+    }
+
+    DOUBLES_EQUAL(16., stats.peak_load(15000000, 10000000), 0.01);
+    DOUBLES_EQUAL(1.6, stats.load(10099999, 1000000), 0.01);
+}
+
+TEST(CanBusStatisticsTestGroup, ReportsStatistics)
+{
+    CanStatistics msg;
+
+    stats.report(1000000, &msg);
+    stats.frame_received(message_id(20160, 42), true, 8, single_frame, 1100000);
+    stats.frame_sent(message_id(20024, 10), true, 8, single_frame, 1100000);
+    stats.driver_state(3, 2, 0);
+    stats.driver_state(1, 2, 5);
+    stats.report(2000000, &msg);
+
+    CHECK_EQUAL(1, msg.rx_frames);
+    CHECK_EQUAL(1, msg.tx_frames);
+    CHECK_EQUAL(1, msg.tx_queue_depth);
+    CHECK_EQUAL(3, msg.tx_queue_peak_depth);
+    CHECK_EQUAL(2, msg.tx_dropped);
+    CHECK_EQUAL(5, msg.errors);
+
+    CHECK_EQUAL(2, msg.data_types_count);
+    CHECK_EQUAL(20160, msg.data_types[0].data_type_id);
+    CHECK_EQUAL(1, msg.data_types[0].transfers);
+    DOUBLES_EQUAL(0.016, msg.data_types[0].load, 0.0001);
+
+    CHECK_EQUAL(2, msg.nodes_count);
+    CHECK_EQUAL(10, msg.nodes[0].node_id);
+    CHECK_EQUAL(42, msg.nodes[1].node_id);
+
+    // The per type load only covers the time since the last report
+    stats.report(3000000, &msg);
+    DOUBLES_EQUAL(0., msg.data_types[0].load, 0.0001);
+}
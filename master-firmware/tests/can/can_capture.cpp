@@ -0,0 +1,176 @@
+#include <sstream>
+#include <CppUTest/TestHarness.h>
+#include "can/can_capture.hpp"
+#include "can/uavcan_frame_header.hpp"
+
+static CaptureRecord make_record(uint64_t timestamp_us, uint32_t id, uint8_t dlc)
+{
+    CaptureRecord record;
+    record.timestamp_us = timestamp_us;
+    record.id = id;
+    record.iface = 0;
+    record.dlc = dlc;
+    for (int i = 0; i < 8; i++) {
+        record.data[i] = i + 1;
+    }
+    return record;
+}
+
+// Message of type 20001 from node 42, single frame transfer
+static const uint32_t message_id = (16 << 24) | (20001 << 8) | 42;
+
+TEST_GROUP (CanCaptureTestGroup) {
+    std::stringstream stream;
+};
+
+TEST(CanCaptureTestGroup, CanReadBackRecords)
+{
+    CaptureWriter writer(stream);
+    auto a = make_record(1000, message_id | CaptureRecord::FlagExtended, 8);
+    auto b = make_record(1250, 0x123, 3);
+    b.iface = 2;
+    writer.write(a);
+    writer.write(b);
+
+    CaptureReader reader(stream);
+    CaptureRecord out;
+
+    CHECK_TRUE(reader.valid());
+    CHECK_TRUE(reader.read(out));
+    CHECK_EQUAL(1000, out.timestamp_us);
+    CHECK_EQUAL(a.id, out.id);
+    CHECK_EQUAL(8, out.dlc);
+    MEMCMP_EQUAL(a.data, out.data, 8);
+
+    CHECK_TRUE(reader.read(out));
+    CHECK_EQUAL(1250, out.timestamp_us);
+    CHECK_EQUAL(0x123, out.id);
+    CHECK_EQUAL(2, out.iface);
+    CHECK_EQUAL(3, out.dlc);
+    MEMCMP_EQUAL(b.data, out.data, 3);
+
+    CHECK_FALSE(reader.read(out));
+}
+
+TEST(CanCaptureTestGroup, RecordsAreCompact)
+{
+    CaptureWriter writer(stream);
+    const auto header_size = stream.str().size();
+
+    // A frame every 130us is roughly a fully loaded bus at 1Mbit/s
+    writer.write(make_record(0, message_id | CaptureRecord::FlagExtended, 8));
+    writer.write(make_record(130, message_id | CaptureRecord::FlagExtended, 8));
+    const auto records_size = stream.str().size() - header_size;
+
+    CHECK_EQUAL(14 + 15, records_size);
+}
+
+TEST(CanCaptureTestGroup, TimestampsGoingBackwardsAreClamped)
+{
+    CaptureWriter writer(stream);
+    writer.write(make_record(1000, 0x10, 0));
+    writer.write(make_record(500, 0x10, 0));
+
+    CaptureReader reader(stream);
+    CaptureRecord out;
+    reader.read(out);
+    reader.read(out);
+
+    CHECK_EQUAL(1000, out.timestamp_us);
+}
+
+TEST(CanCaptureTestGroup, RejectsUnknownFormat)
+{
+    stream << "NOTACAPTURE";
+
+    CaptureReader reader(stream);
+    CaptureRecord out;
+
+    CHECK_FALSE(reader.valid());
+    CHECK_FALSE(reader.read(out));
+}
+
+TEST(CanCaptureTestGroup, TruncatedRecordIsNotRead)
+{
+    CaptureWriter writer(stream);
+    writer.write(make_record(1000, message_id | CaptureRecord::FlagExtended, 8));
+
+    auto data = stream.str();
+    std::stringstream truncated(data.substr(0, data.size() - 1));
+
+    CaptureReader reader(truncated);
+    CaptureRecord out;
+    CHECK_FALSE(reader.read(out));
+}
+
+TEST_GROUP (CaptureNodeFilterTestGroup) {
+    CaptureNodeFilter filter;
+};
+
+TEST(CaptureNodeFilterTestGroup, EmptyFilterAcceptsEverything)
+{
+    CHECK_TRUE(filter.accepts(make_record(0, 0x123, 2)));
+    CHECK_TRUE(filter.accepts(make_record(0, message_id | CaptureRecord::FlagExtended, 8)));
+}
+
+TEST(CaptureNodeFilterTestGroup, FiltersOnSourceNode)
+{
+    filter.add(42);
+
+    CHECK_TRUE(filter.accepts(make_record(0, message_id | CaptureRecord::FlagExtended, 8)));
+    CHECK_FALSE(filter.accepts(make_record(0, (message_id & ~0x7f) | 43 | CaptureRecord::FlagExtended, 8)));
+}
+
+TEST(CaptureNodeFilterTestGroup, NonUavcanFramesAreRejected)
+{
+    filter.add(42);
+
+    CHECK_FALSE(filter.accepts(make_record(0, 42, 8)));
+    CHECK_FALSE(filter.accepts(make_record(0, message_id | CaptureRecord::FlagExtended, 0)));
+}
+
+TEST_GROUP (UavcanFrameHeaderTestGroup) {
+    UavcanFrameHeader header;
+};
+
+TEST(UavcanFrameHeaderTestGroup, DecodesMessageFrame)
+{
+    const uint8_t data[] = {1, 2, 0xc0 | 17};
+
+    CHECK_TRUE(uavcan_decode_frame_header(message_id, true, 3, data, &header));
+
+    CHECK_EQUAL(16, header.priority);
+    CHECK_FALSE(header.service);
+    CHECK_EQUAL(20001, header.data_type_id);
+    CHECK_EQUAL(42, header.source_node);
+    CHECK_TRUE(header.start_of_transfer);
+    CHECK_TRUE(header.end_of_transfer);
+    CHECK_FALSE(header.toggle);
+    CHECK_EQUAL(17, header.transfer_id);
+}
+
+TEST(UavcanFrameHeaderTestGroup, DecodesServiceFrame)
+{
+    // Request of service 11 from node 10 to node 42, middle of a transfer
+    const uint32_t id = (30 << 24) | (11 << 16) | (1 << 15) | (42 << 8) | (1 << 7) | 10;
+    const uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 0x20 | 3};
+
+    CHECK_TRUE(uavcan_decode_frame_header(id, true, 8, data, &header));
+
+    CHECK_TRUE(header.service);
+    CHECK_TRUE(header.request);
+    CHECK_EQUAL(11, header.data_type_id);
+    CHECK_EQUAL(10, header.source_node);
+    CHECK_EQUAL(42, header.destination_node);
+    CHECK_FALSE(header.start_of_transfer);
+    CHECK_FALSE(header.end_of_transfer);
+    CHECK_TRUE(header.toggle);
+    CHECK_EQUAL(3, header.transfer_id);
+}
+
+TEST(UavcanFrameHeaderTestGroup, StandardFramesAreNotUavcan)
+{
+    const uint8_t data[] = {0xc0};
+
+    CHECK_FALSE(uavcan_decode_frame_header(0x123, false, 1, data, &header));
+}
@@ -0,0 +1,59 @@
+#include <CppUTest/TestHarness.h>
+#include "can/inplace_request.hpp"
+#include "can/mpsc_queue.hpp"
+
+TEST_GROUP (InplaceRequestTestGroup) {
+    int calls = 0;
+};
+
+TEST(InplaceRequestTestGroup, RunsTheFunction)
+{
+    int* counter = &calls;
+    InplaceRequest<16> request([counter]() { (*counter)++; });
+
+    request();
+    request();
+
+    CHECK_EQUAL(2, calls);
+}
+
+TEST(InplaceRequestTestGroup, DefaultConstructedRequestIsEmpty)
+{
+    InplaceRequest<16> request;
+
+    CHECK_FALSE(request);
+    request();
+    CHECK_TRUE(InplaceRequest<16>([]() {}));
+}
+
+TEST(InplaceRequestTestGroup, KeepsCapturedValuesWhenCopied)
+{
+    int* counter = &calls;
+    int increment = 42;
+    InplaceRequest<16> copy;
+
+    {
+        InplaceRequest<16> request([counter, increment]() { *counter += increment; });
+        copy = request;
+    }
+
+    copy();
+
+    CHECK_EQUAL(42, calls);
+}
+
+TEST(InplaceRequestTestGroup, CanBeQueued)
+{
+    MpscQueue<InplaceRequest<16>, 4> queue;
+    int* counter = &calls;
+
+    queue.push([counter]() { *counter += 1; });
+    queue.push([counter]() { *counter += 10; });
+
+    InplaceRequest<16> request;
+    while (queue.pop(request)) {
+        request();
+    }
+
+    CHECK_EQUAL(11, calls);
+}
@@ -0,0 +1,84 @@
+#include <CppUTest/TestHarness.h>
+#include <thread>
+#include <vector>
+#include "can/mpsc_queue.hpp"
+
+TEST_GROUP (MpscQueueTestGroup) {
+    MpscQueue<int, 4> queue;
+    int value;
+};
+
+TEST(MpscQueueTestGroup, IsEmptyAtStart)
+{
+    CHECK_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueueTestGroup, PopsInOrder)
+{
+    queue.push(1);
+    queue.push(2);
+
+    CHECK_TRUE(queue.pop(value));
+    CHECK_EQUAL(1, value);
+    CHECK_TRUE(queue.pop(value));
+    CHECK_EQUAL(2, value);
+    CHECK_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueueTestGroup, RefusesElementsWhenFull)
+{
+    for (int i = 0; i < 4; i++) {
+        CHECK_TRUE(queue.push(i));
+    }
+    CHECK_FALSE(queue.push(42));
+
+    // Once an element is consumed there is room again
+    queue.pop(value);
+    CHECK_TRUE(queue.push(42));
+}
+
+TEST(MpscQueueTestGroup, WrapsAround)
+{
+    for (int i = 0; i < 100; i++) {
+        CHECK_TRUE(queue.push(i));
+        CHECK_TRUE(queue.pop(value));
+        CHECK_EQUAL(i, value);
+    }
+}
+
+TEST(MpscQueueTestGroup, ConcurrentProducersDoNotLoseElements)
+{
+    MpscQueue<int, 64> q;
+    const int producer_count = 4;
+    const int per_producer = 10000;
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < producer_count; p++) {
+        producers.emplace_back([&q, p]() {
+            for (int i = 0; i < per_producer; i++) {
+                while (!q.push(p * per_producer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Check that every element is received once, and that each producer's
+    // elements are received in order.
+    std::vector<int> last(producer_count, -1);
+    int received = 0;
+    while (received < producer_count * per_producer) {
+        if (q.pop(value)) {
+            int producer = value / per_producer;
+            CHECK_TRUE(value % per_producer > last[producer]);
+            last[producer] = value % per_producer;
+            received++;
+        }
+    }
+
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    CHECK_FALSE(q.pop(value));
+}
@@ -123,3 +123,75 @@ TEST(BackwardReefPickupGroup, ExpectsToEmptyDispenser)
     CHECK_EQUAL(GlassColor_UNKNOWN, state.our_dispenser.glasses[1]);
     CHECK_EQUAL(GlassColor_UNKNOWN, state.our_dispenser.glasses[2]);
 }
+
+TEST_GROUP (ActionCostTestGroup) {
+    StrategyState state = initial_state();
+    TravelTimeEstimator estimator{{500, 1000, 3, 10}};
+    EnableLighthouse lighthouse;
+    RaiseWindsock far{1}, near{0};
+
+    void setup() override
+    {
+        set_travel_time_estimator(&estimator);
+    }
+
+    void teardown() override
+    {
+        set_travel_time_estimator(nullptr);
+    }
+};
+
+TEST(ActionCostTestGroup, AllActionsCostTheSameWithoutEstimator)
+{
+    set_travel_time_estimator(nullptr);
+
+    CHECK_EQUAL(1, lighthouse.cost(state));
+    CHECK_EQUAL(1, far.cost(state));
+}
+
+TEST(ActionCostTestGroup, CostIsTimeInMilliseconds)
+{
+    // Going to the lighthouse and pushing its button takes a few seconds
+    CHECK(lighthouse.cost(state) > 2000);
+    CHECK(lighthouse.cost(state) < 10000);
+}
+
+TEST(ActionCostTestGroup, MinimumCostIsALowerBound)
+{
+    BackwardReefPickup pickup;
+    const int min_cost = min_action_cost();
+
+    CHECK(min_cost > 1);
+    const int positions[][2] = {{225, 300}, {500, 1525}, {2465, 1500}, {2870, 1850}};
+    for (auto& pos : positions) {
+        state.robot.x_mm = pos[0];
+        state.robot.y_mm = pos[1];
+        CHECK(min_cost <= lighthouse.cost(state));
+        CHECK(min_cost <= far.cost(state));
+        CHECK(min_cost <= near.cost(state));
+        CHECK(min_cost <= pickup.cost(state));
+    }
+}
+
+TEST(ActionCostTestGroup, ClosestWindsockIsCheapest)
+{
+    state.robot.x_mm = 2265;
+    state.robot.y_mm = 1500;
+    CHECK(far.cost(state) < near.cost(state));
+
+    state.robot.x_mm = 2670;
+    CHECK(near.cost(state) < far.cost(state));
+}
+
+TEST(ActionCostTestGroup, ActionsMoveTheRobot)
+{
+    far.plan_effects(state);
+
+    CHECK_EQUAL(2465, state.robot.x_mm);
+    CHECK_EQUAL(1850, state.robot.y_mm);
+
+    lighthouse.plan_effects(state);
+
+    CHECK_EQUAL(225, state.robot.x_mm);
+    CHECK_EQUAL(300, state.robot.y_mm);
+}
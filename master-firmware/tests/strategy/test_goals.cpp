@@ -1,5 +1,6 @@
 #include <CppUTest/TestHarness.h>
 #include "strategy/goals.h"
+#include "strategy/actions.h"
 
 TEST_GROUP (LighthouseEnabledTestCase) {
     goals::LighthouseEnabled goal;
@@ -17,6 +18,18 @@ TEST(LighthouseEnabledTestCase, ReachedOnlyWhenLighthouseEnabled)
     CHECK_EQUAL(0, goal.distance_to(state));
 }
 
+TEST(LighthouseEnabledTestCase, DistanceIsComparableToActionCosts)
+{
+    TravelTimeEstimator estimator{{500, 1000, 3, 10}};
+    actions::set_travel_time_estimator(&estimator);
+
+    state.lighthouse_is_on = false;
+    CHECK_EQUAL(actions::min_action_cost(), goal.distance_to(state));
+    CHECK(goal.distance_to(state) > 1);
+
+    actions::set_travel_time_estimator(nullptr);
+}
+
 TEST_GROUP (WindsocksUpTestCase) {
     goals::WindsocksUp goal;
     StrategyState state;
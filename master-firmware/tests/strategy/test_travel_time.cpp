@@ -0,0 +1,53 @@
+#include <cmath>
+#include <CppUTest/TestHarness.h>
+#include "strategy/travel_time.h"
+
+TEST_GROUP (RampDurationTestGroup) {
+};
+
+TEST(RampDurationTestGroup, LongMoveReachesFullSpeed)
+{
+    // 0.5s to accelerate to 500mm/s over 125mm, 1.5s at full speed over
+    // 750mm, then 0.5s to brake over 125mm.
+    DOUBLES_EQUAL(2.5, ramp_duration(1000, 500, 1000), 1e-5);
+}
+
+TEST(RampDurationTestGroup, ShortMoveNeverReachesFullSpeed)
+{
+    // Accelerate over 50mm, then brake over 50mm
+    DOUBLES_EQUAL(2 * std::sqrt(0.1), ramp_duration(100, 500, 1000), 1e-5);
+}
+
+TEST(RampDurationTestGroup, BackwardMoveTakesAsLong)
+{
+    DOUBLES_EQUAL(ramp_duration(300, 500, 1000), ramp_duration(-300, 500, 1000), 1e-5);
+}
+
+TEST(RampDurationTestGroup, NoMoveTakesNoTime)
+{
+    DOUBLES_EQUAL(0, ramp_duration(0, 500, 1000), 1e-5);
+    DOUBLES_EQUAL(0, ramp_duration(100, 0, 1000), 1e-5);
+}
+
+TEST_GROUP (TravelTimeEstimatorTestGroup) {
+    TravelTimeEstimator estimator{{500, 1000, 3, 10}};
+};
+
+TEST(TravelTimeEstimatorTestGroup, StraightLineWithTurn)
+{
+    auto expected = ramp_duration(M_PI / 2, 3, 10) + ramp_duration(1000, 500, 1000);
+
+    DOUBLES_EQUAL(expected, estimator.travel_time(0, 0, 600, 800), 1e-5);
+}
+
+TEST(TravelTimeEstimatorTestGroup, StayingInPlaceTakesNoTime)
+{
+    DOUBLES_EQUAL(0, estimator.travel_time(100, 200, 100, 200), 1e-5);
+}
+
+TEST(TravelTimeEstimatorTestGroup, FollowsLimits)
+{
+    estimator.set_limits({1000, 1000, 3, 10});
+
+    DOUBLES_EQUAL(2, estimator.move_time(1000), 1e-5);
+}
@@ -0,0 +1,139 @@
+#include <CppUTest/TestHarness.h>
+
+#include "base/distance_field.h"
+
+// Distances are the ones of the cell centers, so points are taken on them
+TEST_GROUP (ADistanceField) {
+    DistanceField field{3000, 2000, 10, 500};
+
+    // Square of 200 mm centered on (1000, 1000)
+    point_t square_points[4] = {{900, 900}, {1100, 900}, {1100, 1100}, {900, 1100}};
+    poly_t square = {square_points, 4};
+};
+
+TEST(ADistanceField, isEmptyByDefault)
+{
+    CHECK_EQUAL(500, field.distance(1000, 1000));
+    CHECK_FALSE(field.is_occupied(1000, 1000));
+}
+
+TEST(ADistanceField, outsideOfTheTableIsOccupied)
+{
+    CHECK_TRUE(field.is_occupied(-1, 1000));
+    CHECK_TRUE(field.is_occupied(1000, 2001));
+    CHECK_TRUE(field.is_occupied(3001, 1000));
+}
+
+TEST(ADistanceField, givesDistanceToPolygon)
+{
+    field.add_polygon(square);
+
+    DOUBLES_EQUAL(205, field.distance(1305, 1005), 1);
+    DOUBLES_EQUAL(95, field.distance(1005, 805), 1);
+    DOUBLES_EQUAL(hypot(205, 205), field.distance(1305, 1305), 1);
+}
+
+TEST(ADistanceField, isNegativeInsidePolygons)
+{
+    field.add_polygon(square);
+
+    DOUBLES_EQUAL(-95, field.distance(1005, 1005), 1);
+    CHECK_TRUE(field.is_occupied(1050, 950));
+}
+
+TEST(ADistanceField, isClampedFarFromObstacles)
+{
+    field.add_polygon(square);
+
+    CHECK_EQUAL(500, field.distance(2000, 1000));
+}
+
+TEST(ADistanceField, keepsClosestObstacle)
+{
+    point_t other_points[4] = {{1300, 900}, {1400, 900}, {1400, 1100}, {1300, 1100}};
+    poly_t other = {other_points, 4};
+
+    field.add_polygon(square);
+    field.add_polygon(other);
+
+    DOUBLES_EQUAL(95, field.distance(1205, 1005), 1);
+    DOUBLES_EQUAL(45, field.distance(1255, 1005), 1);
+}
+
+TEST(ADistanceField, boundingBoxIsAnObstacle)
+{
+    bounding_box_t box = {100, 100, 2900, 1900};
+    field.add_boundingbox(box);
+
+    DOUBLES_EQUAL(105, field.distance(205, 1005), 1);
+    DOUBLES_EQUAL(-45, field.distance(55, 1005), 1);
+    CHECK_EQUAL(500, field.distance(1500, 1000));
+}
+
+TEST(ADistanceField, restoresRegion)
+{
+    DistanceField empty = field;
+    field.add_polygon(square);
+
+    field.restore(empty, field.region_around(square));
+
+    CHECK_EQUAL(500, field.distance(1000, 1000));
+}
+
+TEST(ADistanceField, addsPolygonOnlyInRegion)
+{
+    DistanceField::Region left = {0, 0, 100, 200};
+    field.add_polygon(square, left);
+
+    DOUBLES_EQUAL(5, field.distance(895, 1000), 1);
+    CHECK_EQUAL(500, field.distance(1105, 1000));
+}
+
+TEST(ADistanceField, regionsMerge)
+{
+    DistanceField::Region empty = {0, 0, 0, 0};
+    DistanceField::Region a = {10, 10, 20, 20};
+    DistanceField::Region b = {15, 5, 30, 15};
+
+    auto merged = a.merge(b);
+
+    CHECK_EQUAL(10, merged.x1);
+    CHECK_EQUAL(5, merged.y1);
+    CHECK_EQUAL(30, merged.x2);
+    CHECK_EQUAL(20, merged.y2);
+    CHECK_EQUAL(20, empty.merge(a).x2);
+    CHECK_EQUAL(20, a.merge(empty).x2);
+}
+
+TEST(ADistanceField, segmentThroughObstacleIsNotClear)
+{
+    field.add_polygon(square);
+
+    CHECK_FALSE(field.segment_is_clear({500, 1000}, {1500, 1000}, 0));
+    CHECK_FALSE(field.segment_is_clear({1000, 1000}, {1000, 1500}, 0));
+}
+
+TEST(ADistanceField, segmentAwayFromObstacleIsClear)
+{
+    field.add_polygon(square);
+
+    CHECK_TRUE(field.segment_is_clear({500, 1200}, {1500, 1200}, 0));
+    CHECK_TRUE(field.segment_is_clear({500, 500}, {500, 500}, 0));
+}
+
+TEST(ADistanceField, segmentMustKeepClearance)
+{
+    field.add_polygon(square);
+
+    CHECK_TRUE(field.segment_is_clear({500, 1200}, {1500, 1200}, 50));
+    CHECK_FALSE(field.segment_is_clear({500, 1200}, {1500, 1200}, 150));
+}
+
+TEST(ADistanceField, segmentDoesNotSkipSmallObstacles)
+{
+    point_t post_points[4] = {{1995, 990}, {2015, 990}, {2015, 1010}, {1995, 1010}};
+    poly_t post = {post_points, 4};
+    field.add_polygon(post);
+
+    CHECK_FALSE(field.segment_is_clear({10, 1000}, {2990, 1000}, 0));
+}
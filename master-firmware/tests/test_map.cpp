@@ -245,34 +245,3 @@ TEST(MapEurobot2019, goesToThePuckInFrontOfTheRamp)
         CHECK_PATH_REACHES_GOAL(path, end);
     }
 };
-
-TEST_GROUP (AMap) {
-    struct _map map;
-
-    void setup()
-    {
-        map_init(&map, 0, true);
-        lock_mocks_enable(true);
-    }
-
-    void teardown()
-    {
-        lock_mocks_enable(false);
-    }
-};
-
-TEST(AMap, canSetOpponentObstacleAtomically)
-{
-    mock().expectOneCall("chMtxLock").withPointerParameter("lock", &map.lock);
-    mock().expectOneCall("chMtxUnlock").withPointerParameter("lock", &map.lock);
-
-    map_set_opponent_obstacle(&map, 0, 0, 0, 0, 0);
-}
-
-TEST(AMap, canUpdateOpponentObstacleAtomically)
-{
-    mock().expectOneCall("chMtxLock").withPointerParameter("lock", &map.lock);
-    mock().expectOneCall("chMtxUnlock").withPointerParameter("lock", &map.lock);
-
-    map_update_opponent_obstacle(&map, 0, 0, 0, 0);
-}
@@ -0,0 +1,222 @@
+#include <thread>
+#include <CppUTest/TestHarness.h>
+
+#include "base/map_snapshot.h"
+
+TEST_GROUP (AMapSnapshot) {
+    const int robot_size = 200;
+    const int opponent_size = 300;
+    MapWriter map{robot_size, opponent_size, true};
+
+    void teardown() override
+    {
+        map_snapshot_publish(nullptr);
+    }
+};
+
+TEST(AMapSnapshot, isNotModifiedByLaterChanges)
+{
+    auto before = map.snapshot();
+
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    auto after = map.snapshot();
+
+    CHECK_FALSE(before->opponent(0).present);
+    CHECK_TRUE(after->opponent(0).present);
+    CHECK_EQUAL(1000, after->opponent(0).x);
+    CHECK_EQUAL(before->version() + 1, after->version());
+}
+
+TEST(AMapSnapshot, isOnlyBuiltAgainWhenObstaclesChange)
+{
+    auto before = map.snapshot();
+
+    CHECK_FALSE(map.has_changed());
+    map.opponents_lost();
+    map.ally_lost();
+    CHECK_FALSE(map.has_changed());
+
+    POINTERS_EQUAL(before.get(), map.snapshot().get());
+}
+
+TEST(AMapSnapshot, seeingTheAllyAtTheSamePlaceIsNotAChange)
+{
+    map.ally_seen(1000, 500);
+    map.snapshot();
+
+    map.ally_seen(1000, 500);
+
+    CHECK_FALSE(map.has_changed());
+}
+
+TEST(AMapSnapshot, keepsTheLastPositionOfEachOpponent)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    map.opponent_tracked(1, 1100, 500, 0, 0);
+    map.opponent_tracked(0, 1200, 500, 0, 0);
+    auto snapshot = map.snapshot();
+
+    CHECK_EQUAL(1200, snapshot->opponent(0).x);
+    CHECK_EQUAL(1100, snapshot->opponent(1).x);
+}
+
+TEST(AMapSnapshot, segmentThroughOpponentIsNotClear)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    auto snapshot = map.snapshot();
+
+    CHECK_FALSE(snapshot->segment_is_clear({500, 500}, {1500, 500}));
+    CHECK_TRUE(snapshot->segment_is_clear({500, 1000}, {1500, 1000}));
+}
+
+TEST(AMapSnapshot, segmentStartingInObstacleIsNotClear)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    auto snapshot = map.snapshot();
+
+    CHECK_FALSE(snapshot->segment_is_clear({1000, 500}, {1000, 1000}));
+}
+
+TEST(AMapSnapshot, tableBordersAreObstacles)
+{
+    auto snapshot = map.snapshot();
+
+    CHECK_TRUE(snapshot->clearance(50, 1000) < 0);
+    DOUBLES_EQUAL(50, snapshot->clearance(1500, 150), MAP_DISTANCE_FIELD_CELL_MM);
+}
+
+TEST(AMapSnapshot, clearanceAccountsForRobots)
+{
+    auto empty = map.snapshot();
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    map.ally_seen(2000, 1000);
+    auto snapshot = map.snapshot();
+
+    CHECK_TRUE(snapshot->clearance(1000, 500) < 0);
+    CHECK_TRUE(snapshot->clearance(2000, 1000) < 0);
+    CHECK_TRUE(empty->clearance(1000, 500) > 0);
+    CHECK_TRUE(empty->clearance(2000, 1000) > 0);
+}
+
+TEST(AMapSnapshot, robotsWhichWereNotSeenAreNotObstacles)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    map.ally_seen(2000, 1000);
+    map.opponents_lost();
+    map.ally_lost();
+    auto snapshot = map.snapshot();
+
+    CHECK_TRUE(snapshot->clearance(1000, 500) > 0);
+    CHECK_TRUE(snapshot->clearance(2000, 1000) > 0);
+}
+
+TEST(AMapSnapshot, movingRobotsOnlyLeaveTheirNewPosition)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    map.opponent_tracked(1, 1500, 500, 0, 0);
+    map.opponent_tracked(0, 2000, 500, 0, 0);
+    auto snapshot = map.snapshot();
+
+    CHECK_TRUE(snapshot->clearance(1000, 500) > 0);
+    CHECK_TRUE(snapshot->clearance(1500, 500) < 0);
+    CHECK_TRUE(snapshot->clearance(2000, 500) < 0);
+}
+
+TEST(AMapSnapshot, trackedOpponentCoversItsPredictedMotion)
+{
+    // Moving at 1 m/s towards +x
+    map.opponent_tracked(0, 1000, 500, 1000, 0);
+    auto snapshot = map.snapshot();
+
+    CHECK_TRUE(snapshot->clearance(1000, 500) < 0);
+    CHECK_TRUE(snapshot->clearance(1000 + 1000 * MAP_OPPONENT_PREDICTION_S, 500) < 0);
+    CHECK_TRUE(snapshot->clearance(1000 - 1000 * MAP_OPPONENT_PREDICTION_S, 500) > 0);
+    CHECK_EQUAL(1000, snapshot->opponent(0).vx);
+}
+
+TEST(AMapSnapshot, trackedOpponentKeepsItsSlot)
+{
+    map.opponent_tracked(1, 1000, 500, 0, 0);
+    map.opponent_tracked(1, 1600, 500, 0, 0);
+    auto snapshot = map.snapshot();
+
+    CHECK_FALSE(snapshot->opponent(0).present);
+    CHECK_EQUAL(1600, snapshot->opponent(1).x);
+    CHECK_TRUE(snapshot->clearance(1000, 500) > 0);
+}
+
+TEST(AMapSnapshot, opponentIsLostIndividually)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    map.opponent_tracked(1, 2000, 500, 0, 0);
+    map.opponent_lost(0);
+    auto snapshot = map.snapshot();
+
+    CHECK_FALSE(snapshot->opponent(0).present);
+    CHECK_TRUE(snapshot->opponent(1).present);
+    CHECK_TRUE(snapshot->clearance(1000, 500) > 0);
+}
+
+TEST(AMapSnapshot, fillsObstacleAvoidance)
+{
+    struct obstacle_avoidance without_robots, with_opponent, opponent_ignored;
+    oa_init(&without_robots);
+    oa_init(&with_opponent);
+    oa_init(&opponent_ignored);
+
+    CHECK_TRUE(map.snapshot()->fill(&without_robots, true));
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    CHECK_TRUE(map.snapshot()->fill(&with_opponent, true));
+    CHECK_TRUE(map.snapshot()->fill(&opponent_ignored, false));
+
+    CHECK_EQUAL(without_robots.cur_poly_idx + 1, with_opponent.cur_poly_idx);
+    CHECK_EQUAL(without_robots.cur_poly_idx, opponent_ignored.cur_poly_idx);
+}
+
+TEST(AMapSnapshot, isPublished)
+{
+    POINTERS_EQUAL(nullptr, map_snapshot_get().get());
+
+    auto snapshot = map.snapshot();
+    map_snapshot_publish(snapshot);
+
+    POINTERS_EQUAL(snapshot.get(), map_snapshot_get().get());
+}
+
+TEST(AMapSnapshot, staysValidWhileHeld)
+{
+    map_snapshot_publish(map.snapshot());
+    auto held = map_snapshot_get();
+
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    map_snapshot_publish(map.snapshot());
+
+    CHECK_FALSE(held->opponent(0).present);
+    CHECK_TRUE(map_snapshot_get()->opponent(0).present);
+}
+
+TEST(AMapSnapshot, canBeReadWhileWriterPublishes)
+{
+    map_snapshot_publish(map.snapshot());
+
+    std::thread writer([&]() {
+        for (int i = 0; i < 1000; i++) {
+            map.opponent_tracked(i % MAP_NUM_OPPONENT, 500 + i, 500, 0, 0);
+            map_snapshot_publish(map.snapshot());
+        }
+    });
+
+    uint32_t last_version = 0;
+    bool versions_increase = true;
+    for (int i = 0; i < 1000; i++) {
+        auto snapshot = map_snapshot_get();
+        versions_increase = versions_increase && snapshot->version() >= last_version;
+        last_version = snapshot->version();
+        snapshot->segment_is_clear({500, 1000}, {1500, 1000});
+    }
+
+    writer.join();
+
+    CHECK_TRUE(versions_increase);
+    CHECK_EQUAL(1001, map_snapshot_get()->version());
+}
@@ -0,0 +1,156 @@
+#include <cmath>
+#include <CppUTest/TestHarness.h>
+
+#include "base/opponent_tracker.h"
+
+namespace {
+const uint64_t period_us = 100000; // 10 Hz beacon
+}
+
+TEST_GROUP (AnOpponentTracker) {
+    OpponentTracker tracker;
+    float noise[2][2] = {{400, 0}, {0, 400}}; // 20 mm standard deviation
+};
+
+TEST(AnOpponentTracker, hasNoTrackByDefault)
+{
+    CHECK_EQUAL(0, tracker.tracks(0).size());
+}
+
+TEST(AnOpponentTracker, needsSeveralReadingsToReportATrack)
+{
+    tracker.update(0, 1000, 500, noise);
+    CHECK_EQUAL(0, tracker.tracks(0).size());
+
+    tracker.update(period_us, 1000, 500, noise);
+    auto tracks = tracker.tracks(period_us);
+
+    CHECK_EQUAL(1, tracks.size());
+    DOUBLES_EQUAL(1000, tracks[0].x, 1);
+    DOUBLES_EQUAL(500, tracks[0].y, 1);
+    DOUBLES_EQUAL(0, tracks[0].vx, 10);
+}
+
+TEST(AnOpponentTracker, estimatesSpeed)
+{
+    // Moving at 500 mm/s along x
+    for (auto i = 0; i < 20; i++) {
+        tracker.update(i * period_us, 1000 + 50 * i, 500, noise);
+    }
+
+    auto tracks = tracker.tracks(19 * period_us);
+
+    CHECK_EQUAL(1, tracks.size());
+    DOUBLES_EQUAL(500, tracks[0].vx, 20);
+    DOUBLES_EQUAL(0, tracks[0].vy, 20);
+}
+
+TEST(AnOpponentTracker, predictsPosition)
+{
+    for (auto i = 0; i < 20; i++) {
+        tracker.update(i * period_us, 1000 + 50 * i, 500, noise);
+    }
+
+    auto tracks = tracker.tracks(21 * period_us);
+
+    DOUBLES_EQUAL(2050, tracks[0].x, 20);
+    CHECK_EQUAL(19 * period_us, tracks[0].last_seen_us);
+}
+
+TEST(AnOpponentTracker, predictionIsLessCertain)
+{
+    tracker.update(0, 1000, 500, noise);
+    tracker.update(period_us, 1000, 500, noise);
+
+    auto now = tracker.tracks(period_us);
+    auto later = tracker.tracks(3 * period_us);
+
+    CHECK_TRUE(later[0].covariance[0][0] > now[0].covariance[0][0]);
+    CHECK_TRUE(later[0].covariance[2][2] > now[0].covariance[2][2]);
+}
+
+TEST(AnOpponentTracker, filtersNoise)
+{
+    const float offsets[] = {15, -20, 10, -5, 25, -15, 5, -10, 20, -25};
+    for (auto i = 0; i < 10; i++) {
+        tracker.update(i * period_us, 1000 + offsets[i], 500 - offsets[i], noise);
+    }
+
+    auto tracks = tracker.tracks(9 * period_us);
+
+    DOUBLES_EQUAL(1000, tracks[0].x, 15);
+    DOUBLES_EQUAL(500, tracks[0].y, 15);
+    CHECK_TRUE(tracks[0].covariance[0][0] < noise[0][0]);
+}
+
+TEST(AnOpponentTracker, tracksTwoOpponents)
+{
+    for (auto i = 0; i < 10; i++) {
+        // The beacon sees the opponents one after the other
+        tracker.update(i * period_us, 1000 + 30 * i, 500, noise);
+        tracker.update(i * period_us + period_us / 2, 2000, 1500 - 30 * i, noise);
+    }
+
+    auto tracks = tracker.tracks(10 * period_us);
+
+    CHECK_EQUAL(2, tracks.size());
+    CHECK_TRUE(tracks[0].id != tracks[1].id);
+    DOUBLES_EQUAL(300, tracks[0].vx, 30);
+    DOUBLES_EQUAL(-300, tracks[1].vy, 30);
+}
+
+TEST(AnOpponentTracker, keepsTrackIdentity)
+{
+    tracker.update(0, 1000, 500, noise);
+    tracker.update(period_us, 1000, 500, noise);
+    auto id = tracker.tracks(period_us)[0].id;
+
+    tracker.update(2 * period_us, 1020, 510, noise);
+
+    CHECK_EQUAL(id, tracker.tracks(2 * period_us)[0].id);
+}
+
+TEST(AnOpponentTracker, dropsOldTracks)
+{
+    tracker.update(0, 1000, 500, noise);
+    tracker.update(period_us, 1000, 500, noise);
+
+    CHECK_EQUAL(1, tracker.tracks(period_us + OPPONENT_TRACKER_MAX_AGE_US).size());
+    CHECK_EQUAL(0, tracker.tracks(period_us + OPPONENT_TRACKER_MAX_AGE_US + 1).size());
+
+    // The dropped track is not continued
+    tracker.update(period_us + OPPONENT_TRACKER_MAX_AGE_US + 2, 1000, 500, noise);
+    CHECK_EQUAL(0, tracker.tracks(period_us + OPPONENT_TRACKER_MAX_AGE_US + 2).size());
+}
+
+TEST(AnOpponentTracker, replacesOldestTrackWhenFull)
+{
+    for (auto i = 0; i < OPPONENT_TRACKER_MAX_TRACKS; i++) {
+        tracker.update(i, 500 * i, 500, noise);
+        tracker.update(i + 10, 500 * i, 500, noise);
+    }
+
+    tracker.update(100, 500, 1800, noise);
+    tracker.update(101, 500, 1800, noise);
+    auto tracks = tracker.tracks(101);
+
+    CHECK_EQUAL(OPPONENT_TRACKER_MAX_TRACKS, tracks.size());
+    for (const auto& track : tracks) {
+        CHECK_FALSE(track.x == 0 && track.y == 500);
+    }
+}
+
+TEST(AnOpponentTracker, rangeBearingCovarianceFollowsBearing)
+{
+    float covariance[2][2];
+
+    // Looking along x, the range error is along x and the bearing error along y
+    OpponentTracker::range_bearing_covariance(1000, 0, 50, 0.1, covariance);
+    DOUBLES_EQUAL(2500, covariance[0][0], 1);
+    DOUBLES_EQUAL(10000, covariance[1][1], 1);
+    DOUBLES_EQUAL(0, covariance[0][1], 1);
+
+    OpponentTracker::range_bearing_covariance(1000, M_PI / 2, 50, 0.1, covariance);
+    DOUBLES_EQUAL(10000, covariance[0][0], 1);
+    DOUBLES_EQUAL(2500, covariance[1][1], 1);
+}
@@ -0,0 +1,266 @@
+#include <CppUTest/TestHarness.h>
+
+#include "base/path_planner.h"
+
+namespace {
+PathGoal make_goal(uint32_t id, float x, float y, bool ignore_opponent = false)
+{
+    PathGoal goal = PathGoal_init_default;
+    goal.id = id;
+    goal.active = true;
+    goal.x = x;
+    goal.y = y;
+    goal.ignore_opponent = ignore_opponent;
+    return goal;
+}
+
+bool path_is_straight(const Path& path, float x, float y)
+{
+    return path.waypoints_count == 1 && path.waypoints[0].x == x && path.waypoints[0].y == y;
+}
+} // namespace
+
+TEST_GROUP (APathPlanner) {
+    const int robot_size = 200;
+    const int opponent_size = 300;
+    MapWriter map{robot_size, opponent_size, true};
+    PathPlanner planner;
+    Path path = Path_init_default;
+};
+
+TEST(APathPlanner, doesNothingWithoutGoal)
+{
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, goesStraightWithoutObstacles)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+
+    CHECK_TRUE(path_is_straight(path, 1500, 500));
+    CHECK_EQUAL(1, path.goal_id);
+    CHECK_EQUAL(1, path.version);
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, goesAroundOpponent)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+
+    CHECK_TRUE(path.waypoints_count > 1);
+    CHECK_EQUAL(1500, path.waypoints[path.waypoints_count - 1].x);
+    CHECK_EQUAL(500, path.waypoints[path.waypoints_count - 1].y);
+}
+
+TEST(APathPlanner, roundsCornersAroundOpponent)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+
+    CHECK_TRUE(path.waypoints[0].turn_radius > 0);
+    CHECK_EQUAL(0, path.waypoints[path.waypoints_count - 1].turn_radius);
+}
+
+TEST(APathPlanner, goesThroughOpponentWhenIgnoringIt)
+{
+    planner.set_goal(make_goal(1, 1500, 500, true));
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+
+    CHECK_TRUE(path_is_straight(path, 1500, 500));
+}
+
+TEST(APathPlanner, replansWhenGoalChanges)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    planner.set_goal(make_goal(2, 1500, 800));
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+    CHECK_EQUAL(2, path.goal_id);
+    CHECK_EQUAL(2, path.version);
+}
+
+TEST(APathPlanner, sameGoalDoesNotTriggerReplan)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    planner.set_goal(make_goal(1, 1500, 500));
+
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, stopsPlanningWhenGoalIsInactive)
+{
+    auto goal = make_goal(1, 1500, 500);
+    planner.set_goal(goal);
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    goal.active = false;
+    planner.set_goal(goal);
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, replansWhenOpponentAppears)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, replansWhenOpponentMovesFarEnough)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    map.opponent_tracked(0, 1000 + PATH_PLANNER_REPLAN_THRESHOLD_MM / 2, 500, 0, 0);
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+
+    map.opponent_tracked(0, 1000 + 2 * PATH_PLANNER_REPLAN_THRESHOLD_MM, 500, 0, 0);
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, replansWhenOpponentChangesDirection)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    planner.set_goal(make_goal(1, 1500, 1000));
+    planner.plan(*map.snapshot(), 500, 1000, path);
+
+    map.opponent_tracked(0, 1000, 500, 0, 500);
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, goesStraightWhenMovingOpponentWillBeGone)
+{
+    // Crosses the way well before the robot gets there
+    map.opponent_tracked(0, 1000, 300, 0, 1000);
+    planner.set_goal(make_goal(1, 1500, 700));
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 700, path));
+
+    CHECK_TRUE(path_is_straight(path, 1500, 700));
+    CHECK_EQUAL(1, path.waypoints[0].speed_factor);
+}
+
+TEST(APathPlanner, letsMovingOpponentPass)
+{
+    // Crosses the way when the robot gets there at full speed
+    map.opponent_tracked(0, 1000, 200, 0, 400);
+    planner.set_goal(make_goal(1, 1500, 700));
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 700, path));
+
+    CHECK_EQUAL(1500, path.waypoints[path.waypoints_count - 1].x);
+    CHECK_TRUE(path.waypoints_count > 1 || path.waypoints[0].speed_factor < 1);
+}
+
+TEST(APathPlanner, goesAroundOpponentStandingStill)
+{
+    map.opponent_tracked(0, 1000, 700, 0, 0);
+    planner.set_goal(make_goal(1, 1500, 700));
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 700, path));
+
+    CHECK_TRUE(path.waypoints_count > 1);
+    for (auto i = 0; i < path.waypoints_count; i++) {
+        CHECK_EQUAL(1, path.waypoints[i].speed_factor);
+    }
+}
+
+TEST(APathPlanner, replansWhenOpponentIsLost)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    map.opponents_lost();
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+    CHECK_TRUE(path_is_straight(path, 1500, 500));
+}
+
+TEST(APathPlanner, ignoredOpponentDoesNotTriggerReplan)
+{
+    planner.set_goal(make_goal(1, 1500, 500, true));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, replansWhenAllyMoves)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    // Not centered on the way, as the obstacle avoidance goes through the
+    // corners of the ally obstacle which are aligned with the goal
+    map.ally_seen(1000, 550);
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+    CHECK_TRUE(path.waypoints_count > 1);
+}
+
+TEST(APathPlanner, publishesEmptyPathWhenGoalCannotBeReached)
+{
+    map.opponent_tracked(0, 1500, 500, 0, 0);
+    planner.set_goal(make_goal(1, 1500, 500));
+
+    CHECK_TRUE(planner.plan(*map.snapshot(), 500, 500, path));
+
+    CHECK_EQUAL(1, path.goal_id);
+    CHECK_EQUAL(0, path.waypoints_count);
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, keepsPreviousPathWhenGoalCannotBeReachedAnymore)
+{
+    planner.set_goal(make_goal(1, 1500, 500));
+    planner.plan(*map.snapshot(), 500, 500, path);
+
+    map.opponent_tracked(0, 1500, 500, 0, 0);
+
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+    CHECK_FALSE(planner.plan(*map.snapshot(), 500, 500, path));
+    CHECK_TRUE(path_is_straight(path, 1500, 500));
+    CHECK_EQUAL(1, path.version);
+    CHECK_FALSE(planner.needs_replan(*map.snapshot()));
+}
+
+TEST(APathPlanner, onlyUsesTheGivenSnapshot)
+{
+    auto before_opponent = map.snapshot();
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    planner.set_goal(make_goal(1, 1500, 500));
+
+    CHECK_TRUE(planner.plan(*before_opponent, 500, 500, path));
+
+    CHECK_TRUE(path_is_straight(path, 1500, 500));
+    CHECK_TRUE(planner.needs_replan(*map.snapshot()));
+}
@@ -0,0 +1,138 @@
+#include <cmath>
+#include <CppUTest/TestHarness.h>
+
+#include "base/path_smoother.h"
+
+TEST_GROUP (ACornerArc) {
+    CornerArc arc;
+};
+
+TEST(ACornerArc, isTangentToBothSegments)
+{
+    CHECK_TRUE(path_corner_arc({0, 0}, {1000, 0}, {1000, 1000}, 200, arc));
+
+    DOUBLES_EQUAL(800, arc.entry.x, 0.1);
+    DOUBLES_EQUAL(0, arc.entry.y, 0.1);
+    DOUBLES_EQUAL(1000, arc.exit.x, 0.1);
+    DOUBLES_EQUAL(200, arc.exit.y, 0.1);
+    DOUBLES_EQUAL(800, arc.center.x, 0.1);
+    DOUBLES_EQUAL(200, arc.center.y, 0.1);
+    DOUBLES_EQUAL(M_PI / 2, arc.angle, 0.001);
+}
+
+TEST(ACornerArc, turnsClockwiseToTheRight)
+{
+    CHECK_TRUE(path_corner_arc({0, 0}, {1000, 0}, {1000, -1000}, 200, arc));
+
+    DOUBLES_EQUAL(800, arc.center.x, 0.1);
+    DOUBLES_EQUAL(-200, arc.center.y, 0.1);
+    DOUBLES_EQUAL(-M_PI / 2, arc.angle, 0.001);
+}
+
+TEST(ACornerArc, doesNotExistOnAStraightLine)
+{
+    CHECK_FALSE(path_corner_arc({0, 0}, {1000, 0}, {2000, 0}, 200, arc));
+}
+
+TEST(ACornerArc, mustFitOnTheSegments)
+{
+    CHECK_FALSE(path_corner_arc({0, 0}, {100, 0}, {100, 1000}, 200, arc));
+}
+
+TEST_GROUP (APathSmoother) {
+    MapWriter map{200, 300, false};
+    std::vector<TimedWaypoint> waypoints;
+    const point_t start = {500, 500};
+
+    void add_waypoint(float x, float y)
+    {
+        waypoints.push_back({{x, y}, 1, 0, 0});
+    }
+};
+
+TEST(APathSmoother, removesAlignedWaypoints)
+{
+    // Along the side of the opponent, so that they cannot be skipped
+    map.opponent_tracked(0, 1000, 750, 0, 0);
+    add_waypoint(750, 500);
+    add_waypoint(1250, 500);
+    add_waypoint(1250, 1200);
+
+    path_shortcut(*map.snapshot(), start, waypoints, 15);
+
+    CHECK_EQUAL(2, waypoints.size());
+    CHECK_EQUAL(1250, waypoints[0].point.x);
+    CHECK_EQUAL(500, waypoints[0].point.y);
+}
+
+TEST(APathSmoother, goesStraightWhenPossible)
+{
+    add_waypoint(1000, 900);
+    add_waypoint(1500, 500);
+
+    path_shortcut(*map.snapshot(), start, waypoints, 0);
+
+    CHECK_EQUAL(1, waypoints.size());
+    CHECK_EQUAL(1500, waypoints[0].point.x);
+}
+
+TEST(APathSmoother, keepsWaypointsAroundObstacles)
+{
+    map.opponent_tracked(0, 1000, 500, 0, 0);
+    add_waypoint(750, 750);
+    add_waypoint(1250, 750);
+    add_waypoint(1500, 500);
+
+    path_shortcut(*map.snapshot(), start, waypoints, 15);
+
+    CHECK_EQUAL(3, waypoints.size());
+}
+
+TEST(APathSmoother, roundsCorners)
+{
+    add_waypoint(1500, 500);
+    add_waypoint(1800, 1000);
+
+    path_round_corners(*map.snapshot(), start, waypoints, 30);
+
+    CHECK_TRUE(waypoints[0].turn_radius >= PATH_SMOOTHER_MIN_RADIUS_MM);
+    CHECK_EQUAL(0, waypoints[1].turn_radius);
+}
+
+TEST(APathSmoother, limitsHowMuchCornersAreCut)
+{
+    add_waypoint(1500, 500);
+    add_waypoint(1500, 1200);
+
+    path_round_corners(*map.snapshot(), start, waypoints, 30);
+
+    CornerArc arc;
+    CHECK_TRUE(path_corner_arc(start, waypoints[0].point, waypoints[1].point, waypoints[0].turn_radius, arc));
+    const float cut = std::hypot(arc.center.x - 1500, arc.center.y - 500) - arc.radius;
+    CHECK_TRUE(cut <= 30.1);
+    CHECK_TRUE(cut > 25);
+}
+
+TEST(APathSmoother, sharesSegmentsBetweenCorners)
+{
+    add_waypoint(1500, 500);
+    add_waypoint(1500, 600);
+    add_waypoint(500, 600);
+
+    path_round_corners(*map.snapshot(), start, waypoints, 300);
+
+    CornerArc first, second;
+    CHECK_TRUE(path_corner_arc(start, waypoints[0].point, waypoints[1].point, waypoints[0].turn_radius, first));
+    CHECK_TRUE(path_corner_arc(waypoints[0].point, waypoints[1].point, waypoints[2].point, waypoints[1].turn_radius, second));
+    CHECK_TRUE(first.exit.y <= second.entry.y);
+}
+
+TEST(APathSmoother, leavesUTurnsSharp)
+{
+    add_waypoint(1500, 500);
+    add_waypoint(500, 500);
+
+    path_round_corners(*map.snapshot(), start, waypoints, 30);
+
+    CHECK_EQUAL(0, waypoints[0].turn_radius);
+}
@@ -0,0 +1,118 @@
+#include <CppUTest/TestHarness.h>
+
+#include "base/space_time_planner.h"
+
+TEST_GROUP (ASpaceTimePlanner) {
+    const float speed = 300;
+    SpaceTimePlanner planner{speed, 10};
+    struct obstacle_avoidance oa;
+    std::vector<MovingObstacle> obstacles;
+    std::vector<TimedWaypoint> path;
+
+    void setup() override
+    {
+        oa_init(&oa);
+        oa_set_boundingbox(&oa, 100, 100, 2900, 1900);
+        oa_start_end_points(&oa, 500, 1000, 2500, 1000);
+    }
+};
+
+TEST(ASpaceTimePlanner, goesStraightAtFullSpeedWithoutObstacles)
+{
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+
+    CHECK_EQUAL(1, path.size());
+    CHECK_EQUAL(2500, path[0].point.x);
+    CHECK_EQUAL(1, path[0].speed_factor);
+    DOUBLES_EQUAL(2000 / speed, path[0].arrival, 0.01);
+}
+
+TEST(ASpaceTimePlanner, goesAroundStaticObstacles)
+{
+    auto obstacle = oa_new_poly(&oa, 4);
+    oa_poly_set_point(&oa, obstacle, 1400, 800, 0);
+    oa_poly_set_point(&oa, obstacle, 1600, 800, 1);
+    oa_poly_set_point(&oa, obstacle, 1600, 1200, 2);
+    oa_poly_set_point(&oa, obstacle, 1400, 1200, 3);
+
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+
+    CHECK_EQUAL(3, path.size());
+    CHECK_EQUAL(2500, path[2].point.x);
+}
+
+TEST(ASpaceTimePlanner, ignoresObstaclesMovingAwayInTime)
+{
+    // Crosses the path well before the robot gets there
+    obstacles.push_back({1500, 700, 0, 1000, 250});
+
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+
+    CHECK_EQUAL(1, path.size());
+    CHECK_EQUAL(1, path[0].speed_factor);
+}
+
+TEST(ASpaceTimePlanner, slowsDownToPassBehindMovingObstacle)
+{
+    // Crosses the path when the robot gets there at full speed
+    obstacles.push_back({1500, 400, 0, 300, 250});
+
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+
+    CHECK_EQUAL(1, path.size());
+    CHECK_TRUE(path[0].speed_factor < 1);
+    CHECK_TRUE(path[0].arrival > 2000 / speed);
+}
+
+TEST(ASpaceTimePlanner, failsWhenObstacleStaysOnTheGoal)
+{
+    obstacles.push_back({2500, 1000, 0, 0, 250});
+
+    CHECK_FALSE(planner.plan(&oa, obstacles, path));
+    CHECK_EQUAL(0, path.size());
+}
+
+TEST(ASpaceTimePlanner, obstaclesStopAtTheHorizon)
+{
+    SpaceTimePlanner short_sighted{speed, 1};
+
+    // Would be gone before the robot gets there, but stops on the path
+    obstacles.push_back({1500, 700, 0, 300, 250});
+
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+    CHECK_FALSE(short_sighted.plan(&oa, obstacles, path));
+}
+
+TEST(ASpaceTimePlanner, detectsHeadOnCollision)
+{
+    MovingObstacle obstacle = {1500, 1000, -300, 0, 250};
+
+    CHECK_TRUE(planner.collides({500, 1000}, {2500, 1000}, 0, 6.7, obstacle));
+}
+
+TEST(ASpaceTimePlanner, detectsCrossingOnlyAtTheSameTime)
+{
+    MovingObstacle obstacle = {1500, 400, 0, 300, 250};
+
+    CHECK_TRUE(planner.collides({1000, 1000}, {2000, 1000}, 0, 2, obstacle));
+    CHECK_FALSE(planner.collides({1000, 1000}, {2000, 1000}, 0, 0.5, obstacle));
+}
+
+TEST(ASpaceTimePlanner, waitingInsideAnObstacleCollides)
+{
+    MovingObstacle obstacle = {1000, 1000, 0, 0, 250};
+
+    CHECK_TRUE(planner.collides({1100, 1000}, {1100, 1000}, 3, 3, obstacle));
+}
+
+TEST(ASpaceTimePlanner, canBeUsedSeveralTimes)
+{
+    obstacles.push_back({1500, 400, 0, 300, 250});
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+
+    obstacles.clear();
+    CHECK_TRUE(planner.plan(&oa, obstacles, path));
+
+    CHECK_EQUAL(1, path.size());
+    CHECK_EQUAL(1, path[0].speed_factor);
+}
@@ -1,9 +1,11 @@
 #include <vector>
 #include <array>
+#include <chrono>
 
 #include "robot_helpers/robot.h"
 #include "strategy/goals.h"
 #include "strategy/actions.h"
+#include <goap/anytime_planner.hpp>
 
 #include <CppUTest/TestHarness.h>
 
@@ -15,9 +17,10 @@ int compute_and_execute_plan(goap::Goal<StrategyState>& goal, StrategyState& sta
 {
     const int max_path_len = 40;
     goap::Action<StrategyState>* path[max_path_len] = {nullptr};
-    goap::Planner<StrategyState, GOAP_SPACE_SIZE> planner;
+    goap::AnytimePlanner<StrategyState> planner(GOAP_INITIAL_WEIGHT, GOAP_WEIGHT_STEP, GOAP_NODE_BUDGET);
 
-    int len = planner.plan(state, goal, actions.data(), actions.size(), path, max_path_len);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    int len = planner.plan(state, goal, actions.data(), actions.size(), deadline, path, max_path_len);
     for (int i = 0; i < len; i++) {
         path[i]->execute(state);
     }
@@ -101,7 +101,7 @@ TEST_GROUP (ADistanceToTargetPosition) {
     void setup()
     {
         oa_init(&map.oa);
-        polygon_set_boundingbox(0, 0, 3000, 2000);
+        oa_set_boundingbox(&map.oa, 0, 0, 3000, 2000);
 
         poly_t* obstacle = oa_new_poly(&map.oa, 4);
         obstacle->pts[0] = {400, 400};
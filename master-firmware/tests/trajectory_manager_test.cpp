@@ -134,3 +134,450 @@ TEST(TrajectoryManagerTestGroup, StartsTrajectoryInAngle)
 
     CHECK_EQUAL(RUNNING_A, traj.state);
 }
+
+TEST(TrajectoryManagerTestGroup, CirclesForwardCounterclockwise)
+{
+    position_set_physical_params(&pos, 200, 10);
+
+    trajectory_circle_rel(&traj, 0, 100, 100, 90, FORWARD | TRIGO);
+
+    absl::MutexLock l(&traj.lock_);
+    CHECK_EQUAL(RUNNING_CIRCLE, traj.state);
+    CHECK_TRUE(traj.target.circle.dest_angle > 0);
+    CHECK_TRUE(traj.target.circle.dest_distance > 0);
+}
+
+TEST(TrajectoryManagerTestGroup, CirclesForwardClockwise)
+{
+    position_set_physical_params(&pos, 200, 10);
+
+    trajectory_circle_rel(&traj, 0, -100, 100, 90, FORWARD);
+
+    absl::MutexLock l(&traj.lock_);
+    CHECK_TRUE(traj.target.circle.dest_angle < 0);
+    CHECK_TRUE(traj.target.circle.dest_distance > 0);
+}
+
+TEST(TrajectoryManagerTestGroup, TurnsTowardsCircleCenterOnTheRight)
+{
+    position_set_physical_params(&pos, 200, 10);
+    trajectory_circle_rel(&traj, 0, -100, 100, 90, FORWARD);
+
+    absl::MutexLock l(&traj.lock_);
+    absl::ReaderMutexLock lp(&traj.position->lock_);
+    trajectory_manager_circle_event(&traj);
+
+    // The robot is tangent to the circle, so it drives its full length
+    double d_speed, a_speed;
+    circle_get_speed_from_radius(&traj, 100, &d_speed, &a_speed);
+    DOUBLES_EQUAL(d_speed, get_quadramp_distance_speed(&traj), 0.01);
+    DOUBLES_EQUAL(a_speed, get_quadramp_angle_speed(&traj), 0.01);
+}
+
+TEST_GROUP (TrajectoryManagerWaypointsTestGroup) {
+    struct trajectory traj;
+    struct cs distance_cs, angle_cs;
+    struct quadramp_filter distance_qr, angle_qr;
+    struct robot_position pos;
+    struct robot_system rs;
+
+    const double max_speed = 10;
+    const float imp_per_mm = 10;
+
+    void setup() override
+    {
+        quadramp_init(&angle_qr);
+        quadramp_init(&distance_qr);
+
+        cs_init(&distance_cs);
+        cs_init(&angle_cs);
+        cs_set_consign_filter(&distance_cs, quadramp_do_filter, &distance_qr);
+        cs_set_consign_filter(&angle_cs, quadramp_do_filter, &angle_qr);
+
+        rs_init(&rs);
+        position_init(&pos);
+        position_set_physical_params(&pos, 200, imp_per_mm);
+        position_set(&pos, 0, 0, 0);
+
+        trajectory_manager_init(&traj, 20);
+        trajectory_set_cs(&traj, &distance_cs, &angle_cs);
+        trajectory_set_robot_params(&traj, &rs, &pos);
+        trajectory_set_windows(&traj, 10, 1, 10);
+        trajectory_set_acc(&traj, 1, 1);
+        trajectory_set_speed(&traj, max_speed, max_speed);
+    }
+
+    void run_event()
+    {
+        absl::MutexLock l(&traj.lock_);
+        absl::ReaderMutexLock lp(&traj.position->lock_);
+        trajectory_manager_xy_event(&traj);
+    }
+};
+
+TEST(TrajectoryManagerWaypointsTestGroup, GoesThroughAlignedPointsAtFullSpeed)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}, {3000, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 3);
+
+    absl::MutexLock l(&traj.lock_);
+    DOUBLES_EQUAL(max_speed, traj.waypoints.pass_speed[0], 0.01);
+    DOUBLES_EQUAL(max_speed, traj.waypoints.pass_speed[1], 0.01);
+    DOUBLES_EQUAL(0, traj.waypoints.pass_speed[2], 0.01);
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, SlowsDownToTurn)
+{
+    // 5 degrees is half the angle start window, 90 is outside of it
+    point_t points[] = {{1000, 0}, {2000, 1000 * tan(RAD(5))}, {2000, 1000}, {3000, 1000}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 4);
+
+    absl::MutexLock l(&traj.lock_);
+    DOUBLES_EQUAL(max_speed / 2, traj.waypoints.pass_speed[0], 0.01);
+    DOUBLES_EQUAL(0, traj.waypoints.pass_speed[1], 0.01);
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, SlowsDownInTimeForTheNextPoints)
+{
+    // Braking from v over d takes v^2 = 2 * acc * d
+    point_t points[] = {{1000, 0}, {1000 + 2 * 2 / 2 / imp_per_mm, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 2);
+
+    absl::MutexLock l(&traj.lock_);
+    DOUBLES_EQUAL(2, traj.waypoints.pass_speed[0], 0.01);
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, UsesSpeedFactors)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}, {3000, 0}};
+    float factors[] = {1, 0.5, 1};
+    trajectory_goto_waypoints_abs(&traj, points, factors, 3);
+
+    absl::MutexLock l(&traj.lock_);
+    DOUBLES_EQUAL(max_speed / 2, traj.waypoints.pass_speed[0], 0.01);
+    DOUBLES_EQUAL(max_speed / 2, traj.waypoints.pass_speed[1], 0.01);
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, AimsPastIntermediatePoints)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 2);
+
+    run_event();
+    run_event();
+
+    // Stopping from full speed takes v^2 / (2 * acc)
+    const int32_t expected = 1000 * imp_per_mm + max_speed * max_speed / 2;
+    CHECK_EQUAL(expected, cs_get_consign(&distance_cs));
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, GoesOnToTheNextPointWithoutStopping)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 2);
+    run_event();
+    run_event();
+
+    position_set(&pos, 995, 0, 0);
+    run_event();
+
+    CHECK_EQUAL(1, trajectory_get_waypoint_index(&traj));
+    absl::MutexLock l(&traj.lock_);
+    CHECK_TRUE(traj.scheduled);
+    CHECK_EQUAL(2000, traj.target.cart.x);
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, GoesOnWhenPassingAPointOutsideTheWindow)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}, {3000, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 3);
+    run_event();
+    run_event();
+    position_set(&pos, 1000, 0, 0);
+    run_event();
+
+    position_set(&pos, 2050, 30, 0);
+    run_event();
+
+    CHECK_EQUAL(2, trajectory_get_waypoint_index(&traj));
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, IsOnlyNearlyFinishedAtTheLastPoint)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 2);
+    run_event();
+    run_event();
+
+    position_set(&pos, 1000, 0, 0);
+    CHECK_FALSE(trajectory_in_window(&traj, 10, 1));
+    CHECK_FALSE(trajectory_distance_finished(&traj));
+
+    run_event();
+    position_set(&pos, 2000, 0, 0);
+    CHECK_TRUE(trajectory_in_window(&traj, 10, 1));
+}
+
+TEST(TrajectoryManagerWaypointsTestGroup, OtherCommandsForgetThePoints)
+{
+    point_t points[] = {{1000, 0}, {2000, 0}};
+    trajectory_goto_waypoints_abs(&traj, points, nullptr, 2);
+
+    trajectory_goto_xy_abs(&traj, 500, 0);
+
+    CHECK_EQUAL(-1, trajectory_get_waypoint_index(&traj));
+}
+
+TEST_GROUP (TrajectoryManagerPathTestGroup) {
+    struct trajectory traj;
+    struct cs distance_cs, angle_cs;
+    struct quadramp_filter distance_qr, angle_qr;
+    struct robot_position pos;
+    struct robot_system rs;
+
+    const double imp_per_mm = 100, track_mm = 200;
+    const double cs_hz = 100;
+    int32_t distance = 0, angle = 0;
+
+    void setup() override
+    {
+        quadramp_init(&angle_qr);
+        quadramp_init(&distance_qr);
+
+        cs_init(&distance_cs);
+        cs_init(&angle_cs);
+        cs_set_consign_filter(&distance_cs, quadramp_do_filter, &distance_qr);
+        cs_set_consign_filter(&angle_cs, quadramp_do_filter, &angle_qr);
+
+        rs_init(&rs);
+        position_init(&pos);
+        position_set_physical_params(&pos, track_mm, imp_per_mm);
+        position_set(&pos, 0, 0, 0);
+
+        trajectory_manager_init(&traj, cs_hz);
+        trajectory_set_cs(&traj, &distance_cs, &angle_cs);
+        trajectory_set_robot_params(&traj, &rs, &pos);
+        trajectory_set_windows(&traj, 5, 1, 40);
+
+        // 500 mm/s and 3 rad/s, 2 m/s^2 and 30 rad/s^2
+        trajectory_set_speed(&traj, 500, 300);
+        trajectory_set_acc(&traj, 20, 30);
+    }
+
+    // Runs one period, the wheels following the output of the ramps
+    void step()
+    {
+        trajectory_manager_manage(&traj);
+
+        cs_do_process(&distance_cs, cs_get_consign(&distance_cs));
+        cs_do_process(&angle_cs, cs_get_consign(&angle_cs));
+
+        const double d = (cs_get_filtered_consign(&distance_cs) - distance) / imp_per_mm;
+        const double a = (cs_get_filtered_consign(&angle_cs) - angle) / (imp_per_mm * track_mm / 2);
+        distance = cs_get_filtered_consign(&distance_cs);
+        angle = cs_get_filtered_consign(&angle_cs);
+
+        absl::MutexLock lp(&pos.lock_);
+        pos.pos_d.x += d * cos(pos.pos_d.a + a / 2);
+        pos.pos_d.y += d * sin(pos.pos_d.a + a / 2);
+        pos.pos_d.a += a;
+    }
+
+    // Runs until the trajectory is finished, returns the furthest the robot
+    // went from the segments of the path
+    double run(const point_t* points, int count, int max_periods = 5000)
+    {
+        double max_error = 0;
+        for (auto i = 0; i < max_periods && !trajectory_finished(&traj); i++) {
+            step();
+
+            double error = INFINITY;
+            point_t from = {0, 0};
+            for (auto j = 0; j < count; j++) {
+                error = fmin(error, distance_to_segment(from, points[j]));
+                from = points[j];
+            }
+            max_error = fmax(max_error, error);
+        }
+        return max_error;
+    }
+
+    double distance_to_segment(point_t a, point_t b)
+    {
+        absl::ReaderMutexLock lp(&pos.lock_);
+        const double dx = b.x - a.x, dy = b.y - a.y;
+        double t = ((pos.pos_d.x - a.x) * dx + (pos.pos_d.y - a.y) * dy) / (dx * dx + dy * dy);
+        t = fmin(fmax(t, 0), 1);
+        return hypot(pos.pos_d.x - a.x - t * dx, pos.pos_d.y - a.y - t * dy);
+    }
+
+    double distance_to(point_t p)
+    {
+        absl::ReaderMutexLock lp(&pos.lock_);
+        return hypot(pos.pos_d.x - p.x, pos.pos_d.y - p.y);
+    }
+};
+
+TEST(TrajectoryManagerPathTestGroup, StartsFollowingThePath)
+{
+    point_t points[] = {{500, 0}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 1);
+
+    absl::MutexLock l(&traj.lock_);
+    CHECK_TRUE(traj.scheduled);
+    CHECK_EQUAL(RUNNING_PATH, traj.state);
+    CHECK_EQUAL(2, traj.target.path.count);
+}
+
+TEST(TrajectoryManagerPathTestGroup, DrivesToTheEndOfAStraightLine)
+{
+    point_t points[] = {{500, 0}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 1);
+
+    const double error = run(points, 1);
+
+    CHECK_TRUE(trajectory_finished(&traj));
+    CHECK_TRUE(distance_to(points[0]) < 5);
+    CHECK_TRUE(error < 1);
+}
+
+TEST(TrajectoryManagerPathTestGroup, IsNotFinishedWhileFollowing)
+{
+    point_t points[] = {{500, 0}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 1);
+
+    for (auto i = 0; i < 20; i++) {
+        step();
+    }
+
+    CHECK_FALSE(trajectory_finished(&traj));
+    CHECK_FALSE(trajectory_nearly_finished(&traj));
+}
+
+TEST(TrajectoryManagerPathTestGroup, ReachesFullSpeed)
+{
+    point_t points[] = {{1000, 0}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 1);
+
+    for (auto i = 0; i < 100; i++) {
+        step();
+    }
+
+    DOUBLES_EQUAL(500, distance_qr.previous_var, 0.01);
+}
+
+TEST(TrajectoryManagerPathTestGroup, StaysOnACurveWithoutStopping)
+{
+    // Circle of 300 mm, sampled every 10 degrees for 100 degrees
+    point_t points[10];
+    for (auto i = 0; i < 10; i++) {
+        const double a = RAD(10 * (i + 1));
+        points[i] = {static_cast<float>(300 * sin(a)), static_cast<float>(300 - 300 * cos(a))};
+    }
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 10);
+
+    {
+        absl::MutexLock l(&traj.lock_);
+        for (auto i = 1; i < 10; i++) {
+            CHECK_TRUE(traj.target.path.speed[i] > 0);
+        }
+    }
+
+    const double error = run(points, 10);
+
+    CHECK_TRUE(trajectory_finished(&traj));
+    CHECK_TRUE(distance_to(points[9]) < 5);
+    CHECK_TRUE(error < 5);
+}
+
+TEST(TrajectoryManagerPathTestGroup, SlowsDownInTightCurves)
+{
+    // Half of a circle of 50 mm, sampled every 10 degrees
+    point_t points[18];
+    for (auto i = 0; i < 18; i++) {
+        const double a = RAD(10 * (i + 1));
+        points[i] = {static_cast<float>(50 * sin(a)), static_cast<float>(50 - 50 * cos(a))};
+    }
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 18);
+
+    // The angular speed is the speed divided by the radius
+    absl::MutexLock l(&traj.lock_);
+    const double turn_speed = 300 / (imp_per_mm * track_mm / 2);
+    DOUBLES_EQUAL(turn_speed * 50, traj.target.path.speed[9], turn_speed * 50 * 0.01);
+}
+
+TEST(TrajectoryManagerPathTestGroup, TurnsInPlaceAtSharpCorners)
+{
+    point_t points[] = {{300, 0}, {300, 300}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 2);
+
+    {
+        absl::MutexLock l(&traj.lock_);
+        DOUBLES_EQUAL(0, traj.target.path.speed[1], 1e-6);
+        CHECK_TRUE(traj.target.path.departure[1] > traj.target.path.arrival[1]);
+    }
+
+    const double error = run(points, 2);
+
+    CHECK_TRUE(distance_to(points[1]) < 5);
+    CHECK_TRUE(error < 5);
+}
+
+TEST(TrajectoryManagerPathTestGroup, DoesNotArriveBeforeTheGivenTime)
+{
+    point_t points[] = {{100, 0}, {200, 0}};
+    float arrival_s[] = {0, 10};
+    trajectory_follow_path_abs(&traj, points, nullptr, arrival_s, 2);
+
+    {
+        absl::MutexLock l(&traj.lock_);
+        DOUBLES_EQUAL(10 * cs_hz, traj.target.path.arrival[2], 1e-3);
+    }
+
+    for (auto i = 0; i < 500; i++) {
+        step();
+    }
+
+    CHECK_FALSE(trajectory_nearly_finished(&traj));
+    CHECK_TRUE(distance_to(points[1]) < 100);
+}
+
+TEST(TrajectoryManagerPathTestGroup, UsesSpeedFactors)
+{
+    point_t points[] = {{1000, 0}};
+    float factors[] = {0.5};
+    trajectory_follow_path_abs(&traj, points, factors, nullptr, 1);
+
+    for (auto i = 0; i < 100; i++) {
+        step();
+    }
+    const int32_t start = distance;
+    for (auto i = 0; i < 100; i++) {
+        step();
+    }
+
+    CHECK_EQUAL(100 * 250, distance - start);
+}
+
+TEST(TrajectoryManagerPathTestGroup, ReportsThePointItGoesTo)
+{
+    point_t points[] = {{100, 0}, {200, 0}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 2);
+    CHECK_EQUAL(0, trajectory_get_waypoint_index(&traj));
+
+    while (distance_to(points[1]) > 80) {
+        step();
+    }
+
+    CHECK_EQUAL(1, trajectory_get_waypoint_index(&traj));
+}
+
+TEST(TrajectoryManagerPathTestGroup, OtherCommandsStopFollowing)
+{
+    point_t points[] = {{500, 0}};
+    trajectory_follow_path_abs(&traj, points, nullptr, nullptr, 1);
+
+    trajectory_goto_xy_abs(&traj, 100, 0);
+
+    CHECK_EQUAL(-1, trajectory_get_waypoint_index(&traj));
+}
@@ -16,8 +16,11 @@ struct Proxy : public ProxyBase {
     {
     }
 
+    int topic_name_calls = 0;
+
     std::string topic_name(absl::string_view board_name) override
     {
+        topic_name_calls++;
         return absl::StrCat("/", board_name);
     }
 
@@ -77,6 +80,40 @@ TEST(ProxyTestGroup, DoesNotDoubleTopic)
     CHECK_EQUAL(topic1, topic2);
 }
 
+TEST(ProxyTestGroup, ResolvesTopicOnlyOnFirstMessage)
+{
+    bus_enumerator_update_node_info(&be, "myboard", 42);
+    proxy.process(signal, 42);
+    proxy.process(signal, 42);
+    proxy.process(signal, 42);
+    CHECK_EQUAL(1, proxy.topic_name_calls);
+}
+
+TEST(ProxyTestGroup, UnknownBoardIsResolvedOnceDiscovered)
+{
+    proxy.process(signal, 42);
+    CHECK_FALSE(messagebus_find_topic(&bus, "/myboard"));
+
+    bus_enumerator_update_node_info(&be, "myboard", 42);
+    proxy.process(signal, 42);
+    CHECK_TRUE(messagebus_find_topic(&bus, "/myboard"));
+}
+
+TEST(ProxyTestGroup, ResolvesTopicAgainWhenBoardsChange)
+{
+    bus_enumerator_update_node_info(&be, "myboard", 42);
+    proxy.process(signal, 42);
+    auto* topic1 = messagebus_find_topic(&bus, "/myboard");
+
+    bus_enumerator_add_node(&be, "otherboard", nullptr);
+    proxy.process(signal, 42);
+    proxy.process(signal, 42);
+    auto* topic2 = messagebus_find_topic(&bus, "/myboard");
+
+    CHECK_EQUAL(2, proxy.topic_name_calls);
+    CHECK_EQUAL(topic1, topic2);
+}
+
 TEST(ProxyTestGroup, ForwardsCANReceivedMessages)
 {
     bus_enumerator_update_node_info(&be, "myboard", 42);
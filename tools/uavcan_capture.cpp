@@ -0,0 +1,100 @@
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <uavcan/uavcan.hpp>
+#include <uavcan_linux/uavcan_linux.hpp>
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include "can/batched_socketcan_driver.hpp"
+#include "can/can_capture.hpp"
+
+ABSL_FLAG(std::vector<std::string>, can_iface, {"vcan0"}, "SocketCAN interfaces to capture from, comma separated.");
+ABSL_FLAG(std::string, output, "capture.bin", "File to write the capture to.");
+ABSL_FLAG(int, duration, 0, "Duration of the capture in seconds, 0 to capture until interrupted.");
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+    stop_requested = 1;
+}
+
+int main(int argc, char** argv)
+{
+    absl::SetProgramUsageMessage("Records the raw traffic of CAN interfaces, to be played back by uavcan_replay.");
+    absl::ParseCommandLine(argc, argv);
+
+    uavcan_linux::SystemClock clock;
+    batched_socketcan::Driver driver(clock);
+
+    for (const auto& iface : absl::GetFlag(FLAGS_can_iface)) {
+        if (driver.addIface(iface) < 0) {
+            std::cerr << "Could not open " << iface << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream file(absl::GetFlag(FLAGS_output), std::ios::binary);
+    if (!file) {
+        std::cerr << "Could not open " << absl::GetFlag(FLAGS_output) << std::endl;
+        return 1;
+    }
+    CaptureWriter writer(file);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    const int duration = absl::GetFlag(FLAGS_duration);
+    const auto end = clock.getMonotonic() + uavcan::MonotonicDuration::fromMSec(duration * 1000);
+    uint64_t frame_count = 0;
+
+    while (!stop_requested && (duration == 0 || clock.getMonotonic() < end)) {
+        uavcan::CanSelectMasks masks;
+        masks.read = (1 << driver.getNumIfaces()) - 1;
+        const uavcan::CanFrame* pending[uavcan::MaxCanIfaces] = {};
+
+        // Wake up regularly to check for signals and the end of the capture
+        const auto deadline = clock.getMonotonic() + uavcan::MonotonicDuration::fromMSec(100);
+        if (driver.select(masks, pending, deadline) < 0) {
+            std::cerr << "Could not wait for frames" << std::endl;
+            return 1;
+        }
+
+        for (uint8_t i = 0; i < driver.getNumIfaces(); i++) {
+            uavcan::CanFrame frame;
+            uavcan::MonotonicTime ts_mono;
+            uavcan::UtcTime ts_utc;
+            uavcan::CanIOFlags flags;
+
+            while (driver.getIface(i)->receive(frame, ts_mono, ts_utc, flags) > 0) {
+                CaptureRecord record;
+                record.timestamp_us = ts_mono.toUSec();
+                record.iface = i;
+                record.dlc = frame.dlc;
+                memcpy(record.data, frame.data, frame.dlc);
+
+                if (frame.isExtended()) {
+                    record.id = (frame.id & uavcan::CanFrame::MaskExtID) | CaptureRecord::FlagExtended;
+                } else {
+                    record.id = frame.id & uavcan::CanFrame::MaskStdID;
+                }
+                if (frame.isRemoteTransmissionRequest()) {
+                    record.id |= CaptureRecord::FlagRemote;
+                }
+
+                if (!writer.write(record)) {
+                    std::cerr << "Could not write to " << absl::GetFlag(FLAGS_output) << std::endl;
+                    return 1;
+                }
+                frame_count++;
+            }
+        }
+    }
+
+    std::cout << "Captured " << frame_count << " frames" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <time.h>
+#include <uavcan/uavcan.hpp>
+#include <uavcan_linux/uavcan_linux.hpp>
+#include <absl/flags/flag.h>
+#include <absl/flags/parse.h>
+#include <absl/flags/usage.h>
+#include <absl/strings/numbers.h>
+#include "can/batched_socketcan_driver.hpp"
+#include "can/can_capture.hpp"
+#include "can/replay_can_driver.hpp"
+#include "can/uavcan_frame_header.hpp"
+
+// Data types handled by the master firmware. Including them registers them,
+// which allows the dump to show their names, and the in-process node
+// subscribes to them to exercise their decoding.
+#include <cvra/actuator/Feedback.hpp>
+#include <cvra/io/DigitalInput.hpp>
+#include <cvra/motor/EmergencyStop.hpp>
+#include <cvra/motor/feedback/CurrentPID.hpp>
+#include <cvra/motor/feedback/Index.hpp>
+#include <cvra/motor/feedback/MotorPosition.hpp>
+#include <cvra/motor/feedback/MotorTorque.hpp>
+#include <cvra/motor/feedback/PositionPID.hpp>
+#include <cvra/motor/feedback/VelocityPID.hpp>
+#include <cvra/odometry/WheelEncoder.hpp>
+#include <cvra/proximity_beacon/Signal.hpp>
+#include <cvra/sensor/DistanceVL6180X.hpp>
+#include <uavcan/protocol/NodeStatus.hpp>
+
+ABSL_FLAG(std::string, capture, "capture.bin", "Capture file recorded by uavcan_capture.");
+ABSL_FLAG(double, speed, 1., "Replay speed factor, 0 to replay as fast as possible.");
+ABSL_FLAG(std::vector<std::string>, nodes, {}, "Only replay frames sent by those node IDs, comma separated.");
+ABSL_FLAG(std::vector<std::string>, can_iface, {"vcan0"}, "SocketCAN interfaces to replay to, comma separated.");
+ABSL_FLAG(bool, in_process, false, "Replay into an in-process UAVCAN node instead of a CAN interface.");
+ABSL_FLAG(bool, dump, false, "Print the decoded frames.");
+
+constexpr unsigned NodeMemoryPoolSize = 16384;
+
+static uint64_t cpu_time_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static void dump_record(const CaptureRecord& record, uint64_t start_us)
+{
+    std::printf("%10.6f  %d  %08x  [%d]",
+                (record.timestamp_us - start_us) / 1e6,
+                record.iface, record.raw_id(), record.dlc);
+    for (int i = 0; i < record.dlc; i++) {
+        std::printf(" %02x", record.data[i]);
+    }
+
+    UavcanFrameHeader header;
+    if (record.id & CaptureRecord::FlagRemote
+        || !uavcan_decode_frame_header(record.raw_id(), record.extended(), record.dlc, record.data, &header)) {
+        std::printf("\n");
+        return;
+    }
+
+    const auto kind = header.service ? uavcan::DataTypeKindService : uavcan::DataTypeKindMessage;
+    const auto* descriptor = uavcan::GlobalDataTypeRegistry::instance().find(kind, uavcan::DataTypeID(header.data_type_id));
+
+    std::printf("  %s", descriptor ? descriptor->getFullName() : "unknown");
+    std::printf(" (%d) from %d", header.data_type_id, header.source_node);
+    if (header.service) {
+        std::printf(" to %d %s", header.destination_node, header.request ? "request" : "response");
+    }
+    std::printf(" tid=%d%s%s\n", header.transfer_id,
+                header.start_of_transfer ? " start" : "",
+                header.end_of_transfer ? " end" : "");
+}
+
+template <typename T>
+static std::shared_ptr<void> subscribe(uavcan::INode& node)
+{
+    auto sub = std::make_shared<uavcan::Subscriber<T>>(node);
+    if (sub->start([](const uavcan::ReceivedDataStructure<T>&) {}) < 0) {
+        throw std::runtime_error("Failed to subscribe to " + std::string(T::getDataTypeFullName()));
+    }
+    return sub;
+}
+
+static int replay_in_process(std::vector<CaptureRecord> records, float speed)
+{
+    uavcan_linux::SystemClock clock;
+    ReplayCanDriver driver(clock, std::move(records), speed);
+    uavcan::Node<NodeMemoryPoolSize> node(driver, clock);
+
+    const std::vector<std::shared_ptr<void>> subscribers = {
+        subscribe<cvra::actuator::Feedback>(node),
+        subscribe<cvra::io::DigitalInput>(node),
+        subscribe<cvra::motor::EmergencyStop>(node),
+        subscribe<cvra::motor::feedback::CurrentPID>(node),
+        subscribe<cvra::motor::feedback::Index>(node),
+        subscribe<cvra::motor::feedback::MotorPosition>(node),
+        subscribe<cvra::motor::feedback::MotorTorque>(node),
+        subscribe<cvra::motor::feedback::PositionPID>(node),
+        subscribe<cvra::motor::feedback::VelocityPID>(node),
+        subscribe<cvra::odometry::WheelEncoder>(node),
+        subscribe<cvra::proximity_beacon::Signal>(node),
+        subscribe<cvra::sensor::DistanceVL6180X>(node),
+        subscribe<uavcan::protocol::NodeStatus>(node),
+    };
+
+    const uint64_t cpu_start = cpu_time_ns();
+    while (!driver.done()) {
+        const int res = node.spin(uavcan::MonotonicDuration::fromMSec(100));
+        if (res < 0) {
+            std::cerr << "Transient failure: " << res << std::endl;
+        }
+    }
+    // Let the node process the frames it received last
+    node.spinOnce();
+    const uint64_t cpu_ns = cpu_time_ns() - cpu_start;
+
+    const size_t frames = driver.getFramesReplayed();
+    std::cout << "Replayed " << frames << " frames in process" << std::endl;
+    if (frames) {
+        std::cout << "CPU time per frame: " << cpu_ns / frames << " ns" << std::endl;
+    }
+
+    return 0;
+}
+
+static int replay_to_iface(const std::vector<CaptureRecord>& records, float speed)
+{
+    uavcan_linux::SystemClock clock;
+    batched_socketcan::Driver driver(clock);
+
+    for (const auto& iface : absl::GetFlag(FLAGS_can_iface)) {
+        if (driver.addIface(iface) < 0) {
+            std::cerr << "Could not open " << iface << std::endl;
+            return 1;
+        }
+    }
+
+    const auto start = clock.getMonotonic();
+    for (const auto& record : records) {
+        if (speed > 0) {
+            const uint64_t offset_us = (record.timestamp_us - records.front().timestamp_us) / speed;
+            const int64_t wait_us = (start + uavcan::MonotonicDuration::fromUSec(offset_us) - clock.getMonotonic()).toUSec();
+
+            // Frames due at the same time are sent as a single batch
+            if (wait_us > 0) {
+                driver.flush();
+                timespec ts;
+                ts.tv_sec = wait_us / 1000000;
+                ts.tv_nsec = (wait_us % 1000000) * 1000;
+                nanosleep(&ts, nullptr);
+            }
+        }
+
+        auto* iface = driver.getIface(record.iface % driver.getNumIfaces());
+        while (!iface->canAcceptTx()) {
+            uavcan::CanSelectMasks masks;
+            masks.write = (1 << driver.getNumIfaces()) - 1;
+            const uavcan::CanFrame* pending[uavcan::MaxCanIfaces] = {};
+            driver.select(masks, pending, clock.getMonotonic() + uavcan::MonotonicDuration::fromMSec(10));
+        }
+
+        uint32_t id = record.raw_id();
+        if (record.extended()) {
+            id |= uavcan::CanFrame::FlagEFF;
+        }
+        if (record.id & CaptureRecord::FlagRemote) {
+            id |= uavcan::CanFrame::FlagRTR;
+        }
+
+        const auto deadline = clock.getMonotonic() + uavcan::MonotonicDuration::fromMSec(1000);
+        iface->send(uavcan::CanFrame(id, record.data, record.dlc), deadline, 0);
+    }
+
+    driver.flush();
+
+    uint64_t dropped = 0;
+    for (uint8_t i = 0; i < driver.getNumIfaces(); i++) {
+        dropped += driver.getIface(i)->getTxDropCount();
+    }
+    std::cout << "Replayed " << records.size() << " frames, " << dropped << " dropped" << std::endl;
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    absl::SetProgramUsageMessage("Plays back a capture recorded by uavcan_capture on a CAN interface or into an in-process UAVCAN node.");
+    absl::ParseCommandLine(argc, argv);
+
+    std::ifstream file(absl::GetFlag(FLAGS_capture), std::ios::binary);
+    CaptureReader reader(file);
+    if (!reader.valid()) {
+        std::cerr << "Could not read a capture from " << absl::GetFlag(FLAGS_capture) << std::endl;
+        return 1;
+    }
+
+    CaptureNodeFilter filter;
+    for (const auto& node : absl::GetFlag(FLAGS_nodes)) {
+        int node_id;
+        if (!absl::SimpleAtoi(node, &node_id) || node_id < 1 || node_id > 127) {
+            std::cerr << "Invalid node ID \"" << node << "\" in --nodes, expected 1 to 127" << std::endl;
+            return 1;
+        }
+        filter.add(node_id);
+    }
+
+    std::vector<CaptureRecord> records;
+    CaptureRecord record;
+    while (reader.read(record)) {
+        if (filter.accepts(record)) {
+            records.push_back(record);
+        }
+    }
+
+    if (records.empty()) {
+        std::cerr << "No frames to replay" << std::endl;
+        return 1;
+    }
+
+    if (absl::GetFlag(FLAGS_dump)) {
+        for (const auto& r : records) {
+            dump_record(r, records.front().timestamp_us);
+        }
+    }
+
+    const float speed = absl::GetFlag(FLAGS_speed);
+    if (absl::GetFlag(FLAGS_in_process)) {
+        return replay_in_process(std::move(records), speed);
+    }
+
+    return replay_to_iface(records, speed);
+}